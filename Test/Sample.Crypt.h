@@ -90,5 +90,32 @@ DEF_SAMPLE(Crypt)
   #define crc_we    64, 0x42f0e1eba9ea3693, 0xffffffffffffffff, false, false, 0xffffffffffffffff, 0x62ec59e3f1a4f00a
   std::tcout << ts("crc64 we   -> ") << std::hex << vu::crypt_crc_buffer(data, crc_we) << std::endl;
 
+  // Hash Cache
+
+  std::tcout << ts("Crypt - Hash Cache") << std::endl;
+
+  {
+    vu::HashCache cache(ts("Crypt.Hash.Cache"));
+    assert(cache.ready());
+
+    std::tcout << ts("md5-file (cached)      -> ") << cache.md5(file_path) << std::endl;
+    std::tcout << ts("sha2-256-file (cached) -> ") << cache.sha(file_path, vu::sha_version::_2, vu::crypt_bits::_256) << std::endl;
+    std::tcout << ts("crc-32-file (cached)   -> ") << std::hex << cache.crc(file_path, vu::crypt_bits::_32) << std::endl;
+    assert(cache.md5(file_path) == vu::crypt_md5_file(file_path));
+
+    std::vector<std::tstring> file_paths;
+    file_paths.push_back(ts("C:\\Windows\\notepad.exe"));
+    file_paths.push_back(ts("C:\\Windows\\regedit.exe"));
+    file_paths.push_back(file_path);
+
+    for (const auto& e : cache.md5(file_paths))
+    {
+      std::tcout << ts("md5-file (cached)      -> ") << e << std::endl;
+    }
+
+    cache.compact();
+    std::tcout << ts("cached entries         -> ") << std::dec << cache.size() << std::endl;
+  }
+
   return vu::VU_OK;
 }
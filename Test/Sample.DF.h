@@ -71,6 +71,15 @@ DEF_SAMPLE(DF)
   std::tcout << ts("File Name : ") << file_path.extract_name().as_string() << std::endl;
   std::tcout << ts("File Directory : ") << file_path.extract_directory().as_string() << std::endl;
 
+  vu::PathPool path_pool;
+  vu::PathNode path_node(path_pool, ts("C:/Users/Vic\\.vscode\\extensions/../"));
+  auto path_node_tmp = path_node + ts("argv.json");
+  assert(path_node_tmp.parent() == path_node);
+  assert(path_node_tmp == path_node + ts("./ARGV.JSON"));
+  std::tcout << ts("Interned Path : ") << path_node_tmp.as_string() << std::endl;
+  std::tcout << ts("Interned Name : ") << path_node_tmp.name() << std::endl;
+  std::tcout << ts("Interned Size : ") << path_pool.size() << std::endl;
+
   auto path = ts("C:\\");
   std::tcout << vu::check_path_permissions(path, GENERIC_READ) << std::endl;
   std::tcout << vu::check_path_permissions(path, GENERIC_READ | GENERIC_WRITE) << std::endl;
@@ -42,5 +42,26 @@ DEF_SAMPLE(FileMapping)
     }
   }
 
+  vu::FileCursor cursor(ts("Test.txt"), 64 * KiB, 2);
+  if (cursor.ready())
+  {
+    vu::uint64 checksum = 0;
+
+    for (vu::uint64 offset = 0; offset < cursor.size();)
+    {
+      size_t size = 0;
+      auto ptr = cursor.view(offset, size);
+      if (ptr == nullptr)
+      {
+        break;
+      }
+
+      for (size_t i = 0; i < size; i++) checksum += ptr[i];
+      offset += size;
+    }
+
+    std::tcout << ts("Checksum = ") << checksum << std::endl;
+  }
+
   return vu::VU_OK;
 }
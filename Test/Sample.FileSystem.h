@@ -17,6 +17,35 @@ DEF_SAMPLE(FileSystem)
 
     std::tcout << _T("D = ") << D << std::endl;
   }
+  {
+    vu::FileSystem file(FILE_NAME, vu::FM_OPENEXISTING, vu::FG_READ, vu::FS_READ, vu::FA_OVERLAPPED);
+
+    char head[4] = { 0 }, tail[6] = { 0 };
+    std::vector<vu::FileSystemX::IOVector> buffers = { { head, sizeof(head) }, { tail, sizeof(tail) } };
+
+    size_t read_size = 0;
+    file.read_at(10, buffers, &read_size);
+    assert(read_size == 10 && memcmp(head, "test", 4) == 0 && memcmp(tail, " strin", 6) == 0);
+
+    std::atomic<size_t> total_size(0);
+    char parts[4][8] = { 0 };
+    for (size_t i = 0; i < 4; i++)
+    {
+      file.read_async(i * 5, parts[i], 5, [&](vu::ulong error_code, size_t transferred_size)
+      {
+        if (error_code == ERROR_SUCCESS) total_size += transferred_size;
+      });
+    }
+    file.wait_async();
+
+    std::tcout << _T("Read (async) = ") << total_size << _T(" bytes of ") << file.get_file_size_64() << std::endl;
+  }
+  {
+    vu::FileView file_view(FILE_NAME);
+    assert(file_view.ready() && file_view.mapped());
+    std::string s(reinterpret_cast<const char*>(file_view.data()), file_view.size());
+    std::tcout << _T("View = ") << s.c_str() << std::endl;
+  }
 
   vu::FileSystem::iterate(_T("C:\\Intel\\Logs"), _T("*.*"), [](const vu::FSObject& fso) -> bool
   {
@@ -24,5 +53,19 @@ DEF_SAMPLE(FileSystem)
     return true;
   });
 
+  vu::FSWalkOptions options;
+  options.patterns.push_back(_T("*.log"));
+  options.patterns.push_back(_T("*.txt"));
+  options.max_depth = 3;
+
+  size_t num_files = 0;
+  vu::FileSystem::walk(_T("C:\\Intel"), options, [&](const std::vector<vu::FSObject>& batch) -> bool
+  {
+    num_files += batch.size();
+    return true;
+  });
+
+  std::tcout << _T("Walk -> ") << num_files << _T(" file(s)") << std::endl;
+
   return vu::VU_OK;
 }
@@ -13,6 +13,54 @@ DEF_SAMPLE(UIDGlobal)
     std::tcout << vu::UIDGlobal::to_string(vu::UIDGlobal::to_guid(guid.as_string())) << std::endl;
   }
 
+  // Time-ordered (v7) identifiers are sorted by their creation time
+
+  std::vector<vu::Guid> guids;
+  for (auto& e : std::vector<int>(5))
+  {
+    guids.push_back(vu::UIDGlobal::generate(7));
+  }
+
+  assert(std::is_sorted(guids.cbegin(), guids.cend()));
+
+  for (const auto& guid : guids)
+  {
+    std::tcout << vu::UIDGlobal::to_string(guid) << ts(" v") << guid.version() << std::endl;
+  }
+
+  // Parsing & formatting into fixed buffers, and hashing
+
+  const size_t N = 1000000;
+
+  std::vector<char> texts(N * vu::GUIDX::GUID_LENGTH);
+  for (size_t i = 0; i < N; i++)
+  {
+    vu::GUIDX::to_chars(vu::GUIDX::generate(), &texts[i * vu::GUIDX::GUID_LENGTH]);
+  }
+
+  vu::ScopeStopWatch logger(ts("GUID =>"), ts(""), vu::ScopeStopWatch::console);
+
+  std::unordered_map<vu::Guid, size_t> map;
+  map.reserve(N);
+
+  for (size_t i = 0; i < N; i++)
+  {
+    vu::Guid guid = { 0 };
+    if (vu::GUIDX::from_chars(&texts[i * vu::GUIDX::GUID_LENGTH], vu::GUIDX::GUID_LENGTH, guid))
+    {
+      map[guid] = i;
+    }
+  }
+
+  logger.log(ts("Parsed & Mapped : "));
+
+  assert(map.size() == N);
+
+  vu::Guid guid = { 0 };
+  assert(!vu::GUIDX::from_chars("123e4567-e89b-12d3-a456-42661417400g", vu::GUIDX::GUID_LENGTH, guid));
+  assert(vu::GUIDX::from_chars("{123E4567-E89B-12D3-A456-426614174000}", vu::GUIDX::GUID_LENGTH + 2, guid));
+  assert(vu::GUIDA::to_string(guid) == "123e4567-e89b-12d3-a456-426614174000");
+
   #endif // VU_GUID_ENABLED
 
   return vu::VU_OK;
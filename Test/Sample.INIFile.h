@@ -33,6 +33,8 @@ DEF_SAMPLE(INIFile)
     section->write(ts("object"), &object, sizeof(object));
   }
 
+  ini.flush(); // the writes are batched in memory until flushed (or the destructor)
+
   std::cout << std::endl;
 
   std::vector<std::tstring> section_names;
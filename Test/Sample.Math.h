@@ -134,5 +134,234 @@ DEF_SAMPLE(Math)
     std::cout << big1 << std::endl;
   }
 
+  // BigNumber (64-bit limbs) vs. BigInt (decimal string)
+
+  {
+    std::string digits;
+    for (int i = 0; i < 2000; i++) digits += char('1' + i % 9);
+
+    const BigInt a(digits), b(digits.substr(0, 1500)), d(digits.substr(0, 700));
+    const vu::BigNumber x(digits), y(digits.substr(0, 1500)), z(digits.substr(0, 700));
+
+    const int N = 10;
+    BigInt c, q;
+    vu::BigNumber r, s;
+
+    vu::ScopeStopWatchA watcher("BigNumber ->", " ", vu::ScopeStopWatchA::console);
+
+    for (int i = 0; i < N; i++) c = a * b;
+    watcher.log("BigInt    (2000 x 1500 digits) * x %d :", N);
+
+    for (int i = 0; i < N; i++) r = x * y;
+    watcher.log("BigNumber (2000 x 1500 digits) * x %d :", N);
+
+    assert(r.to_string() == c.to_string());
+
+    q = a / d;
+    watcher.log("BigInt    (2000 / 700 digits) / x 1 :");
+
+    for (int i = 0; i < N; i++) s = x / z;
+    watcher.log("BigNumber (2000 / 700 digits) / x %d :", N);
+
+    assert(s.to_string() == q.to_string());
+
+    for (int i = 0; i < N; i++) digits = r.to_string();
+    watcher.log("BigNumber (3500 digits) to decimal x %d :", N);
+
+    // the modular exponentiation (RSA-2048 sized)
+
+    const auto modulus = (vu::BigNumber(1) << 2048) - 159;
+    const auto exponent = (vu::BigNumber(1) << 2047) + 12345;
+
+    auto power = pow_mod(3, exponent, modulus);
+    watcher.log("BigNumber 3^e mod m (2048 bits) x 1 :");
+
+    std::cout << power.to_string_hex().substr(0, 32) << "..." << std::endl;
+  }
+
+  // Structure-of-Arrays (batch kernels) vs. Array-of-Structures (point_t/rect_t)
+
+  {
+    const int N = 1 << 20;
+
+    std::vector<vu::v2f> aos_points(N);
+    std::vector<vu::r4f> aos_rects(N);
+    vu::points_soa_t<2, float> soa_points(N);
+    vu::rects_soa_t<float> soa_rects(N);
+
+    for (int i = 0; i < N; i++)
+    {
+      const auto x = float(i % 1000), y = float(i / 1000);
+      aos_points[i] = vu::v2f(x, y);
+      aos_rects[i]  = vu::r4f(x, y, x + float(i % 7), y + float(i % 5));
+      soa_points.set(i, aos_points[i]);
+      soa_rects.set(i, aos_rects[i]);
+    }
+
+    std::cout << "Batch ISA : " << vu::batch_t<float>::isa() << std::endl;
+
+    vu::ScopeStopWatchA watcher("SoA ->", " ", vu::ScopeStopWatchA::console);
+
+    const vu::v2f offset(1.5F, 2.5F);
+    for (auto& point : aos_points) point += offset;
+    watcher.log("AoS translate (%d points) :", N);
+
+    soa_points.translate(offset);
+    watcher.log("SoA translate (%d points) :", N);
+
+    std::vector<float> lengths(N);
+    for (int i = 0; i < N; i++) lengths[i] = float(aos_points[i].mag());
+    watcher.log("AoS length    (%d points) :", N);
+
+    soa_points.mag(lengths);
+    watcher.log("SoA length    (%d points) :", N);
+
+    const vu::p2f target(500.F, 500.F);
+    std::vector<vu::byte> mask(N);
+    for (int i = 0; i < N; i++)
+    {
+      const auto& r = aos_rects[i];
+      mask[i] = r.left() <= target.x() && target.x() < r.right() && r.top() <= target.y() && target.y() < r.bottom();
+    }
+    watcher.log("AoS contains  (%d rects)  :", N);
+
+    soa_rects.contains(target, mask);
+    watcher.log("SoA contains  (%d rects)  :", N);
+
+    size_t hits = 0;
+    for (const auto v : mask) hits += v;
+    std::cout << "Hits : " << hits << std::endl;
+
+    vu::rects_soa_t<float> unions;
+    soa_rects.unite(soa_rects, unions);
+    assert(unions.get(N - 1).right() == aos_rects[N - 1].right());
+  }
+
+  // Spatial Index (packed R-tree, uniform grid) vs. Brute Force
+
+  {
+    const int N = 10000, Q = 10000;
+
+    std::vector<vu::r4i> windows;
+    for (int i = 0; i < N; i++)
+    {
+      const int x = (i * 7919) % 3840, y = (i * 104729) % 2160;
+      windows.push_back(vu::r4i(x, y, x + 20 + i % 300, y + 20 + i % 200));
+    }
+
+    std::vector<vu::p2i> cursors;
+    for (int i = 0; i < Q; i++)
+    {
+      cursors.push_back(vu::p2i((i * 48271) % 3840, (i * 16807) % 2160));
+    }
+
+    vu::ScopeStopWatchA watcher("Spatial ->", " ", vu::ScopeStopWatchA::console);
+
+    vu::spatial_rtree_t<int> rtree(windows);
+    watcher.log("R-tree build (%d rects) :", N);
+
+    vu::spatial_grid_t<int> grid(128.);
+    for (const auto& window : windows) grid.insert(window);
+    watcher.log("Grid   build (%d rects) :", N);
+
+    size_t hits_brute = 0, hits_rtree = 0, hits_grid = 0;
+    std::vector<size_t> ids;
+
+    for (const auto& cursor : cursors)
+    {
+      for (const auto& window : windows)
+      {
+        hits_brute += window.left() <= cursor.x() && cursor.x() < window.right() &&
+          window.top() <= cursor.y() && cursor.y() < window.bottom();
+      }
+    }
+    watcher.log("Brute  hit-test (%d points) :", Q);
+
+    for (const auto& cursor : cursors) hits_rtree += rtree.query(cursor, ids);
+    watcher.log("R-tree hit-test (%d points) :", Q);
+
+    for (const auto& cursor : cursors) hits_grid += grid.query(cursor, ids);
+    watcher.log("Grid   hit-test (%d points) :", Q);
+
+    assert(hits_brute == hits_rtree && hits_brute == hits_grid);
+
+    size_t overlaps_rtree = 0, overlaps_grid = 0;
+
+    for (const auto& cursor : cursors)
+    {
+      overlaps_rtree += rtree.query(vu::r4i(cursor.x(), cursor.y(), cursor.x() + 64, cursor.y() + 64), ids);
+    }
+    watcher.log("R-tree overlap (%d rects) :", Q);
+
+    for (const auto& cursor : cursors)
+    {
+      overlaps_grid += grid.query(vu::r4i(cursor.x(), cursor.y(), cursor.x() + 64, cursor.y() + 64), ids);
+    }
+    watcher.log("Grid   overlap (%d rects) :", Q);
+
+    assert(overlaps_rtree == overlaps_grid);
+
+    for (const auto& cursor : cursors) rtree.nearest(cursor, 8, ids);
+    watcher.log("R-tree 8-nearest (%d points) :", Q);
+
+    for (const auto& cursor : cursors) grid.nearest(cursor, 8, ids);
+    watcher.log("Grid   8-nearest (%d points) :", Q);
+
+    for (int i = 0; i < N; i += 2)
+    {
+      const auto window = windows[i];
+      windows[i] = vu::r4i(window.left() + 5, window.top() + 5, window.right() + 5, window.bottom() + 5);
+      rtree.update(i, windows[i]);
+      grid.update(i, windows[i]);
+    }
+    watcher.log("Move (%d rects) :", N / 2);
+
+    std::cout << "Hits : " << hits_grid << ", Overlaps : " << overlaps_grid << std::endl;
+  }
+
+  // Batch Math (vectorized elementary functions) vs. C Run-Time
+
+  {
+    const int N = 1 << 20;
+
+    std::vector<float> in(N), out(N), ref(N);
+    for (int i = 0; i < N; i++) in[i] = 0.001F + float(i % 10000) * 0.01F;
+
+    vu::ScopeStopWatchA watcher("Batch Math ->", " ", vu::ScopeStopWatchA::console);
+
+    for (int i = 0; i < N; i++) ref[i] = 1.F / vu::fast_sqrtf(in[i]);
+    watcher.log("fast_sqrtf rsqrt (%d floats) :", N);
+
+    vu::batch_t<float>::rsqrt(in.data(), out.data(), N);
+    watcher.log("batch      rsqrt (%d floats) :", N);
+
+    for (int i = 0; i < N; i++) ref[i] = std::exp(in[i] * 0.001F);
+    watcher.log("std::exp         (%d floats) :", N);
+
+    vu::batch_t<float>::scale(in.data(), 0.001F, out.data(), N);
+    vu::batch_t<float>::exp(out.data(), out.data(), N);
+    watcher.log("batch      exp   (%d floats) :", N);
+
+    for (int i = 0; i < N; i++) ref[i] = std::log(in[i]);
+    watcher.log("std::log         (%d floats) :", N);
+
+    vu::batch_t<float>::log(in.data(), out.data(), N);
+    watcher.log("batch      log   (%d floats) :", N);
+
+    for (int i = 0; i < N; i++) ref[i] = std::sin(in[i]);
+    watcher.log("std::sin         (%d floats) :", N);
+
+    vu::batch_t<float>::sin(in.data(), out.data(), N);
+    watcher.log("batch      sin   (%d floats) :", N);
+
+    float error = 0.F;
+    for (int i = 0; i < N; i++) error = std::max(error, std::fabs(out[i] - ref[i]));
+    std::cout << "Max |sin error| : " << error << std::endl;
+
+    const std::vector<vu::uint64> values = { 1234567890ULL * 6, 1234567890ULL * 10, 1234567890ULL * 15 };
+    std::cout << "GCD : " << vu::gcd(values.data(), values.size()) << std::endl; // 1234567890
+    std::cout << "LCM : " << vu::lcm(values.data(), values.size()) << std::endl; // 37037036700
+  }
+
   return vu::VU_OK;
 }
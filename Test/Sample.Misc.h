@@ -167,6 +167,32 @@ DEF_SAMPLE(Misc)
     std::tcout << ts("Called #") << i << std::endl; Sleep(100);
   }
 
+  // Throttler
+  // - Call the lambda function 10 times, and 0.1 second per each call
+  // - But the calls are really executed at most once per 0.5 second (the leading and the trailing calls)
+  for (int i = 1; i <= 10; i++)
+  {
+    vu::Debouncer::instance().throttle(__LINE__, 500, [i]() -> void
+    {
+      std::tcout << ts("This message printed by Throttler at most once per 0.5 second #") << i << std::endl;
+    });
+
+    Sleep(100);
+  }
+
+  // Timer Wheel
+  // - The periodic timer is fired every 0.2 second until it is cancelled
+  {
+    vu::TimerWheel timers;
+    auto id = timers.schedule(200, []() -> void
+    {
+      std::tcout << ts("This message printed by Timer Wheel every 0.2 second") << std::endl;
+    }, 200);
+
+    Sleep(1000);
+    timers.cancel(id);
+  }
+
   MessageBoxA(nullptr, "This message box just keep for the program running...", "", MB_OK);
 
   #ifdef VU_HAS_EASY_PRINT
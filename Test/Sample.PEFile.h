@@ -145,5 +145,50 @@ DEF_SAMPLE(PEFile)
     std::tcout << vu::format(fmt, entry.rva, entry.value, value) << std::endl;
   }
 
+  SEPERATOR()
+
+  pe.get_resource_root().iterate([](const vu::PEResourceNode& type) -> bool
+  {
+    if (type.id().named())
+    {
+      std::wcout << type.id().name.as_string();
+    }
+    else
+    {
+      std::wcout << type.id().id;
+    }
+
+    std::wcout << L" -> " << type.count() << L" item(s)" << std::endl;
+
+    return true;
+  });
+
+  SEPERATOR()
+
+  vu::PEVersionInfo version_info;
+  if (pe.get_version_info(version_info))
+  {
+    for (const auto& e : version_info.strings)
+    {
+      std::wcout << e.key.as_string() << L" = " << e.value.as_string() << std::endl;
+    }
+  }
+
+  SEPERATOR()
+
+  pe.iterate_resource_strings([](const vu::uint id, const vu::PEResourceText& text) -> bool
+  {
+    std::wcout << id << L" : " << text.as_string() << std::endl;
+    return true;
+  });
+
+  SEPERATOR()
+
+  vu::PEResourceData manifest;
+  if (pe.get_manifest(manifest))
+  {
+    std::cout << std::string(reinterpret_cast<const char*>(manifest.ptr), manifest.size) << std::endl;
+  }
+
   return vu::VU_OK;
 }
@@ -15,5 +15,52 @@ DEF_SAMPLE(StopWatch)
   Sleep(500);
   logger.log(ts("Test 3 : "));
 
+  vu::StopWatch watcher(true);
+  for (int i = 0; i < 1000; i++)
+  {
+    watcher.start();
+    Sleep(i % 3);
+    watcher.stop();
+  }
+
+  const auto& stats = watcher.stats();
+  const auto  histogram = watcher.histogram();
+  std::tcout << ts("StopWatch -> Laps ") << stats.count()
+             << ts(", Min ") << stats.minimum() << ts("ns")
+             << ts(", Max ") << stats.maximum() << ts("ns")
+             << ts(", Mean ") << stats.mean() << ts("ns")
+             << ts(", StdDev ") << stats.stddev() << ts("ns") << std::endl;
+  std::tcout << ts("StopWatch -> P50 ") << histogram->percentile(50.)  << ts("ns")
+             << ts(", P99 ")   << histogram->percentile(99.)  << ts("ns")
+             << ts(", P99.9 ") << histogram->percentile(99.9) << ts("ns") << std::endl;
+
+  auto& profiler = vu::Profiler::instance();
+  profiler.start();
+
+  for (int i = 0; i < 100; i++)
+  {
+    VU_PROFILE_ZONE("Outer");
+    for (int j = 0; j < 10; j++)
+    {
+      VU_PROFILE_ZONE("Inner");
+      Sleep(0);
+    }
+  }
+
+  profiler.stop();
+
+  for (const auto& e : profiler.summaries())
+  {
+    std::cout << "Profiler -> " << e.site->name
+              << " : Count " << e.stats.count()
+              << ", Total " << e.stats.total() << "ns"
+              << ", Self " << e.self_ns << "ns" << std::endl;
+  }
+
+  std::cout << profiler.to_folded_stacks();
+
+  const auto trace = profiler.to_chrome_trace();
+  vu::write_file_binary(ts("StopWatch.Trace.json"), (const vu::byte*)trace.data(), trace.size());
+
   return vu::VU_OK;
 }
@@ -18,6 +18,14 @@ DEF_SAMPLE(String)
   for (auto e : l) std::tcout << e << ts("|");
   std::tcout << std::endl;
 
+  #if defined(VU_HAS_CXX17)
+  for (const auto& e : vu::SplitString(ts("THIS,IS,,A,LAZY,SPLIT,STRING"), ts(','), true))
+  {
+    std::tcout << e << ts("|");
+  }
+  std::tcout << std::endl;
+  #endif // VU_HAS_CXX17
+
   l.clear();
   l = vu::multi_string_to_list(ts("THIS\0IS\0A\0MULTI\0STRING\0\0"));
   for (auto& e : l) std::tcout << e << ts("|");
@@ -25,6 +33,16 @@ DEF_SAMPLE(String)
 
   std::tcout << vu::date_time_to_string(time(NULL)) << std::endl;
 
+  vu::TimestampFormatter timestamp_formatter;
+  std::tcout << timestamp_formatter.to_string() << std::endl;
+
+  vu::TimestampFormatterA log_formatter("[%d/%m/%Y %H:%M:%S.%6f] ");
+  char log_prefix[64];
+  if (log_formatter.write(log_prefix, sizeof(log_prefix)) != 0)
+  {
+    std::cout << log_prefix << "a log line" << std::endl;
+  }
+
   std::cout << vu::to_string_A(L"THIS IS A WIDE STRING") << std::endl;
   std::wcout << vu::to_string_W("THIS IS AN ANSI STRING") << std::endl;
 
@@ -50,6 +68,9 @@ DEF_SAMPLE(String)
   std::tcout << vu::compare_string(ts("C++"), ts("c++"), false) << std::endl;
   std::tcout << vu::compare_string(ts("C++"), ts("c++"), true)  << std::endl;
 
+  std::tcout << vu::find_string(ts("Written in C++ and for C++"), ts("AND"), true) << std::endl;
+  std::tcout << vu::upper_string(ts("Written in C++ and for C++")) << std::endl;
+
   struct
   {
     vu::text_encoding encoding;
@@ -92,6 +113,62 @@ DEF_SAMPLE(String)
     }
   }
 
+  // UTF-8 <-> UTF-16 throughput
+
+  {
+    std::string utf8;
+    for (int i = 0; i < 100000; i++)
+    {
+      utf8 += "The quick brown fox jumps over the lazy dog. ";
+      utf8 += "Ti\xE1\xBA\xBFng Vi\xE1\xBB\x87t \xE4\xB8\xAD\xE6\x96\x87 \xF0\x9F\x98\x80 ";
+    }
+
+    const auto mb = float(utf8.size()) / (MB);
+
+    std::wstring utf16;
+    std::string round_trip;
+
+    vu::ScopeStopWatchA watcher("Transcoding ->", " ", vu::ScopeStopWatchA::console);
+
+    for (int i = 0; i < 10; i++) utf16 = vu::to_string_W(utf8, true);
+    watcher.log("UTF-8 to UTF-16 (%.2f MB x 10) :", mb);
+
+    for (int i = 0; i < 10; i++) round_trip = vu::to_string_A(utf16, true);
+    watcher.log("UTF-16 to UTF-8 (%.2f MB x 10) :", mb);
+
+    assert(round_trip == utf8);
+
+    std::wstring invalid;
+    assert(!vu::utf8_to_utf16("\xC0\xAF", 2, invalid, true) && invalid.empty());
+  }
+
+  // format_to (single pass) vs. format (printf-style)
+
+  {
+    std::cout << vu::format_string("{} | {:08X} | {:.3f} | {:6} | {}", 42, 0xC0FFEE, 3.14159, "text", true) << std::endl;
+
+    const int N = 1000000;
+    size_t total = 0;
+
+    vu::ScopeStopWatchA watcher("Formatting ->", " ", vu::ScopeStopWatchA::console);
+
+    for (int i = 0; i < N; i++)
+    {
+      total += vu::format_A("[%d] %s value=%d ratio=%.2f", i, "Vutils.dll", 7 * i, 0.5 * i).size();
+    }
+    watcher.log("format_A x %d :", N);
+
+    vu::FormatBufferA buffer;
+    for (int i = 0; i < N; i++)
+    {
+      buffer.clear();
+      total -= vu::format_to(buffer, "[{}] {} value={} ratio={:.2f}", i, "Vutils.dll", 7 * i, 0.5 * i).size();
+    }
+    watcher.log("format_to x %d :", N);
+
+    assert(total == 0);
+  }
+
   std::vector<std::tstring> strings;
   {
     strings.push_back(ts("ape"));
@@ -102,5 +179,12 @@ DEF_SAMPLE(String)
   auto closest_string = vu::find_closest_string(ts("aple"), strings);
   assert(closest_string == ts("apple"));
 
+  vu::FuzzyIndex fuzzy_index(strings);
+  for (const auto& e : fuzzy_index.find(ts("appel"), 3, 3))
+  {
+    std::tcout << fuzzy_index.at(e.first) << ts(" (") << e.second << ts(")") << std::endl;
+  }
+  assert(fuzzy_index.closest(ts("pech")) == ts("peach"));
+
   return vu::VU_OK;
 }
@@ -76,5 +76,112 @@ DEF_SAMPLE(ThreadPool)
 
   logger.log(ts("Taken : "));
 
+  // Parallel Loop (balanced and cache-line aligned pieces)
+
+  logger.reset();
+
+  std::vector<double> values(10000000);
+  const auto num_pieces = pool.parallel_for(values.size(), [&](const vu::piece_t& piece)
+  {
+    for (size_t i = piece.beg; i <= piece.end; i++)
+    {
+      values[i] = std::sqrt(double(i));
+    }
+  }, 4096, 64 / sizeof(double));
+
+  std::cout << "pieces is " << num_pieces << std::endl;
+
+  logger.log(ts("Taken : "));
+
+  vu::divide_items(10, 4, [](const vu::piece_t& piece)
+  {
+    std::cout << piece.idx << " : [" << piece.beg << ", " << piece.end << "] " << piece.num << std::endl;
+  });
+
+  // Lock Contention (short critical sections)
+
+  const auto contend = [](std::function<void()> fn_lock, std::function<void()> fn_unlock)
+  {
+    const int n_threads = std::max(4, int(std::thread::hardware_concurrency()));
+    const int n_iterations = 200000;
+
+    long long counter = 0;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < n_threads; i++)
+    {
+      threads.emplace_back([&]()
+      {
+        for (int j = 0; j < n_iterations; j++)
+        {
+          fn_lock();
+          counter++;
+          fn_unlock();
+        }
+      });
+    }
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    assert(counter == (long long)n_threads * n_iterations);
+  };
+
+  vu::ThreadLock thread_lock;
+  logger.reset();
+  contend([&]() { thread_lock.lock(); }, [&]() { thread_lock.unlock(); });
+  logger.log(ts("ThreadLock    : "));
+
+  std::mutex std_mutex;
+  logger.reset();
+  contend([&]() { std_mutex.lock(); }, [&]() { std_mutex.unlock(); });
+  logger.log(ts("std::mutex    : "));
+
+  vu::AdaptiveMutex adaptive_mutex;
+  logger.reset();
+  contend([&]() { adaptive_mutex.lock(); }, [&]() { adaptive_mutex.unlock(); });
+  logger.log(ts("AdaptiveMutex : "));
+
+  vu::ReadWriteLock rw_lock;
+  logger.reset();
+  contend([&]() { rw_lock.lock(); }, [&]() { rw_lock.unlock(); });
+  logger.log(ts("ReadWriteLock : "));
+
+  std::atomic<int> n_readers(0);
+  vu::Latch latch(4);
+  vu::Barrier barrier(4);
+  vu::LightEvent event;
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++)
+  {
+    readers.emplace_back([&]()
+    {
+      event.wait();
+      for (int j = 0; j < 100000; j++)
+      {
+        rw_lock.lock_shared();
+        n_readers++;
+        rw_lock.unlock_shared();
+      }
+      barrier.arrive_and_wait();
+      latch.count_down();
+    });
+  }
+
+  logger.reset();
+  event.set();
+  latch.wait();
+  logger.log(ts("ReadWriteLock (shared) : "));
+
+  for (auto& reader : readers)
+  {
+    reader.join();
+  }
+
+  assert(n_readers == 4 * 100000);
+
   return vu::VU_OK;
 }
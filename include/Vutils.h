@@ -108,9 +108,11 @@
 #include <string>
 #include <vector>
 #include <thread>
+#include <condition_variable>
 #include <memory>
 #include <atomic>
 #include <numeric>
+#include <algorithm>
 #include <sstream>
 #include <cassert>
 #include <functional>
@@ -118,6 +120,10 @@
 #include <unordered_map>
 #if defined(VU_HAS_CXX17)
 #include <any>
+#include <string_view>
+#if __has_include(<charconv>)
+#include <charconv>
+#endif // __has_include(<charconv>)
 #endif // VU_HAS_CXX17
 
 #ifdef _MSC_VER
@@ -194,10 +200,6 @@ const VUResult VU_OK  = 0;
 
 const size_t MAX_SIZE = MAXBYTE;
 
-/* Vutils Third Party */
-
-typedef BigInt BigNumber;
-
 /* ------------------------------------ Public Function(s) -------------------------------------- */
 
 /**
@@ -232,6 +234,8 @@ bool vuapi use_std_io_console_window();
 bool vuapi is_flag_on(ulongptr flags, ulongptr flag);
 intptr vuapi gcd(ulongptr count, ...); // UCLN
 intptr vuapi lcm(ulongptr count, ...); // BCNN
+uint64 vuapi gcd(const uint64* values, const size_t count); // the binary GCD reduction (0 for none)
+uint64 vuapi lcm(const uint64* values, const size_t count); // 1 for none, 0 if any value is 0 or it overflows
 void vuapi hex_dump(const void* data, int size);
 float vuapi fast_sqrtf(const float number); // Estimates the square root of a 32-bit floating-point number (from Quake III Arena)
 
@@ -248,8 +252,103 @@ void divide_items_into_pieces(const size_t num_items, const size_t num_pieces,
   std::function<void(const piece_t& piece)> fn);
 size_t divide_items_into_num_items_per_piece(const size_t num_items, const size_t num_items_per_piece,
   std::function<void(const piece_t& piece)> fn);
+size_t divide_items(const size_t num_items, const size_t num_pieces,
+  std::function<void(const piece_t& piece)> fn, const size_t grain_size = 1, const size_t alignment = 1);
+size_t divide_items_count(const size_t num_items, const size_t num_pieces,
+  const size_t grain_size = 1, const size_t alignment = 1);
+piece_t divide_items_at(const size_t num_items, const size_t num_pieces, const size_t idx,
+  const size_t grain_size = 1, const size_t alignment = 1);
+
+/**
+ * BigNumber - The arbitrary-precision integer that is stored as the 64-bit limbs (sign and magnitude).
+ * The multiplication switches from the schoolbook to Karatsuba then Toom-3 by the operand sizes,
+ * the division is Knuth's algorithm D and the modular exponentiation of an odd modulus is done
+ * in the Montgomery form. The decimal and the hexadecimal (0x) texts are converted by the limb chunks.
+ * It has the same operators as the decimal-string BigInt (3rdparty) which is converted implicitly.
+ * Eg. BigNumber n = "0xFFFFFFFFFFFFFFFFFF"; auto r = pow_mod(n, 65537, "1000000007");
+ */
+
+class BigNumber
+{
+public:
+  BigNumber();
+  BigNumber(const BigNumber& num);
+  BigNumber(BigNumber&& num);
+  BigNumber(const long long num);
+  template <size_t N> BigNumber(const char (&num)[N]) : m_negative(false) { this->assign(num); } // the literals
+  BigNumber(const std::string& num);
+  BigNumber(const BigInt& num);
+  virtual ~BigNumber();
+
+  BigNumber& operator=(const BigNumber& num);
+  BigNumber& operator=(BigNumber&& num);
+
+  BigNumber operator+() const;
+  BigNumber operator-() const;
+
+  BigNumber& operator+=(const BigNumber& num);
+  BigNumber& operator-=(const BigNumber& num);
+  BigNumber& operator*=(const BigNumber& num);
+  BigNumber& operator/=(const BigNumber& num);
+  BigNumber& operator%=(const BigNumber& num);
+  BigNumber& operator<<=(const size_t bits); // the shifts are applied to the magnitude
+  BigNumber& operator>>=(const size_t bits);
+
+  BigNumber& operator++();
+  BigNumber& operator--();
+  BigNumber operator++(int);
+  BigNumber operator--(int);
+
+  friend BigNumber operator+(const BigNumber& left, const BigNumber& right);
+  friend BigNumber operator-(const BigNumber& left, const BigNumber& right);
+  friend BigNumber operator*(const BigNumber& left, const BigNumber& right);
+  friend BigNumber operator/(const BigNumber& left, const BigNumber& right);
+  friend BigNumber operator%(const BigNumber& left, const BigNumber& right);
+  friend BigNumber operator<<(const BigNumber& num, const size_t bits);
+  friend BigNumber operator>>(const BigNumber& num, const size_t bits);
+
+  friend bool operator==(const BigNumber& left, const BigNumber& right);
+  friend bool operator!=(const BigNumber& left, const BigNumber& right);
+  friend bool operator<(const BigNumber& left, const BigNumber& right);
+  friend bool operator>(const BigNumber& left, const BigNumber& right);
+  friend bool operator<=(const BigNumber& left, const BigNumber& right);
+  friend bool operator>=(const BigNumber& left, const BigNumber& right);
+
+  friend std::istream& operator>>(std::istream& is, BigNumber& num);
+  friend std::ostream& operator<<(std::ostream& os, const BigNumber& num);
+
+  std::string to_string() const;
+  std::string to_string_hex() const; // "0x" prefixed, so that it round-trips through the constructor
+  int to_int() const;
+  long to_long() const;
+  long long to_long_long() const;
+
+  bool is_zero() const;
+  bool is_negative() const;
+  bool is_odd() const;
+  size_t bit_length() const;
+
+  // The functions are only found by the argument-dependent lookup, so they never hide the ones of numbers
+
+  friend BigNumber abs(const BigNumber& num);
+  friend BigNumber pow(const BigNumber& base, int exp);
+  friend BigNumber sqrt(const BigNumber& num);
+  friend BigNumber gcd(const BigNumber& num1, const BigNumber& num2);
+  friend BigNumber lcm(const BigNumber& num1, const BigNumber& num2);
+  friend BigNumber pow_mod(const BigNumber& base, const BigNumber& exp, const BigNumber& mod);
+  friend void div_mod(const BigNumber& dividend, const BigNumber& divisor, BigNumber& quotient, BigNumber& remainder);
+
+private:
+  void assign(const std::string& num);
+  void normalize();
+
+private:
+  std::vector<uint64> m_limbs; // the magnitude in little-endian without the leading zero limbs (empty is zero)
+  bool m_negative;
+};
 
 #include "template/math.tpl"
+#include "template/spatial.tpl"
 
 /**
  * String Formatting
@@ -317,8 +416,14 @@ std::string vuapi lower_string_A(const std::string& string);
 std::wstring vuapi lower_string_W(const std::wstring& string);
 std::string vuapi upper_string_A(const std::string& string);
 std::wstring vuapi upper_string_W(const std::wstring& string);
+void vuapi lower_string_in_place_A(std::string& string);
+void vuapi lower_string_in_place_W(std::wstring& string);
+void vuapi upper_string_in_place_A(std::string& string);
+void vuapi upper_string_in_place_W(std::wstring& string);
 std::string vuapi to_string_A(const std::wstring& string, const bool utf8 = false); // ANSI or UTF-8
 std::wstring vuapi to_string_W(const std::string& string, const bool utf8 = false); // ANSI or UTF-8
+bool vuapi utf8_to_utf16(const char* ptr, const size_t length, std::wstring& result, const bool strict = false);
+bool vuapi utf16_to_utf8(const wchar* ptr, const size_t length, std::string& result, const bool strict = false);
 std::vector<std::string> vuapi split_string_A(
   const std::string& string, const std::string& separator, bool remove_empty = false);
 std::vector<std::wstring> vuapi split_string_W(
@@ -349,6 +454,8 @@ bool vuapi ends_with_A(const std::string& text, const std::string& with, bool ig
 bool vuapi ends_with_W(const std::wstring& text, const std::wstring& with, bool ignore_case = false);
 bool vuapi contains_string_A(const std::string& text, const std::string& test, bool ignore_case = false);
 bool vuapi contains_string_W(const std::wstring& text, const std::wstring& test, bool ignore_case = false);
+size_t vuapi find_string_A(const std::string& text, const std::string& test, bool ignore_case = false);
+size_t vuapi find_string_W(const std::wstring& text, const std::wstring& test, bool ignore_case = false);
 bool vuapi compare_string_A(const std::string& vl, const std::string& vr, bool ignore_case = false);
 bool vuapi compare_string_W(const std::wstring& vl, const std::wstring& vr, bool ignore_case = false);
 std::string vuapi regex_replace_string_A(
@@ -366,6 +473,9 @@ std::string vuapi find_closest_string_A(
 std::wstring vuapi find_closest_string_W(
   const std::wstring& string, const std::vector<std::wstring>& string_list);
 
+#include "template/string.tpl"
+#include "template/strfmt.tpl"
+
 /**
  * Process Working
  */
@@ -792,6 +902,8 @@ void vuapi crypt_sha_buffer(
 /* String Working */
 #define lower_string lower_string_W
 #define upper_string upper_string_W
+#define lower_string_in_place lower_string_in_place_W
+#define upper_string_in_place upper_string_in_place_W
 #define split_string split_string_W
 #define join_string join_string_W
 #define multi_string_to_list multi_string_to_list_W
@@ -802,6 +914,7 @@ void vuapi crypt_sha_buffer(
 #define starts_with starts_with_W
 #define ends_with ends_with_W
 #define contains_string contains_string_W
+#define find_string find_string_W
 #define compare_string compare_string_W
 #define regex_replace_string regex_replace_string_W
 #define find_closest_string find_closest_string_W
@@ -868,6 +981,8 @@ void vuapi crypt_sha_buffer(
 /* String Working */
 #define lower_string lower_string_A
 #define upper_string upper_string_A
+#define lower_string_in_place lower_string_in_place_A
+#define upper_string_in_place upper_string_in_place_A
 #define split_string split_string_A
 #define join_string join_string_A
 #define multi_string_to_list multi_string_to_list_A
@@ -877,6 +992,7 @@ void vuapi crypt_sha_buffer(
 #define starts_with starts_with_A
 #define ends_with ends_with_A
 #define contains_string contains_string_A
+#define find_string find_string_A
 #define compare_string compare_string_A
 #define regex_replace_string regex_replace_string_A
 #define find_closest_string find_closest_string_A
@@ -1006,19 +1122,65 @@ struct Guid
   const Guid& operator = (const Guid &right) const;
   bool operator == (const Guid &right) const;
   bool operator != (const Guid &right) const;
+
+  /**
+   * Orders by the canonical (RFC 9562) byte order, so that sorted indexes of time-ordered (v7)
+   * identifiers are sorted by their creation time.
+   */
+  bool operator <  (const Guid &right) const;
+  bool operator >  (const Guid &right) const;
+  bool operator <= (const Guid &right) const;
+  bool operator >= (const Guid &right) const;
+
+  int version() const;
+  bool empty() const;
+};
+
+/**
+ * The hasher of Guid for unordered containers. Eg. std::unordered_map<vu::Guid, T, vu::GuidHash>.
+ * The std::hash<vu::Guid> specialization is also provided and uses the same function.
+ */
+struct GuidHash
+{
+  size_t operator()(const Guid& guid) const;
 };
 
 class GUIDX
 {
 public:
-  GUIDX(bool create = false);
+  static const size_t GUID_LENGTH = 36; // xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
+
+  GUIDX(bool create = false, int version = 4);
   virtual ~GUIDX();
 
   const GUIDX& operator = (const GUIDX& right);
   bool operator == (const GUIDX& right) const;
   bool operator != (const GUIDX& right) const;
 
-  bool create();
+  /**
+   * Creates a random (v4) or a time-ordered (v7) identifier.
+   * The random bits come from a per-thread ChaCha20 generator that is seeded by the system CSPRNG.
+   * The v7 identifiers that are created by the same thread are strictly increasing.
+   */
+  bool create(int version = 4);
+
+  static Guid generate(int version = 4);
+
+  /**
+   * Formats to the canonical lower-case form, without allocating and without the terminator.
+   * The buffer must be at least GUID_LENGTH characters. Returns the number of characters written.
+   */
+  static size_t to_chars(const Guid& guid, char* buffer, bool upper = false);
+  static size_t to_chars(const Guid& guid, wchar_t* buffer, bool upper = false);
+
+  /**
+   * Parses the canonical form in any letter case, optionally enclosed in braces, or 32 hex digits.
+   * Returns false and leaves the guid unchanged if the text is not exactly one of these forms.
+   */
+  static bool from_chars(const char* text, size_t length, Guid& guid);
+  static bool from_chars(const wchar_t* text, size_t length, Guid& guid);
+
+  static size_t hash(const Guid& guid);
 
   const Guid& GUID() const;
   void  GUID(const Guid& guid);
@@ -1031,7 +1193,7 @@ protected:
 class GUIDA : public GUIDX
 {
 public:
-  GUIDA(bool create = false) : GUIDX(create) {}
+  GUIDA(bool create = false, int version = 4) : GUIDX(create, version) {}
   virtual ~GUIDA() {}
 
   void parse(const std::string& guid);
@@ -1044,7 +1206,7 @@ public:
 class GUIDW : public GUIDX
 {
 public:
-  GUIDW(bool create = false) : GUIDX(create) {}
+  GUIDW(bool create = false, int version = 4) : GUIDX(create, version) {}
   virtual ~GUIDW() {}
 
   void parse(const std::wstring& guid);
@@ -1111,31 +1273,64 @@ private:
 
 /**
  * Variant
+ * The tagged union of a native value (bool, integer, floating point), a string or bytes.
+ * The value is converted (by from_chars/to_chars when available) and produced as text on demand.
+ * Streaming a value into a non-empty variant appends its text (the same as a string stream).
  */
 
-template <class T>
+enum class variant_type : byte
+{
+  VAR_EMPTY = 0,
+  VAR_BOOL,
+  VAR_INT,
+  VAR_UINT,
+  VAR_FLOAT,
+  VAR_DOUBLE,
+  VAR_STRING,
+  VAR_BYTES,
+};
+
+template <typename T, typename CharT>
+struct __vu_variant_kind
+{
+  static const int value =
+    std::is_same<T, bool>::value ? 1 :
+    std::is_same<T, CharT>::value || std::is_same<T, char>::value ? 2 :
+    std::is_enum<T>::value ? 3 :
+    std::is_integral<T>::value && std::is_signed<T>::value ? 4 :
+    std::is_integral<T>::value ? 5 :
+    std::is_same<T, float>::value ? 6 :
+    std::is_floating_point<T>::value ? 7 :
+    std::is_same<T, const CharT*>::value || std::is_same<T, CharT*>::value ? 8 :
+    std::is_same<T, std::basic_string<CharT>>::value ? 9 :
+    std::is_same<T, std::vector<byte>>::value ? 10 : 0;
+};
+
+template <class StringT>
 class VariantT
 {
 public:
+  typedef typename StringT::value_type char_type;
+
   VariantT();
   VariantT(const VariantT& right);
+  VariantT(VariantT&& right);
   virtual ~VariantT();
 
   VariantT& operator=(const VariantT& right);
-
-  T& data()
-  {
-    return *m_data;
-  }
+  VariantT& operator=(VariantT&& right);
 
   template<typename V>
-  friend VariantT& operator<<(VariantT& stream, V v)
+  friend VariantT& operator<<(VariantT& var, const V& v)
   {
-    stream.data() << v;
-    return stream;
+    typedef typename std::decay<V>::type D;
+    var.put(v, std::integral_constant<int, __vu_variant_kind<D, char_type>::value>());
+    return var;
   }
 
+  variant_type type() const;
   bool empty() const;
+  void clear();
 
   int to_int() const;
   unsigned int to_uint() const;
@@ -1145,12 +1340,75 @@ public:
   float to_float() const;
   double to_double() const;
   std::unique_ptr<byte[]> to_bytes() const;
+  StringT to_string() const;
+
+protected:
+  void put_bool(const bool v);
+  void put_int(const int64 v);
+  void put_uint(const uint64 v);
+  void put_float(const float v);
+  void put_double(const double v);
+  void put_text(const char_type* ptr, const size_t length);
+  void put_bytes(const std::vector<byte>& bytes);
+  void put_variant(VariantT&& value);
+
+private:
+  template <typename V>
+  void put(const V& v, std::integral_constant<int, 0>)
+  {
+    std::basic_ostringstream<char_type> ss;
+    ss << v;
+    const auto s = ss.str();
+    this->put_text(s.data(), s.size());
+  }
+
+  void put(const bool v, std::integral_constant<int, 1>) { this->put_bool(v); }
+  template <typename V>
+  void put(const V& v, std::integral_constant<int, 2>)
+  {
+    const auto c = char_type(typename std::make_unsigned<V>::type(v));
+    this->put_text(&c, 1);
+  }
+
+  template <typename V>
+  void put(const V& v, std::integral_constant<int, 3>) { this->put_int(int64(v)); }
+  template <typename V>
+  void put(const V& v, std::integral_constant<int, 4>) { this->put_int(int64(v)); }
+  template <typename V>
+  void put(const V& v, std::integral_constant<int, 5>) { this->put_uint(uint64(v)); }
+
+  void put(const float v, std::integral_constant<int, 6>) { this->put_float(v); }
+
+  template <typename V>
+  void put(const V& v, std::integral_constant<int, 7>) { this->put_double(double(v)); }
+
+  void put(const char_type* v, std::integral_constant<int, 8>)
+  {
+    this->put_text(v, v != nullptr ? std::char_traits<char_type>::length(v) : 0);
+  }
+
+  void put(const StringT& v, std::integral_constant<int, 9>) { this->put_text(v.data(), v.size()); }
+  void put(const std::vector<byte>& v, std::integral_constant<int, 10>) { this->put_bytes(v); }
+
+  void to_text(StringT& text) const;
 
 protected:
-  std::unique_ptr<T> m_data;
+  variant_type m_type;
+
+  union
+  {
+    bool   b;
+    int64  i;
+    uint64 u;
+    float  f;
+    double d;
+  } m_value;
+
+  StringT m_string;
+  std::vector<byte> m_bytes;
 };
 
-#define VariantTA VariantT<std::stringstream>
+#define VariantTA VariantT<std::string>
 
 class VariantA : public VariantTA
 {
@@ -1158,11 +1416,9 @@ public:
   VariantA();
   VariantA(const VariantA& right);
   virtual ~VariantA();
-
-  std::string to_string() const;
 };
 
-#define VariantTW VariantT<std::wstringstream>
+#define VariantTW VariantT<std::wstring>
 
 class VariantW : public VariantTW
 {
@@ -1170,10 +1426,134 @@ public:
   VariantW();
   VariantW(const VariantW& right);
   virtual ~VariantW();
+};
+
+/**
+ * FuzzyIndexT - The BK-tree index of a string list for the approximate (Levenshtein) matching.
+ * The distances are computed by Myers' bit-parallel algorithm (a two-row DP for strings over 64 characters).
+ * Eg. FuzzyIndexA index(names); auto matches = index.find("prnitf", 5, 2);
+ */
+
+template <class StringT>
+class FuzzyIndexT
+{
+public:
+  typedef std::pair<size_t, size_t> Match; // <the index in the string list, the edit distance>
+
+  FuzzyIndexT();
+  FuzzyIndexT(const std::vector<StringT>& string_list);
+  virtual ~FuzzyIndexT();
+
+  void build(const std::vector<StringT>& string_list);
+  void add(const StringT& string);
+  void clear();
+
+  bool empty() const;
+  size_t size() const;
+  const StringT& at(const size_t index) const;
+
+  /**
+   * Find the top-k closest strings within the maximum edit distance.
+   * The matches are sorted by the edit distance then by the index in the string list.
+   */
+  std::vector<Match> find(
+    const StringT& string, const size_t k = 1, const size_t max_distance = size_t(-1)) const;
+  StringT closest(const StringT& string) const;
+
+  static size_t distance(const StringT& a, const StringT& b);
+
+private:
+  struct Node
+  {
+    size_t distance; // the edit distance to the parent node
+    size_t first_child;
+    size_t next_sibling;
+  };
+
+  std::vector<StringT> m_strings;
+  std::vector<Node> m_nodes; // the node of m_strings[i] is m_nodes[i] and the root is m_nodes[0]
+};
+
+typedef FuzzyIndexT<std::string>  FuzzyIndexA;
+typedef FuzzyIndexT<std::wstring> FuzzyIndexW;
 
-  std::wstring to_string() const;
+/**
+ * TimestampFormatterT - The locale-free timestamp formatter for the high-rate logging.
+ * The pattern is compiled once, the date/time fields are rendered once per second per thread and cached,
+ * then only the sub-second fields are rendered (by integer arithmetic) into the caller buffer.
+ * Fields: %Y %y %m %d %H %M %S, %b %a (English names), %f or %Nf (N = 1..9 fractional digits, default 3),
+ * %z (+hh:mm, or Z for UTC) and %%. The default pattern is ISO-8601 (YYYY-MM-DDThh:mm:ss.fff+hh:mm).
+ * Eg. TimestampFormatterA formatter; char buffer[64]; formatter.write(buffer, sizeof(buffer));
+ */
+
+template <typename CharT>
+class TimestampFormatterT
+{
+public:
+  typedef std::basic_string<CharT> String;
+
+  TimestampFormatterT(const bool utc = false);
+  TimestampFormatterT(const String& pattern, const bool utc = false);
+  virtual ~TimestampFormatterT();
+
+  const String& pattern() const;
+  bool utc() const;
+
+  /**
+   * Render the timestamp into the buffer (null-terminated).
+   * Returns the number of the rendered characters, or 0 if the buffer is too small.
+   */
+  size_t write(CharT* buffer, const size_t size) const;
+  size_t write(const FILETIME& time, CharT* buffer, const size_t size) const;
+  size_t write(const time_t time, CharT* buffer, const size_t size) const;
+
+  String to_string() const;
+  String to_string(const FILETIME& time) const;
+  String to_string(const time_t time) const;
+
+private:
+  enum token_type : byte
+  {
+    TT_LITERAL,
+    TT_YEAR,
+    TT_YEAR_2,
+    TT_MONTH,
+    TT_DAY,
+    TT_HOUR,
+    TT_MINUTE,
+    TT_SECOND,
+    TT_MONTH_NAME,
+    TT_WEEKDAY_NAME,
+    TT_FRACTION,
+    TT_ZONE,
+  };
+
+  struct Token
+  {
+    token_type type;
+    byte  width;  // the number of digits of TT_FRACTION
+    ushort offset; // the literal text in m_literals
+    ushort length;
+  };
+
+  struct Cache;
+
+  void compile(const String& pattern);
+  size_t render(const int64 ticks, CharT* buffer, const size_t size) const;
+  size_t render_seconds(const int64 seconds, CharT* buffer, const size_t size, Cache& cache) const;
+  String format_string(const int64 ticks) const;
+
+private:
+  uint64 m_id;
+  bool m_utc;
+  String m_pattern;
+  String m_literals;
+  std::vector<Token> m_tokens;
 };
 
+typedef TimestampFormatterT<char>  TimestampFormatterA;
+typedef TimestampFormatterT<wchar> TimestampFormatterW;
+
 /**
  * Library
  */
@@ -1748,6 +2128,7 @@ enum fs_attribute
   FA_OFFLINE          = 0x00001000,   // FILE_ATTRIBUTE_OFFLINE              = $00001000;
   FANOTCONTENTINDEXED = 0x00002000,   // FILE_ATTRIBUTE_NOT_CONTENT_INDEXED  = $00002000;
   FAENCRYPTED         = 0x00004000,   // FILE_ATTRIBUTE_ENCRYPTED            = $00004000;
+  FA_OVERLAPPED       = 0x40000000,   // FILE_FLAG_OVERLAPPED                = $40000000; (only the positional & asynchronous I/O)
 };
 
 enum fs_share
@@ -1792,23 +2173,87 @@ struct FSObjectW
   ulong attributes;
 };
 
+enum fs_link_policy
+{
+  LP_SKIP   = 0, // skip the reparse points (symbolic links, junctions, etc.)
+  LP_LIST   = 1, // list the reparse points but do not descend into them
+  LP_FOLLOW = 2, // descend into the reparse points, each directory is descended once
+};
+
+/**
+ * The options of the recursive walk.
+ * The patterns are the wildcards of the names (eg. "*.exe", "log-??.txt"), empty is any name.
+ * The max depth 0 is the entries of the root directory only, -1 is unlimited.
+ * The number of threads 0 is the number of the logical processors.
+ */
+
+struct FSWalkOptionsA
+{
+  std::vector<std::string> patterns;
+  size_t max_depth;
+  fs_link_policy link_policy;
+  bool include_directories;
+  size_t batch_size;
+  size_t n_threads;
+
+  FSWalkOptionsA() : max_depth(size_t(-1)), link_policy(fs_link_policy::LP_LIST)
+    , include_directories(false), batch_size(256), n_threads(0) {}
+};
+
+struct FSWalkOptionsW
+{
+  std::vector<std::wstring> patterns;
+  size_t max_depth;
+  fs_link_policy link_policy;
+  bool include_directories;
+  size_t batch_size;
+  size_t n_threads;
+
+  FSWalkOptionsW() : max_depth(size_t(-1)), link_policy(fs_link_policy::LP_LIST)
+    , include_directories(false), batch_size(256), n_threads(0) {}
+};
+
 #ifdef _UNICODE
 #define FSObject FSObjectW
+#define FSWalkOptions FSWalkOptionsW
 #else
 #define FSObject FSObjectA
+#define FSWalkOptions FSWalkOptionsA
 #endif
 
+#pragma pack(push, 8) // the pending count is waited on by address, so it is kept naturally aligned
+
 class FileSystemX : public LastError
 {
 public:
+  /**
+   * The buffer of the vectored I/O, the buffers are transferred in order from/to the contiguous file range.
+   */
+  struct IOVector
+  {
+    void* ptr;
+    size_t size;
+  };
+
+  /**
+   * The completion callback of the asynchronous I/O, it is invoked on a thread of the system thread pool.
+   */
+  typedef std::function<void(ulong error_code, size_t transferred_size)> fn_io_completion_t;
+
   FileSystemX();
   virtual ~FileSystemX();
 
   virtual bool vuapi ready();
   virtual bool vuapi valid(HANDLE handle);
   virtual ulong vuapi get_file_size();
+  virtual uint64 vuapi get_file_size_64();
 
   virtual std::unique_ptr<Buffer> vuapi read_as_buffer();
+
+  /**
+   * The I/O at the file pointer. The files that are opened with `FA_OVERLAPPED` have no file pointer,
+   * so these are failed with `ERROR_INVALID_FUNCTION`, use the positional or the asynchronous I/O instead.
+   */
   virtual bool vuapi read(void* ptr_buffer, ulong size);
   virtual bool vuapi read(
     ulong offset, void* ptr_buffer, ulong size, fs_position_at flags = fs_position_at::PA_BEGIN);
@@ -1818,13 +2263,43 @@ public:
     ulong offset, const void* ptr_buffer, ulong size, fs_position_at flags = fs_position_at::PA_BEGIN);
 
   virtual bool vuapi seek(ulong offset, fs_position_at flags);
+  virtual bool vuapi seek_64(int64 offset, fs_position_at flags);
   virtual bool vuapi io_control(
     ulong code, void* ptr_send_buffer, ulong send_size, void* ptr_recv_buffer, ulong recv_size);
 
+  /**
+   * The positional I/O (like pread/pwrite) that is safe to be called from many threads on the same object.
+   * The files that are opened with `FA_OVERLAPPED` are transferred concurrently, otherwise the system
+   * serializes the transfers on the handle. The transferred size is less than the size at the end of file.
+   */
+  virtual bool vuapi read_at(uint64 offset, void* ptr_buffer, size_t size, size_t* ptr_read_size = nullptr);
+  virtual bool vuapi write_at(
+    uint64 offset, const void* ptr_buffer, size_t size, size_t* ptr_wrote_size = nullptr);
+  virtual bool vuapi read_at(
+    uint64 offset, const std::vector<IOVector>& buffers, size_t* ptr_read_size = nullptr);
+  virtual bool vuapi write_at(
+    uint64 offset, const std::vector<IOVector>& buffers, size_t* ptr_wrote_size = nullptr);
+
+  /**
+   * The asynchronous I/O. The files that are opened with `FA_OVERLAPPED` are submitted to the I/O completion
+   * port of the system thread pool, otherwise the positional I/O is queued to the system thread pool.
+   * The buffer must be valid until the completion callback is invoked.
+   */
+  virtual bool vuapi read_async(uint64 offset, void* ptr_buffer, size_t size, fn_io_completion_t fn);
+  virtual bool vuapi write_async(uint64 offset, const void* ptr_buffer, size_t size, fn_io_completion_t fn);
+  virtual void vuapi wait_async();
+
   virtual bool vuapi close();
 
 protected:
+  bool streamable();
+  bool submit_async(bool writing, uint64 offset, void* ptr_buffer, size_t size, fn_io_completion_t& fn);
+
+protected:
+  std::atomic<uint32> m_pending_async;
   HANDLE m_handle;
+  bool m_overlapped;
+  void* m_ptr_io;
 
 private:
   ulong m_read_size, m_wrote_size;
@@ -1857,6 +2332,15 @@ public:
     const std::string& path,
     const std::string& pattern,
     const std::function<bool(const FSObjectA& fso)> fn_callback);
+
+  /**
+   * Walk the directory tree recursively, the subdirectories are fanned out over the work-stealing threads.
+   * The entries are passed in batches to the callback, the callback is serialized and returning false stops.
+   */
+  static bool walk(
+    const std::string& path,
+    const FSWalkOptionsA& options,
+    const std::function<bool(const std::vector<FSObjectA>& batch)> fn_callback);
 };
 
 class FileSystemW : public FileSystemX
@@ -1888,8 +2372,19 @@ public:
     const std::wstring& path,
     const std::wstring& pattern,
     const std::function<bool(const FSObjectW& fso)> fn_callback);
+
+  /**
+   * Walk the directory tree recursively, the subdirectories are fanned out over the work-stealing threads.
+   * The entries are passed in batches to the callback, the callback is serialized and returning false stops.
+   */
+  static bool walk(
+    const std::wstring& path,
+    const FSWalkOptionsW& options,
+    const std::function<bool(const std::vector<FSObjectW>& batch)> fn_callback);
 };
 
+#pragma pack(pop)
+
 /**
  * Service Working
  */
@@ -2058,6 +2553,7 @@ public:
   );
 
   ulong vuapi get_file_size();
+  uint64 vuapi get_file_size_64();
   void vuapi close();
 
 protected:
@@ -2158,117 +2654,491 @@ public:
 };
 
 /**
- * INI File
+ * FileViewX - The read-only byte view of a whole file without copying it into the memory.
+ * The regular files are mapped with the sequential scan and the prefetch hints, the other files
+ * (eg. pipes, character devices) or the files that could not be mapped are read in chunks.
  */
 
-template <class INIFileX, class VariantX, class StringT>
-class INISectionT
+class FileViewX : public LastError
 {
 public:
-  INISectionT(INIFileX& ini, const StringT& section) : m_ini(ini), m_section(section) {}
-  virtual ~INISectionT() {}
-
-  VariantX read(const StringT& key)
-  {
-    return m_ini.read(m_section, key);
-  }
-
-  template <typename T>
-  bool write(const StringT& key, const T val)
-  {
-    VariantX var;
-    var << val;
-    return this->write_variant(key, var);
-  }
+  FileViewX();
+  virtual ~FileViewX();
 
-  template <typename Ptr>
-  bool write(const std::string& key, const Ptr ptr, const size_t size)
-  {
-    VariantA var;
-    var << to_hex_string_A((const byte*)ptr, size);
-    return this->write_variant(key, var);
-  }
+  FileViewX(const FileViewX&) = delete;
+  FileViewX& operator=(const FileViewX&) = delete;
 
-  template <typename Ptr>
-  bool write(const std::wstring& key, const Ptr ptr, const size_t size)
-  {
-    VariantW var;
-    var << to_hex_string_W((const byte*)ptr, size);
-    return this->write_variant(key, var);
-  }
+  bool vuapi ready() const;
+  bool vuapi mapped() const;
+  const byte* vuapi data() const;
+  size_t vuapi size() const;
+  void vuapi close();
 
 protected:
-  bool write_variant(const StringT& key, const VariantX& var)
-  {
-    return m_ini.write_string(m_section, key, var.to_string());
-  }
+  bool vuapi attach(HANDLE file_handle);
 
 protected:
-  INIFileX& m_ini;
-  StringT m_section;
+  HANDLE m_file_handle;
+  HANDLE m_map_handle;
+  const byte* m_ptr_data;
+  size_t m_size;
+  std::vector<byte> m_data;
 };
 
-#define INISectionTA INISectionT<INIFileA, VariantA, std::string>
-#define INISectionTW INISectionT<INIFileW, VariantW, std::wstring>
+/**
+ * FileViewA
+ */
 
-class INIFileA : public LastError
+class FileViewA : public FileViewX
 {
 public:
-  INIFileA();
-  INIFileA(const std::string& file_path);
-  virtual ~INIFileA();
-
-  class Section : public INISectionTA
-  {
-  public:
-    Section(INIFileA& ini, const std::string& section) : INISectionT(ini, section) {}
-    virtual ~Section() {}
-  };
-
-  friend class INISectionTA;
+  FileViewA();
+  FileViewA(const std::string& file_path);
+  virtual ~FileViewA();
 
-  std::unique_ptr<Section> section(const std::string& name);
-  bool read_section_names(std::vector<std::string>& section_names, const ulong max_chars = KiB);
+  bool vuapi open(const std::string& file_path);
+};
 
-  VariantA read(const std::string& section, const std::string& key);
-  bool write(const std::string& section, const std::string& key, const VariantA& var);
+/**
+ * FileViewW
+ */
 
-protected:
-  std::string read_string(const std::string& section, const std::string& key, const std::string& def);
-  bool write_string(const std::string& section, const std::string& key, const std::string& val);
+class FileViewW : public FileViewX
+{
+public:
+  FileViewW();
+  FileViewW(const std::wstring& file_path);
+  virtual ~FileViewW();
 
-protected:
-  std::string m_file_path;
+  bool vuapi open(const std::wstring& file_path);
 };
 
-class INIFileW : public LastError
+/**
+ * FileCursorX - The random-access byte cursor over a read-only file mapping of any size.
+ * The file is mapped in the windows (aligned to the allocation granularity) on demand, the next window
+ * is mapped and prefetched on the sequential access, and the least recently used windows are unmapped
+ * to keep the mapped memory under the budget (window size x max windows).
+ */
+
+class FileCursorX : public LastError
 {
 public:
-  INIFileW();
-  INIFileW(const std::wstring& file_path);
-  virtual ~INIFileW();
+  FileCursorX(const size_t window_size = 64 * MiB, const size_t max_windows = 4);
+  virtual ~FileCursorX();
 
-  class Section : public INISectionTW
-  {
-  public:
-    Section(INIFileW& ini, const std::wstring& section) : INISectionT(ini, section) {}
-    virtual ~Section() {}
-  };
+  FileCursorX(const FileCursorX&) = delete;
+  FileCursorX& operator=(const FileCursorX&) = delete;
 
-  friend class INISectionTW;
+  bool vuapi ready() const;
+  uint64 vuapi size() const;
+  size_t vuapi window_size() const;
+  void vuapi close();
 
-  std::unique_ptr<Section> section(const std::wstring& name);
-  bool read_section_names(std::vector<std::wstring>& section_names, const ulong max_chars = KiB);
+  /**
+   * The pointer to the byte at the offset and the number of the bytes that are available from there
+   * to the end of its window. The pointer is valid until the next access maps another window.
+   */
+  const byte* vuapi view(const uint64 offset, size_t& available_size);
 
-  VariantW read(const std::wstring& section, const std::wstring& key);
-  bool write(const std::wstring& section, const std::wstring& key, const VariantW& var);
+  size_t vuapi read(const uint64 offset, void* ptr_buffer, const size_t size);
+  bool vuapi at(const uint64 offset, byte& value);
 
 protected:
-  std::wstring read_string(const std::wstring& section, const std::wstring& key, const std::wstring& def);
+  bool vuapi attach(HANDLE file_handle);
+
+private:
+  struct Window
+  {
+    uint64 offset;
+    const byte* ptr;
+    size_t size;
+    uint64 tick;
+  };
+
+  size_t find_window(const uint64 offset);
+  size_t map_window(const uint64 offset);
+
+protected:
+  HANDLE m_file_handle;
+  HANDLE m_map_handle;
+  uint64 m_size;
+  size_t m_window_size;
+  size_t m_max_windows;
+
+private:
+  std::vector<Window> m_windows;
+  size_t m_last_window;
+  uint64 m_tick;
+};
+
+/**
+ * FileCursorA
+ */
+
+class FileCursorA : public FileCursorX
+{
+public:
+  FileCursorA(const size_t window_size = 64 * MiB, const size_t max_windows = 4);
+  FileCursorA(const std::string& file_path, const size_t window_size = 64 * MiB, const size_t max_windows = 4);
+  virtual ~FileCursorA();
+
+  bool vuapi open(const std::string& file_path);
+};
+
+/**
+ * FileCursorW
+ */
+
+class FileCursorW : public FileCursorX
+{
+public:
+  FileCursorW(const size_t window_size = 64 * MiB, const size_t max_windows = 4);
+  FileCursorW(const std::wstring& file_path, const size_t window_size = 64 * MiB, const size_t max_windows = 4);
+  virtual ~FileCursorW();
+
+  bool vuapi open(const std::wstring& file_path);
+};
+
+/**
+ * HashCacheX - The persistent cache of the file digests that are keyed by the path, the size,
+ * the last write time and the file identity (the volume serial number and the file index).
+ * The cache file is an append-only log of the checksummed records that is mapped and indexed once,
+ * so a torn record at the tail (eg. by a crash) is discarded and the later records override the earlier ones.
+ * The stored digests are returned immediately, only the stale ones are recomputed (in parallel for a list).
+ * The cache file is opened exclusively for writing, so it is used by one cache object at a time (in any process).
+ */
+
+class HashCacheX : public LastError
+{
+public:
+  typedef std::function<std::string(const std::wstring& file_path)> fn_digest_t;
+
+  HashCacheX();
+  virtual ~HashCacheX();
+
+  HashCacheX(const HashCacheX&) = delete;
+  HashCacheX& operator=(const HashCacheX&) = delete;
+
+  bool vuapi ready() const;
+  size_t vuapi size() const;
+  bool vuapi compact();
+  void vuapi close();
+
+protected:
+  bool vuapi open_cache(const std::wstring& file_path);
+
+  std::string vuapi digest(
+    const std::wstring& file_path, const std::string& algorithm, const fn_digest_t& fn);
+  std::vector<std::string> vuapi digest(
+    const std::vector<std::wstring>& file_paths,
+    const std::string& algorithm,
+    const fn_digest_t& fn,
+    const size_t n_threads);
+
+private:
+  struct Stamp
+  {
+    uint64 size;
+    uint64 time;
+    uint64 index;
+    ulong  volume;
+  };
+
+  struct Entry
+  {
+    Stamp stamp;
+    std::string digest;
+  };
+
+  static std::wstring key(const std::wstring& file_path, const std::string& algorithm);
+  static bool stamp(const std::wstring& file_path, Stamp& stamp);
+
+  bool lookup(const std::wstring& key, const Stamp& stamp, std::string& digest);
+  void store(const std::wstring& key, const Stamp& stamp, const std::string& digest);
+  bool append(const std::wstring& key, const Entry& entry);
+
+protected:
+  std::wstring m_file_path;
+  HANDLE m_file_handle;
+
+private:
+  std::unordered_map<std::wstring, Entry> m_entries;
+  std::mutex m_mutex;
+};
+
+/**
+ * HashCacheA
+ */
+
+class HashCacheA : public HashCacheX
+{
+public:
+  HashCacheA();
+  HashCacheA(const std::string& file_path);
+  virtual ~HashCacheA();
+
+  bool vuapi open(const std::string& file_path);
+
+  std::string vuapi md5(const std::string& file_path);
+  std::string vuapi sha(const std::string& file_path, const sha_version version, const crypt_bits bits);
+  uint64 vuapi crc(const std::string& file_path, const crypt_bits bits);
+
+  std::vector<std::string> vuapi md5(const std::vector<std::string>& file_paths, const size_t n_threads = 0);
+  std::vector<std::string> vuapi sha(const std::vector<std::string>& file_paths,
+    const sha_version version, const crypt_bits bits, const size_t n_threads = 0);
+  std::vector<uint64> vuapi crc(const std::vector<std::string>& file_paths,
+    const crypt_bits bits, const size_t n_threads = 0);
+};
+
+/**
+ * HashCacheW
+ */
+
+class HashCacheW : public HashCacheX
+{
+public:
+  HashCacheW();
+  HashCacheW(const std::wstring& file_path);
+  virtual ~HashCacheW();
+
+  bool vuapi open(const std::wstring& file_path);
+
+  std::wstring vuapi md5(const std::wstring& file_path);
+  std::wstring vuapi sha(const std::wstring& file_path, const sha_version version, const crypt_bits bits);
+  uint64 vuapi crc(const std::wstring& file_path, const crypt_bits bits);
+
+  std::vector<std::wstring> vuapi md5(const std::vector<std::wstring>& file_paths, const size_t n_threads = 0);
+  std::vector<std::wstring> vuapi sha(const std::vector<std::wstring>& file_paths,
+    const sha_version version, const crypt_bits bits, const size_t n_threads = 0);
+  std::vector<uint64> vuapi crc(const std::vector<std::wstring>& file_paths,
+    const crypt_bits bits, const size_t n_threads = 0);
+};
+
+/**
+ * INI File
+ */
+
+/**
+ * INIDocumentT - The in-memory INI document that is parsed once into the section/key hash index.
+ * The original lines (including blank lines and comments) and their order are kept as is,
+ * so that the serialized document only differs from the parsed one at the modified keys.
+ * The section and key names are case-insensitive, the first one wins if duplicated.
+ * Note: Only the C++ standard library is used here, so it is portable.
+ */
+
+template <class StringT>
+class INIDocumentT
+{
+public:
+  typedef typename StringT::value_type char_type;
+
+  INIDocumentT();
+  virtual ~INIDocumentT();
+
+  void parse(const char_type* ptr, const size_t length);
+  void parse(const StringT& text);
+  StringT serialize() const;
+  void clear();
+
+  bool modified() const;
+  void modified(const bool state);
+
+  bool has_section(const StringT& section) const;
+  std::vector<StringT> section_names() const;
+  std::vector<StringT> key_names(const StringT& section) const;
+
+  const StringT* find(const StringT& section, const StringT& key) const;
+  void set(const StringT& section, const StringT& key, const StringT& value);
+  bool remove(const StringT& section, const StringT& key);
+  bool remove(const StringT& section);
+
+private:
+  struct Line
+  {
+    StringT text;
+    StringT key;
+    StringT value;
+    bool is_key;
+  };
+
+  struct Section
+  {
+    StringT name;
+    StringT header;
+    std::vector<Line> lines;
+    std::unordered_map<StringT, size_t> keys; // lower-case key -> index in lines
+  };
+
+  void parse_line(const char_type* ptr, size_t length);
+  const Section* find_section(const StringT& section) const;
+  void reindex(Section& section);
+
+private:
+  std::vector<Section> m_sections; // the first one is the area before any section header
+  std::unordered_map<StringT, size_t> m_section_index; // lower-case name -> index in m_sections
+  StringT m_new_line;
+  bool m_modified;
+};
+
+typedef INIDocumentT<std::string>  INIDocumentA;
+typedef INIDocumentT<std::wstring> INIDocumentW;
+
+template <class INIFileX, class VariantX, class StringT>
+class INISectionT
+{
+public:
+  INISectionT(INIFileX& ini, const StringT& section) : m_ini(ini), m_section(section) {}
+  virtual ~INISectionT() {}
+
+  VariantX read(const StringT& key)
+  {
+    return m_ini.read(m_section, key);
+  }
+
+  template <typename T>
+  bool write(const StringT& key, const T val)
+  {
+    VariantX var;
+    var << val;
+    return this->write_variant(key, var);
+  }
+
+  template <typename Ptr>
+  bool write(const std::string& key, const Ptr ptr, const size_t size)
+  {
+    VariantA var;
+    var << to_hex_string_A((const byte*)ptr, size);
+    return this->write_variant(key, var);
+  }
+
+  template <typename Ptr>
+  bool write(const std::wstring& key, const Ptr ptr, const size_t size)
+  {
+    VariantW var;
+    var << to_hex_string_W((const byte*)ptr, size);
+    return this->write_variant(key, var);
+  }
+
+protected:
+  bool write_variant(const StringT& key, const VariantX& var)
+  {
+    return m_ini.write_string(m_section, key, var.to_string());
+  }
+
+protected:
+  INIFileX& m_ini;
+  StringT m_section;
+};
+
+#define INISectionTA INISectionT<INIFileA, VariantA, std::string>
+#define INISectionTW INISectionT<INIFileW, VariantW, std::wstring>
+
+class INIFileA : public LastError
+{
+public:
+  INIFileA();
+  INIFileA(const std::string& file_path);
+  virtual ~INIFileA();
+
+  INIFileA(const INIFileA&) = delete;
+  INIFileA& operator=(const INIFileA&) = delete;
+
+  class Section : public INISectionTA
+  {
+  public:
+    Section(INIFileA& ini, const std::string& section) : INISectionT(ini, section) {}
+    virtual ~Section() {}
+  };
+
+  friend class INISectionTA;
+
+  std::unique_ptr<Section> section(const std::string& name);
+  bool read_section_names(std::vector<std::string>& section_names, const ulong max_chars = KiB);
+
+  VariantA read(const std::string& section, const std::string& key);
+  bool write(const std::string& section, const std::string& key, const VariantA& var);
+
+  bool flush();
+  bool reload();
+
+protected:
+  std::string read_string(const std::string& section, const std::string& key, const std::string& def);
+  bool write_string(const std::string& section, const std::string& key, const std::string& val);
+
+  bool load();
+  bool load_file();
+  bool changed(uint64& time, uint64& size);
+
+protected:
+  struct Pending
+  {
+    std::string section;
+    std::string key;
+    std::string value;
+  };
+
+  std::string m_file_path;
+  INIDocumentA m_document;
+  text_encoding m_encoding;
+  bool m_loaded;
+  uint64 m_time;
+  uint64 m_size;
+  std::vector<Pending> m_pending; // the writes since the last flush, re-applied if the file was changed
+  std::unordered_map<std::string, size_t> m_pending_index; // lower-case section & key -> index in m_pending
+};
+
+class INIFileW : public LastError
+{
+public:
+  INIFileW();
+  INIFileW(const std::wstring& file_path);
+  virtual ~INIFileW();
+
+  INIFileW(const INIFileW&) = delete;
+  INIFileW& operator=(const INIFileW&) = delete;
+
+  class Section : public INISectionTW
+  {
+  public:
+    Section(INIFileW& ini, const std::wstring& section) : INISectionT(ini, section) {}
+    virtual ~Section() {}
+  };
+
+  friend class INISectionTW;
+
+  std::unique_ptr<Section> section(const std::wstring& name);
+  bool read_section_names(std::vector<std::wstring>& section_names, const ulong max_chars = KiB);
+
+  VariantW read(const std::wstring& section, const std::wstring& key);
+  bool write(const std::wstring& section, const std::wstring& key, const VariantW& var);
+
+  bool flush();
+  bool reload();
+
+protected:
+  std::wstring read_string(const std::wstring& section, const std::wstring& key, const std::wstring& def);
   bool write_string(const std::wstring& section, const std::wstring& key, const std::wstring& val);
 
+  bool load();
+  bool load_file();
+  bool changed(uint64& time, uint64& size);
+
 protected:
+  struct Pending
+  {
+    std::wstring section;
+    std::wstring key;
+    std::wstring value;
+  };
+
   std::wstring m_file_path;
+  INIDocumentW m_document;
+  text_encoding m_encoding;
+  bool m_loaded;
+  uint64 m_time;
+  uint64 m_size;
+  std::vector<Pending> m_pending; // the writes since the last flush, re-applied if the file was changed
+  std::unordered_map<std::wstring, size_t> m_pending_index; // lower-case section & key -> index in m_pending
 };
 
 /**
@@ -2482,6 +3352,8 @@ public:
 
 private:
   int m_thread_lock_id;
+  ThreadLock* m_ptr_thread_lock;
+  static std::mutex m_mutex;
   static std::map<int, std::unique_ptr<ThreadLock>> m_list;
 };
 
@@ -2516,27 +3388,203 @@ private:
   HANDLE m_event;
 };
 
+/**
+ * Lightweight Synchronization
+ * The user-mode primitives on a 32-bit word that spin briefly then park on WaitOnAddress
+ * (falling back to a hashed SRW lock + condition variable table prior to Windows 8),
+ * so the uncontended and the short contended paths never enter the kernel.
+ */
+
+#pragma pack(push, 8) // the words are kept naturally aligned for the interlocked and the WaitOnAddress operations
+
+class AdaptiveMutex
+{
+public:
+  AdaptiveMutex(const ulong max_spin_count = 128);
+  virtual ~AdaptiveMutex();
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+private:
+  std::atomic<uint32> m_state; // 0 unlocked, 1 locked, 2 locked with waiters
+  std::atomic<uint32> m_spin_count;
+  ulong m_max_spin_count;
+};
+
+class ReadWriteLock
+{
+public:
+  ReadWriteLock(const ulong max_spin_count = 128);
+  virtual ~ReadWriteLock();
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+  void lock_shared();
+  bool try_lock_shared();
+  void unlock_shared();
+
+private:
+  std::atomic<uint32> m_state; // the reader count, the writer locked and the writer waiting bits
+  std::atomic<uint32> m_waiters;
+  ulong m_max_spin_count;
+};
+
+class LightEvent
+{
+public:
+  LightEvent(const bool manual_reset = true, const bool signaled = false);
+  virtual ~LightEvent();
+
+  void set();
+  void reset();
+  bool is_set() const;
+  bool wait(const ulong time_out = INFINITE);
+
+private:
+  std::atomic<uint32> m_state;
+  std::atomic<uint32> m_waiters;
+  bool m_manual_reset;
+};
+
+class Latch
+{
+public:
+  Latch(const uint32 count);
+  virtual ~Latch();
+
+  void count_down(const uint32 n = 1);
+  bool try_wait() const;
+  bool wait(const ulong time_out = INFINITE) const;
+  void arrive_and_wait(const uint32 n = 1);
+
+private:
+  mutable std::atomic<uint32> m_count;
+};
+
+class Barrier
+{
+public:
+  Barrier(const uint32 count);
+  virtual ~Barrier();
+
+  void arrive_and_wait();
+
+private:
+  std::atomic<uint32> m_arrived;
+  std::atomic<uint32> m_generation;
+  uint32 m_count;
+};
+
+#pragma pack(pop)
+
+/**
+ * Latency Statistics
+ * The streaming count/total/minimum/maximum/mean/standard deviation of samples in constant memory.
+ * The mean and the variance are updated by Welford's algorithm so no sample is ever stored.
+ */
+
+class LatencyStats
+{
+public:
+  LatencyStats();
+  virtual ~LatencyStats();
+
+  void record(const uint64 value);
+  void merge(const LatencyStats& right);
+  void reset();
+
+  uint64 count() const;
+  uint64 total() const;
+  uint64 minimum() const;
+  uint64 maximum() const;
+  double mean() const;
+  double variance() const;
+  double stddev() const;
+
+private:
+  uint64 m_count;
+  uint64 m_total;
+  uint64 m_minimum;
+  uint64 m_maximum;
+  double m_mean;
+  double m_m2;
+};
+
+/**
+ * Latency Histogram
+ * The HDR-style log-linear histogram of samples in fixed memory (allocated once at construction).
+ * Values below 2^(PRECISION + 1) are counted exactly, larger values fall into 2^PRECISION linear
+ * sub-buckets per power of two, so any reported value is within 1/2^PRECISION (~3%) of the real one.
+ */
+
+class LatencyHistogram
+{
+public:
+  static const int PRECISION = 5;
+
+  LatencyHistogram();
+  virtual ~LatencyHistogram();
+
+  void record(const uint64 value, const uint64 count = 1);
+  void merge(const LatencyHistogram& right);
+  void reset();
+
+  uint64 count() const;
+  uint64 minimum() const;
+  uint64 maximum() const;
+  double mean() const;
+  uint64 percentile(const double percentage) const; // percentage in [0, 100]
+
+  static size_t index_of(const uint64 value);
+  static uint64 lowest_of(const size_t index);
+  static uint64 highest_of(const size_t index);
+
+private:
+  std::vector<uint64> m_buckets;
+  uint64 m_count;
+  uint64 m_minimum;
+  uint64 m_maximum;
+  double m_total;
+};
+
 /**
  * Stop Watch
+ * The monotonic stop watch in nanoseconds (QueryPerformanceCounter) that keeps the streaming
+ * statistics of all laps and optionally their latency histogram, both in fixed memory.
  */
 
 class StopWatch
 {
 public:
-  typedef std::pair<unsigned long, float> TDuration;
+  typedef std::pair<unsigned long, float> TDuration; // <milliseconds, seconds>
 
 public:
-  StopWatch();
+  StopWatch(const bool histogram = false);
   virtual ~StopWatch();
   void start(bool reset = false);
   const TDuration stop();
   const TDuration duration();
   const TDuration total();
 
+  uint64 elapsed_ns() const;
+  uint64 duration_ns() const;
+  uint64 total_ns() const;
+
+  const LatencyStats& stats() const;
+  const LatencyHistogram* histogram() const;
+
+  static uint64 now_ns();
+  static TDuration to_duration(const uint64 ns);
+
 private:
-  bool m_reset;
-  std::clock_t m_count, m_delta;
-  std::vector<std::clock_t> m_delta_history;
+  uint64 m_start;
+  uint64 m_delta;
+  LatencyStats m_stats;
+  std::unique_ptr<LatencyHistogram> m_ptr_histogram;
 };
 
 /**
@@ -2553,6 +3601,8 @@ public:
   void lap();
   void active(bool state = true);
 
+  const StopWatch& watcher() const;
+
 protected:
   void start(bool reset = false);
   void stop();
@@ -2602,6 +3652,122 @@ private:
   FnLogging m_fn_logging;
 };
 
+/**
+ * Profiler
+ * The zone-based profiler. Scoped zones write fixed-size records into the per-thread lock-free
+ * ring buffers (never blocking, dropping records when a ring is full), then the background collector
+ * drains them and aggregates per call-site and per call-stack for the Chrome trace / folded stacks.
+ */
+
+#define VU_PROFILE_CONCAT_IMPL(a, b) a ## b
+#define VU_PROFILE_CONCAT(a, b) VU_PROFILE_CONCAT_IMPL(a, b)
+
+#define VU_PROFILE_ZONE(name)\
+  static const vu::ProfileSite VU_PROFILE_CONCAT(vu_profile_site_, __LINE__) = { name, __FILE__, VU_FUNC_NAME, __LINE__ };\
+  vu::ProfileZone VU_PROFILE_CONCAT(vu_profile_zone_, __LINE__)(&VU_PROFILE_CONCAT(vu_profile_site_, __LINE__))
+
+#define VU_PROFILE_FUNCTION() VU_PROFILE_ZONE(VU_FUNC_NAME)
+
+struct ProfileSite
+{
+  const char* name;
+  const char* file;
+  const char* function;
+  int line;
+};
+
+struct ProfileRecord
+{
+  const ProfileSite* site;
+  uint64 path;   // the hash of the call-stack up to this zone
+  uint64 parent; // the hash of the call-stack up to the enclosing zone
+  uint64 begin;  // in nanoseconds
+  uint64 end;    // in nanoseconds
+  ulong  thread_id;
+  ulong  depth;
+};
+
+class ProfileZone
+{
+public:
+  ProfileZone(const ProfileSite* site);
+  virtual ~ProfileZone();
+
+private:
+  const ProfileSite* m_ptr_site;
+  uint64 m_begin;
+};
+
+struct ProfileRing;
+
+#pragma pack(push, 8) // the atomic flag and the mutexes are kept naturally aligned
+
+class Profiler : public SingletonT<Profiler>
+{
+public:
+  struct Summary
+  {
+    const ProfileSite* site;
+    LatencyStats stats; // the inclusive durations
+    uint64 self_ns;     // the total duration excluding the nested zones
+  };
+
+  Profiler();
+  virtual ~Profiler();
+
+  void start(const ulong interval_ms = 10, const size_t trace_capacity = 1 << 20);
+  void stop();
+  bool started() const;
+
+  void collect();
+  void reset();
+
+  uint64 dropped();
+  std::vector<Summary> summaries();
+  std::vector<ProfileRecord> records();
+
+  std::string to_chrome_trace();
+  std::string to_folded_stacks();
+
+  static bool enabled();
+
+private:
+  friend class ProfileZone;
+
+  struct Node
+  {
+    const ProfileSite* site;
+    uint64 parent;
+    uint64 total_ns;
+    uint64 child_ns;
+  };
+
+  ProfileRing* attach();
+  void drain(ProfileRing& ring);
+  void collector();
+
+private:
+  std::atomic<bool> m_started;
+  std::thread m_thread;
+  std::mutex m_mutex_signal;
+  std::condition_variable m_signal;
+  ulong m_interval;
+
+  std::mutex m_mutex_rings;
+  std::vector<std::shared_ptr<ProfileRing>> m_rings;
+
+  std::mutex m_mutex_data;
+  uint64 m_origin;
+  uint64 m_dropped;
+  std::unordered_map<uint64, Node> m_nodes;
+  std::unordered_map<const ProfileSite*, Summary> m_sites;
+  std::vector<ProfileRecord> m_trace;
+  size_t m_trace_capacity;
+  size_t m_trace_next;
+};
+
+#pragma pack(pop)
+
 /**
  * PE File
  */
@@ -2834,6 +4000,101 @@ struct RelocationEntryT
   T value;
 };
 
+// IMAGE_RESOURCE_DIRECTORY
+// Note: All of the resource objects below are views into the mapped PE file (not copies),
+//       so they are only valid while the PE file object that produced them is alive.
+
+struct PEResourceText
+{
+  const wchar* ptr;
+  size_t length;
+
+  PEResourceText() : ptr(nullptr), length(0) {}
+  PEResourceText(const wchar* p, const size_t n) : ptr(p), length(n) {}
+
+  bool empty() const;
+  bool equals(const std::wstring& text, bool ignore_case = false) const;
+  std::wstring as_string() const;
+};
+
+struct PEResourceId
+{
+  ushort id;           // The integer identifier (used when the name is empty)
+  PEResourceText name; // The string identifier
+
+  PEResourceId() : id(0) {}
+
+  bool named() const;
+};
+
+struct PEResourceData
+{
+  ulong rva;
+  ulong size;
+  ulong code_page;
+  const byte* ptr;
+
+  PEResourceData() : rva(0), size(0), code_page(0), ptr(nullptr) {}
+};
+
+class PEResourceNode
+{
+public:
+  PEResourceNode();
+  PEResourceNode(const byte* ptr_root, const ulong root_rva, const ulong root_size);
+  virtual ~PEResourceNode();
+
+  bool valid() const;
+  bool is_directory() const;
+  const PEResourceId& id() const;
+
+  ulong count() const;
+  PEResourceNode child(const ulong index) const;
+  PEResourceNode find(const ushort id) const;
+  PEResourceNode find(const std::wstring& name, bool ignore_case = true) const;
+  PEResourceNode first() const;
+
+  bool data(PEResourceData& data) const;
+
+  /**
+   * Iterate the direct children of the current directory node.
+   * @param[in] fn The callback function, return false to stop iterating.
+   * @return true if the current node is a valid directory node.
+   */
+  bool iterate(const std::function<bool(const PEResourceNode& node)> fn) const;
+
+private:
+  PEResourceNode(const PEResourceNode& parent, const ulong entry_offset);
+
+  const void* at(const ulong offset, const ulong size) const;
+
+private:
+  const byte* m_ptr_root;
+  ulong m_root_rva;
+  ulong m_root_size;
+  ulong m_offset;
+  bool  m_directory;
+  PEResourceId m_id;
+};
+
+struct PEVersionString
+{
+  PEResourceText table; // The language & code page, eg. 040904B0
+  PEResourceText key;
+  PEResourceText value;
+};
+
+struct PEVersionInfo
+{
+  const VS_FIXEDFILEINFO* ptr_fixed_file_info;
+  std::vector<PEVersionString> strings;
+  std::vector<ulong> translations; // MAKELONG(language, code page)
+
+  PEVersionInfo() : ptr_fixed_file_info(nullptr) {}
+
+  const PEVersionString* find(const std::wstring& key, bool ignore_case = true) const;
+};
+
 template <typename T>
 class PEFileTX
 {
@@ -2873,10 +4134,23 @@ public:
 
   const std::vector<RelocationEntryT<T>> vuapi get_relocation_entries(bool in_cache = true);
 
+  PEResourceNode vuapi get_resource_root();
+  bool vuapi find_resource(
+    PEResourceData& data, const ushort type, const ushort name, const ushort lang = 0); // lang = 0 is any
+  bool vuapi find_resource(
+    PEResourceData& data, const ushort type, const std::wstring& name, const ushort lang = 0);
+
+  bool vuapi get_version_info(PEVersionInfo& version_info, const ushort lang = 0);
+  bool vuapi get_manifest(PEResourceData& data, const ushort lang = 0);
+  bool vuapi get_resource_string(PEResourceText& text, const uint id, const ushort lang = 0);
+  bool vuapi iterate_resource_strings(
+    const std::function<bool(const uint id, const PEResourceText& text)> fn, const ushort lang = 0);
+
 protected:
   bool m_initialized;
 
   void* m_ptr_base;
+  size_t m_file_size;
 
   DOSHeader* m_ptr_dos_header;
   TPEHeaderT<T>* m_ptr_pe_header;
@@ -3337,6 +4611,10 @@ public:
   void add_task(fn_task_t&& fn);
   void launch();
 
+  // divides the items into the balanced pieces (refer to divide_items) for the workers then waits for all
+  size_t parallel_for(const size_t num_items, std::function<void(const piece_t& piece)> fn,
+    const size_t grain_size = 1, const size_t alignment = 1);
+
   size_t worker_count() const;
   size_t work_queue_count() const;
 
@@ -3433,6 +4711,149 @@ private:
   std::wstring m_path;
 };
 
+/**
+ * PathPoolT - The interned path table that shares the parent prefixes of the paths.
+ * A path is a node id (the parent node + an interned component), so joins, parents and component
+ * iteration are table lookups without reallocating, and the flat string is only built on demand.
+ * The separators are normalized and the `.` and `..` components are resolved while joining.
+ * The components are case-insensitive (ASCII) for the Windows separator, the first spelling is kept.
+ * Note: Not thread-safe, use a pool per thread or guard it.
+ * Eg. PathPoolA pool; auto id = pool.join(pool.intern("C:\\Windows"), "System32/../notepad.exe");
+ */
+
+template <class StringT>
+class PathPoolT
+{
+public:
+  typedef typename StringT::value_type char_type;
+  typedef uint32 id_t;
+
+  static const id_t root = 0; // the empty path
+
+  PathPoolT(const path_separator separator = path_separator::WIN);
+  virtual ~PathPoolT();
+
+  id_t intern(const StringT& path);
+  id_t join(const id_t id, const StringT& path);
+  id_t join(const id_t id, const char_type* ptr, const size_t length);
+  id_t join(const id_t id, const id_t relative_id);
+
+  id_t parent(const id_t id) const;
+  size_t depth(const id_t id) const;
+  StringT name(const id_t id) const;
+  const char_type* name(const id_t id, size_t& length) const;
+  bool is_absolute(const id_t id) const;
+  bool is_ancestor(const id_t ancestor_id, const id_t id) const;
+  void components(const id_t id, std::vector<id_t>& ids) const;
+
+  StringT as_string(const id_t id) const;
+  void as_string(const id_t id, StringT& result) const;
+
+  path_separator separator() const;
+  size_t size() const;
+  void clear();
+
+private:
+  enum component_kind : byte
+  {
+    CK_NAME,
+    CK_ROOT,   // `\`, `\\` (UNC), `/` or `X:\`
+    CK_PARENT, // `..` that could not be resolved (relative paths)
+  };
+
+  struct Component
+  {
+    size_t offset; // in m_chars
+    uint32 length;
+    uint32 hash;
+    component_kind kind;
+  };
+
+  struct Node
+  {
+    id_t parent;
+    id_t component;
+    uint32 depth;
+  };
+
+  uint32 hash(const char_type* ptr, const size_t length) const;
+  bool equal(const Component& component, const char_type* ptr, const size_t length) const;
+  id_t intern_component(const char_type* ptr, const size_t length, const component_kind kind);
+  id_t child(const id_t id, const id_t component_id);
+  id_t child(const id_t id, const char_type* ptr, const size_t length);
+  void rehash_components();
+  void rehash_nodes();
+
+private:
+  path_separator m_separator;
+  StringT m_chars;                        // the texts of all interned components
+  std::vector<Component> m_components;    // the first one is the component of the root
+  std::vector<id_t> m_component_table;    // the open-addressing table of m_components
+  std::vector<Node> m_nodes;              // the first one is the root
+  std::vector<id_t> m_node_table;         // the open-addressing table of m_nodes
+};
+
+typedef PathPoolT<std::string>  PathPoolA;
+typedef PathPoolT<std::wstring> PathPoolW;
+
+/**
+ * PathNodeT - The lightweight path value (a pool and a node id) over PathPoolT.
+ * Copying and comparing are O(1), the paths of the same pool are equal if they have the same id.
+ */
+
+template <class StringT>
+class PathNodeT
+{
+public:
+  typedef PathPoolT<StringT> Pool;
+  typedef typename Pool::id_t id_t;
+
+  PathNodeT(Pool& pool, const id_t id = Pool::root) : m_ptr_pool(&pool), m_id(id) {}
+  PathNodeT(Pool& pool, const StringT& path) : m_ptr_pool(&pool), m_id(pool.intern(path)) {}
+  virtual ~PathNodeT() {}
+
+  PathNodeT operator+(const StringT& right) const
+  {
+    return PathNodeT(*m_ptr_pool, m_ptr_pool->join(m_id, right));
+  }
+
+  PathNodeT operator+(const PathNodeT& right) const
+  {
+    return PathNodeT(*m_ptr_pool, m_ptr_pool->join(m_id, right.m_id));
+  }
+
+  PathNodeT& operator+=(const StringT& right)
+  {
+    m_id = m_ptr_pool->join(m_id, right);
+    return *this;
+  }
+
+  bool operator==(const PathNodeT& right) const
+  {
+    return m_ptr_pool == right.m_ptr_pool && m_id == right.m_id;
+  }
+
+  bool operator!=(const PathNodeT& right) const
+  {
+    return !(*this == right);
+  }
+
+  id_t id() const { return m_id; }
+  Pool& pool() const { return *m_ptr_pool; }
+  PathNodeT parent() const { return PathNodeT(*m_ptr_pool, m_ptr_pool->parent(m_id)); }
+  size_t depth() const { return m_ptr_pool->depth(m_id); }
+  StringT name() const { return m_ptr_pool->name(m_id); }
+  bool empty() const { return m_id == Pool::root; }
+  StringT as_string() const { return m_ptr_pool->as_string(m_id); }
+
+private:
+  Pool* m_ptr_pool;
+  id_t m_id;
+};
+
+typedef PathNodeT<std::string>  PathNodeA;
+typedef PathNodeT<std::wstring> PathNodeW;
+
 /**
  * WMIProvider - Windows Management Instrumentation
  */
@@ -3659,32 +5080,110 @@ private:
 #endif // VU_INET_ENABLED
 
 /**
- * Debouncer
+ * Timer Wheel
+ * The hierarchical timing wheel (4 levels x 256 slots) with O(1) schedule/cancel/reschedule.
+ * The callbacks are fired by the own timer thread (or by polling from an event loop) and executed
+ * there or dispatched to the given thread pool.
  */
 
-class Debouncer : public SingletonT<Debouncer>
+#pragma pack(push, 8) // the mutexes and the condition variables are kept naturally aligned
+
+class TimerWheel
 {
 public:
-  struct Timer
+  typedef uint64 id_t; // 0 is invalid
+  typedef std::function<void()> FnCallback;
+
+  TimerWheel(const ulong tick_ms = 1, ThreadPool* ptr_thread_pool = nullptr, const bool threaded = true);
+  virtual ~TimerWheel();
+
+  id_t schedule(const ulong delay_ms, FnCallback fn, const ulong period_ms = 0);
+  bool reschedule(const id_t id, const ulong delay_ms);
+  bool cancel(const id_t id);
+  bool exists(const id_t id);
+  size_t size();
+  void clear();
+
+  size_t poll();
+  ulong next_timeout();
+
+private:
+  struct Node
   {
-    ulongptr m_handle;
-    std::function<void()> m_function;
-    Timer() : m_handle(0), m_function(nullptr) {}
+    uint64 expiry; // in ticks
+    uint64 period; // in ticks, 0 for one-shot
+    FnCallback fn;
+    uint32 prev;
+    uint32 next;
+    uint32 slot;
+    uint32 generation;
   };
 
+  uint64 current_tick() const;
+  uint64 next_tick() const;
+  uint32 lookup(const id_t id) const;
+  void link(const uint32 index);
+  void unlink(const uint32 index);
+  void cascade(const uint32 level, const uint32 slot);
+  void release(const uint32 index);
+  void expire(std::vector<FnCallback>& fns);
+  void dispatch(std::vector<FnCallback>& fns);
+  void worker();
+
+private:
+  uint64 m_origin;
+  uint64 m_tick_ns;
+  uint64 m_now;       // the next tick to process
+  uint64 m_wake_tick; // the tick that the timer thread is waiting for
+  std::vector<Node> m_nodes;
+  std::vector<uint32> m_slots;
+  uint64 m_occupied[4][4];
+  uint32 m_free;
+  size_t m_size;
+  ThreadPool* m_ptr_thread_pool;
+  std::mutex m_mutex;
+  std::condition_variable m_signal;
+  bool m_running;
+  std::thread m_thread;
+};
+
+/**
+ * Debouncer
+ */
+
+class Debouncer : public SingletonT<Debouncer>
+{
+public:
+  Debouncer();
   virtual ~Debouncer();
 
   void debounce(ulongptr id, ulong elapse, std::function<void()> fn);
+  void throttle(ulongptr id, ulong elapse, std::function<void()> fn);
   bool exists(ulongptr id);
   void remove(ulongptr id);
   void cleanup();
 
 private:
-  static ulongptr m_using_timer_id;
-  static std::unordered_map<ulongptr, Timer*> m_timers;
-  static VOID CALLBACK fn_timer_proc(HWND hWnd, UINT message, UINT_PTR idTimer, DWORD dwTime);
+  struct Entry
+  {
+    TimerWheel::id_t timer;
+    uint64 sequence;
+    bool throttling;
+    bool pending;
+    std::function<void()> fn;
+  };
+
+  void fire(const ulongptr id, const uint64 sequence, const ulong elapse);
+
+private:
+  std::mutex m_mutex;
+  uint64 m_sequence;
+  std::unordered_map<ulongptr, Entry> m_entries;
+  TimerWheel m_wheel;
 };
 
+#pragma pack(pop)
+
 /*------------ The definition of common Class(es) which compatible both ANSI & UNICODE -----------*/
 
 #ifdef _UNICODE
@@ -3697,13 +5196,20 @@ private:
 #define Library LibraryW
 #define FileSystem FileSystemW
 #define FileMapping FileMappingW
+#define FileView FileViewW
+#define FileCursor FileCursorW
+#define HashCache HashCacheW
 #define INIFile INIFileW
 #define Registry RegistryW
 #define PEFileT PEFileTW
 #define Path PathW
+#define PathPool PathPoolW
+#define PathNode PathNodeW
 #define ScopeStopWatch ScopeStopWatchW
 #define WMIProvider WMIProviderW
 #define Variant VariantW
+#define FuzzyIndex FuzzyIndexW
+#define TimestampFormatter TimestampFormatterW
 #define Picker PickerW
 #define RESTClient RESTClientW
 #else // _UNICODE
@@ -3716,13 +5222,20 @@ private:
 #define Library LibraryA
 #define FileSystem FileSystemA
 #define FileMapping FileMappingA
+#define FileView FileViewA
+#define FileCursor FileCursorA
+#define HashCache HashCacheA
 #define INIFile INIFileA
 #define Registry RegistryA
 #define PEFileT PEFileTA
 #define Path PathA
+#define PathPool PathPoolA
+#define PathNode PathNodeA
 #define ScopeStopWatch ScopeStopWatchA
 #define WMIProvider WMIProviderA
 #define Variant VariantA
+#define FuzzyIndex FuzzyIndexA
+#define TimestampFormatter TimestampFormatterA
 #define Picker PickerA
 #define RESTClient RESTClientA
 #endif // _UNICODE
@@ -3733,6 +5246,24 @@ private:
 
 } // namespace vu
 
+#ifdef VU_GUID_ENABLED
+
+namespace std
+{
+
+template <>
+struct hash<vu::Guid>
+{
+  size_t operator()(const vu::Guid& guid) const
+  {
+    return vu::GUIDX::hash(guid);
+  }
+};
+
+} // namespace std
+
+#endif // VU_GUID_ENABLED
+
 #ifdef _MSC_VER
 #pragma pack(pop)
 #endif // _MSC_VER
@@ -184,11 +184,16 @@ public:
     return m_v[3];
   }
 
-  const T* data() const
+  T* data()
   {
     return reinterpret_cast<T*>(&m_v);
   }
 
+  const T* data() const
+  {
+    return reinterpret_cast<const T*>(&m_v);
+  }
+
   friend std::ostream& operator<<(std::ostream& os, const point_t& point)
   {
     os << "(";
@@ -743,3 +748,436 @@ private:
 typedef rect_t<int> r4i;
 typedef rect_t<float> r4f;
 typedef rect_t<double> r4d;
+
+// batch_t - The batch kernels over the arrays (the structure-of-arrays components)
+// The float, double and int kernels are vectorized (SSE2 or AVX2 that is picked at run-time on x86/x64),
+// the other types and the other architectures use the scalar loops (auto-vectorized by the compiler).
+// The division by zero results zero, the masks are one byte per element (0 or 1).
+// The rectangles are half-open (left <= x < right, top <= y < bottom) as PtInRect.
+// The elementary functions (rsqrt, exp, log, sin, cos) of float and double are the Cephes algorithms
+// over the vectors, the maximum errors versus the correctly rounded results are
+//  float  : rsqrt 3 ulp (an estimation + a Newton-Raphson step), exp 1 ulp, log 1 ulp, sin/cos 2 ulp
+//  double : rsqrt 1 ulp, exp 2 ulp, log 1 ulp, sin/cos 2 ulp
+// with the IEEE special values (eg. log(0) = -inf, log(-1) = nan, exp(1000) = inf) and the subnormals,
+// sin/cos use the C run-time functions for |x| > 8192 (float) and |x| > 2^20 (double).
+// The other types and the scalar fallback use the C run-time functions (the integers in double).
+
+template <typename T>
+struct batch_t
+{
+  static const char* isa()
+  {
+    return "scalar";
+  }
+
+  static void add(const T* a, const T* b, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+  }
+
+  static void add(const T* a, const T s, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = a[i] + s;
+  }
+
+  static void sub(const T* a, const T* b, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = a[i] - b[i];
+  }
+
+  static void mul(const T* a, const T* b, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = a[i] * b[i];
+  }
+
+  static void div(const T* a, const T* b, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = b[i] != T(0) ? T(a[i] / b[i]) : T(0);
+  }
+
+  static void scale(const T* a, const T s, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = a[i] * s;
+  }
+
+  static void madd(const T* a, const T* b, T* acc, const size_t n) // acc += a * b
+  {
+    for (size_t i = 0; i < n; i++) acc[i] += a[i] * b[i];
+  }
+
+  static void cross(const T* a, const T* b, const T* c, const T* d, T* out, const size_t n) // a * b - c * d
+  {
+    for (size_t i = 0; i < n; i++) out[i] = a[i] * b[i] - c[i] * d[i];
+  }
+
+  static void sqrt(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = a[i] > T(0) ? T(std::sqrt(double(a[i]))) : T(0);
+  }
+
+  static void rsqrt(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = T(1. / std::sqrt(double(a[i])));
+  }
+
+  static void exp(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = T(std::exp(double(a[i])));
+  }
+
+  static void log(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = T(std::log(double(a[i])));
+  }
+
+  static void sin(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = T(std::sin(double(a[i])));
+  }
+
+  static void cos(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = T(std::cos(double(a[i])));
+  }
+
+  static void minimum(const T* a, const T* b, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = b[i] < a[i] ? b[i] : a[i];
+  }
+
+  static void maximum(const T* a, const T* b, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = a[i] < b[i] ? b[i] : a[i];
+  }
+
+  static void contains(const T* l, const T* t, const T* r, const T* b,
+    const T x, const T y, byte* mask, const size_t n) // each rectangle contains the point
+  {
+    for (size_t i = 0; i < n; i++) mask[i] = byte(l[i] <= x && x < r[i] && t[i] <= y && y < b[i]);
+  }
+
+  static void contains(const T* l, const T* t, const T* r, const T* b,
+    const T* x, const T* y, byte* mask, const size_t n) // the rectangle i contains the point i
+  {
+    for (size_t i = 0; i < n; i++) mask[i] = byte(l[i] <= x[i] && x[i] < r[i] && t[i] <= y[i] && y[i] < b[i]);
+  }
+
+  static void overlaps(const T* l1, const T* t1, const T* r1, const T* b1,
+    const T* l2, const T* t2, const T* r2, const T* b2, byte* mask, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) mask[i] = byte(l1[i] < r2[i] && l2[i] < r1[i] && t1[i] < b2[i] && t2[i] < b1[i]);
+  }
+};
+
+#define VU_BATCH_SPECIALIZE(T)\
+template <>\
+struct batch_t<T>\
+{\
+  static const char* isa();\
+  static void add(const T* a, const T* b, T* out, const size_t n);\
+  static void add(const T* a, const T s, T* out, const size_t n);\
+  static void sub(const T* a, const T* b, T* out, const size_t n);\
+  static void mul(const T* a, const T* b, T* out, const size_t n);\
+  static void div(const T* a, const T* b, T* out, const size_t n);\
+  static void scale(const T* a, const T s, T* out, const size_t n);\
+  static void madd(const T* a, const T* b, T* acc, const size_t n);\
+  static void cross(const T* a, const T* b, const T* c, const T* d, T* out, const size_t n);\
+  static void sqrt(const T* a, T* out, const size_t n);\
+  static void rsqrt(const T* a, T* out, const size_t n);\
+  static void exp(const T* a, T* out, const size_t n);\
+  static void log(const T* a, T* out, const size_t n);\
+  static void sin(const T* a, T* out, const size_t n);\
+  static void cos(const T* a, T* out, const size_t n);\
+  static void minimum(const T* a, const T* b, T* out, const size_t n);\
+  static void maximum(const T* a, const T* b, T* out, const size_t n);\
+  static void contains(const T* l, const T* t, const T* r, const T* b,\
+    const T x, const T y, byte* mask, const size_t n);\
+  static void contains(const T* l, const T* t, const T* r, const T* b,\
+    const T* x, const T* y, byte* mask, const size_t n);\
+  static void overlaps(const T* l1, const T* t1, const T* r1, const T* b1,\
+    const T* l2, const T* t2, const T* r2, const T* b2, byte* mask, const size_t n);\
+};
+
+VU_BATCH_SPECIALIZE(float)
+VU_BATCH_SPECIALIZE(double)
+VU_BATCH_SPECIALIZE(int)
+
+// points_soa_t - The points/vectors template in the structure-of-arrays layout (one array per component)
+
+template <int N, typename T>
+class points_soa_t
+{
+public:
+  enum { D = N };
+
+  typedef point_t<N, T> item_t;
+  typedef batch_t<T> batch;
+
+  points_soa_t(const size_t size = 0)
+  {
+    this->resize(size);
+  }
+
+  size_t size() const
+  {
+    return m_v[0].size();
+  }
+
+  bool empty() const
+  {
+    return m_v[0].empty();
+  }
+
+  void resize(const size_t size)
+  {
+    for (int i = 0; i < D; i++) m_v[i].resize(size);
+  }
+
+  void reserve(const size_t size)
+  {
+    for (int i = 0; i < D; i++) m_v[i].reserve(size);
+  }
+
+  void clear()
+  {
+    for (int i = 0; i < D; i++) m_v[i].clear();
+  }
+
+  T* data(const int component)
+  {
+    return m_v[component].data();
+  }
+
+  const T* data(const int component) const
+  {
+    return m_v[component].data();
+  }
+
+  void push_back(const item_t& item)
+  {
+    for (int i = 0; i < D; i++) m_v[i].push_back(item.data()[i]);
+  }
+
+  item_t get(const size_t index) const
+  {
+    item_t result;
+    T* ptr = result.data();
+    for (int i = 0; i < D; i++) ptr[i] = m_v[i][index];
+    return result;
+  }
+
+  void set(const size_t index, const item_t& item)
+  {
+    for (int i = 0; i < D; i++) m_v[i][index] = item.data()[i];
+  }
+
+  points_soa_t& operator+=(const points_soa_t& right)
+  {
+    assert(right.size() == this->size());
+    for (int i = 0; i < D; i++) batch::add(data(i), right.data(i), data(i), size());
+    return *this;
+  }
+
+  points_soa_t& operator-=(const points_soa_t& right)
+  {
+    assert(right.size() == this->size());
+    for (int i = 0; i < D; i++) batch::sub(data(i), right.data(i), data(i), size());
+    return *this;
+  }
+
+  points_soa_t& operator*=(const points_soa_t& right)
+  {
+    assert(right.size() == this->size());
+    for (int i = 0; i < D; i++) batch::mul(data(i), right.data(i), data(i), size());
+    return *this;
+  }
+
+  points_soa_t& translate(const item_t& offset)
+  {
+    for (int i = 0; i < D; i++) batch::add(data(i), offset.data()[i], data(i), size());
+    return *this;
+  }
+
+  points_soa_t& scale(const T ratio)
+  {
+    for (int i = 0; i < D; i++) batch::scale(data(i), ratio, data(i), size());
+    return *this;
+  }
+
+  void dot(const points_soa_t& right, std::vector<T>& out) const // dot/scalar products
+  {
+    assert(right.size() == this->size());
+    out.assign(size(), T(0));
+    for (int i = 0; i < D; i++) batch::madd(data(i), right.data(i), out.data(), size());
+  }
+
+  void mag(std::vector<T>& out) const // magnitudes/lengths
+  {
+    this->dot(*this, out);
+    batch::sqrt(out.data(), out.data(), out.size());
+  }
+
+  points_soa_t& normalize() // normalize/unit, the zero vectors stay zero
+  {
+    std::vector<T> lengths;
+    this->mag(lengths);
+    for (int i = 0; i < D; i++) batch::div(data(i), lengths.data(), data(i), size());
+    return *this;
+  }
+
+  void cross(const points_soa_t& right, std::vector<T>& out) const // 2D cross products (z components)
+  {
+    static_assert(N == 2, "the scalar cross product is for 2D vectors");
+    assert(right.size() == this->size());
+    out.resize(size());
+    batch::cross(data(0), right.data(1), data(1), right.data(0), out.data(), size());
+  }
+
+  void cross(const points_soa_t& right, points_soa_t& out) const // 3D cross products
+  {
+    static_assert(N == 3, "the vector cross product is for 3D vectors");
+    assert(right.size() == this->size());
+
+    if (&out == this || &out == &right) // each component reads the others, so it could not be overwritten in-place
+    {
+      points_soa_t result;
+      this->cross(right, result);
+      out = std::move(result);
+      return;
+    }
+
+    out.resize(size());
+    batch::cross(data(1), right.data(2), data(2), right.data(1), out.data(0), size());
+    batch::cross(data(2), right.data(0), data(0), right.data(2), out.data(1), size());
+    batch::cross(data(0), right.data(1), data(1), right.data(0), out.data(2), size());
+  }
+
+private:
+  std::vector<T> m_v[N];
+};
+
+// rects_soa_t - The rectangles template in the structure-of-arrays layout (normalized, unflipped)
+
+template <typename T>
+class rects_soa_t
+{
+public:
+  typedef rect_t<T> item_t;
+  typedef batch_t<T> batch;
+
+  enum component_t
+  {
+    LEFT,
+    TOP,
+    RIGHT,
+    BOTTOM,
+  };
+
+  rects_soa_t(const size_t size = 0)
+  {
+    this->resize(size);
+  }
+
+  size_t size() const
+  {
+    return m_v[0].size();
+  }
+
+  bool empty() const
+  {
+    return m_v[0].empty();
+  }
+
+  void resize(const size_t size)
+  {
+    for (int i = 0; i < 4; i++) m_v[i].resize(size);
+  }
+
+  void reserve(const size_t size)
+  {
+    for (int i = 0; i < 4; i++) m_v[i].reserve(size);
+  }
+
+  void clear()
+  {
+    for (int i = 0; i < 4; i++) m_v[i].clear();
+  }
+
+  T* data(const component_t component)
+  {
+    return m_v[component].data();
+  }
+
+  const T* data(const component_t component) const
+  {
+    return m_v[component].data();
+  }
+
+  void push_back(const item_t& item)
+  {
+    m_v[LEFT].push_back(item.left() < item.right() ? item.left() : item.right());
+    m_v[TOP].push_back(item.top() < item.bottom() ? item.top() : item.bottom());
+    m_v[RIGHT].push_back(item.left() < item.right() ? item.right() : item.left());
+    m_v[BOTTOM].push_back(item.top() < item.bottom() ? item.bottom() : item.top());
+  }
+
+  item_t get(const size_t index) const
+  {
+    return item_t(m_v[LEFT][index], m_v[TOP][index], m_v[RIGHT][index], m_v[BOTTOM][index]);
+  }
+
+  void set(const size_t index, const item_t& item)
+  {
+    m_v[LEFT][index]   = item.left() < item.right() ? item.left() : item.right();
+    m_v[TOP][index]    = item.top() < item.bottom() ? item.top() : item.bottom();
+    m_v[RIGHT][index]  = item.left() < item.right() ? item.right() : item.left();
+    m_v[BOTTOM][index] = item.top() < item.bottom() ? item.bottom() : item.top();
+  }
+
+  void contains(const point_2d_t<T>& point, std::vector<byte>& mask) const // hit-testing
+  {
+    mask.resize(size());
+    batch::contains(data(LEFT), data(TOP), data(RIGHT), data(BOTTOM), point.x(), point.y(), mask.data(), size());
+  }
+
+  void contains(const points_soa_t<2, T>& points, std::vector<byte>& mask) const // pair-wise
+  {
+    assert(points.size() == this->size());
+    mask.resize(size());
+    batch::contains(data(LEFT), data(TOP), data(RIGHT), data(BOTTOM),
+      points.data(0), points.data(1), mask.data(), size());
+  }
+
+  void overlaps(const rects_soa_t& right, std::vector<byte>& mask) const // pair-wise
+  {
+    assert(right.size() == this->size());
+    mask.resize(size());
+    batch::overlaps(data(LEFT), data(TOP), data(RIGHT), data(BOTTOM),
+      right.data(LEFT), right.data(TOP), right.data(RIGHT), right.data(BOTTOM), mask.data(), size());
+  }
+
+  void intersect(const rects_soa_t& right, rects_soa_t& out) const // pair-wise, no intersection results empty
+  {
+    assert(right.size() == this->size());
+    out.resize(size());
+    batch::maximum(data(LEFT), right.data(LEFT), out.data(LEFT), size());
+    batch::maximum(data(TOP), right.data(TOP), out.data(TOP), size());
+    batch::minimum(data(RIGHT), right.data(RIGHT), out.data(RIGHT), size());
+    batch::minimum(data(BOTTOM), right.data(BOTTOM), out.data(BOTTOM), size());
+    batch::maximum(out.data(LEFT), out.data(RIGHT), out.data(RIGHT), size());
+    batch::maximum(out.data(TOP), out.data(BOTTOM), out.data(BOTTOM), size());
+  }
+
+  void unite(const rects_soa_t& right, rects_soa_t& out) const // pair-wise bounding rectangles
+  {
+    assert(right.size() == this->size());
+    out.resize(size());
+    batch::minimum(data(LEFT), right.data(LEFT), out.data(LEFT), size());
+    batch::minimum(data(TOP), right.data(TOP), out.data(TOP), size());
+    batch::maximum(data(RIGHT), right.data(RIGHT), out.data(RIGHT), size());
+    batch::maximum(data(BOTTOM), right.data(BOTTOM), out.data(BOTTOM), size());
+  }
+
+private:
+  std::vector<T> m_v[4];
+};
@@ -0,0 +1,807 @@
+/**
+ * @file   spatial.tpl
+ * @author Vic P.
+ * @brief  Template for Spatial Index
+ */
+
+// Spatial Index
+// The rectangles are normalized (the flipped ones are unflipped) and half-open as PtInRect,
+// a point hits a rectangle if left <= x < right and top <= y < bottom,
+// two rectangles overlap if they share an area (the touching edges do not overlap).
+// The ids are stable, they are assigned incrementally and not reused until clear().
+// The queries are const and do not share any state, so they are safe to run concurrently.
+
+// spatial_box_t - The normalized rectangle that is used by the spatial indexes
+
+template <typename T>
+struct spatial_box_t
+{
+  T l, t, r, b;
+
+  spatial_box_t() : l(T(0)), t(T(0)), r(T(0)), b(T(0)) {}
+
+  spatial_box_t(const rect_t<T>& rect)
+  {
+    l = rect.left() < rect.right() ? rect.left() : rect.right();
+    r = rect.left() < rect.right() ? rect.right() : rect.left();
+    t = rect.top() < rect.bottom() ? rect.top() : rect.bottom();
+    b = rect.top() < rect.bottom() ? rect.bottom() : rect.top();
+  }
+
+  rect_t<T> rect() const
+  {
+    return rect_t<T>(l, t, r, b);
+  }
+
+  bool contains(const T x, const T y) const
+  {
+    return l <= x && x < r && t <= y && y < b;
+  }
+
+  bool overlaps(const spatial_box_t& v) const
+  {
+    return l < v.r && v.l < r && t < v.b && v.t < b;
+  }
+
+  void unite(const spatial_box_t& v)
+  {
+    if (v.l < l) l = v.l;
+    if (v.t < t) t = v.t;
+    if (v.r > r) r = v.r;
+    if (v.b > b) b = v.b;
+  }
+
+  double distance(const T x, const T y) const // the squared distance, zero if the point is inside
+  {
+    const double dx = x < l ? double(l) - double(x) : (x > r ? double(x) - double(r) : 0.);
+    const double dy = y < t ? double(t) - double(y) : (y > b ? double(y) - double(b) : 0.);
+    return dx * dx + dy * dy;
+  }
+};
+
+// spatial_rtree_t - The packed R-tree (Sort-Tile-Recursive bulk loading) for the mostly static sets
+// The updates of the indexed items refit their ancestors in O(log n), the inserted items are kept
+// in a pending list (scanned linearly) that is packed into the tree once it grows over
+// NODE_SIZE + sqrt(n) items, the removed items are packed out once they are over a half of the tree.
+
+template <typename T>
+class spatial_rtree_t
+{
+public:
+  typedef rect_t<T> item_t;
+  typedef spatial_box_t<T> box_t;
+
+  enum { NODE_SIZE = 16 };
+
+  spatial_rtree_t() : m_count(0), m_removed(0) {}
+
+  spatial_rtree_t(const std::vector<item_t>& items) : m_count(0), m_removed(0)
+  {
+    build(items);
+  }
+
+  size_t size() const
+  {
+    return m_count;
+  }
+
+  bool empty() const
+  {
+    return m_count == 0;
+  }
+
+  void clear()
+  {
+    m_items.clear();
+    m_states.clear();
+    m_pending.clear();
+    m_nodes.clear();
+    m_levels.clear();
+    m_leaf_ids.clear();
+    m_leaf_of.clear();
+    m_count = 0;
+    m_removed = 0;
+  }
+
+  void build(const std::vector<item_t>& items) // bulk loading, the ids are the indices of the items
+  {
+    this->clear();
+
+    m_items.reserve(items.size());
+    for (const auto& item : items)
+    {
+      m_items.push_back(box_t(item));
+    }
+
+    m_states.assign(items.size(), byte(ITEM_PENDING));
+    m_count = items.size();
+
+    this->pack();
+  }
+
+  size_t insert(const item_t& item)
+  {
+    const size_t id = m_items.size();
+
+    m_items.push_back(box_t(item));
+    m_states.push_back(byte(ITEM_PENDING));
+    m_leaf_of.push_back(size_t(-1));
+    m_pending.push_back(id);
+    m_count++;
+
+    if (m_pending.size() > NODE_SIZE + size_t(std::sqrt(double(m_count))))
+    {
+      this->pack();
+    }
+
+    return id;
+  }
+
+  bool update(const size_t id, const item_t& item)
+  {
+    if (!this->exists(id))
+    {
+      return false;
+    }
+
+    m_items[id] = box_t(item);
+
+    if (m_states[id] == ITEM_INDEXED) // refit the path to the root
+    {
+      size_t pos = m_leaf_of[id];
+      m_nodes[pos] = m_items[id];
+
+      for (size_t level = 1; level < m_levels.size(); level++)
+      {
+        pos = this->level_begin(level) + (pos - this->level_begin(level - 1)) / NODE_SIZE;
+        m_nodes[pos] = this->unite_children(pos, level);
+      }
+    }
+
+    return true;
+  }
+
+  bool remove(const size_t id)
+  {
+    if (!this->exists(id))
+    {
+      return false;
+    }
+
+    if (m_states[id] == ITEM_PENDING)
+    {
+      m_pending.erase(std::find(m_pending.begin(), m_pending.end(), id));
+    }
+    else
+    {
+      m_removed++;
+    }
+
+    m_states[id] = byte(ITEM_REMOVED);
+    m_count--;
+
+    if (m_removed > m_leaf_ids.size() / 2)
+    {
+      this->pack();
+    }
+
+    return true;
+  }
+
+  bool exists(const size_t id) const
+  {
+    return id < m_states.size() && m_states[id] != ITEM_REMOVED;
+  }
+
+  item_t get(const size_t id) const
+  {
+    return this->exists(id) ? m_items[id].rect() : item_t();
+  }
+
+  void rebuild() // packs the pending items into the tree and drops the removed ones
+  {
+    this->pack();
+  }
+
+  size_t query(const point_2d_t<T>& point, std::vector<size_t>& ids) const // the items contain the point
+  {
+    const T x = point.x(), y = point.y();
+    return this->search([x, y](const box_t& box) { return box.contains(x, y); }, ids);
+  }
+
+  size_t query(const item_t& area, std::vector<size_t>& ids) const // the items overlap the area
+  {
+    const box_t v(area);
+    return this->search([&v](const box_t& box) { return box.overlaps(v); }, ids);
+  }
+
+  size_t nearest(const point_2d_t<T>& point, const size_t k, std::vector<size_t>& ids) const // sorted by distance
+  {
+    ids.clear();
+
+    if (k == 0 || m_count == 0)
+    {
+      return 0;
+    }
+
+    const T x = point.x(), y = point.y();
+    const size_t pending_level = size_t(-1);
+
+    std::vector<entry_t> heap; // best-first, the min-heap of the nodes and the items by distance
+    const auto heap_push = [&heap](const double d, const size_t pos, const size_t level)
+    {
+      heap.push_back(entry_t(d, pos, level));
+      std::push_heap(heap.begin(), heap.end(), std::greater<entry_t>());
+    };
+
+    for (const auto id : m_pending)
+    {
+      heap_push(m_items[id].distance(x, y), id, pending_level);
+    }
+
+    if (!m_nodes.empty())
+    {
+      heap_push(m_nodes.back().distance(x, y), m_nodes.size() - 1, m_levels.size() - 1);
+    }
+
+    while (!heap.empty() && ids.size() < k)
+    {
+      std::pop_heap(heap.begin(), heap.end(), std::greater<entry_t>());
+      const auto entry = heap.back();
+      heap.pop_back();
+
+      const size_t pos = entry.pos, level = entry.level;
+
+      if (level == pending_level)
+      {
+        ids.push_back(pos);
+      }
+      else if (level == 0)
+      {
+        if (m_states[m_leaf_ids[pos]] == ITEM_INDEXED)
+        {
+          ids.push_back(m_leaf_ids[pos]);
+        }
+      }
+      else
+      {
+        const size_t end = this->children_end(pos, level);
+        for (size_t child = this->children_begin(pos, level); child < end; child++)
+        {
+          heap_push(m_nodes[child].distance(x, y), child, level - 1);
+        }
+      }
+    }
+
+    return ids.size();
+  }
+
+private:
+  enum item_state_t
+  {
+    ITEM_REMOVED,
+    ITEM_INDEXED,
+    ITEM_PENDING,
+  };
+
+  struct entry_t
+  {
+    double distance;
+    size_t pos;
+    size_t level;
+
+    entry_t(const double d, const size_t p, const size_t l) : distance(d), pos(p), level(l) {}
+
+    bool operator>(const entry_t& right) const
+    {
+      return distance > right.distance;
+    }
+  };
+
+  size_t level_begin(const size_t level) const
+  {
+    return level == 0 ? 0 : m_levels[level - 1];
+  }
+
+  size_t children_begin(const size_t pos, const size_t level) const
+  {
+    return this->level_begin(level - 1) + (pos - this->level_begin(level)) * NODE_SIZE;
+  }
+
+  size_t children_end(const size_t pos, const size_t level) const
+  {
+    const size_t end = this->children_begin(pos, level) + NODE_SIZE;
+    return end < m_levels[level - 1] ? end : m_levels[level - 1];
+  }
+
+  box_t unite_children(const size_t pos, const size_t level) const
+  {
+    const size_t end = this->children_end(pos, level);
+    size_t child = this->children_begin(pos, level);
+
+    box_t result = m_nodes[child];
+    for (++child; child < end; child++)
+    {
+      result.unite(m_nodes[child]);
+    }
+
+    return result;
+  }
+
+  template <typename Fn>
+  size_t search(Fn match, std::vector<size_t>& ids) const
+  {
+    ids.clear();
+
+    if (m_levels.size() == 1) // a single leaf
+    {
+      if (match(m_nodes.front()) && m_states[m_leaf_ids.front()] == ITEM_INDEXED)
+      {
+        ids.push_back(m_leaf_ids.front());
+      }
+    }
+    else if (!m_nodes.empty() && match(m_nodes.back()))
+    {
+      std::vector<std::pair<size_t, size_t>> stack; // position, level
+      stack.push_back(std::make_pair(m_nodes.size() - 1, m_levels.size() - 1));
+
+      while (!stack.empty())
+      {
+        const auto node = stack.back();
+        stack.pop_back();
+
+        const size_t end = this->children_end(node.first, node.second);
+        for (size_t child = this->children_begin(node.first, node.second); child < end; child++)
+        {
+          if (!match(m_nodes[child]))
+          {
+            continue;
+          }
+
+          if (node.second > 1)
+          {
+            stack.push_back(std::make_pair(child, node.second - 1));
+          }
+          else if (m_states[m_leaf_ids[child]] == ITEM_INDEXED)
+          {
+            ids.push_back(m_leaf_ids[child]);
+          }
+        }
+      }
+    }
+
+    for (const auto id : m_pending)
+    {
+      if (match(m_items[id]))
+      {
+        ids.push_back(id);
+      }
+    }
+
+    return ids.size();
+  }
+
+  void pack()
+  {
+    m_pending.clear();
+    m_nodes.clear();
+    m_levels.clear();
+    m_leaf_ids.clear();
+    m_leaf_of.assign(m_items.size(), size_t(-1));
+    m_removed = 0;
+
+    for (size_t id = 0; id < m_states.size(); id++)
+    {
+      if (m_states[id] != ITEM_REMOVED)
+      {
+        m_states[id] = byte(ITEM_INDEXED);
+        m_leaf_ids.push_back(id);
+      }
+    }
+
+    const size_t n = m_leaf_ids.size();
+    if (n == 0)
+    {
+      return;
+    }
+
+    // sort-tile-recursive: the vertical slices of the x-sorted items, then each slice is sorted by y
+
+    const auto items = m_items.data();
+    const auto less_x = [items](const size_t a, const size_t b)
+    {
+      return double(items[a].l) + double(items[a].r) < double(items[b].l) + double(items[b].r);
+    };
+    const auto less_y = [items](const size_t a, const size_t b)
+    {
+      return double(items[a].t) + double(items[a].b) < double(items[b].t) + double(items[b].b);
+    };
+
+    const size_t num_leaves = (n + NODE_SIZE - 1) / NODE_SIZE;
+    const size_t num_slices = size_t(std::ceil(std::sqrt(double(num_leaves))));
+    const size_t slice_size = num_slices * NODE_SIZE;
+
+    std::sort(m_leaf_ids.begin(), m_leaf_ids.end(), less_x);
+
+    for (size_t i = 0; i < n; i += slice_size)
+    {
+      const size_t end = i + slice_size < n ? i + slice_size : n;
+      std::sort(m_leaf_ids.begin() + i, m_leaf_ids.begin() + end, less_y);
+    }
+
+    // the levels are stored continuously from the leaves to the root
+
+    m_nodes.reserve(n + n / (NODE_SIZE - 1) + 1);
+
+    for (size_t pos = 0; pos < n; pos++)
+    {
+      m_nodes.push_back(m_items[m_leaf_ids[pos]]);
+      m_leaf_of[m_leaf_ids[pos]] = pos;
+    }
+
+    m_levels.push_back(n);
+
+    while (m_levels.back() - this->level_begin(m_levels.size() - 1) > 1)
+    {
+      const size_t level = m_levels.size();
+      const size_t end = m_levels.back();
+
+      for (size_t child = this->level_begin(level - 1); child < end; child += NODE_SIZE)
+      {
+        m_nodes.push_back(box_t());
+        m_nodes.back() = this->unite_children(m_nodes.size() - 1, level);
+      }
+
+      m_levels.push_back(m_nodes.size());
+    }
+  }
+
+private:
+  std::vector<box_t> m_items;      // by id
+  std::vector<byte> m_states;      // by id, refer to item_state_t
+  std::vector<size_t> m_pending;   // the ids that are not in the tree
+  std::vector<box_t> m_nodes;      // the leaves then the upper levels, the root is the last one
+  std::vector<size_t> m_levels;    // the end positions of the levels
+  std::vector<size_t> m_leaf_ids;  // by leaf position
+  std::vector<size_t> m_leaf_of;   // the leaf position by id
+  size_t m_count;
+  size_t m_removed;
+};
+
+// spatial_grid_t - The uniform grid (sparse cells) for the dynamic sets
+// An item is kept in all cells it covers, so the cell size should be about the typical item size.
+
+template <typename T>
+class spatial_grid_t
+{
+public:
+  typedef rect_t<T> item_t;
+  typedef spatial_box_t<T> box_t;
+
+  spatial_grid_t(const double cell_size = 64.) : m_cell_size(cell_size > 0. ? cell_size : 64.)
+  {
+    this->clear();
+  }
+
+  double cell_size() const
+  {
+    return m_cell_size;
+  }
+
+  size_t size() const
+  {
+    return m_count;
+  }
+
+  bool empty() const
+  {
+    return m_count == 0;
+  }
+
+  void clear()
+  {
+    m_items.clear();
+    m_alive.clear();
+    m_cells.clear();
+    m_count = 0;
+    m_extent.l = m_extent.t = INT_MAX;
+    m_extent.r = m_extent.b = INT_MIN;
+  }
+
+  size_t insert(const item_t& item)
+  {
+    const size_t id = m_items.size();
+
+    m_items.push_back(box_t(item));
+    m_alive.push_back(true);
+    m_count++;
+
+    this->link(id);
+
+    return id;
+  }
+
+  bool update(const size_t id, const item_t& item)
+  {
+    if (!this->exists(id))
+    {
+      return false;
+    }
+
+    const box_t box(item);
+    const auto from = this->cells_of(m_items[id]), to = this->cells_of(box);
+
+    if (from.l == to.l && from.t == to.t && from.r == to.r && from.b == to.b)
+    {
+      m_items[id] = box; // the same cells
+    }
+    else
+    {
+      this->unlink(id);
+      m_items[id] = box;
+      this->link(id);
+    }
+
+    return true;
+  }
+
+  bool remove(const size_t id)
+  {
+    if (!this->exists(id))
+    {
+      return false;
+    }
+
+    this->unlink(id);
+    m_alive[id] = false;
+    m_count--;
+
+    return true;
+  }
+
+  bool exists(const size_t id) const
+  {
+    return id < m_alive.size() && m_alive[id];
+  }
+
+  item_t get(const size_t id) const
+  {
+    return this->exists(id) ? m_items[id].rect() : item_t();
+  }
+
+  size_t query(const point_2d_t<T>& point, std::vector<size_t>& ids) const // the items contain the point
+  {
+    ids.clear();
+
+    const auto it = m_cells.find(this->key_of(this->cell_of(point.x()), this->cell_of(point.y())));
+    if (it != m_cells.cend())
+    {
+      for (const auto id : it->second)
+      {
+        if (m_items[id].contains(point.x(), point.y()))
+        {
+          ids.push_back(id);
+        }
+      }
+    }
+
+    return ids.size();
+  }
+
+  size_t query(const item_t& area, std::vector<size_t>& ids) const // the items overlap the area
+  {
+    ids.clear();
+
+    const box_t v(area);
+    const auto cells = this->cells_of(v);
+
+    // an item is reported once by the cell of the top-left corner of its overlapped area
+
+    const auto visit = [&](const int cx, const int cy, const std::vector<size_t>& bucket)
+    {
+      for (const auto id : bucket)
+      {
+        const auto& box = m_items[id];
+        if (box.overlaps(v) &&
+          this->cell_of(box.l < v.l ? v.l : box.l) == cx &&
+          this->cell_of(box.t < v.t ? v.t : box.t) == cy)
+        {
+          ids.push_back(id);
+        }
+      }
+    };
+
+    const double num_cells = (double(cells.r) - cells.l + 1.) * (double(cells.b) - cells.t + 1.);
+    if (num_cells > double(m_cells.size())) // a large area, walk the occupied cells instead
+    {
+      for (const auto& cell : m_cells)
+      {
+        const int cx = int(int32(cell.first >> 32)), cy = int(int32(cell.first));
+        if (cells.l <= cx && cx <= cells.r && cells.t <= cy && cy <= cells.b)
+        {
+          visit(cx, cy, cell.second);
+        }
+      }
+    }
+    else
+    {
+      for (int cy = cells.t; cy <= cells.b; cy++)
+      {
+        for (int cx = cells.l; cx <= cells.r; cx++)
+        {
+          const auto it = m_cells.find(this->key_of(cx, cy));
+          if (it != m_cells.cend())
+          {
+            visit(cx, cy, it->second);
+          }
+        }
+      }
+    }
+
+    return ids.size();
+  }
+
+  size_t nearest(const point_2d_t<T>& point, const size_t k, std::vector<size_t>& ids) const // sorted by distance
+  {
+    ids.clear();
+
+    if (k == 0 || m_count == 0)
+    {
+      return 0;
+    }
+
+    const T x = point.x(), y = point.y();
+    const int px = this->cell_of(x), py = this->cell_of(y);
+
+    // the rings of cells around the point, an item is seen once by the cell of its closest point,
+    // so an unseen item is farther than (ring * cell size) from the point
+
+    std::vector<std::pair<double, size_t>> best; // the max-heap of the k nearest items
+
+    const auto visit = [&](const int cx, const int cy)
+    {
+      const auto it = m_cells.find(this->key_of(cx, cy));
+      if (it == m_cells.cend())
+      {
+        return;
+      }
+
+      for (const auto id : it->second)
+      {
+        const auto& box = m_items[id];
+        const T nx = x < box.l ? box.l : (x > box.r ? box.r : x);
+        const T ny = y < box.t ? box.t : (y > box.b ? box.b : y);
+        if (this->cell_of(nx) != cx || this->cell_of(ny) != cy)
+        {
+          continue;
+        }
+
+        const auto candidate = std::make_pair(box.distance(x, y), id);
+        if (best.size() < k)
+        {
+          best.push_back(candidate);
+          std::push_heap(best.begin(), best.end());
+        }
+        else if (candidate < best.front())
+        {
+          std::pop_heap(best.begin(), best.end());
+          best.back() = candidate;
+          std::push_heap(best.begin(), best.end());
+        }
+      }
+    };
+
+    const auto gap = [](const int v, const int lo, const int hi) -> int
+    {
+      return v < lo ? lo - v : (v > hi ? v - hi : 0);
+    };
+
+    const int gx = gap(px, m_extent.l, m_extent.r), gy = gap(py, m_extent.t, m_extent.b);
+
+    for (int ring = gx > gy ? gx : gy;; ring++)
+    {
+      const int l = px - ring, t = py - ring, r = px + ring, b = py + ring;
+      const int cl = l > m_extent.l ? l : m_extent.l, cr = r < m_extent.r ? r : m_extent.r;
+      const int ct = t > m_extent.t ? t : m_extent.t, cb = b < m_extent.b ? b : m_extent.b;
+
+      if (t >= m_extent.t) for (int cx = cl; cx <= cr; cx++) visit(cx, t);
+      if (ring > 0 && b <= m_extent.b) for (int cx = cl; cx <= cr; cx++) visit(cx, b);
+      if (l >= m_extent.l) for (int cy = ct; cy <= cb; cy++) if (cy != t && cy != b) visit(l, cy);
+      if (ring > 0 && r <= m_extent.r) for (int cy = ct; cy <= cb; cy++) if (cy != t && cy != b) visit(r, cy);
+
+      const double reach = double(ring) * m_cell_size;
+      if (best.size() == k && best.front().first <= reach * reach)
+      {
+        break;
+      }
+
+      if (l <= m_extent.l && t <= m_extent.t && r >= m_extent.r && b >= m_extent.b)
+      {
+        break; // all occupied cells are visited
+      }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+
+    for (const auto& e : best)
+    {
+      ids.push_back(e.second);
+    }
+
+    return ids.size();
+  }
+
+private:
+  int cell_of(const T v) const
+  {
+    return int(std::floor(double(v) / m_cell_size));
+  }
+
+  spatial_box_t<int> cells_of(const box_t& box) const // the inclusive range of cells
+  {
+    spatial_box_t<int> result;
+    result.l = this->cell_of(box.l);
+    result.t = this->cell_of(box.t);
+    result.r = this->cell_of(box.r);
+    result.b = this->cell_of(box.b);
+    return result;
+  }
+
+  static uint64 key_of(const int cx, const int cy)
+  {
+    return (uint64(uint32(cx)) << 32) | uint64(uint32(cy));
+  }
+
+  void link(const size_t id)
+  {
+    const auto cells = this->cells_of(m_items[id]);
+
+    for (int cy = cells.t; cy <= cells.b; cy++)
+    {
+      for (int cx = cells.l; cx <= cells.r; cx++)
+      {
+        m_cells[this->key_of(cx, cy)].push_back(id);
+      }
+    }
+
+    m_extent.unite(cells);
+  }
+
+  void unlink(const size_t id)
+  {
+    const auto cells = this->cells_of(m_items[id]);
+
+    for (int cy = cells.t; cy <= cells.b; cy++)
+    {
+      for (int cx = cells.l; cx <= cells.r; cx++)
+      {
+        const auto it = m_cells.find(this->key_of(cx, cy));
+        if (it == m_cells.end())
+        {
+          continue;
+        }
+
+        auto& bucket = it->second;
+        const auto pos = std::find(bucket.begin(), bucket.end(), id);
+        if (pos != bucket.end())
+        {
+          *pos = bucket.back();
+          bucket.pop_back();
+        }
+
+        if (bucket.empty())
+        {
+          m_cells.erase(it);
+        }
+      }
+    }
+  }
+
+private:
+  double m_cell_size;
+  std::vector<box_t> m_items; // by id
+  std::vector<bool> m_alive;  // by id
+  std::unordered_map<uint64, std::vector<size_t>> m_cells;
+  spatial_box_t<int> m_extent; // the inclusive range of the cells that have ever been occupied
+  size_t m_count;
+};
@@ -0,0 +1,620 @@
+/**
+ * @file   strfmt.tpl
+ * @author Vic P.
+ * @brief  Template for String Format
+ */
+
+// String Format
+
+/**
+ * FormatBufferT - The growable character buffer that lives on the stack until it outgrows `Size`.
+ * Reuse it across calls (clear() keeps the capacity) to format without any allocation at all.
+ */
+
+template <typename CharT, size_t Size = 500>
+class FormatBufferT
+{
+public:
+  typedef CharT value_type;
+
+  FormatBufferT() : m_ptr(m_stack), m_size(0), m_capacity(Size) {}
+  virtual ~FormatBufferT() {}
+
+  FormatBufferT(const FormatBufferT&) = delete;
+  FormatBufferT& operator=(const FormatBufferT&) = delete;
+
+  void push_back(const CharT c)
+  {
+    if (m_size == m_capacity)
+    {
+      this->grow(m_size + 1);
+    }
+
+    m_ptr[m_size++] = c;
+  }
+
+  void append(const CharT* ptr, const size_t length)
+  {
+    if (m_size + length > m_capacity)
+    {
+      this->grow(m_size + length);
+    }
+
+    std::char_traits<CharT>::copy(m_ptr + m_size, ptr, length);
+    m_size += length;
+  }
+
+  void clear()
+  {
+    m_size = 0;
+  }
+
+  bool empty() const
+  {
+    return m_size == 0;
+  }
+
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  size_t capacity() const
+  {
+    return m_capacity;
+  }
+
+  const CharT* data() const
+  {
+    return m_ptr;
+  }
+
+  const CharT* c_str()
+  {
+    this->push_back(CharT(0));
+    m_size--;
+    return m_ptr;
+  }
+
+  std::basic_string<CharT> str() const
+  {
+    return std::basic_string<CharT>(m_ptr, m_size);
+  }
+
+private:
+  void grow(const size_t size)
+  {
+    const size_t capacity = size > 2 * m_capacity ? size : 2 * m_capacity;
+
+    std::unique_ptr<CharT[]> ptr(new CharT[capacity]);
+    std::char_traits<CharT>::copy(ptr.get(), m_ptr, m_size);
+
+    m_heap = std::move(ptr);
+    m_ptr = m_heap.get();
+    m_capacity = capacity;
+  }
+
+private:
+  CharT m_stack[Size];
+  std::unique_ptr<CharT[]> m_heap;
+  CharT* m_ptr;
+  size_t m_size;
+  size_t m_capacity;
+};
+
+typedef FormatBufferT<char>  FormatBufferA;
+typedef FormatBufferT<wchar> FormatBufferW;
+
+#ifdef _UNICODE
+#define FormatBuffer FormatBufferW
+#else
+#define FormatBuffer FormatBufferA
+#endif
+
+/**
+ * The sinks - a format buffer or any output iterator.
+ */
+
+template <typename CharT, size_t Size>
+void __vu_format_put(FormatBufferT<CharT, Size>& out, const CharT c)
+{
+  out.push_back(c);
+}
+
+template <typename CharT, size_t Size>
+void __vu_format_put(FormatBufferT<CharT, Size>& out, const CharT* ptr, const size_t length)
+{
+  out.append(ptr, length);
+}
+
+template <typename OutputIt, typename CharT>
+void __vu_format_put(OutputIt& out, const CharT c)
+{
+  *out++ = c;
+}
+
+template <typename OutputIt, typename CharT>
+void __vu_format_put(OutputIt& out, const CharT* ptr, const size_t length)
+{
+  out = std::copy(ptr, ptr + length, out);
+}
+
+/**
+ * The replacement field is `{[:][0][width][.precision][type]}` where the type is one of
+ * `d` (default), `x`, `X`, `o`, `b` for integers, `f`, `e`, `g` (default) for floating points.
+ * The numbers are right-aligned and the others are left-aligned in the width.
+ */
+
+struct __vu_format_spec
+{
+  int  width;
+  int  precision;
+  char type;
+  bool zero;
+};
+
+template <typename CharT>
+const CharT* __vu_format_parse_spec(const CharT* ptr, const CharT* last, __vu_format_spec& spec)
+{
+  spec.width = 0;
+  spec.precision = -1;
+  spec.type = 0;
+  spec.zero = false;
+
+  if (ptr != last && *ptr == CharT(':'))
+  {
+    ptr++;
+  }
+
+  if (ptr != last && *ptr == CharT('0'))
+  {
+    spec.zero = true;
+    ptr++;
+  }
+
+  for (; ptr != last && *ptr >= CharT('0') && *ptr <= CharT('9'); ptr++)
+  {
+    spec.width = 10 * spec.width + int(*ptr - CharT('0'));
+  }
+
+  if (ptr != last && *ptr == CharT('.'))
+  {
+    spec.precision = 0;
+    for (ptr++; ptr != last && *ptr >= CharT('0') && *ptr <= CharT('9'); ptr++)
+    {
+      spec.precision = 10 * spec.precision + int(*ptr - CharT('0'));
+    }
+  }
+
+  if (ptr != last && *ptr != CharT('}'))
+  {
+    spec.type = char(*ptr++);
+  }
+
+  return ptr;
+}
+
+template <typename CharT, typename Out, typename T>
+void __vu_format_padded(
+  Out& out, const T* ptr, const size_t length, const __vu_format_spec& spec, const bool right)
+{
+  const size_t padding = size_t(spec.width) > length ? size_t(spec.width) - length : 0;
+  const CharT fill = spec.zero && right ? CharT('0') : CharT(' ');
+
+  size_t i = 0;
+
+  if (right && fill == CharT('0') && length != 0 && (ptr[0] == T('-') || ptr[0] == T('+')))
+  {
+    __vu_format_put(out, CharT(ptr[i++])); // the sign goes before the zeros
+  }
+
+  if (right)
+  {
+    for (size_t n = 0; n < padding; n++) __vu_format_put(out, fill);
+  }
+
+  for (; i < length; i++)
+  {
+    __vu_format_put(out, CharT(ptr[i]));
+  }
+
+  if (!right)
+  {
+    for (size_t n = 0; n < padding; n++) __vu_format_put(out, fill);
+  }
+}
+
+template <typename CharT, typename Out>
+void __vu_format_string(Out& out, const CharT* ptr, const size_t length, const __vu_format_spec& spec)
+{
+  if (spec.width <= 0 || size_t(spec.width) <= length)
+  {
+    __vu_format_put(out, ptr, length);
+  }
+  else
+  {
+    __vu_format_padded<CharT>(out, ptr, length, spec, false);
+  }
+}
+
+template <typename CharT, typename Out, typename T>
+void __vu_format_integer(Out& out, const T v, const __vu_format_spec& spec)
+{
+  typedef typename std::make_unsigned<T>::type U;
+
+  static const char digits_2[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+  const char* digits = spec.type == 'X' ? "0123456789ABCDEF" : "0123456789abcdef";
+
+  U base = 10;
+  switch (spec.type)
+  {
+  case 'x': case 'X': base = 16; break;
+  case 'o': base = 8; break;
+  case 'b': base = 2; break;
+  default: break;
+  }
+
+  const bool negative = std::is_signed<T>::value && v < T(1) && v != T(0);
+  U u = negative ? U(U(0) - U(v)) : U(v);
+
+  char text[8 * sizeof(T) + 1];
+  char* const end = text + sizeof(text);
+  char* ptr = end;
+
+  if (base == 10)
+  {
+    for (; u >= 100; u /= 100)
+    {
+      const auto i = size_t(u % 100) * 2;
+      *--ptr = digits_2[i + 1];
+      *--ptr = digits_2[i];
+    }
+
+    if (u >= 10)
+    {
+      const auto i = size_t(u) * 2;
+      *--ptr = digits_2[i + 1];
+      *--ptr = digits_2[i];
+    }
+    else
+    {
+      *--ptr = char('0' + u);
+    }
+  }
+  else
+  {
+    do
+    {
+      *--ptr = digits[size_t(u % base)];
+      u /= base;
+    } while (u != 0);
+  }
+
+  if (negative)
+  {
+    *--ptr = '-';
+  }
+
+  __vu_format_padded<CharT>(out, ptr, size_t(end - ptr), spec, true);
+}
+
+template <typename CharT, typename Out>
+void __vu_format_floating(Out& out, const double v, const __vu_format_spec& spec)
+{
+  char type = spec.type == 'f' || spec.type == 'e' || spec.type == 'E' || spec.type == 'G' ? spec.type : 'g';
+  const char format[] = { '%', '.', '*', type, '\0' };
+
+  char text[512];
+  int n = snprintf(text, sizeof(text), format, spec.precision < 0 ? 6 : spec.precision, v);
+  n = n < 0 ? 0 : (n >= int(sizeof(text)) ? int(sizeof(text)) - 1 : n);
+
+  __vu_format_padded<CharT>(out, text, size_t(n), spec, true);
+}
+
+/**
+ * The values - the overloads are selected by the decayed argument type at compile time.
+ */
+
+template <typename CharT, typename T, typename Enable = void>
+struct __vu_format_value
+{
+  template <typename Out>
+  static void write(Out& out, const T& v, const __vu_format_spec& spec)
+  {
+    std::basic_ostringstream<CharT> ss;
+    ss << v;
+    const auto s = ss.str();
+    __vu_format_string<CharT>(out, s.data(), s.size(), spec);
+  }
+};
+
+template <typename CharT, typename T>
+struct __vu_format_value<CharT, T, typename std::enable_if<
+  std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+  !std::is_same<T, char>::value && !std::is_same<T, wchar>::value>::type>
+{
+  template <typename Out>
+  static void write(Out& out, const T v, const __vu_format_spec& spec)
+  {
+    __vu_format_integer<CharT>(out, v, spec);
+  }
+};
+
+template <typename CharT, typename T>
+struct __vu_format_value<CharT, T, typename std::enable_if<std::is_enum<T>::value>::type>
+{
+  template <typename Out>
+  static void write(Out& out, const T v, const __vu_format_spec& spec)
+  {
+    __vu_format_integer<CharT>(out, typename std::underlying_type<T>::type(v), spec);
+  }
+};
+
+template <typename CharT, typename T>
+struct __vu_format_value<CharT, T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+  template <typename Out>
+  static void write(Out& out, const T v, const __vu_format_spec& spec)
+  {
+    __vu_format_floating<CharT>(out, double(v), spec);
+  }
+};
+
+template <typename CharT, typename T>
+struct __vu_format_value<CharT, T*, typename std::enable_if<
+  !std::is_same<typename std::remove_cv<T>::type, char>::value &&
+  !std::is_same<typename std::remove_cv<T>::type, wchar>::value>::type>
+{
+  template <typename Out>
+  static void write(Out& out, const T* v, const __vu_format_spec& spec)
+  {
+    __vu_format_spec hex = spec;
+    hex.type = hex.type == 'X' ? 'X' : 'x';
+    __vu_format_put(out, CharT('0'));
+    __vu_format_put(out, CharT('x'));
+    __vu_format_integer<CharT>(out, uintptr_t(v), hex);
+  }
+};
+
+template <typename CharT>
+struct __vu_format_value<CharT, bool>
+{
+  template <typename Out>
+  static void write(Out& out, const bool v, const __vu_format_spec& spec)
+  {
+    static const CharT t[] = { 't', 'r', 'u', 'e' };
+    static const CharT f[] = { 'f', 'a', 'l', 's', 'e' };
+    v ? __vu_format_string<CharT>(out, t, 4, spec) : __vu_format_string<CharT>(out, f, 5, spec);
+  }
+};
+
+template <typename CharT>
+struct __vu_format_value<CharT, char>
+{
+  template <typename Out>
+  static void write(Out& out, const char v, const __vu_format_spec& spec)
+  {
+    const CharT c = CharT(byte(v));
+    __vu_format_string<CharT>(out, &c, 1, spec);
+  }
+};
+
+template <typename CharT>
+struct __vu_format_value<CharT, wchar>
+{
+  template <typename Out>
+  static void write(Out& out, const wchar v, const __vu_format_spec& spec)
+  {
+    const CharT c = sizeof(CharT) >= sizeof(wchar) || v < 0x80 ? CharT(v) : CharT('?');
+    __vu_format_string<CharT>(out, &c, 1, spec);
+  }
+};
+
+template <typename CharT, typename T>
+struct __vu_format_value<CharT, T*, typename std::enable_if<
+  std::is_same<typename std::remove_cv<T>::type, CharT>::value>::type>
+{
+  template <typename Out>
+  static void write(Out& out, const CharT* v, const __vu_format_spec& spec)
+  {
+    v != nullptr ? __vu_format_string<CharT>(out, v, std::char_traits<CharT>::length(v), spec) : (void)0;
+  }
+};
+
+template <typename CharT>
+struct __vu_format_value<CharT, std::basic_string<CharT>>
+{
+  template <typename Out>
+  static void write(Out& out, const std::basic_string<CharT>& v, const __vu_format_spec& spec)
+  {
+    __vu_format_string<CharT>(out, v.data(), v.size(), spec);
+  }
+};
+
+#if defined(VU_HAS_CXX17)
+template <typename CharT>
+struct __vu_format_value<CharT, std::basic_string_view<CharT>>
+{
+  template <typename Out>
+  static void write(Out& out, const std::basic_string_view<CharT>& v, const __vu_format_spec& spec)
+  {
+    __vu_format_string<CharT>(out, v.data(), v.size(), spec);
+  }
+};
+#endif // VU_HAS_CXX17
+
+// the strings of the other character width are converted (ANSI <-> wide)
+
+template <typename T>
+struct __vu_format_value<char, T*, typename std::enable_if<
+  std::is_same<typename std::remove_cv<T>::type, wchar>::value>::type>
+{
+  template <typename Out>
+  static void write(Out& out, const wchar* v, const __vu_format_spec& spec)
+  {
+    const auto s = to_string_A(v != nullptr ? std::wstring(v) : std::wstring());
+    __vu_format_string<char>(out, s.data(), s.size(), spec);
+  }
+};
+
+template <>
+struct __vu_format_value<char, std::wstring>
+{
+  template <typename Out>
+  static void write(Out& out, const std::wstring& v, const __vu_format_spec& spec)
+  {
+    const auto s = to_string_A(v);
+    __vu_format_string<char>(out, s.data(), s.size(), spec);
+  }
+};
+
+template <typename T>
+struct __vu_format_value<wchar, T*, typename std::enable_if<
+  std::is_same<typename std::remove_cv<T>::type, char>::value>::type>
+{
+  template <typename Out>
+  static void write(Out& out, const char* v, const __vu_format_spec& spec)
+  {
+    const auto s = to_string_W(v != nullptr ? std::string(v) : std::string());
+    __vu_format_string<wchar>(out, s.data(), s.size(), spec);
+  }
+};
+
+template <>
+struct __vu_format_value<wchar, std::string>
+{
+  template <typename Out>
+  static void write(Out& out, const std::string& v, const __vu_format_spec& spec)
+  {
+    const auto s = to_string_W(v);
+    __vu_format_string<wchar>(out, s.data(), s.size(), spec);
+  }
+};
+
+/**
+ * The single pass over the format - the literal runs are copied as blocks,
+ * each replacement field consumes the next argument, `{{` and `}}` are the escaped braces.
+ * The fields without an argument are copied as-is and the extra arguments are ignored.
+ */
+
+template <typename CharT, typename Out>
+const CharT* __vu_format_literal(Out& out, const CharT* ptr, const CharT* last)
+{
+  while (ptr != last)
+  {
+    const CharT* run = ptr;
+    while (ptr != last && *ptr != CharT('{') && *ptr != CharT('}'))
+    {
+      ptr++;
+    }
+
+    if (ptr != run)
+    {
+      __vu_format_put(out, run, size_t(ptr - run));
+    }
+
+    if (ptr == last)
+    {
+      break;
+    }
+
+    if (ptr + 1 != last && ptr[1] == ptr[0]) // escaped
+    {
+      __vu_format_put(out, ptr[0]);
+      ptr += 2;
+      continue;
+    }
+
+    if (*ptr == CharT('{'))
+    {
+      break; // a replacement field
+    }
+
+    __vu_format_put(out, *ptr++); // an unmatched '}'
+  }
+
+  return ptr;
+}
+
+template <typename CharT, typename Out>
+void __vu_format_impl(Out& out, const CharT* ptr, const CharT* last)
+{
+  while ((ptr = __vu_format_literal(out, ptr, last)) != last)
+  {
+    __vu_format_put(out, *ptr++);
+  }
+}
+
+template <typename CharT, typename Out, typename T, typename... Args>
+void __vu_format_impl(Out& out, const CharT* ptr, const CharT* last, const T& v, const Args&... args)
+{
+  ptr = __vu_format_literal(out, ptr, last);
+  if (ptr == last)
+  {
+    return;
+  }
+
+  const CharT* field = ptr;
+
+  __vu_format_spec spec;
+  ptr = __vu_format_parse_spec(ptr + 1, last, spec);
+
+  if (ptr == last || *ptr != CharT('}')) // an unterminated field
+  {
+    __vu_format_put(out, field, size_t(last - field));
+    return;
+  }
+
+  __vu_format_value<CharT, typename std::decay<T>::type>::write(out, v, spec);
+
+  __vu_format_impl(out, ptr + 1, last, args...);
+}
+
+/**
+ * format_to(buffer or iterator, "{} is {:.2f}", ...) / format_string("{} is {:.2f}", ...)
+ * The type-safe and single-pass alternative to format_A/W (printf-style, two passes).
+ * Eg. vu::FormatBufferA buffer; vu::format_to(buffer, "{:08X} {}", 0xC0FFEE, "hex"); buffer.c_str();
+ */
+
+template <typename CharT, size_t Size, typename... Args>
+FormatBufferT<CharT, Size>& format_to(
+  FormatBufferT<CharT, Size>& buffer, const CharT* fmt, const Args&... args)
+{
+  __vu_format_impl(buffer, fmt, fmt + std::char_traits<CharT>::length(fmt), args...);
+  return buffer;
+}
+
+template <typename CharT, size_t Size, typename... Args>
+FormatBufferT<CharT, Size>& format_to(
+  FormatBufferT<CharT, Size>& buffer, const std::basic_string<CharT>& fmt, const Args&... args)
+{
+  __vu_format_impl(buffer, fmt.data(), fmt.data() + fmt.size(), args...);
+  return buffer;
+}
+
+template <typename OutputIt, typename CharT, typename... Args>
+OutputIt format_to(OutputIt out, const CharT* fmt, const Args&... args)
+{
+  __vu_format_impl(out, fmt, fmt + std::char_traits<CharT>::length(fmt), args...);
+  return out;
+}
+
+template <typename CharT, typename... Args>
+std::basic_string<CharT> format_string(const CharT* fmt, const Args&... args)
+{
+  FormatBufferT<CharT> buffer;
+  format_to(buffer, fmt, args...);
+  return buffer.str();
+}
+
+template <typename CharT, typename... Args>
+std::basic_string<CharT> format_string(const std::basic_string<CharT>& fmt, const Args&... args)
+{
+  FormatBufferT<CharT> buffer;
+  format_to(buffer, fmt, args...);
+  return buffer.str();
+}
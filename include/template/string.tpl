@@ -0,0 +1,216 @@
+/**
+ * @file   string.tpl
+ * @author Vic P.
+ * @brief  Template for String
+ */
+
+// String
+
+/**
+ * Find the first occurrence of a sequence of characters in the range [first, last).
+ * The first character is located by `char_traits::find` (memchr/wmemchr, vectorized by the CRT),
+ * then the rest of the sequence is verified by `char_traits::compare` (memcmp/wmemcmp).
+ * @return The pointer to the found sequence or `last` if not found or the sequence is empty.
+ */
+template <typename CharT>
+const CharT* find_sequence_T(
+  const CharT* first, const CharT* last, const CharT* ptr_sequence, const size_t sequence_length)
+{
+  typedef std::char_traits<CharT> traits;
+
+  if (sequence_length == 0 || first == nullptr || size_t(last - first) < sequence_length)
+  {
+    return last;
+  }
+
+  if (sequence_length == 1)
+  {
+    auto ptr = traits::find(first, size_t(last - first), *ptr_sequence);
+    return ptr != nullptr ? ptr : last;
+  }
+
+  while (size_t(last - first) >= sequence_length)
+  {
+    auto ptr = traits::find(first, size_t(last - first) - sequence_length + 1, *ptr_sequence);
+    if (ptr == nullptr)
+    {
+      break;
+    }
+
+    if (traits::compare(ptr + 1, ptr_sequence + 1, sequence_length - 1) == 0)
+    {
+      return ptr;
+    }
+
+    first = ptr + 1;
+  }
+
+  return last;
+}
+
+// C++17 (MSVC 2017+ or MinGW 7.1+)
+#if defined(VU_HAS_CXX17)
+
+/**
+ * SplitStringT - The lazy split range that yields the pieces as views into the input text.
+ * Note: The input text (and the separator) must outlive the range and its iterators.
+ * Eg. for (const auto& piece : vu::SplitStringA(text, ',')) { ... }
+ */
+
+template <typename CharT>
+class SplitStringT
+{
+public:
+  typedef std::basic_string_view<CharT> view_type;
+
+  class iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef view_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const view_type* pointer;
+    typedef const view_type& reference;
+
+    iterator() : m_ptr_owner(nullptr), m_ptr_next(nullptr) {}
+
+    explicit iterator(const SplitStringT* ptr_owner) : m_ptr_owner(ptr_owner), m_ptr_next(nullptr)
+    {
+      if (!m_ptr_owner->m_text.empty())
+      {
+        m_ptr_next = m_ptr_owner->m_text.data();
+      }
+
+      this->next();
+    }
+
+    reference operator*() const
+    {
+      return m_piece;
+    }
+
+    pointer operator->() const
+    {
+      return &m_piece;
+    }
+
+    iterator& operator++()
+    {
+      this->next();
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      iterator it(*this);
+      this->next();
+      return it;
+    }
+
+    bool operator==(const iterator& right) const
+    {
+      return m_ptr_owner == right.m_ptr_owner &&
+        m_ptr_next == right.m_ptr_next && m_piece.data() == right.m_piece.data();
+    }
+
+    bool operator!=(const iterator& right) const
+    {
+      return !(*this == right);
+    }
+
+  private:
+    void next()
+    {
+      while (m_ptr_owner != nullptr)
+      {
+        if (m_ptr_next == nullptr) // the last piece has been yielded
+        {
+          m_ptr_owner = nullptr;
+          m_piece = view_type();
+          break;
+        }
+
+        const auto ptr_last = m_ptr_owner->m_text.data() + m_ptr_owner->m_text.size();
+        const auto ptr_separator = m_ptr_owner->separator();
+        const auto separator_length = m_ptr_owner->separator_length();
+
+        auto ptr = find_sequence_T(m_ptr_next, ptr_last, ptr_separator, separator_length);
+
+        m_piece = view_type(m_ptr_next, size_t(ptr - m_ptr_next));
+        m_ptr_next = ptr == ptr_last ? nullptr : ptr + separator_length;
+
+        if (!m_piece.empty() || !m_ptr_owner->m_remove_empty)
+        {
+          break;
+        }
+      }
+    }
+
+  private:
+    const SplitStringT* m_ptr_owner;
+    const CharT* m_ptr_next;
+    view_type m_piece;
+  };
+
+  typedef iterator const_iterator;
+
+  SplitStringT(view_type text, view_type separator, bool remove_empty = false)
+    : m_text(text), m_separator(separator), m_separator_char(CharT(0))
+    , m_single_char(false), m_remove_empty(remove_empty) {}
+
+  SplitStringT(view_type text, const CharT separator, bool remove_empty = false)
+    : m_text(text), m_separator(), m_separator_char(separator)
+    , m_single_char(true), m_remove_empty(remove_empty) {}
+
+  iterator begin() const
+  {
+    return iterator(this);
+  }
+
+  iterator end() const
+  {
+    return iterator();
+  }
+
+  template <typename Container>
+  Container to() const
+  {
+    Container result;
+
+    for (const auto& e : *this)
+    {
+      result.emplace_back(e.data(), e.size());
+    }
+
+    return result;
+  }
+
+private:
+  const CharT* separator() const
+  {
+    return m_single_char ? &m_separator_char : m_separator.data();
+  }
+
+  size_t separator_length() const
+  {
+    return m_single_char ? 1 : m_separator.size();
+  }
+
+private:
+  view_type m_text;
+  view_type m_separator;
+  CharT m_separator_char;
+  bool m_single_char;
+  bool m_remove_empty;
+};
+
+typedef SplitStringT<char> SplitStringA;
+typedef SplitStringT<wchar> SplitStringW;
+
+#ifdef _UNICODE
+#define SplitString SplitStringW
+#else
+#define SplitString SplitStringA
+#endif
+
+#endif // VU_HAS_CXX17
@@ -0,0 +1,1058 @@
+/**
+ * @file   batch.cpp
+ * @author Vic P.
+ * @brief  Implementation for Batch (SIMD) Kernels
+ */
+
+#include "Vutils.h"
+
+#include <cmath>
+#include <cfloat>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VU_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(VU_SSE2) && (defined(_MSC_VER) || defined(__AVX2__)) // MSVC emits AVX2 without /arch
+#define VU_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#elif defined(VU_SSE2)
+#include <cpuid.h>
+#endif
+
+namespace vu
+{
+
+/**
+ * The lane wrappers - the same operations over the scalar (1 lane), the SSE2 and the AVX2 registers
+ */
+
+template <typename T>
+struct lane_scalar
+{
+  typedef T type;
+  typedef T V;
+  typedef bool M;
+  typedef lane_scalar<T> tail;
+  static const size_t W = 1;
+
+  static V load(const T* p) { return *p; }
+  static void store(T* p, const V v) { *p = v; }
+  static V set1(const T v) { return v; }
+  static V add(const V a, const V b) { return a + b; }
+  static V sub(const V a, const V b) { return a - b; }
+  static V mul(const V a, const V b) { return a * b; }
+  static V div(const V a, const V b) { return b != T(0) ? T(a / b) : T(0); }
+  static V sqrt(const V a) { return a > T(0) ? T(std::sqrt(double(a))) : T(0); }
+  static V vmin(const V a, const V b) { return b < a ? b : a; }
+  static V vmax(const V a, const V b) { return a < b ? b : a; }
+  static M lt(const V a, const V b) { return a < b; }
+  static M le(const V a, const V b) { return a <= b; }
+  static M and_(const M a, const M b) { return a && b; }
+  static int bits(const M m) { return m ? 1 : 0; }
+};
+
+#ifdef VU_SSE2
+
+struct lane_sse2_f32
+{
+  typedef float type;
+  typedef __m128 V;
+  typedef __m128 M;
+  typedef lane_scalar<float> tail;
+  static const size_t W = 4;
+
+  static V load(const float* p) { return _mm_loadu_ps(p); }
+  static void store(float* p, const V v) { _mm_storeu_ps(p, v); }
+  static V set1(const float v) { return _mm_set1_ps(v); }
+  static V add(const V a, const V b) { return _mm_add_ps(a, b); }
+  static V sub(const V a, const V b) { return _mm_sub_ps(a, b); }
+  static V mul(const V a, const V b) { return _mm_mul_ps(a, b); }
+  static V div(const V a, const V b) { return _mm_and_ps(_mm_div_ps(a, b), _mm_cmpneq_ps(b, _mm_setzero_ps())); }
+  static V sqrt(const V a) { return _mm_sqrt_ps(_mm_max_ps(a, _mm_setzero_ps())); }
+  static V vmin(const V a, const V b) { return _mm_min_ps(b, a); }
+  static V vmax(const V a, const V b) { return _mm_max_ps(b, a); }
+  static M lt(const V a, const V b) { return _mm_cmplt_ps(a, b); }
+  static M le(const V a, const V b) { return _mm_cmple_ps(a, b); }
+  static M and_(const M a, const M b) { return _mm_and_ps(a, b); }
+  static int bits(const M m) { return _mm_movemask_ps(m); }
+
+  // for the elementary functions
+
+  static V root(const V a) { return _mm_sqrt_ps(a); }
+  static V quot(const V a, const V b) { return _mm_div_ps(a, b); }
+  static V rsqrt_est(const V a) { return _mm_rsqrt_ps(a); }
+  static V pattern(const uint64 v) { return _mm_castsi128_ps(_mm_set1_epi32(int(uint32(v)))); }
+  static V band(const V a, const V b) { return _mm_and_ps(a, b); }
+  static V bor(const V a, const V b) { return _mm_or_ps(a, b); }
+  static V bxor(const V a, const V b) { return _mm_xor_ps(a, b); }
+  static V blend(const M m, const V a, const V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+  static V shl(const V a, const int n) { return _mm_castsi128_ps(_mm_sll_epi32(_mm_castps_si128(a), _mm_cvtsi32_si128(n))); }
+  static V shr(const V a, const int n) { return _mm_castsi128_ps(_mm_srl_epi32(_mm_castps_si128(a), _mm_cvtsi32_si128(n))); }
+  static M gt(const V a, const V b) { return _mm_cmpgt_ps(a, b); }
+  static M eq(const V a, const V b) { return _mm_cmpeq_ps(a, b); }
+  static M unord(const V a, const V b) { return _mm_cmpunord_ps(a, b); }
+};
+
+struct lane_sse2_f64
+{
+  typedef double type;
+  typedef __m128d V;
+  typedef __m128d M;
+  typedef lane_scalar<double> tail;
+  static const size_t W = 2;
+
+  static V load(const double* p) { return _mm_loadu_pd(p); }
+  static void store(double* p, const V v) { _mm_storeu_pd(p, v); }
+  static V set1(const double v) { return _mm_set1_pd(v); }
+  static V add(const V a, const V b) { return _mm_add_pd(a, b); }
+  static V sub(const V a, const V b) { return _mm_sub_pd(a, b); }
+  static V mul(const V a, const V b) { return _mm_mul_pd(a, b); }
+  static V div(const V a, const V b) { return _mm_and_pd(_mm_div_pd(a, b), _mm_cmpneq_pd(b, _mm_setzero_pd())); }
+  static V sqrt(const V a) { return _mm_sqrt_pd(_mm_max_pd(a, _mm_setzero_pd())); }
+  static V vmin(const V a, const V b) { return _mm_min_pd(b, a); }
+  static V vmax(const V a, const V b) { return _mm_max_pd(b, a); }
+  static M lt(const V a, const V b) { return _mm_cmplt_pd(a, b); }
+  static M le(const V a, const V b) { return _mm_cmple_pd(a, b); }
+  static M and_(const M a, const M b) { return _mm_and_pd(a, b); }
+  static int bits(const M m) { return _mm_movemask_pd(m); }
+
+  // for the elementary functions
+
+  static V root(const V a) { return _mm_sqrt_pd(a); }
+  static V quot(const V a, const V b) { return _mm_div_pd(a, b); }
+  static V pattern(const uint64 v) { return _mm_castsi128_pd(_mm_set1_epi64x(int64(v))); }
+  static V band(const V a, const V b) { return _mm_and_pd(a, b); }
+  static V bor(const V a, const V b) { return _mm_or_pd(a, b); }
+  static V bxor(const V a, const V b) { return _mm_xor_pd(a, b); }
+  static V blend(const M m, const V a, const V b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+  static V shl(const V a, const int n) { return _mm_castsi128_pd(_mm_sll_epi64(_mm_castpd_si128(a), _mm_cvtsi32_si128(n))); }
+  static V shr(const V a, const int n) { return _mm_castsi128_pd(_mm_srl_epi64(_mm_castpd_si128(a), _mm_cvtsi32_si128(n))); }
+  static M gt(const V a, const V b) { return _mm_cmpgt_pd(a, b); }
+  static M eq(const V a, const V b) { return _mm_cmpeq_pd(a, b); }
+  static M unord(const V a, const V b) { return _mm_cmpunord_pd(a, b); }
+};
+
+struct lane_sse2_i32
+{
+  typedef int type;
+  typedef __m128i V;
+  typedef __m128i M;
+  typedef lane_scalar<int> tail;
+  static const size_t W = 4;
+
+  static V load(const int* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+  static void store(int* p, const V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+  static V set1(const int v) { return _mm_set1_epi32(v); }
+  static V add(const V a, const V b) { return _mm_add_epi32(a, b); }
+  static V sub(const V a, const V b) { return _mm_sub_epi32(a, b); }
+
+  static V mul(const V a, const V b) // SSE2 has no _mm_mullo_epi32 (SSE4.1)
+  {
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(
+      _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+  }
+
+  static V div(const V a, const V b) // no integer division in SSE/AVX
+  {
+    int x[4], y[4];
+    store(x, a);
+    store(y, b);
+    for (int i = 0; i < 4; i++) x[i] = lane_scalar<int>::div(x[i], y[i]);
+    return load(x);
+  }
+
+  static V sqrt(const V a)
+  {
+    int x[4];
+    store(x, a);
+    for (int i = 0; i < 4; i++) x[i] = lane_scalar<int>::sqrt(x[i]);
+    return load(x);
+  }
+
+  static V vmin(const V a, const V b) // SSE2 has no _mm_min_epi32 (SSE4.1)
+  {
+    const __m128i m = _mm_cmplt_epi32(b, a);
+    return _mm_or_si128(_mm_and_si128(m, b), _mm_andnot_si128(m, a));
+  }
+
+  static V vmax(const V a, const V b)
+  {
+    const __m128i m = _mm_cmplt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(m, b), _mm_andnot_si128(m, a));
+  }
+
+  static M lt(const V a, const V b) { return _mm_cmplt_epi32(a, b); }
+  static M le(const V a, const V b) { return _mm_xor_si128(_mm_cmpgt_epi32(a, b), _mm_set1_epi32(-1)); }
+  static M and_(const M a, const M b) { return _mm_and_si128(a, b); }
+  static int bits(const M m) { return _mm_movemask_ps(_mm_castsi128_ps(m)); }
+};
+
+#endif // VU_SSE2
+
+#ifdef VU_AVX2
+
+struct lane_avx2_f32
+{
+  typedef float type;
+  typedef __m256 V;
+  typedef __m256 M;
+  typedef lane_sse2_f32 tail;
+  static const size_t W = 8;
+
+  static V load(const float* p) { return _mm256_loadu_ps(p); }
+  static void store(float* p, const V v) { _mm256_storeu_ps(p, v); }
+  static V set1(const float v) { return _mm256_set1_ps(v); }
+  static V add(const V a, const V b) { return _mm256_add_ps(a, b); }
+  static V sub(const V a, const V b) { return _mm256_sub_ps(a, b); }
+  static V mul(const V a, const V b) { return _mm256_mul_ps(a, b); }
+  static V div(const V a, const V b) { return _mm256_and_ps(_mm256_div_ps(a, b), _mm256_cmp_ps(b, _mm256_setzero_ps(), _CMP_NEQ_UQ)); }
+  static V sqrt(const V a) { return _mm256_sqrt_ps(_mm256_max_ps(a, _mm256_setzero_ps())); }
+  static V vmin(const V a, const V b) { return _mm256_min_ps(b, a); }
+  static V vmax(const V a, const V b) { return _mm256_max_ps(b, a); }
+  static M lt(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static M le(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+  static M and_(const M a, const M b) { return _mm256_and_ps(a, b); }
+  static int bits(const M m) { return _mm256_movemask_ps(m); }
+
+  // for the elementary functions
+
+  static V root(const V a) { return _mm256_sqrt_ps(a); }
+  static V quot(const V a, const V b) { return _mm256_div_ps(a, b); }
+  static V rsqrt_est(const V a) { return _mm256_rsqrt_ps(a); }
+  static V pattern(const uint64 v) { return _mm256_castsi256_ps(_mm256_set1_epi32(int(uint32(v)))); }
+  static V band(const V a, const V b) { return _mm256_and_ps(a, b); }
+  static V bor(const V a, const V b) { return _mm256_or_ps(a, b); }
+  static V bxor(const V a, const V b) { return _mm256_xor_ps(a, b); }
+  static V blend(const M m, const V a, const V b) { return _mm256_blendv_ps(b, a, m); }
+  static V shl(const V a, const int n) { return _mm256_castsi256_ps(_mm256_sll_epi32(_mm256_castps_si256(a), _mm_cvtsi32_si128(n))); }
+  static V shr(const V a, const int n) { return _mm256_castsi256_ps(_mm256_srl_epi32(_mm256_castps_si256(a), _mm_cvtsi32_si128(n))); }
+  static M gt(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  static M eq(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+  static M unord(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_UNORD_Q); }
+};
+
+struct lane_avx2_f64
+{
+  typedef double type;
+  typedef __m256d V;
+  typedef __m256d M;
+  typedef lane_sse2_f64 tail;
+  static const size_t W = 4;
+
+  static V load(const double* p) { return _mm256_loadu_pd(p); }
+  static void store(double* p, const V v) { _mm256_storeu_pd(p, v); }
+  static V set1(const double v) { return _mm256_set1_pd(v); }
+  static V add(const V a, const V b) { return _mm256_add_pd(a, b); }
+  static V sub(const V a, const V b) { return _mm256_sub_pd(a, b); }
+  static V mul(const V a, const V b) { return _mm256_mul_pd(a, b); }
+  static V div(const V a, const V b) { return _mm256_and_pd(_mm256_div_pd(a, b), _mm256_cmp_pd(b, _mm256_setzero_pd(), _CMP_NEQ_UQ)); }
+  static V sqrt(const V a) { return _mm256_sqrt_pd(_mm256_max_pd(a, _mm256_setzero_pd())); }
+  static V vmin(const V a, const V b) { return _mm256_min_pd(b, a); }
+  static V vmax(const V a, const V b) { return _mm256_max_pd(b, a); }
+  static M lt(const V a, const V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static M le(const V a, const V b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+  static M and_(const M a, const M b) { return _mm256_and_pd(a, b); }
+  static int bits(const M m) { return _mm256_movemask_pd(m); }
+
+  // for the elementary functions
+
+  static V root(const V a) { return _mm256_sqrt_pd(a); }
+  static V quot(const V a, const V b) { return _mm256_div_pd(a, b); }
+  static V pattern(const uint64 v) { return _mm256_castsi256_pd(_mm256_set1_epi64x(int64(v))); }
+  static V band(const V a, const V b) { return _mm256_and_pd(a, b); }
+  static V bor(const V a, const V b) { return _mm256_or_pd(a, b); }
+  static V bxor(const V a, const V b) { return _mm256_xor_pd(a, b); }
+  static V blend(const M m, const V a, const V b) { return _mm256_blendv_pd(b, a, m); }
+  static V shl(const V a, const int n) { return _mm256_castsi256_pd(_mm256_sll_epi64(_mm256_castpd_si256(a), _mm_cvtsi32_si128(n))); }
+  static V shr(const V a, const int n) { return _mm256_castsi256_pd(_mm256_srl_epi64(_mm256_castpd_si256(a), _mm_cvtsi32_si128(n))); }
+  static M gt(const V a, const V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+  static M eq(const V a, const V b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+  static M unord(const V a, const V b) { return _mm256_cmp_pd(a, b, _CMP_UNORD_Q); }
+};
+
+struct lane_avx2_i32
+{
+  typedef int type;
+  typedef __m256i V;
+  typedef __m256i M;
+  typedef lane_sse2_i32 tail;
+  static const size_t W = 8;
+
+  static V load(const int* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+  static void store(int* p, const V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+  static V set1(const int v) { return _mm256_set1_epi32(v); }
+  static V add(const V a, const V b) { return _mm256_add_epi32(a, b); }
+  static V sub(const V a, const V b) { return _mm256_sub_epi32(a, b); }
+  static V mul(const V a, const V b) { return _mm256_mullo_epi32(a, b); }
+
+  static V div(const V a, const V b)
+  {
+    int x[8], y[8];
+    store(x, a);
+    store(y, b);
+    for (int i = 0; i < 8; i++) x[i] = lane_scalar<int>::div(x[i], y[i]);
+    return load(x);
+  }
+
+  static V sqrt(const V a)
+  {
+    int x[8];
+    store(x, a);
+    for (int i = 0; i < 8; i++) x[i] = lane_scalar<int>::sqrt(x[i]);
+    return load(x);
+  }
+
+  static V vmin(const V a, const V b) { return _mm256_min_epi32(a, b); }
+  static V vmax(const V a, const V b) { return _mm256_max_epi32(a, b); }
+  static M lt(const V a, const V b) { return _mm256_cmpgt_epi32(b, a); }
+  static M le(const V a, const V b) { return _mm256_xor_si256(_mm256_cmpgt_epi32(a, b), _mm256_set1_epi32(-1)); }
+  static M and_(const M a, const M b) { return _mm256_and_si256(a, b); }
+  static int bits(const M m) { return _mm256_movemask_ps(_mm256_castsi256_ps(m)); }
+};
+
+#endif // VU_AVX2
+
+/**
+ * The kernels - the vector loops then the remaining elements by the narrower lanes
+ */
+
+template <class S>
+struct kernels_t
+{
+  typedef typename S::type T;
+  typedef typename S::tail R;
+
+  static void add(const T* a, const T* b, T* out, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(out + i, S::add(S::load(a + i), S::load(b + i)));
+    if (i < n) kernels_t<R>::add(a + i, b + i, out + i, n - i);
+  }
+
+  static void add_scalar(const T* a, const T s, T* out, const size_t n)
+  {
+    size_t i = 0;
+    const auto v = S::set1(s);
+    for (; i + S::W <= n; i += S::W) S::store(out + i, S::add(S::load(a + i), v));
+    if (i < n) kernels_t<R>::add_scalar(a + i, s, out + i, n - i);
+  }
+
+  static void sub(const T* a, const T* b, T* out, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(out + i, S::sub(S::load(a + i), S::load(b + i)));
+    if (i < n) kernels_t<R>::sub(a + i, b + i, out + i, n - i);
+  }
+
+  static void mul(const T* a, const T* b, T* out, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(out + i, S::mul(S::load(a + i), S::load(b + i)));
+    if (i < n) kernels_t<R>::mul(a + i, b + i, out + i, n - i);
+  }
+
+  static void div(const T* a, const T* b, T* out, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(out + i, S::div(S::load(a + i), S::load(b + i)));
+    if (i < n) kernels_t<R>::div(a + i, b + i, out + i, n - i);
+  }
+
+  static void scale(const T* a, const T s, T* out, const size_t n)
+  {
+    size_t i = 0;
+    const auto v = S::set1(s);
+    for (; i + S::W <= n; i += S::W) S::store(out + i, S::mul(S::load(a + i), v));
+    if (i < n) kernels_t<R>::scale(a + i, s, out + i, n - i);
+  }
+
+  static void madd(const T* a, const T* b, T* acc, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(acc + i, S::add(S::load(acc + i), S::mul(S::load(a + i), S::load(b + i))));
+    if (i < n) kernels_t<R>::madd(a + i, b + i, acc + i, n - i);
+  }
+
+  static void cross(const T* a, const T* b, const T* c, const T* d, T* out, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W)
+    {
+      S::store(out + i, S::sub(
+        S::mul(S::load(a + i), S::load(b + i)), S::mul(S::load(c + i), S::load(d + i))));
+    }
+    if (i < n) kernels_t<R>::cross(a + i, b + i, c + i, d + i, out + i, n - i);
+  }
+
+  static void sqrt(const T* a, T* out, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(out + i, S::sqrt(S::load(a + i)));
+    if (i < n) kernels_t<R>::sqrt(a + i, out + i, n - i);
+  }
+
+  static void minimum(const T* a, const T* b, T* out, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(out + i, S::vmin(S::load(a + i), S::load(b + i)));
+    if (i < n) kernels_t<R>::minimum(a + i, b + i, out + i, n - i);
+  }
+
+  static void maximum(const T* a, const T* b, T* out, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(out + i, S::vmax(S::load(a + i), S::load(b + i)));
+    if (i < n) kernels_t<R>::maximum(a + i, b + i, out + i, n - i);
+  }
+
+  static void store_mask(byte* mask, const int bits)
+  {
+    for (size_t k = 0; k < S::W; k++) mask[k] = byte((bits >> k) & 1);
+  }
+
+  static void contains_point(const T* l, const T* t, const T* r, const T* b,
+    const T x, const T y, byte* mask, const size_t n)
+  {
+    size_t i = 0;
+    const auto vx = S::set1(x), vy = S::set1(y);
+    for (; i + S::W <= n; i += S::W)
+    {
+      const auto m = S::and_(
+        S::and_(S::le(S::load(l + i), vx), S::lt(vx, S::load(r + i))),
+        S::and_(S::le(S::load(t + i), vy), S::lt(vy, S::load(b + i))));
+      store_mask(mask + i, S::bits(m));
+    }
+    if (i < n) kernels_t<R>::contains_point(l + i, t + i, r + i, b + i, x, y, mask + i, n - i);
+  }
+
+  static void contains_points(const T* l, const T* t, const T* r, const T* b,
+    const T* x, const T* y, byte* mask, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W)
+    {
+      const auto vx = S::load(x + i), vy = S::load(y + i);
+      const auto m = S::and_(
+        S::and_(S::le(S::load(l + i), vx), S::lt(vx, S::load(r + i))),
+        S::and_(S::le(S::load(t + i), vy), S::lt(vy, S::load(b + i))));
+      store_mask(mask + i, S::bits(m));
+    }
+    if (i < n) kernels_t<R>::contains_points(l + i, t + i, r + i, b + i, x + i, y + i, mask + i, n - i);
+  }
+
+  static void overlaps(const T* l1, const T* t1, const T* r1, const T* b1,
+    const T* l2, const T* t2, const T* r2, const T* b2, byte* mask, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W)
+    {
+      const auto m = S::and_(
+        S::and_(S::lt(S::load(l1 + i), S::load(r2 + i)), S::lt(S::load(l2 + i), S::load(r1 + i))),
+        S::and_(S::lt(S::load(t1 + i), S::load(b2 + i)), S::lt(S::load(t2 + i), S::load(b1 + i))));
+      store_mask(mask + i, S::bits(m));
+    }
+    if (i < n)
+    {
+      kernels_t<R>::overlaps(l1 + i, t1 + i, r1 + i, b1 + i, l2 + i, t2 + i, r2 + i, b2 + i, mask + i, n - i);
+    }
+  }
+};
+
+/**
+ * The elementary functions - the Cephes range reductions and polynomials over the lanes.
+ * No FMA is used, so the SSE2 and the AVX2 results are bit-identical (on the same CPU for rsqrt).
+ */
+
+template <class S>
+struct elementary_base_t
+{
+  typedef typename S::type T;
+  typedef typename S::V V;
+  typedef typename S::M M;
+
+  static const int ALL = (1 << S::W) - 1;
+  static const int BITS = int(sizeof(T) * 8);
+  static const int MANTISSA = sizeof(T) == 4 ? 23 : 52;
+  static const int BIAS = sizeof(T) == 4 ? 127 : 1023;
+
+  static T magic() // 1.5 * 2^MANTISSA, adding it rounds to the integer that is kept in the low bits
+  {
+    return sizeof(T) == 4 ? T(12582912.) : T(6755399441055744.);
+  }
+
+  static V round(const V x) // to the nearest (even) integer for |x| < 2^(MANTISSA - 1)
+  {
+    const V m = S::set1(magic());
+    return S::sub(S::add(x, m), m);
+  }
+
+  static M bit_set(const V n, const int k) // the bit k of the integral n is set
+  {
+    const V v = S::add(n, S::set1(magic()));
+    const V sign = S::band(S::shl(v, BITS - 1 - k), S::set1(T(-0.)));
+    return S::lt(S::bor(sign, S::set1(T(1))), S::set1(T(0)));
+  }
+
+  static V pow2n(const V n) // 2^n for the integral n in the normal exponent range
+  {
+    return S::shl(S::add(n, S::set1(magic() + T(BIAS))), MANTISSA);
+  }
+
+  static V frexp(const V x, V& e) // x = m * 2^e and m in [0.5, 1) for the positive normal x
+  {
+    const V one_m = S::set1(sizeof(T) == 4 ? T(8388608.) : T(4503599627370496.)); // 2^MANTISSA
+    e = S::sub(S::sub(S::bor(S::shr(x, MANTISSA), one_m), one_m), S::set1(T(BIAS - 1)));
+    return S::bor(S::band(x, S::pattern((uint64(1) << MANTISSA) - 1)), S::set1(T(0.5)));
+  }
+
+  static V fix_large(const V x, const V y, const T limit, T (*fn)(T)) // the scalar function for |x| > limit
+  {
+    const V ax = S::band(x, S::pattern((uint64(1) << (BITS - 1)) - 1));
+    if (S::bits(S::gt(ax, S::set1(limit))) == 0)
+    {
+      return y;
+    }
+
+    T in[S::W], out[S::W];
+    S::store(in, x);
+    S::store(out, y);
+
+    for (size_t k = 0; k < S::W; k++)
+    {
+      if (std::fabs(in[k]) > limit)
+      {
+        out[k] = fn(in[k]);
+      }
+    }
+
+    return S::load(out);
+  }
+
+  static T scalar_sin(T v) { return std::sin(v); }
+  static T scalar_cos(T v) { return std::cos(v); }
+};
+
+template <class S, typename T = typename S::type>
+struct elementary_t;
+
+template <class S>
+struct elementary_t<S, float> : public elementary_base_t<S>
+{
+  typedef elementary_base_t<S> B;
+  typedef typename S::V V;
+  typedef typename S::M M;
+
+  static V rsqrt(const V x) // the estimation then a Newton-Raphson step for the normal numbers
+  {
+    const V y0 = S::rsqrt_est(x);
+    const V hx = S::mul(x, S::set1(0.5f));
+    V y = S::add(y0, S::mul(y0, S::sub(S::set1(0.5f), S::mul(S::mul(hx, y0), y0))));
+
+    const M normal = S::and_(S::le(S::set1(FLT_MIN), x), S::le(x, S::set1(FLT_MAX)));
+    if (S::bits(normal) != B::ALL)
+    {
+      y = S::blend(normal, y, S::quot(S::set1(1.f), S::root(x)));
+    }
+
+    return y;
+  }
+
+  static V exp(const V x)
+  {
+    const V hi = S::set1(88.72283935546875f), lo = S::set1(-103.97208404541015625f);
+    const V xc = S::vmax(S::vmin(x, hi), lo);
+
+    const V n = B::round(S::mul(xc, S::set1(1.44269504088896341f)));
+    const V r = S::sub(S::sub(xc, S::mul(n, S::set1(0.693359375f))), S::mul(n, S::set1(-2.12194440e-4f)));
+
+    V p = S::set1(1.9875691500e-4f);
+    p = S::add(S::mul(p, r), S::set1(1.3981999507e-3f));
+    p = S::add(S::mul(p, r), S::set1(8.3334519073e-3f));
+    p = S::add(S::mul(p, r), S::set1(4.1665795894e-2f));
+    p = S::add(S::mul(p, r), S::set1(1.6666665459e-1f));
+    p = S::add(S::mul(p, r), S::set1(5.0000001201e-1f));
+
+    V y = S::add(S::add(S::mul(S::mul(p, r), r), r), S::set1(1.f));
+
+    const V n1 = B::round(S::mul(n, S::set1(0.5f))), n2 = S::sub(n, n1); // 2^n might be subnormal
+    y = S::mul(S::mul(y, B::pow2n(n1)), B::pow2n(n2));
+
+    y = S::blend(S::gt(x, S::set1(88.72283172607421875f)), S::set1(std::numeric_limits<float>::infinity()), y);
+    y = S::blend(S::lt(x, lo), S::set1(0.f), y);
+    y = S::blend(S::unord(x, x), x, y);
+
+    return y;
+  }
+
+  static V log(const V x)
+  {
+    const M tiny = S::lt(x, S::set1(FLT_MIN));
+    V e, m = B::frexp(S::blend(tiny, S::mul(x, S::set1(8388608.f)), x), e); // scale the subnormals by 2^23
+    e = S::sub(e, S::band(tiny, S::set1(23.f)));
+
+    const M small = S::lt(m, S::set1(0.707106781186547524f)); // m in [sqrt(1/2), sqrt(2)) - 1
+    e = S::sub(e, S::band(small, S::set1(1.f)));
+    m = S::sub(S::add(m, S::band(small, m)), S::set1(1.f));
+
+    const V z = S::mul(m, m);
+
+    V p = S::set1(7.0376836292e-2f);
+    p = S::add(S::mul(p, m), S::set1(-1.1514610310e-1f));
+    p = S::add(S::mul(p, m), S::set1(1.1676998740e-1f));
+    p = S::add(S::mul(p, m), S::set1(-1.2420140846e-1f));
+    p = S::add(S::mul(p, m), S::set1(1.4249322787e-1f));
+    p = S::add(S::mul(p, m), S::set1(-1.6668057665e-1f));
+    p = S::add(S::mul(p, m), S::set1(2.0000714765e-1f));
+    p = S::add(S::mul(p, m), S::set1(-2.4999993993e-1f));
+    p = S::add(S::mul(p, m), S::set1(3.3333331174e-1f));
+
+    V y = S::mul(S::mul(p, m), z);
+    y = S::add(y, S::mul(e, S::set1(-2.12194440e-4f)));
+    y = S::sub(y, S::mul(z, S::set1(0.5f)));
+    y = S::add(S::add(m, y), S::mul(e, S::set1(0.693359375f)));
+
+    y = S::blend(S::eq(x, S::set1(0.f)), S::set1(-std::numeric_limits<float>::infinity()), y);
+    y = S::blend(S::lt(x, S::set1(0.f)), S::set1(std::numeric_limits<float>::quiet_NaN()), y);
+    y = S::blend(S::gt(x, S::set1(FLT_MAX)), x, y);
+    y = S::blend(S::unord(x, x), x, y);
+
+    return y;
+  }
+
+  static V sincos(const V x, const float quadrant) // quadrant 0 for sin, 1 for cos = sin(x + pi/2)
+  {
+    const V j = B::round(S::mul(x, S::set1(0.636619772367581343f))); // r = x - j * pi/2 in [-pi/4, pi/4]
+    V r = S::sub(x, S::mul(j, S::set1(1.5703125f)));
+    r = S::sub(r, S::mul(j, S::set1(4.837512969970703125e-4f)));
+    r = S::sub(r, S::mul(j, S::set1(7.5495336204767227173e-8f)));
+    r = S::sub(r, S::mul(j, S::set1(2.563344068257089603e-12f))); // the parts of 11 bits are exact by |j| < 2^13
+
+    const V z = S::mul(r, r);
+
+    V ps = S::set1(-1.9515295891e-4f);
+    ps = S::add(S::mul(ps, z), S::set1(8.3321608736e-3f));
+    ps = S::add(S::mul(ps, z), S::set1(-1.6666654611e-1f));
+    const V sin_r = S::add(r, S::mul(S::mul(ps, z), r));
+
+    V pc = S::set1(2.443315711809948e-5f);
+    pc = S::add(S::mul(pc, z), S::set1(-1.388731625493765e-3f));
+    pc = S::add(S::mul(pc, z), S::set1(4.166664568298827e-2f));
+    const V cos_r = S::add(S::sub(S::set1(1.f), S::mul(z, S::set1(0.5f))), S::mul(S::mul(pc, z), z));
+
+    const V q = S::add(j, S::set1(quadrant));
+    V y = S::blend(B::bit_set(q, 0), cos_r, sin_r);
+    y = S::bxor(y, S::band(B::bit_set(q, 1), S::set1(-0.f)));
+
+    return B::fix_large(x, y, 8192.f, quadrant == 0.f ? B::scalar_sin : B::scalar_cos);
+  }
+
+  static V sin(const V x)
+  {
+    return sincos(x, 0.f);
+  }
+
+  static V cos(const V x)
+  {
+    return sincos(x, 1.f);
+  }
+};
+
+template <class S>
+struct elementary_t<S, double> : public elementary_base_t<S>
+{
+  typedef elementary_base_t<S> B;
+  typedef typename S::V V;
+  typedef typename S::M M;
+
+  static V rsqrt(const V x)
+  {
+    return S::quot(S::set1(1.), S::root(x));
+  }
+
+  static V exp(const V x)
+  {
+    const V hi = S::set1(709.782712893383973096), lo = S::set1(-745.13321910194110842);
+    const V xc = S::vmax(S::vmin(x, hi), lo);
+
+    const V n = B::round(S::mul(xc, S::set1(1.4426950408889634073599)));
+    const V r = S::sub(S::sub(xc, S::mul(n, S::set1(6.93145751953125e-1))), S::mul(n, S::set1(1.42860682030941723212e-6)));
+
+    const V rr = S::mul(r, r);
+
+    V p = S::set1(1.26177193074810590878e-4);
+    p = S::add(S::mul(p, rr), S::set1(3.02994407707441961300e-2));
+    p = S::add(S::mul(p, rr), S::set1(9.99999999999999999910e-1));
+    p = S::mul(p, r);
+
+    V q = S::set1(3.00198505138664455042e-6);
+    q = S::add(S::mul(q, rr), S::set1(2.52448340349684104192e-3));
+    q = S::add(S::mul(q, rr), S::set1(2.27265548208155028766e-1));
+    q = S::add(S::mul(q, rr), S::set1(2.00000000000000000009e0));
+
+    V y = S::quot(p, S::sub(q, p)); // the Pade approximation
+    y = S::add(S::add(y, y), S::set1(1.));
+
+    const V n1 = B::round(S::mul(n, S::set1(0.5))), n2 = S::sub(n, n1); // 2^n might be subnormal
+    y = S::mul(S::mul(y, B::pow2n(n1)), B::pow2n(n2));
+
+    y = S::blend(S::gt(x, hi), S::set1(std::numeric_limits<double>::infinity()), y);
+    y = S::blend(S::lt(x, lo), S::set1(0.), y);
+    y = S::blend(S::unord(x, x), x, y);
+
+    return y;
+  }
+
+  static V log(const V x)
+  {
+    const M tiny = S::lt(x, S::set1(DBL_MIN));
+    V e, m = B::frexp(S::blend(tiny, S::mul(x, S::set1(4503599627370496.)), x), e); // scale the subnormals by 2^52
+    e = S::sub(e, S::band(tiny, S::set1(52.)));
+
+    const M small = S::lt(m, S::set1(0.70710678118654752440)); // m in [sqrt(1/2), sqrt(2)) - 1
+    e = S::sub(e, S::band(small, S::set1(1.)));
+    m = S::sub(S::add(m, S::band(small, m)), S::set1(1.));
+
+    const V z = S::mul(m, m);
+
+    V p = S::set1(1.01875663804580931796e-4);
+    p = S::add(S::mul(p, m), S::set1(4.97494994976747001425e-1));
+    p = S::add(S::mul(p, m), S::set1(4.70579119878881725854e0));
+    p = S::add(S::mul(p, m), S::set1(1.44989225341610930846e1));
+    p = S::add(S::mul(p, m), S::set1(1.79368678507819816313e1));
+    p = S::add(S::mul(p, m), S::set1(7.70838733755885391666e0));
+
+    V q = S::add(m, S::set1(1.12873587189167450590e1));
+    q = S::add(S::mul(q, m), S::set1(4.52279145837532221105e1));
+    q = S::add(S::mul(q, m), S::set1(8.29875266912776603211e1));
+    q = S::add(S::mul(q, m), S::set1(7.11544750618563894466e1));
+    q = S::add(S::mul(q, m), S::set1(2.31251620126765340583e1));
+
+    V y = S::mul(m, S::quot(S::mul(z, p), q));
+    y = S::sub(y, S::mul(e, S::set1(2.121944400546905827679e-4)));
+    y = S::sub(y, S::mul(z, S::set1(0.5)));
+    y = S::add(S::add(m, y), S::mul(e, S::set1(0.693359375)));
+
+    y = S::blend(S::eq(x, S::set1(0.)), S::set1(-std::numeric_limits<double>::infinity()), y);
+    y = S::blend(S::lt(x, S::set1(0.)), S::set1(std::numeric_limits<double>::quiet_NaN()), y);
+    y = S::blend(S::gt(x, S::set1(DBL_MAX)), x, y);
+    y = S::blend(S::unord(x, x), x, y);
+
+    return y;
+  }
+
+  static V sincos(const V x, const double quadrant) // quadrant 0 for sin, 1 for cos = sin(x + pi/2)
+  {
+    const V j = B::round(S::mul(x, S::set1(0.63661977236758134308))); // r = x - j * pi/2 in [-pi/4, pi/4]
+    V r = S::sub(x, S::mul(j, S::set1(1.570796251296997070312)));
+    r = S::sub(r, S::mul(j, S::set1(7.549789415861596353e-8)));
+    r = S::sub(r, S::mul(j, S::set1(5.390302858158119e-15)));
+
+    const V z = S::mul(r, r);
+
+    V ps = S::set1(1.58962301576546568060e-10);
+    ps = S::add(S::mul(ps, z), S::set1(-2.50507477628578072866e-8));
+    ps = S::add(S::mul(ps, z), S::set1(2.75573136213857245213e-6));
+    ps = S::add(S::mul(ps, z), S::set1(-1.98412698295895385996e-4));
+    ps = S::add(S::mul(ps, z), S::set1(8.33333333332211858878e-3));
+    ps = S::add(S::mul(ps, z), S::set1(-1.66666666666666307295e-1));
+    const V sin_r = S::add(r, S::mul(S::mul(ps, z), r));
+
+    V pc = S::set1(-1.13585365213876817300e-11);
+    pc = S::add(S::mul(pc, z), S::set1(2.08757008419747316778e-9));
+    pc = S::add(S::mul(pc, z), S::set1(-2.75573141792967388112e-7));
+    pc = S::add(S::mul(pc, z), S::set1(2.48015872888517045348e-5));
+    pc = S::add(S::mul(pc, z), S::set1(-1.38888888888730564116e-3));
+    pc = S::add(S::mul(pc, z), S::set1(4.16666666666665929218e-2));
+    const V cos_r = S::add(S::sub(S::set1(1.), S::mul(z, S::set1(0.5))), S::mul(S::mul(pc, z), z));
+
+    const V q = S::add(j, S::set1(quadrant));
+    V y = S::blend(B::bit_set(q, 0), cos_r, sin_r);
+    y = S::bxor(y, S::band(B::bit_set(q, 1), S::set1(-0.)));
+
+    return B::fix_large(x, y, 1048576., quadrant == 0. ? B::scalar_sin : B::scalar_cos);
+  }
+
+  static V sin(const V x)
+  {
+    return sincos(x, 0.);
+  }
+
+  static V cos(const V x)
+  {
+    return sincos(x, 1.);
+  }
+};
+
+template <class S>
+struct math_kernels_t
+{
+  typedef typename S::type T;
+  typedef typename S::V V;
+  typedef elementary_t<S> E;
+
+  template <V (*F)(V)>
+  static void apply(const T* a, T* out, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(out + i, F(S::load(a + i)));
+
+    if (i < n) // the remaining elements by a padded vector, so the results do not depend on the positions
+    {
+      T in[S::W], tmp[S::W];
+      for (size_t k = 0; k < S::W; k++) in[k] = i + k < n ? a[i + k] : T(1);
+      S::store(tmp, F(S::load(in)));
+      for (size_t k = 0; i + k < n; k++) out[i + k] = tmp[k];
+    }
+  }
+
+  static void rsqrt(const T* a, T* out, const size_t n) { apply<E::rsqrt>(a, out, n); }
+  static void exp(const T* a, T* out, const size_t n) { apply<E::exp>(a, out, n); }
+  static void log(const T* a, T* out, const size_t n) { apply<E::log>(a, out, n); }
+  static void sin(const T* a, T* out, const size_t n) { apply<E::sin>(a, out, n); }
+  static void cos(const T* a, T* out, const size_t n) { apply<E::cos>(a, out, n); }
+};
+
+template <typename T>
+struct math_kernels_t<lane_scalar<T>> // the C run-time functions
+{
+  static void rsqrt(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = T(1. / std::sqrt(double(a[i])));
+  }
+
+  static void exp(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = T(std::exp(a[i]));
+  }
+
+  static void log(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = T(std::log(a[i]));
+  }
+
+  static void sin(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = T(std::sin(a[i]));
+  }
+
+  static void cos(const T* a, T* out, const size_t n)
+  {
+    for (size_t i = 0; i < n; i++) out[i] = T(std::cos(a[i]));
+  }
+};
+
+/**
+ * The run-time dispatching
+ */
+
+enum class batch_isa_t
+{
+  scalar,
+  sse2,
+  avx2,
+};
+
+static batch_isa_t batch_detect_isa()
+{
+  #ifdef VU_AVX2
+  int info[4] = { 0 };
+
+  #ifdef _MSC_VER
+  __cpuid(info, 0);
+  const int max_leaf = info[0];
+  __cpuid(info, 1);
+  #else  // __GNUC__
+  const int max_leaf = int(__get_cpuid_max(0, nullptr));
+  __cpuid(1, info[0], info[1], info[2], info[3]);
+  #endif // _MSC_VER
+
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+
+  if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) // the OS saves XMM and YMM
+  {
+    #ifdef _MSC_VER
+    __cpuidex(info, 7, 0);
+    #else  // __GNUC__
+    __cpuid_count(7, 0, info[0], info[1], info[2], info[3]);
+    #endif // _MSC_VER
+
+    if ((info[1] & (1 << 5)) != 0)
+    {
+      return batch_isa_t::avx2;
+    }
+  }
+  #endif // VU_AVX2
+
+  #ifdef VU_SSE2
+  return batch_isa_t::sse2;
+  #else  // no SSE2
+  return batch_isa_t::scalar;
+  #endif // VU_SSE2
+}
+
+static batch_isa_t batch_isa()
+{
+  static const batch_isa_t isa = batch_detect_isa();
+  return isa;
+}
+
+static const char* batch_isa_name(const batch_isa_t isa)
+{
+  switch (isa)
+  {
+  case batch_isa_t::avx2: return "avx2";
+  case batch_isa_t::sse2: return "sse2";
+  default: return "scalar";
+  }
+}
+
+#if defined(VU_AVX2)
+#define VU_BATCH_DISPATCH(K, S_SCALAR, S_SSE2, S_AVX2, call)\
+  switch (batch_isa())\
+  {\
+  case batch_isa_t::avx2: K<S_AVX2>::call; break;\
+  case batch_isa_t::sse2: K<S_SSE2>::call; break;\
+  default: K<S_SCALAR>::call; break;\
+  }
+#elif defined(VU_SSE2)
+#define VU_BATCH_DISPATCH(K, S_SCALAR, S_SSE2, S_AVX2, call)\
+  K<S_SSE2>::call;
+#else  // no SSE2
+#define VU_BATCH_DISPATCH(K, S_SCALAR, S_SSE2, S_AVX2, call)\
+  K<S_SCALAR>::call;
+#endif
+
+#define VU_BATCH_DEFINE(T, S_SCALAR, S_SSE2, S_AVX2)\
+\
+const char* batch_t<T>::isa()\
+{\
+  return batch_isa_name(batch_isa());\
+}\
+\
+void batch_t<T>::add(const T* a, const T* b, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, add(a, b, out, n));\
+}\
+\
+void batch_t<T>::add(const T* a, const T s, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, add_scalar(a, s, out, n));\
+}\
+\
+void batch_t<T>::sub(const T* a, const T* b, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, sub(a, b, out, n));\
+}\
+\
+void batch_t<T>::mul(const T* a, const T* b, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, mul(a, b, out, n));\
+}\
+\
+void batch_t<T>::div(const T* a, const T* b, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, div(a, b, out, n));\
+}\
+\
+void batch_t<T>::scale(const T* a, const T s, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, scale(a, s, out, n));\
+}\
+\
+void batch_t<T>::madd(const T* a, const T* b, T* acc, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, madd(a, b, acc, n));\
+}\
+\
+void batch_t<T>::cross(const T* a, const T* b, const T* c, const T* d, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, cross(a, b, c, d, out, n));\
+}\
+\
+void batch_t<T>::sqrt(const T* a, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, sqrt(a, out, n));\
+}\
+\
+void batch_t<T>::minimum(const T* a, const T* b, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, minimum(a, b, out, n));\
+}\
+\
+void batch_t<T>::maximum(const T* a, const T* b, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, maximum(a, b, out, n));\
+}\
+\
+void batch_t<T>::contains(const T* l, const T* t, const T* r, const T* b,\
+  const T x, const T y, byte* mask, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, contains_point(l, t, r, b, x, y, mask, n));\
+}\
+\
+void batch_t<T>::contains(const T* l, const T* t, const T* r, const T* b,\
+  const T* x, const T* y, byte* mask, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, contains_points(l, t, r, b, x, y, mask, n));\
+}\
+\
+void batch_t<T>::overlaps(const T* l1, const T* t1, const T* r1, const T* b1,\
+  const T* l2, const T* t2, const T* r2, const T* b2, byte* mask, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(kernels_t, S_SCALAR, S_SSE2, S_AVX2, overlaps(l1, t1, r1, b1, l2, t2, r2, b2, mask, n));\
+}
+
+#define VU_BATCH_MATH_DEFINE(T, S_SCALAR, S_SSE2, S_AVX2)\
+\
+void batch_t<T>::rsqrt(const T* a, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(math_kernels_t, S_SCALAR, S_SSE2, S_AVX2, rsqrt(a, out, n));\
+}\
+\
+void batch_t<T>::exp(const T* a, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(math_kernels_t, S_SCALAR, S_SSE2, S_AVX2, exp(a, out, n));\
+}\
+\
+void batch_t<T>::log(const T* a, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(math_kernels_t, S_SCALAR, S_SSE2, S_AVX2, log(a, out, n));\
+}\
+\
+void batch_t<T>::sin(const T* a, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(math_kernels_t, S_SCALAR, S_SSE2, S_AVX2, sin(a, out, n));\
+}\
+\
+void batch_t<T>::cos(const T* a, T* out, const size_t n)\
+{\
+  VU_BATCH_DISPATCH(math_kernels_t, S_SCALAR, S_SSE2, S_AVX2, cos(a, out, n));\
+}
+
+#ifdef VU_SSE2
+VU_BATCH_DEFINE(float,  lane_scalar<float>,  lane_sse2_f32, lane_avx2_f32)
+VU_BATCH_DEFINE(double, lane_scalar<double>, lane_sse2_f64, lane_avx2_f64)
+VU_BATCH_DEFINE(int,    lane_scalar<int>,    lane_sse2_i32, lane_avx2_i32)
+VU_BATCH_MATH_DEFINE(float,  lane_scalar<float>,  lane_sse2_f32, lane_avx2_f32)
+VU_BATCH_MATH_DEFINE(double, lane_scalar<double>, lane_sse2_f64, lane_avx2_f64)
+#else  // no SSE2
+VU_BATCH_DEFINE(float,  lane_scalar<float>,  void, void)
+VU_BATCH_DEFINE(double, lane_scalar<double>, void, void)
+VU_BATCH_DEFINE(int,    lane_scalar<int>,    void, void)
+VU_BATCH_MATH_DEFINE(float,  lane_scalar<float>,  void, void)
+VU_BATCH_MATH_DEFINE(double, lane_scalar<double>, void, void)
+#endif // VU_SSE2
+
+VU_BATCH_MATH_DEFINE(int, lane_scalar<int>, lane_scalar<int>, lane_scalar<int>) // in double then truncated
+
+} // namespace vu
@@ -0,0 +1,1447 @@
+/**
+ * @file   bignum.cpp
+ * @author Vic P.
+ * @brief  Implementation for Big Number
+ */
+
+#include "Vutils.h"
+
+#include <climits>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace vu
+{
+
+typedef std::vector<uint64> Limbs;
+
+static const size_t BN_KARATSUBA_THRESHOLD = 32; // in limbs
+static const size_t BN_TOOM3_THRESHOLD = 160;
+
+/**
+ * The limb primitives
+ */
+
+static inline uint64 bn_mul_64(const uint64 a, const uint64 b, uint64& high)
+{
+  #if defined(_MSC_VER) && defined(_M_X64)
+  return _umul128(a, b, &high);
+  #elif defined(__SIZEOF_INT128__)
+  const unsigned __int128 r = (unsigned __int128)(a) * b;
+  high = uint64(r >> 64);
+  return uint64(r);
+  #else
+  const uint64 a0 = a & 0xFFFFFFFF, a1 = a >> 32;
+  const uint64 b0 = b & 0xFFFFFFFF, b1 = b >> 32;
+  const uint64 p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  const uint64 middle = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+  high = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+  return (middle << 32) | (p00 & 0xFFFFFFFF);
+  #endif
+}
+
+static inline void bn_trim(Limbs& a)
+{
+  while (!a.empty() && a.back() == 0)
+  {
+    a.pop_back();
+  }
+}
+
+static inline size_t bn_size(const uint64* a, size_t n)
+{
+  while (n != 0 && a[n - 1] == 0)
+  {
+    n--;
+  }
+
+  return n;
+}
+
+static int bn_compare(const Limbs& a, const Limbs& b)
+{
+  if (a.size() != b.size())
+  {
+    return a.size() < b.size() ? -1 : 1;
+  }
+
+  for (size_t i = a.size(); i != 0; i--)
+  {
+    if (a[i - 1] != b[i - 1])
+    {
+      return a[i - 1] < b[i - 1] ? -1 : 1;
+    }
+  }
+
+  return 0;
+}
+
+// r[offset...] += b, r must be large enough to hold the carry
+
+static void bn_add_to(Limbs& r, const size_t offset, const uint64* b, const size_t nb)
+{
+  uint64 carry = 0;
+  size_t i = 0;
+
+  for (; i < nb; i++)
+  {
+    const uint64 s = r[offset + i] + carry;
+    const uint64 c1 = s < carry;
+    r[offset + i] = s + b[i];
+    carry = c1 + (r[offset + i] < b[i]);
+  }
+
+  for (size_t j = offset + i; carry != 0 && j < r.size(); j++)
+  {
+    r[j] += carry;
+    carry = r[j] < carry;
+  }
+}
+
+static Limbs bn_add(const uint64* a, const size_t na, const uint64* b, const size_t nb)
+{
+  if (na < nb)
+  {
+    return bn_add(b, nb, a, na);
+  }
+
+  Limbs r(a, a + na);
+  r.push_back(0);
+  bn_add_to(r, 0, b, nb);
+  bn_trim(r);
+
+  return r;
+}
+
+// a -= b where a >= b
+
+static void bn_sub_from(Limbs& a, const uint64* b, const size_t nb)
+{
+  uint64 borrow = 0;
+  size_t i = 0;
+
+  for (; i < nb; i++)
+  {
+    const uint64 d = a[i] - b[i];
+    const uint64 b1 = a[i] < b[i];
+    a[i] = d - borrow;
+    borrow = b1 + (d < borrow);
+  }
+
+  for (; borrow != 0 && i < a.size(); i++)
+  {
+    const uint64 b1 = a[i] < borrow;
+    a[i] -= borrow;
+    borrow = b1;
+  }
+
+  bn_trim(a);
+}
+
+static Limbs bn_sub(const Limbs& a, const Limbs& b)
+{
+  Limbs r(a);
+  bn_sub_from(r, b.data(), b.size());
+  return r;
+}
+
+// a = a * m + add
+
+static void bn_mul_small_add(Limbs& a, const uint64 m, uint64 add)
+{
+  for (auto& limb : a)
+  {
+    uint64 high = 0;
+    const uint64 low = bn_mul_64(limb, m, high);
+    limb = low + add;
+    add = high + (limb < low);
+  }
+
+  if (add != 0)
+  {
+    a.push_back(add);
+  }
+}
+
+// a = a / d, returns a % d
+
+static uint32 bn_div_small(Limbs& a, const uint32 d)
+{
+  uint64 remainder = 0;
+
+  for (size_t i = a.size(); i != 0; i--)
+  {
+    uint64 current = (remainder << 32) | (a[i - 1] >> 32);
+    const uint64 qh = current / d;
+    remainder = current % d;
+
+    current = (remainder << 32) | (a[i - 1] & 0xFFFFFFFF);
+    const uint64 ql = current / d;
+    remainder = current % d;
+
+    a[i - 1] = (qh << 32) | ql;
+  }
+
+  bn_trim(a);
+
+  return uint32(remainder);
+}
+
+static void bn_shift_left(Limbs& a, const size_t bits)
+{
+  if (a.empty() || bits == 0)
+  {
+    return;
+  }
+
+  const size_t limbs = bits / 64, shift = bits % 64;
+
+  if (shift != 0)
+  {
+    a.push_back(0);
+    for (size_t i = a.size() - 1; i != 0; i--)
+    {
+      a[i] = (a[i] << shift) | (a[i - 1] >> (64 - shift));
+    }
+    a[0] <<= shift;
+  }
+
+  a.insert(a.begin(), limbs, 0);
+  bn_trim(a);
+}
+
+static void bn_shift_right(Limbs& a, const size_t bits)
+{
+  const size_t limbs = bits / 64, shift = bits % 64;
+
+  if (limbs >= a.size())
+  {
+    a.clear();
+    return;
+  }
+
+  a.erase(a.begin(), a.begin() + limbs);
+
+  if (shift != 0)
+  {
+    for (size_t i = 0; i + 1 < a.size(); i++)
+    {
+      a[i] = (a[i] >> shift) | (a[i + 1] << (64 - shift));
+    }
+    a.back() >>= shift;
+  }
+
+  bn_trim(a);
+}
+
+/**
+ * The multiplication (schoolbook -> Karatsuba -> Toom-3)
+ */
+
+static Limbs bn_mul(const uint64* a, size_t na, const uint64* b, size_t nb);
+
+static Limbs bn_mul_schoolbook(const uint64* a, const size_t na, const uint64* b, const size_t nb)
+{
+  Limbs r(na + nb, 0);
+
+  for (size_t i = 0; i < na; i++)
+  {
+    uint64 carry = 0;
+
+    for (size_t j = 0; j < nb; j++)
+    {
+      uint64 high = 0;
+      uint64 low = bn_mul_64(a[i], b[j], high);
+      low += carry;
+      high += low < carry;
+      r[i + j] += low;
+      high += r[i + j] < low;
+      carry = high;
+    }
+
+    r[i + nb] = carry;
+  }
+
+  return r;
+}
+
+// na >= nb > na / 2
+
+static Limbs bn_mul_karatsuba(const uint64* a, const size_t na, const uint64* b, const size_t nb)
+{
+  const size_t m = na / 2;
+
+  auto z0 = bn_mul(a, m, b, m);
+  auto z2 = bn_mul(a + m, na - m, b + m, nb - m);
+
+  const auto sa = bn_add(a, bn_size(a, m), a + m, na - m);
+  const auto sb = bn_add(b, bn_size(b, m), b + m, nb - m);
+  auto z1 = bn_mul(sa.data(), sa.size(), sb.data(), sb.size());
+
+  bn_trim(z0);
+  bn_trim(z1);
+  bn_trim(z2);
+
+  bn_sub_from(z1, z0.data(), z0.size());
+  bn_sub_from(z1, z2.data(), z2.size());
+
+  Limbs r(na + nb + 1, 0);
+  bn_add_to(r, 0, z0.data(), z0.size());
+  bn_add_to(r, m, z1.data(), z1.size());
+  bn_add_to(r, 2 * m, z2.data(), z2.size());
+  r.resize(na + nb);
+
+  return r;
+}
+
+struct BNSigned
+{
+  Limbs magnitude;
+  bool negative;
+};
+
+static BNSigned bn_signed(const uint64* a, const size_t n)
+{
+  BNSigned result = { Limbs(a, a + bn_size(a, n)), false };
+  return result;
+}
+
+static BNSigned bn_signed_add(const BNSigned& a, const BNSigned& b)
+{
+  BNSigned result;
+
+  if (a.negative == b.negative)
+  {
+    result.magnitude = bn_add(a.magnitude.data(), a.magnitude.size(), b.magnitude.data(), b.magnitude.size());
+    result.negative = a.negative;
+  }
+  else if (bn_compare(a.magnitude, b.magnitude) >= 0)
+  {
+    result.magnitude = bn_sub(a.magnitude, b.magnitude);
+    result.negative = a.negative;
+  }
+  else
+  {
+    result.magnitude = bn_sub(b.magnitude, a.magnitude);
+    result.negative = b.negative;
+  }
+
+  result.negative = result.negative && !result.magnitude.empty();
+
+  return result;
+}
+
+static BNSigned bn_signed_sub(const BNSigned& a, BNSigned b)
+{
+  b.negative = !b.negative && !b.magnitude.empty();
+  return bn_signed_add(a, b);
+}
+
+static BNSigned bn_signed_mul(const BNSigned& a, const BNSigned& b)
+{
+  BNSigned result;
+  result.magnitude = bn_mul(a.magnitude.data(), a.magnitude.size(), b.magnitude.data(), b.magnitude.size());
+  bn_trim(result.magnitude);
+  result.negative = a.negative != b.negative && !result.magnitude.empty();
+  return result;
+}
+
+// na >= nb > na / 2, by Bodrato's interpolation sequence at the points 0, 1, -1, -2, infinity
+
+static Limbs bn_mul_toom3(const uint64* a, const size_t na, const uint64* b, const size_t nb)
+{
+  const size_t k = (na + 2) / 3;
+
+  auto fn_split = [&](const uint64* x, const size_t n, BNSigned& x0, BNSigned& x1, BNSigned& x2)
+  {
+    x0 = bn_signed(x, n < k ? n : k);
+    x1 = bn_signed(x + (n < k ? n : k), n < k ? 0 : (n < 2 * k ? n - k : k));
+    x2 = bn_signed(x + (n < 2 * k ? n : 2 * k), n < 2 * k ? 0 : n - 2 * k);
+  };
+
+  auto fn_evaluate = [&](const BNSigned& x0, const BNSigned& x1, const BNSigned& x2,
+    BNSigned& p1, BNSigned& pm1, BNSigned& pm2)
+  {
+    const auto p0 = bn_signed_add(x0, x2);
+    p1 = bn_signed_add(p0, x1);
+    pm1 = bn_signed_sub(p0, x1);
+    pm2 = bn_signed_add(pm1, x2);
+    bn_shift_left(pm2.magnitude, 1);
+    pm2 = bn_signed_sub(pm2, x0);
+  };
+
+  BNSigned a0, a1, a2, b0, b1, b2;
+  fn_split(a, na, a0, a1, a2);
+  fn_split(b, nb, b0, b1, b2);
+
+  BNSigned pa1, pam1, pam2, pb1, pbm1, pbm2;
+  fn_evaluate(a0, a1, a2, pa1, pam1, pam2);
+  fn_evaluate(b0, b1, b2, pb1, pbm1, pbm2);
+
+  const auto r0 = bn_signed_mul(a0, b0);
+  auto r1 = bn_signed_mul(pa1, pb1);
+  const auto rm1 = bn_signed_mul(pam1, pbm1);
+  const auto rm2 = bn_signed_mul(pam2, pbm2);
+  const auto rinf = bn_signed_mul(a2, b2);
+
+  auto r3 = bn_signed_sub(rm2, r1);
+  bn_div_small(r3.magnitude, 3); // exact
+  r1 = bn_signed_sub(r1, rm1);
+  bn_shift_right(r1.magnitude, 1); // exact
+  auto r2 = bn_signed_sub(rm1, r0);
+  r3 = bn_signed_sub(r2, r3);
+  bn_shift_right(r3.magnitude, 1); // exact
+  auto rinf2 = rinf;
+  bn_shift_left(rinf2.magnitude, 1);
+  r3 = bn_signed_add(r3, rinf2);
+  r2 = bn_signed_add(r2, r1);
+  r2 = bn_signed_sub(r2, rinf);
+  r1 = bn_signed_sub(r1, r3);
+
+  // all coefficients are non-negative here
+
+  Limbs r(na + nb + 1, 0);
+  bn_add_to(r, 0, r0.magnitude.data(), r0.magnitude.size());
+  bn_add_to(r, k, r1.magnitude.data(), r1.magnitude.size());
+  bn_add_to(r, 2 * k, r2.magnitude.data(), r2.magnitude.size());
+  bn_add_to(r, 3 * k, r3.magnitude.data(), r3.magnitude.size());
+  bn_add_to(r, 4 * k, rinf.magnitude.data(), rinf.magnitude.size());
+  r.resize(na + nb);
+
+  return r;
+}
+
+static Limbs bn_mul(const uint64* a, size_t na, const uint64* b, size_t nb)
+{
+  na = bn_size(a, na);
+  nb = bn_size(b, nb);
+
+  if (na < nb)
+  {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+
+  if (nb == 0)
+  {
+    return Limbs();
+  }
+
+  if (nb < BN_KARATSUBA_THRESHOLD)
+  {
+    return bn_mul_schoolbook(a, na, b, nb);
+  }
+
+  // the unbalanced operands are multiplied by the blocks of the smaller size
+
+  if (na >= 2 * nb)
+  {
+    Limbs r(na + nb + 1, 0);
+
+    for (size_t offset = 0; offset < na; offset += nb)
+    {
+      const auto block = bn_mul(a + offset, std::min(nb, na - offset), b, nb);
+      bn_add_to(r, offset, block.data(), bn_size(block.data(), block.size()));
+    }
+
+    r.resize(na + nb);
+
+    return r;
+  }
+
+  return nb < BN_TOOM3_THRESHOLD ? bn_mul_karatsuba(a, na, b, nb) : bn_mul_toom3(a, na, b, nb);
+}
+
+/**
+ * The division (Knuth's algorithm D in base 2^32)
+ */
+
+static void bn_div_mod(const Limbs& a, const Limbs& b, Limbs& q, Limbs& r)
+{
+  if (bn_compare(a, b) < 0)
+  {
+    q.clear();
+    r = a;
+    return;
+  }
+
+  if (b.size() == 1 && b[0] <= 0xFFFFFFFF)
+  {
+    q = a;
+    const uint32 remainder = bn_div_small(q, uint32(b[0]));
+    r.assign(remainder != 0 ? 1 : 0, remainder);
+    return;
+  }
+
+  auto fn_to_32 = [](const Limbs& x) -> std::vector<uint32>
+  {
+    std::vector<uint32> result(x.size() * 2);
+    for (size_t i = 0; i < x.size(); i++)
+    {
+      result[2 * i] = uint32(x[i]);
+      result[2 * i + 1] = uint32(x[i] >> 32);
+    }
+    while (!result.empty() && result.back() == 0) result.pop_back();
+    return result;
+  };
+
+  auto fn_to_64 = [](const std::vector<uint32>& x, const size_t n) -> Limbs
+  {
+    Limbs result((n + 1) / 2, 0);
+    for (size_t i = 0; i < n; i++)
+    {
+      result[i / 2] |= uint64(x[i]) << (32 * (i % 2));
+    }
+    bn_trim(result);
+    return result;
+  };
+
+  const auto u = fn_to_32(a);
+  const auto v = fn_to_32(b);
+  const size_t m = u.size(), n = v.size();
+
+  // normalize the divisor so that its top bit is set
+
+  int s = 0;
+  for (uint32 top = v[n - 1]; (top & 0x80000000) == 0; top <<= 1)
+  {
+    s++;
+  }
+
+  std::vector<uint32> vn(n), un(m + 1), qn(m - n + 1, 0);
+
+  for (size_t i = n - 1; i != 0; i--)
+  {
+    vn[i] = uint32((uint64(v[i]) << s) | (uint64(v[i - 1]) >> (32 - s)));
+  }
+  vn[0] = uint32(uint64(v[0]) << s);
+
+  un[m] = uint32(uint64(u[m - 1]) >> (32 - s));
+  for (size_t i = m - 1; i != 0; i--)
+  {
+    un[i] = uint32((uint64(u[i]) << s) | (uint64(u[i - 1]) >> (32 - s)));
+  }
+  un[0] = uint32(uint64(u[0]) << s);
+
+  const uint64 base = 0x100000000ULL;
+
+  for (size_t j = m - n + 1; j-- != 0;)
+  {
+    // estimate the quotient digit then correct it
+
+    const uint64 numerator = (uint64(un[j + n]) << 32) | un[j + n - 1];
+    uint64 qhat = numerator / vn[n - 1];
+    uint64 rhat = numerator - qhat * vn[n - 1];
+
+    while (qhat >= base || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2]))
+    {
+      qhat--;
+      rhat += vn[n - 1];
+      if (rhat >= base)
+      {
+        break;
+      }
+    }
+
+    // multiply and subtract
+
+    int64 t = 0, k = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      const uint64 p = qhat * vn[i];
+      t = int64(un[i + j]) - k - int64(p & 0xFFFFFFFF);
+      un[i + j] = uint32(t);
+      k = int64(p >> 32) - (t >> 32);
+    }
+    t = int64(un[j + n]) - k;
+    un[j + n] = uint32(t);
+
+    qn[j] = uint32(qhat);
+
+    // add back if it was too large
+
+    if (t < 0)
+    {
+      qn[j]--;
+      uint64 carry = 0;
+      for (size_t i = 0; i < n; i++)
+      {
+        const uint64 sum = uint64(un[i + j]) + vn[i] + carry;
+        un[i + j] = uint32(sum);
+        carry = sum >> 32;
+      }
+      un[j + n] = uint32(un[j + n] + carry);
+    }
+  }
+
+  std::vector<uint32> rn(n);
+  for (size_t i = 0; i + 1 < n; i++)
+  {
+    rn[i] = uint32((uint64(un[i]) >> s) | (uint64(un[i + 1]) << (32 - s)));
+  }
+  rn[n - 1] = uint32(uint64(un[n - 1]) >> s);
+
+  q = fn_to_64(qn, qn.size());
+  r = fn_to_64(rn, n);
+}
+
+/**
+ * The Montgomery multiplication (CIOS), t is the scratch of n + 2 limbs
+ */
+
+static void bn_mont_mul(const uint64* a, const uint64* b, const Limbs& mod, const uint64 inv, Limbs& t, uint64* out)
+{
+  const size_t n = mod.size();
+
+  std::fill(t.begin(), t.end(), 0);
+
+  for (size_t i = 0; i < n; i++)
+  {
+    uint64 carry = 0;
+
+    for (size_t j = 0; j < n; j++)
+    {
+      uint64 high = 0;
+      uint64 low = bn_mul_64(a[i], b[j], high);
+      low += carry;
+      high += low < carry;
+      t[j] += low;
+      high += t[j] < low;
+      carry = high;
+    }
+
+    t[n] += carry;
+    t[n + 1] = t[n] < carry;
+
+    const uint64 m = t[0] * inv;
+
+    uint64 high = 0;
+    uint64 low = bn_mul_64(m, mod[0], high);
+    carry = high + ((t[0] + low) < low);
+
+    for (size_t j = 1; j < n; j++)
+    {
+      low = bn_mul_64(m, mod[j], high);
+      low += carry;
+      high += low < carry;
+      t[j - 1] = t[j] + low;
+      high += t[j - 1] < low;
+      carry = high;
+    }
+
+    t[n - 1] = t[n] + carry;
+    t[n] = t[n + 1] + (t[n - 1] < carry);
+  }
+
+  // the result is less than 2 * mod
+
+  bool subtract = t[n] != 0;
+  if (!subtract)
+  {
+    subtract = true;
+    for (size_t i = n; i != 0; i--)
+    {
+      if (t[i - 1] != mod[i - 1])
+      {
+        subtract = t[i - 1] > mod[i - 1];
+        break;
+      }
+    }
+  }
+
+  if (subtract)
+  {
+    uint64 borrow = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      const uint64 d = t[i] - mod[i];
+      const uint64 b1 = t[i] < mod[i];
+      out[i] = d - borrow;
+      borrow = b1 + (d < borrow);
+    }
+  }
+  else
+  {
+    std::copy_n(t.begin(), n, out);
+  }
+}
+
+/**
+ * BigNumber
+ */
+
+BigNumber::BigNumber() : m_negative(false)
+{
+}
+
+BigNumber::BigNumber(const BigNumber& num) : m_limbs(num.m_limbs), m_negative(num.m_negative)
+{
+}
+
+BigNumber::BigNumber(BigNumber&& num) : m_limbs(std::move(num.m_limbs)), m_negative(num.m_negative)
+{
+  num.m_negative = false;
+}
+
+BigNumber::BigNumber(const long long num) : m_negative(num < 0)
+{
+  const uint64 magnitude = num < 0 ? uint64(0) - uint64(num) : uint64(num);
+  if (magnitude != 0)
+  {
+    m_limbs.push_back(magnitude);
+  }
+}
+
+BigNumber::BigNumber(const std::string& num) : m_negative(false)
+{
+  this->assign(num);
+}
+
+BigNumber::BigNumber(const BigInt& num) : m_negative(false)
+{
+  this->assign(num.to_string());
+}
+
+BigNumber::~BigNumber()
+{
+}
+
+BigNumber& BigNumber::operator=(const BigNumber& num)
+{
+  m_limbs = num.m_limbs;
+  m_negative = num.m_negative;
+  return *this;
+}
+
+BigNumber& BigNumber::operator=(BigNumber&& num)
+{
+  m_limbs = std::move(num.m_limbs);
+  m_negative = num.m_negative;
+  num.m_negative = false;
+  return *this;
+}
+
+void BigNumber::normalize()
+{
+  bn_trim(m_limbs);
+  m_negative = m_negative && !m_limbs.empty();
+}
+
+void BigNumber::assign(const std::string& num)
+{
+  auto fn_invalid = [&]() -> void
+  {
+    throw std::invalid_argument("Expected an integer, got \'" + num + "\'");
+  };
+
+  m_limbs.clear();
+  m_negative = false;
+
+  size_t i = 0;
+
+  if (i < num.length() && (num[i] == '+' || num[i] == '-'))
+  {
+    m_negative = num[i++] == '-';
+  }
+
+  const bool hex = i + 1 < num.length() && num[i] == '0' && (num[i + 1] == 'x' || num[i + 1] == 'X');
+  if (hex)
+  {
+    i += 2;
+  }
+
+  if (i == num.length())
+  {
+    fn_invalid();
+  }
+
+  if (hex) // 16 digits per limb from the end
+  {
+    m_limbs.assign((num.length() - i + 15) / 16, 0);
+
+    for (size_t j = num.length(), k = 0; j-- > i; k++)
+    {
+      const char c = num[j];
+      uint64 digit = 0;
+      if (c >= '0' && c <= '9') digit = c - '0';
+      else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+      else fn_invalid();
+      m_limbs[k / 16] |= digit << (4 * (k % 16));
+    }
+  }
+  else // 19 digits per step
+  {
+    static const uint64 powers_of_10[] =
+    {
+      1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+      1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+      100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+      1000000000000000000ULL, 10000000000000000000ULL,
+    };
+
+    m_limbs.reserve((num.length() - i) / 19 + 1);
+
+    while (i < num.length())
+    {
+      const size_t n = std::min(size_t(19), num.length() - i);
+
+      uint64 chunk = 0;
+      for (size_t j = 0; j < n; j++)
+      {
+        const char c = num[i + j];
+        if (c < '0' || c > '9')
+        {
+          fn_invalid();
+        }
+        chunk = chunk * 10 + uint64(c - '0');
+      }
+
+      bn_mul_small_add(m_limbs, powers_of_10[n], chunk);
+      bn_trim(m_limbs);
+
+      i += n;
+    }
+  }
+
+  this->normalize();
+}
+
+BigNumber BigNumber::operator+() const
+{
+  return *this;
+}
+
+BigNumber BigNumber::operator-() const
+{
+  BigNumber result(*this);
+  result.m_negative = !m_negative && !m_limbs.empty();
+  return result;
+}
+
+BigNumber& BigNumber::operator+=(const BigNumber& num)
+{
+  if (m_negative == num.m_negative)
+  {
+    m_limbs.resize(std::max(m_limbs.size(), num.m_limbs.size()) + 1, 0);
+    bn_add_to(m_limbs, 0, num.m_limbs.data(), num.m_limbs.size());
+  }
+  else if (bn_compare(m_limbs, num.m_limbs) >= 0)
+  {
+    bn_sub_from(m_limbs, num.m_limbs.data(), num.m_limbs.size());
+  }
+  else
+  {
+    m_limbs = bn_sub(num.m_limbs, m_limbs);
+    m_negative = num.m_negative;
+  }
+
+  this->normalize();
+
+  return *this;
+}
+
+BigNumber& BigNumber::operator-=(const BigNumber& num)
+{
+  return *this += -num;
+}
+
+BigNumber& BigNumber::operator*=(const BigNumber& num)
+{
+  *this = *this * num;
+  return *this;
+}
+
+BigNumber& BigNumber::operator/=(const BigNumber& num)
+{
+  *this = *this / num;
+  return *this;
+}
+
+BigNumber& BigNumber::operator%=(const BigNumber& num)
+{
+  *this = *this % num;
+  return *this;
+}
+
+BigNumber& BigNumber::operator<<=(const size_t bits)
+{
+  bn_shift_left(m_limbs, bits);
+  return *this;
+}
+
+BigNumber& BigNumber::operator>>=(const size_t bits)
+{
+  bn_shift_right(m_limbs, bits);
+  this->normalize();
+  return *this;
+}
+
+BigNumber& BigNumber::operator++()
+{
+  return *this += 1LL;
+}
+
+BigNumber& BigNumber::operator--()
+{
+  return *this -= 1LL;
+}
+
+BigNumber BigNumber::operator++(int)
+{
+  BigNumber result(*this);
+  ++*this;
+  return result;
+}
+
+BigNumber BigNumber::operator--(int)
+{
+  BigNumber result(*this);
+  --*this;
+  return result;
+}
+
+BigNumber operator+(const BigNumber& left, const BigNumber& right)
+{
+  BigNumber result(left);
+  result += right;
+  return result;
+}
+
+BigNumber operator-(const BigNumber& left, const BigNumber& right)
+{
+  BigNumber result(left);
+  result -= right;
+  return result;
+}
+
+BigNumber operator*(const BigNumber& left, const BigNumber& right)
+{
+  BigNumber result;
+  result.m_limbs = bn_mul(left.m_limbs.data(), left.m_limbs.size(), right.m_limbs.data(), right.m_limbs.size());
+  result.m_negative = left.m_negative != right.m_negative;
+  result.normalize();
+  return result;
+}
+
+void div_mod(const BigNumber& dividend, const BigNumber& divisor, BigNumber& quotient, BigNumber& remainder)
+{
+  if (divisor.m_limbs.empty())
+  {
+    throw std::logic_error("Attempted division by zero");
+  }
+
+  // truncated toward zero, the remainder has the sign of the dividend
+
+  const bool negative_quotient = dividend.m_negative != divisor.m_negative;
+  const bool negative_remainder = dividend.m_negative;
+
+  bn_div_mod(dividend.m_limbs, divisor.m_limbs, quotient.m_limbs, remainder.m_limbs);
+
+  quotient.m_negative = negative_quotient;
+  quotient.normalize();
+  remainder.m_negative = negative_remainder;
+  remainder.normalize();
+}
+
+BigNumber operator/(const BigNumber& left, const BigNumber& right)
+{
+  BigNumber quotient, remainder;
+  div_mod(left, right, quotient, remainder);
+  return quotient;
+}
+
+BigNumber operator%(const BigNumber& left, const BigNumber& right)
+{
+  BigNumber quotient, remainder;
+  div_mod(left, right, quotient, remainder);
+  return remainder;
+}
+
+BigNumber operator<<(const BigNumber& num, const size_t bits)
+{
+  BigNumber result(num);
+  result <<= bits;
+  return result;
+}
+
+BigNumber operator>>(const BigNumber& num, const size_t bits)
+{
+  BigNumber result(num);
+  result >>= bits;
+  return result;
+}
+
+bool operator==(const BigNumber& left, const BigNumber& right)
+{
+  return left.m_negative == right.m_negative && left.m_limbs == right.m_limbs;
+}
+
+bool operator!=(const BigNumber& left, const BigNumber& right)
+{
+  return !(left == right);
+}
+
+bool operator<(const BigNumber& left, const BigNumber& right)
+{
+  if (left.m_negative != right.m_negative)
+  {
+    return left.m_negative;
+  }
+
+  const int result = bn_compare(left.m_limbs, right.m_limbs);
+  return left.m_negative ? result > 0 : result < 0;
+}
+
+bool operator>(const BigNumber& left, const BigNumber& right)
+{
+  return right < left;
+}
+
+bool operator<=(const BigNumber& left, const BigNumber& right)
+{
+  return !(right < left);
+}
+
+bool operator>=(const BigNumber& left, const BigNumber& right)
+{
+  return !(left < right);
+}
+
+std::istream& operator>>(std::istream& is, BigNumber& num)
+{
+  std::string text;
+  is >> text;
+  num = BigNumber(text);
+  return is;
+}
+
+std::ostream& operator<<(std::ostream& os, const BigNumber& num)
+{
+  os << num.to_string();
+  return os;
+}
+
+// the decimal digits of a small magnitude, 9 digits per division, left-padded with zeros to the width
+
+static void bn_to_decimal_small(Limbs magnitude, const size_t width, std::string& result)
+{
+  std::vector<uint32> chunks;
+  chunks.reserve(magnitude.size() * 64 / 29 + 1);
+
+  while (!magnitude.empty())
+  {
+    chunks.push_back(bn_div_small(magnitude, 1000000000));
+  }
+
+  char digits[16];
+  std::string text;
+  text.reserve(chunks.size() * 9);
+
+  if (!chunks.empty())
+  {
+    snprintf(digits, sizeof(digits), "%u", chunks.back());
+    text += digits;
+  }
+
+  for (size_t i = chunks.size(); i > 1; i--)
+  {
+    uint32 chunk = chunks[i - 2];
+    for (int j = 8; j >= 0; j--)
+    {
+      digits[j] = char('0' + chunk % 10);
+      chunk /= 10;
+    }
+    text.append(digits, 9);
+  }
+
+  if (text.length() < width)
+  {
+    result.append(width - text.length(), '0');
+  }
+
+  result += text;
+}
+
+// divide and conquer by the powers 10^(9 * 2^level), so the cost is bounded by the top-level divisions
+
+static void bn_to_decimal(
+  const Limbs& magnitude, const size_t level, const size_t width, const std::vector<Limbs>& powers, std::string& result)
+{
+  if (level == 0 || magnitude.size() <= BN_KARATSUBA_THRESHOLD)
+  {
+    bn_to_decimal_small(magnitude, width, result);
+    return;
+  }
+
+  const size_t low_width = size_t(9) << (level - 1);
+
+  Limbs q, r;
+  bn_div_mod(magnitude, powers[level - 1], q, r);
+
+  if (!q.empty() || width > low_width)
+  {
+    bn_to_decimal(q, level - 1, width > low_width ? width - low_width : 0, powers, result);
+    bn_to_decimal(r, level - 1, low_width, powers, result);
+  }
+  else
+  {
+    bn_to_decimal(r, level - 1, width, powers, result);
+  }
+}
+
+std::string BigNumber::to_string() const
+{
+  if (m_limbs.empty())
+  {
+    return "0";
+  }
+
+  std::string result;
+  result.reserve(m_limbs.size() * 20 + 1);
+
+  if (m_negative)
+  {
+    result += '-';
+  }
+
+  // the powers 10^(9 * 2^i) up to the square root of the magnitude
+
+  std::vector<Limbs> powers(1, Limbs(1, 1000000000));
+  while (powers.back().size() * 2 <= m_limbs.size())
+  {
+    const auto& p = powers.back();
+    auto square = bn_mul(p.data(), p.size(), p.data(), p.size());
+    bn_trim(square);
+    powers.push_back(std::move(square));
+  }
+
+  bn_to_decimal(m_limbs, powers.size(), 0, powers, result);
+
+  return result;
+}
+
+std::string BigNumber::to_string_hex() const
+{
+  if (m_limbs.empty())
+  {
+    return "0x0";
+  }
+
+  static const char hex_digits[] = "0123456789ABCDEF";
+
+  std::string result;
+  result.reserve(m_limbs.size() * 16 + 3);
+
+  if (m_negative)
+  {
+    result += '-';
+  }
+
+  result += "0x";
+
+  bool leading = true;
+
+  for (size_t i = m_limbs.size(); i != 0; i--)
+  {
+    for (int shift = 60; shift >= 0; shift -= 4)
+    {
+      const auto digit = (m_limbs[i - 1] >> shift) & 0xF;
+      if (leading && digit == 0)
+      {
+        continue;
+      }
+
+      leading = false;
+      result += hex_digits[digit];
+    }
+  }
+
+  return result;
+}
+
+long long BigNumber::to_long_long() const
+{
+  if (m_limbs.empty())
+  {
+    return 0;
+  }
+
+  const uint64 limit = m_negative ? 0x8000000000000000ULL : 0x7FFFFFFFFFFFFFFFULL;
+  if (m_limbs.size() > 1 || m_limbs[0] > limit)
+  {
+    throw std::out_of_range("The big number is out of range of long long");
+  }
+
+  return m_negative ? (long long)(uint64(0) - m_limbs[0]) : (long long)(m_limbs[0]);
+}
+
+long BigNumber::to_long() const
+{
+  const long long result = this->to_long_long();
+  if (result < LONG_MIN || result > LONG_MAX)
+  {
+    throw std::out_of_range("The big number is out of range of long");
+  }
+
+  return long(result);
+}
+
+int BigNumber::to_int() const
+{
+  const long long result = this->to_long_long();
+  if (result < INT_MIN || result > INT_MAX)
+  {
+    throw std::out_of_range("The big number is out of range of int");
+  }
+
+  return int(result);
+}
+
+bool BigNumber::is_zero() const
+{
+  return m_limbs.empty();
+}
+
+bool BigNumber::is_negative() const
+{
+  return m_negative;
+}
+
+bool BigNumber::is_odd() const
+{
+  return !m_limbs.empty() && (m_limbs[0] & 1) != 0;
+}
+
+size_t BigNumber::bit_length() const
+{
+  if (m_limbs.empty())
+  {
+    return 0;
+  }
+
+  size_t result = (m_limbs.size() - 1) * 64;
+  for (uint64 top = m_limbs.back(); top != 0; top >>= 1)
+  {
+    result++;
+  }
+
+  return result;
+}
+
+BigNumber abs(const BigNumber& num)
+{
+  BigNumber result(num);
+  result.m_negative = false;
+  return result;
+}
+
+BigNumber pow(const BigNumber& base, int exp)
+{
+  if (exp < 0)
+  {
+    if (base.is_zero())
+    {
+      throw std::logic_error("Cannot divide by zero");
+    }
+
+    if (base.m_limbs.size() == 1 && base.m_limbs[0] == 1) // 1 or -1
+    {
+      return base.m_negative && (exp % 2) == 0 ? BigNumber(1LL) : base;
+    }
+
+    return BigNumber();
+  }
+
+  if (exp == 0)
+  {
+    if (base.is_zero())
+    {
+      throw std::logic_error("Zero cannot be raised to zero");
+    }
+
+    return BigNumber(1LL);
+  }
+
+  BigNumber result(1LL), square(base);
+
+  for (; exp != 0; exp >>= 1)
+  {
+    if (exp & 1)
+    {
+      result *= square;
+    }
+
+    if (exp > 1)
+    {
+      square *= square;
+    }
+  }
+
+  return result;
+}
+
+BigNumber sqrt(const BigNumber& num)
+{
+  if (num.m_negative)
+  {
+    throw std::invalid_argument("Cannot compute square root of a negative integer");
+  }
+
+  if (num.is_zero())
+  {
+    return BigNumber();
+  }
+
+  // Newton's iteration from above
+
+  BigNumber x(1LL);
+  x <<= (num.bit_length() + 1) / 2;
+
+  for (;;)
+  {
+    BigNumber y = (x + num / x) >> 1;
+    if (y >= x)
+    {
+      break;
+    }
+
+    x = std::move(y);
+  }
+
+  return x;
+}
+
+BigNumber gcd(const BigNumber& num1, const BigNumber& num2)
+{
+  BigNumber a = abs(num1), b = abs(num2);
+
+  while (!b.is_zero())
+  {
+    BigNumber r = a % b;
+    a = std::move(b);
+    b = std::move(r);
+  }
+
+  return a;
+}
+
+BigNumber lcm(const BigNumber& num1, const BigNumber& num2)
+{
+  if (num1.is_zero() || num2.is_zero())
+  {
+    return BigNumber();
+  }
+
+  return abs(num1 * num2) / gcd(num1, num2);
+}
+
+BigNumber pow_mod(const BigNumber& base, const BigNumber& exp, const BigNumber& mod)
+{
+  if (mod.m_negative || mod.is_zero())
+  {
+    throw std::invalid_argument("The modulus must be positive");
+  }
+
+  if (exp.m_negative)
+  {
+    throw std::invalid_argument("The exponent must be non-negative");
+  }
+
+  if (mod.m_limbs.size() == 1 && mod.m_limbs[0] == 1)
+  {
+    return BigNumber();
+  }
+
+  BigNumber b = base % mod;
+  if (b.m_negative)
+  {
+    b += mod;
+  }
+
+  const size_t n_bits = exp.bit_length();
+
+  // the square-and-multiply for an even modulus
+
+  if (!mod.is_odd())
+  {
+    BigNumber result(1LL);
+
+    for (size_t i = n_bits; i != 0; i--)
+    {
+      result = result * result % mod;
+      if ((exp.m_limbs[(i - 1) / 64] >> ((i - 1) % 64)) & 1)
+      {
+        result = result * b % mod;
+      }
+    }
+
+    return result;
+  }
+
+  // the Montgomery form (R = 2^(64n)) with the fixed 4-bit window
+
+  const Limbs& m = mod.m_limbs;
+  const size_t n = m.size();
+
+  uint64 inv = m[0]; // m^-1 mod 2^64 by Newton's iteration
+  for (int i = 0; i < 5; i++)
+  {
+    inv *= 2 - m[0] * inv;
+  }
+  inv = uint64(0) - inv;
+
+  auto fn_to_montgomery = [&](const BigNumber& x) -> Limbs
+  {
+    BigNumber shifted(x);
+    shifted <<= 64 * n;
+    Limbs q, r;
+    bn_div_mod(shifted.m_limbs, m, q, r);
+    r.resize(n, 0);
+    return r;
+  };
+
+  Limbs scratch(n + 2, 0);
+
+  std::vector<Limbs> table(16);
+  table[0] = fn_to_montgomery(BigNumber(1LL));
+  table[1] = fn_to_montgomery(b);
+  for (size_t i = 2; i < table.size(); i++)
+  {
+    table[i].resize(n);
+    bn_mont_mul(table[i - 1].data(), table[1].data(), m, inv, scratch, table[i].data());
+  }
+
+  Limbs x = table[0];
+
+  const size_t n_windows = (n_bits + 3) / 4;
+  for (size_t w = n_windows; w != 0; w--)
+  {
+    for (int i = 0; i < 4; i++)
+    {
+      bn_mont_mul(x.data(), x.data(), m, inv, scratch, x.data());
+    }
+
+    const size_t bit = (w - 1) * 4;
+    const auto window = size_t((exp.m_limbs[bit / 64] >> (bit % 64)) & 0xF);
+    if (window != 0)
+    {
+      bn_mont_mul(x.data(), table[window].data(), m, inv, scratch, x.data());
+    }
+  }
+
+  Limbs one(n, 0);
+  one[0] = 1;
+
+  BigNumber result;
+  result.m_limbs.resize(n);
+  bn_mont_mul(x.data(), one.data(), m, inv, scratch, result.m_limbs.data());
+  result.normalize();
+
+  return result;
+}
+
+} // namespace vu
@@ -5,6 +5,9 @@
  */
 
 #include "Vutils.h"
+#include "crisec.h"
+
+#include <algorithm>
 
 namespace vu
 {
@@ -38,26 +41,32 @@ void vuapi ThreadLock::unlock()
  * GlobalThreadLock
  */
 
+std::mutex _GlobalThreadLock::m_mutex;
 std::map<int, std::unique_ptr<ThreadLock>> _GlobalThreadLock::m_list;
 
-_GlobalThreadLock::_GlobalThreadLock(int thread_lock_id) : m_thread_lock_id(thread_lock_id)
+_GlobalThreadLock::_GlobalThreadLock(int thread_lock_id)
+  : m_thread_lock_id(thread_lock_id), m_ptr_thread_lock(nullptr)
 {
-  auto it = m_list.find(thread_lock_id);
-  if (it == m_list.cend())
   {
-    m_thread_lock_id = thread_lock_id;
-    m_list[m_thread_lock_id].reset(new ThreadLock());
+    std::lock_guard<std::mutex> lg(m_mutex);
+
+    auto& ptr = m_list[m_thread_lock_id];
+    if (ptr == nullptr)
+    {
+      ptr.reset(new ThreadLock());
+    }
+
+    m_ptr_thread_lock = ptr.get();
   }
 
-  m_list[m_thread_lock_id]->lock();
+  m_ptr_thread_lock->lock();
 }
 
 _GlobalThreadLock::~_GlobalThreadLock()
 {
-  if (m_thread_lock_id != -1)
+  if (m_ptr_thread_lock != nullptr)
   {
-    m_list[m_thread_lock_id]->unlock();
-    //m_list.erase(m_thread_lock_id);
+    m_ptr_thread_lock->unlock();
   }
 }
 
@@ -144,4 +153,454 @@ bool ThreadSignal::wait(ulong time_out) const
   return WaitForSingleObject(m_event, time_out) == WAIT_OBJECT_0;
 }
 
+/**
+ * Futex - WaitOnAddress (Windows 8+) or the hashed SRW lock + condition variable table
+ */
+
+static_assert(
+  alignof(AdaptiveMutex) >= 4 && alignof(ReadWriteLock) >= 4 &&
+  alignof(LightEvent) >= 4 && alignof(Latch) >= 4 && alignof(Barrier) >= 4,
+  "the futex words must be naturally aligned");
+
+typedef BOOL (WINAPI *PfnWaitOnAddress)(volatile VOID* Address, PVOID CompareAddress, SIZE_T AddressSize, DWORD dwMilliseconds);
+typedef VOID (WINAPI *PfnWakeByAddress)(PVOID Address);
+
+struct FutexAPI
+{
+  PfnWaitOnAddress pfn_wait;
+  PfnWakeByAddress pfn_wake_one;
+  PfnWakeByAddress pfn_wake_all;
+
+  FutexAPI() : pfn_wait(nullptr), pfn_wake_one(nullptr), pfn_wake_all(nullptr)
+  {
+    auto module = LoadLibraryW(L"api-ms-win-core-synch-l1-2-0.dll");
+    if (module != nullptr)
+    {
+      pfn_wait = PfnWaitOnAddress(GetProcAddress(module, "WaitOnAddress"));
+      pfn_wake_one = PfnWakeByAddress(GetProcAddress(module, "WakeByAddressSingle"));
+      pfn_wake_all = PfnWakeByAddress(GetProcAddress(module, "WakeByAddressAll"));
+    }
+
+    if (pfn_wait == nullptr || pfn_wake_one == nullptr || pfn_wake_all == nullptr)
+    {
+      pfn_wait = nullptr;
+      pfn_wake_one = nullptr;
+      pfn_wake_all = nullptr;
+    }
+  }
+};
+
+static const FutexAPI& futex_api()
+{
+  static FutexAPI api;
+  return api;
+}
+
+struct FutexBucket
+{
+  SRWLOCK lock;
+  CONDITION_VARIABLE cv;
+};
+
+static FutexBucket g_futex_buckets[64]; // zero-initialized as SRWLOCK_INIT and CONDITION_VARIABLE_INIT
+
+static FutexBucket& futex_bucket(const volatile void* address)
+{
+  auto v = uint64(ulongptr(address)) >> 2;
+  v *= 0x9E3779B97F4A7C15ULL;
+  return g_futex_buckets[v >> 58];
+}
+
+// returns false if timed out, may return spuriously
+
+bool futex_wait(const std::atomic<uint32>& word, uint32 expected, const ulong time_out)
+{
+  const auto& api = futex_api();
+  const auto address = reinterpret_cast<volatile void*>(const_cast<std::atomic<uint32>*>(&word));
+
+  if (api.pfn_wait != nullptr)
+  {
+    if (api.pfn_wait(address, &expected, sizeof(expected), time_out) != FALSE)
+    {
+      return true;
+    }
+
+    return GetLastError() != ERROR_TIMEOUT;
+  }
+
+  auto& bucket = futex_bucket(address);
+  bool result = true;
+
+  AcquireSRWLockExclusive(&bucket.lock);
+  if (word.load() == expected)
+  {
+    result = SleepConditionVariableSRW(&bucket.cv, &bucket.lock, time_out, 0) != FALSE || GetLastError() != ERROR_TIMEOUT;
+  }
+  ReleaseSRWLockExclusive(&bucket.lock);
+
+  return result;
+}
+
+void futex_wake(const std::atomic<uint32>& word, const bool all)
+{
+  const auto& api = futex_api();
+  const auto address = reinterpret_cast<void*>(const_cast<std::atomic<uint32>*>(&word));
+
+  if (api.pfn_wait != nullptr)
+  {
+    (all ? api.pfn_wake_all : api.pfn_wake_one)(address);
+    return;
+  }
+
+  // the bucket is shared by other words, so wake all of its waiters to re-check theirs
+
+  auto& bucket = futex_bucket(address);
+  AcquireSRWLockExclusive(&bucket.lock);
+  ReleaseSRWLockExclusive(&bucket.lock);
+  WakeAllConditionVariable(&bucket.cv);
+}
+
+// the remaining time-out from a deadline (in nanoseconds), INFINITE stays INFINITE
+
+static ulong futex_remaining(const ulong time_out, const uint64 deadline)
+{
+  if (time_out == INFINITE)
+  {
+    return INFINITE;
+  }
+
+  const uint64 now = StopWatch::now_ns();
+  return now >= deadline ? 0 : ulong((deadline - now + 999999ULL) / 1000000ULL);
+}
+
+static uint64 futex_deadline(const ulong time_out)
+{
+  return time_out == INFINITE ? 0 : StopWatch::now_ns() + uint64(time_out) * 1000000ULL;
+}
+
+/**
+ * AdaptiveMutex
+ */
+
+AdaptiveMutex::AdaptiveMutex(const ulong max_spin_count)
+  : m_state(0), m_spin_count(std::min(max_spin_count, ulong(10))), m_max_spin_count(max_spin_count)
+{
+}
+
+AdaptiveMutex::~AdaptiveMutex()
+{
+}
+
+bool AdaptiveMutex::try_lock()
+{
+  uint32 expected = 0;
+  return m_state.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void AdaptiveMutex::lock()
+{
+  if (this->try_lock())
+  {
+    return;
+  }
+
+  // spin up to twice the running average of the spins that succeeded before (as glibc adaptive mutex)
+
+  const uint32 average = m_spin_count.load(std::memory_order_relaxed);
+  const uint32 limit = uint32(std::min(ulong(average) * 2 + 10, m_max_spin_count));
+
+  uint32 spins = 0;
+  for (; spins < limit; spins++)
+  {
+    if (m_state.load(std::memory_order_relaxed) == 0 && this->try_lock())
+    {
+      break;
+    }
+
+    YieldProcessor();
+  }
+
+  m_spin_count.store(uint32(int(average) + (int(spins) - int(average)) / 8), std::memory_order_relaxed);
+
+  if (spins < limit)
+  {
+    return;
+  }
+
+  // park with the state 2 (locked with waiters), so the unlocking knows that it must wake one up
+
+  uint32 state = m_state.exchange(2, std::memory_order_acquire);
+  while (state != 0)
+  {
+    futex_wait(m_state, 2, INFINITE);
+    state = m_state.exchange(2, std::memory_order_acquire);
+  }
+}
+
+void AdaptiveMutex::unlock()
+{
+  if (m_state.exchange(0, std::memory_order_release) == 2)
+  {
+    futex_wake(m_state, false);
+  }
+}
+
+/**
+ * ReadWriteLock
+ */
+
+static const uint32 RWL_WRITER_LOCKED  = 0x80000000;
+static const uint32 RWL_WRITER_WAITING = 0x40000000;
+static const uint32 RWL_READERS_MASK   = 0x3FFFFFFF;
+
+ReadWriteLock::ReadWriteLock(const ulong max_spin_count)
+  : m_state(0), m_waiters(0), m_max_spin_count(max_spin_count)
+{
+}
+
+ReadWriteLock::~ReadWriteLock()
+{
+}
+
+bool ReadWriteLock::try_lock()
+{
+  uint32 state = m_state.load(std::memory_order_relaxed);
+  return (state & ~RWL_WRITER_WAITING) == 0 &&
+    m_state.compare_exchange_strong(state, RWL_WRITER_LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void ReadWriteLock::lock()
+{
+  for (ulong spins = 0;; spins++)
+  {
+    if (this->try_lock())
+    {
+      return;
+    }
+
+    if (spins < m_max_spin_count)
+    {
+      YieldProcessor();
+      continue;
+    }
+
+    // the writer waiting bit holds off the new readers (writer preference)
+
+    const uint32 state = m_state.fetch_or(RWL_WRITER_WAITING) | RWL_WRITER_WAITING;
+    if ((state & ~RWL_WRITER_WAITING) == 0)
+    {
+      continue;
+    }
+
+    m_waiters.fetch_add(1);
+    futex_wait(m_state, state, INFINITE);
+    m_waiters.fetch_sub(1);
+  }
+}
+
+void ReadWriteLock::unlock()
+{
+  m_state.fetch_and(~RWL_WRITER_LOCKED);
+
+  if (m_waiters.load() != 0)
+  {
+    futex_wake(m_state, true);
+  }
+}
+
+bool ReadWriteLock::try_lock_shared()
+{
+  uint32 state = m_state.load(std::memory_order_relaxed);
+  while ((state & (RWL_WRITER_LOCKED | RWL_WRITER_WAITING)) == 0 && (state & RWL_READERS_MASK) != RWL_READERS_MASK)
+  {
+    if (m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ReadWriteLock::lock_shared()
+{
+  for (ulong spins = 0;; spins++)
+  {
+    if (this->try_lock_shared())
+    {
+      return;
+    }
+
+    if (spins < m_max_spin_count)
+    {
+      YieldProcessor();
+      continue;
+    }
+
+    const uint32 state = m_state.load();
+    if ((state & (RWL_WRITER_LOCKED | RWL_WRITER_WAITING)) == 0)
+    {
+      continue;
+    }
+
+    m_waiters.fetch_add(1);
+    futex_wait(m_state, state, INFINITE);
+    m_waiters.fetch_sub(1);
+  }
+}
+
+void ReadWriteLock::unlock_shared()
+{
+  const uint32 state = m_state.fetch_sub(1) - 1;
+
+  if ((state & RWL_READERS_MASK) == 0 && m_waiters.load() != 0)
+  {
+    futex_wake(m_state, true);
+  }
+}
+
+/**
+ * LightEvent
+ */
+
+LightEvent::LightEvent(const bool manual_reset, const bool signaled)
+  : m_state(signaled ? 1 : 0), m_waiters(0), m_manual_reset(manual_reset)
+{
+}
+
+LightEvent::~LightEvent()
+{
+}
+
+void LightEvent::set()
+{
+  if (m_state.exchange(1) == 0 && m_waiters.load() != 0)
+  {
+    futex_wake(m_state, m_manual_reset);
+  }
+}
+
+void LightEvent::reset()
+{
+  m_state.store(0);
+}
+
+bool LightEvent::is_set() const
+{
+  return m_state.load() != 0;
+}
+
+bool LightEvent::wait(const ulong time_out)
+{
+  const uint64 deadline = futex_deadline(time_out);
+
+  for (;;)
+  {
+    if (m_manual_reset)
+    {
+      if (m_state.load(std::memory_order_acquire) != 0)
+      {
+        return true;
+      }
+    }
+    else
+    {
+      uint32 expected = 1;
+      if (m_state.compare_exchange_strong(expected, 0, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        return true;
+      }
+    }
+
+    const ulong remaining = futex_remaining(time_out, deadline);
+    if (remaining == 0)
+    {
+      return false;
+    }
+
+    m_waiters.fetch_add(1);
+    futex_wait(m_state, 0, remaining);
+    m_waiters.fetch_sub(1);
+  }
+}
+
+/**
+ * Latch
+ */
+
+Latch::Latch(const uint32 count) : m_count(count)
+{
+}
+
+Latch::~Latch()
+{
+}
+
+void Latch::count_down(const uint32 n)
+{
+  if (m_count.fetch_sub(n, std::memory_order_acq_rel) == n)
+  {
+    futex_wake(m_count, true);
+  }
+}
+
+bool Latch::try_wait() const
+{
+  return m_count.load(std::memory_order_acquire) == 0;
+}
+
+bool Latch::wait(const ulong time_out) const
+{
+  const uint64 deadline = futex_deadline(time_out);
+
+  for (uint32 count = m_count.load(std::memory_order_acquire); count != 0; count = m_count.load(std::memory_order_acquire))
+  {
+    const ulong remaining = futex_remaining(time_out, deadline);
+    if (remaining == 0)
+    {
+      return false;
+    }
+
+    futex_wait(m_count, count, remaining);
+  }
+
+  return true;
+}
+
+void Latch::arrive_and_wait(const uint32 n)
+{
+  this->count_down(n);
+  this->wait();
+}
+
+/**
+ * Barrier
+ */
+
+Barrier::Barrier(const uint32 count) : m_arrived(0), m_generation(0), m_count(count)
+{
+}
+
+Barrier::~Barrier()
+{
+}
+
+void Barrier::arrive_and_wait()
+{
+  const uint32 generation = m_generation.load(std::memory_order_acquire);
+
+  if (m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count)
+  {
+    m_arrived.store(0, std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_release);
+    futex_wake(m_generation, true);
+    return;
+  }
+
+  while (m_generation.load(std::memory_order_acquire) == generation)
+  {
+    futex_wait(m_generation, generation, INFINITE);
+  }
+}
+
 } // namespace vu
\ No newline at end of file
@@ -0,0 +1,22 @@
+/**
+ * @file   crisec.h
+ * @author Vic P.
+ * @brief  Header for Critical Section
+ */
+
+#pragma once
+
+#include "Vutils.h"
+
+namespace vu
+{
+
+/**
+ * Futex - Wait while the word equals the expected value, or wake the waiters of the word
+ * Note: The waker never touches the word, so it could be woken after the owner of the word is gone.
+ */
+
+bool futex_wait(const std::atomic<uint32>& word, uint32 expected, const ulong time_out);
+void futex_wake(const std::atomic<uint32>& word, const bool all);
+
+} // namespace vu
@@ -6,112 +6,634 @@
 
 #include "Vutils.h"
 
+#include <chrono>
+#include <limits>
+#include <algorithm>
+
 namespace vu
 {
 
-ulongptr Debouncer::m_using_timer_id;
-std::unordered_map<ulongptr, Debouncer::Timer*> Debouncer::m_timers;
+/**
+ * TimerWheel
+ */
 
-Debouncer::~Debouncer()
+static const uint32 TW_LEVELS = 4;
+static const uint32 TW_SLOT_BITS = 8;
+static const uint32 TW_SLOTS = 1 << TW_SLOT_BITS;
+static const uint32 TW_SLOT_MASK = TW_SLOTS - 1;
+static const uint32 TW_NIL = 0xFFFFFFFF;
+static const uint64 TW_NEVER = std::numeric_limits<uint64>::max();
+
+static_assert(alignof(TimerWheel) >= alignof(void*) && alignof(Debouncer) >= alignof(void*),
+  "the mutexes and the condition variables must be naturally aligned");
+
+static inline uint32 tw_ctz(const uint64 v)
 {
-  this->cleanup();
+  static const uint32 DE_BRUIJN[64] =
+  {
+    0,  1,  2,  53, 3,  7,  54, 27, 4,  38, 41, 8,  34, 55, 48, 28,
+    62, 5,  39, 46, 44, 42, 22, 9,  24, 35, 59, 56, 49, 18, 29, 11,
+    63, 52, 6,  26, 37, 40, 33, 47, 61, 45, 43, 21, 23, 58, 17, 10,
+    51, 25, 36, 32, 60, 20, 57, 16, 50, 31, 19, 15, 30, 14, 13, 12,
+  };
+
+  return DE_BRUIJN[((v & (~v + 1)) * 0x022FDD63CC95386DULL) >> 58];
 }
 
-bool Debouncer::exists(ulongptr id)
+// the first occupied slot at or after the given slot, or TW_NIL
+
+static inline uint32 tw_find_occupied(const uint64 occupied[4], const uint32 from)
 {
-  auto it = m_timers.find(id);
-  return it != m_timers.cend();
+  for (uint32 word = from >> 6; word < 4; word++)
+  {
+    uint64 bits = occupied[word];
+    if (word == (from >> 6))
+    {
+      bits &= ~0ULL << (from & 63);
+    }
+
+    if (bits != 0)
+    {
+      return (word << 6) + tw_ctz(bits);
+    }
+  }
+
+  return TW_NIL;
 }
 
-void Debouncer::remove(ulongptr id)
+TimerWheel::TimerWheel(const ulong tick_ms, ThreadPool* ptr_thread_pool, const bool threaded)
+  : m_origin(StopWatch::now_ns())
+  , m_tick_ns(uint64(std::max(tick_ms, ulong(1))) * 1000000ULL)
+  , m_now(0)
+  , m_wake_tick(TW_NEVER)
+  , m_slots(TW_LEVELS * TW_SLOTS, TW_NIL)
+  , m_free(TW_NIL)
+  , m_size(0)
+  , m_ptr_thread_pool(ptr_thread_pool)
+  , m_running(threaded)
 {
-  auto it = m_timers.find(id);
-  if (it == m_timers.cend())
+  memset(m_occupied, 0, sizeof(m_occupied));
+
+  if (threaded)
   {
-    return;
+    m_thread = std::thread(&TimerWheel::worker, this);
+  }
+}
+
+TimerWheel::~TimerWheel()
+{
+  {
+    std::lock_guard<std::mutex> lg(m_mutex);
+    m_running = false;
+  }
+
+  m_signal.notify_all();
+
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+}
+
+uint64 TimerWheel::current_tick() const
+{
+  return (StopWatch::now_ns() - m_origin) / m_tick_ns;
+}
+
+uint64 TimerWheel::next_tick() const
+{
+  if (m_size == 0)
+  {
+    return TW_NEVER;
+  }
+
+  // the next occupied slot of the lowest level, else the next cascading of the upper levels
+
+  const uint64 base = m_now & ~uint64(TW_SLOT_MASK);
+  const uint32 slot = tw_find_occupied(m_occupied[0], uint32(m_now & TW_SLOT_MASK));
+
+  return base + (slot != TW_NIL ? slot : TW_SLOTS);
+}
+
+uint32 TimerWheel::lookup(const id_t id) const
+{
+  const uint32 index = uint32(id) - 1;
+  if (id == 0 || index >= m_nodes.size())
+  {
+    return TW_NIL;
+  }
+
+  const auto& node = m_nodes[index];
+  if (node.generation != uint32(id >> 32) || node.slot == TW_NIL)
+  {
+    return TW_NIL;
+  }
+
+  return index;
+}
+
+void TimerWheel::link(const uint32 index)
+{
+  auto& node = m_nodes[index];
+
+  node.expiry = std::max(node.expiry, m_now);
+
+  // the expiry that is too far is parked at the top level then re-cascaded until it is reachable
+
+  const uint64 delta = std::min(node.expiry - m_now, uint64(0xFFFFFFFF));
+  const uint64 expiry = m_now + delta;
+
+  uint32 level = 0;
+  while (level + 1 < TW_LEVELS && delta >= (1ULL << (TW_SLOT_BITS * (level + 1))))
+  {
+    level++;
+  }
+
+  const uint32 slot = uint32(expiry >> (TW_SLOT_BITS * level)) & TW_SLOT_MASK;
+  const uint32 position = level * TW_SLOTS + slot;
+
+  node.slot = position;
+  node.prev = TW_NIL;
+  node.next = m_slots[position];
+
+  if (node.next != TW_NIL)
+  {
+    m_nodes[node.next].prev = index;
+  }
+
+  m_slots[position] = index;
+  m_occupied[level][slot >> 6] |= 1ULL << (slot & 63);
+}
+
+void TimerWheel::unlink(const uint32 index)
+{
+  auto& node = m_nodes[index];
+
+  const uint32 position = node.slot;
+
+  if (node.prev != TW_NIL)
+  {
+    m_nodes[node.prev].next = node.next;
+  }
+  else
+  {
+    m_slots[position] = node.next;
   }
 
-  if (it->second != nullptr)
+  if (node.next != TW_NIL)
   {
-    if (it->second->m_handle != 0)
+    m_nodes[node.next].prev = node.prev;
+  }
+
+  if (m_slots[position] == TW_NIL)
+  {
+    const uint32 level = position / TW_SLOTS, slot = position % TW_SLOTS;
+    m_occupied[level][slot >> 6] &= ~(1ULL << (slot & 63));
+  }
+
+  node.slot = TW_NIL;
+}
+
+void TimerWheel::cascade(const uint32 level, const uint32 slot)
+{
+  const uint32 position = level * TW_SLOTS + slot;
+
+  uint32 index = m_slots[position];
+  m_slots[position] = TW_NIL;
+  m_occupied[level][slot >> 6] &= ~(1ULL << (slot & 63));
+
+  while (index != TW_NIL)
+  {
+    const uint32 next = m_nodes[index].next;
+    this->link(index);
+    index = next;
+  }
+}
+
+void TimerWheel::release(const uint32 index)
+{
+  auto& node = m_nodes[index];
+  node.fn = nullptr;
+  node.slot = TW_NIL;
+  node.generation++;
+  node.next = m_free;
+  m_free = index;
+  m_size--;
+}
+
+void TimerWheel::expire(std::vector<FnCallback>& fns)
+{
+  const uint64 target = this->current_tick();
+
+  while (m_now <= target)
+  {
+    if (m_size == 0)
     {
-      ::KillTimer(0, it->second->m_handle);
+      m_now = target + 1;
+      break;
     }
 
-    delete it->second;
-  }
+    const uint32 slot = uint32(m_now & TW_SLOT_MASK);
+
+    if (slot == 0)
+    {
+      for (uint32 level = 1; level < TW_LEVELS; level++)
+      {
+        const uint32 index = uint32(m_now >> (TW_SLOT_BITS * level)) & TW_SLOT_MASK;
+        this->cascade(level, index);
+        if (index != 0)
+        {
+          break;
+        }
+      }
+    }
+
+    uint32 index = m_slots[slot];
+    m_slots[slot] = TW_NIL;
+    m_occupied[0][slot >> 6] &= ~(1ULL << (slot & 63));
+
+    while (index != TW_NIL)
+    {
+      auto& node = m_nodes[index];
+      const uint32 next = node.next;
 
-  m_timers.erase(it);
+      if (node.period != 0)
+      {
+        fns.push_back(node.fn);
+        node.expiry = m_now + node.period;
+        this->link(index);
+      }
+      else
+      {
+        fns.push_back(std::move(node.fn));
+        this->release(index);
+      }
+
+      index = next;
+    }
+
+    m_now++;
+
+    // skip the empty slots up to the next occupied one or the next cascading
+
+    if (m_now <= target && (m_now & TW_SLOT_MASK) != 0)
+    {
+      const uint32 next = tw_find_occupied(m_occupied[0], uint32(m_now & TW_SLOT_MASK));
+      const uint64 base = m_now & ~uint64(TW_SLOT_MASK);
+      m_now = std::min(base + (next != TW_NIL ? next : TW_SLOTS), target + 1);
+    }
+  }
 }
 
-void Debouncer::cleanup()
+void TimerWheel::dispatch(std::vector<FnCallback>& fns)
 {
-  for (auto& e : m_timers)
+  for (auto& fn : fns)
   {
-    if (e.second != nullptr)
+    if (fn == nullptr)
+    {
+      continue;
+    }
+
+    if (m_ptr_thread_pool != nullptr)
     {
-      if (e.second->m_handle != 0)
+      m_ptr_thread_pool->add_task(std::move(fn));
+    }
+    else
+    {
+      try
+      {
+        fn();
+      }
+      catch (...)
       {
-        ::KillTimer(0, e.second->m_handle);
+        // keep the timer thread alive
       }
+    }
+  }
+
+  fns.clear();
+}
+
+void TimerWheel::worker()
+{
+  std::vector<FnCallback> fns;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while (m_running)
+  {
+    this->expire(fns);
 
-      delete e.second;
+    if (!fns.empty())
+    {
+      lock.unlock();
+      this->dispatch(fns);
+      lock.lock();
+      continue;
     }
+
+    m_wake_tick = this->next_tick();
+
+    if (m_wake_tick == TW_NEVER)
+    {
+      m_signal.wait(lock);
+    }
+    else
+    {
+      const uint64 now = StopWatch::now_ns() - m_origin;
+      const uint64 due = m_wake_tick * m_tick_ns;
+      m_signal.wait_for(lock, std::chrono::nanoseconds(due > now ? due - now : 0));
+    }
+
+    m_wake_tick = TW_NEVER;
   }
+}
+
+TimerWheel::id_t TimerWheel::schedule(const ulong delay_ms, FnCallback fn, const ulong period_ms)
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
 
-  m_timers.clear();
+  uint32 index = m_free;
+  if (index != TW_NIL)
+  {
+    m_free = m_nodes[index].next;
+  }
+  else
+  {
+    if (m_nodes.size() >= TW_NIL - 1)
+    {
+      return 0;
+    }
+
+    index = uint32(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes.back().generation = 1;
+  }
+
+  auto& node = m_nodes[index];
+  node.fn = std::move(fn);
+  node.expiry = this->current_tick() + (uint64(delay_ms) * 1000000ULL + m_tick_ns - 1) / m_tick_ns;
+  node.period = period_ms == 0 ? 0 : std::max((uint64(period_ms) * 1000000ULL) / m_tick_ns, uint64(1));
+
+  this->link(index);
+  m_size++;
+
+  if (node.expiry < m_wake_tick)
+  {
+    m_signal.notify_one();
+  }
+
+  return (uint64(node.generation) << 32) | uint64(index + 1);
 }
 
-void Debouncer::debounce(ulongptr id, ulong elapse, std::function<void()> fn)
+bool TimerWheel::reschedule(const id_t id, const ulong delay_ms)
 {
-  m_using_timer_id = id;
-  Timer* ptr_timer = nullptr;
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  const uint32 index = this->lookup(id);
+  if (index == TW_NIL)
+  {
+    return false;
+  }
 
-  auto it = m_timers.find(m_using_timer_id);
-  if (it != m_timers.cend())
+  this->unlink(index);
+
+  auto& node = m_nodes[index];
+  node.expiry = this->current_tick() + (uint64(delay_ms) * 1000000ULL + m_tick_ns - 1) / m_tick_ns;
+
+  this->link(index);
+
+  if (node.expiry < m_wake_tick)
   {
-    ptr_timer = it->second;
+    m_signal.notify_one();
   }
 
-  if (ptr_timer == nullptr)
+  return true;
+}
+
+bool TimerWheel::cancel(const id_t id)
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  const uint32 index = this->lookup(id);
+  if (index == TW_NIL)
   {
-    m_timers[m_using_timer_id] = new Timer();
-    ptr_timer = m_timers[m_using_timer_id];
+    return false;
   }
 
-  if (ptr_timer == nullptr)
+  this->unlink(index);
+  this->release(index);
+
+  return true;
+}
+
+bool TimerWheel::exists(const id_t id)
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+  return this->lookup(id) != TW_NIL;
+}
+
+size_t TimerWheel::size()
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+  return m_size;
+}
+
+void TimerWheel::clear()
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  for (uint32 index = 0; index < uint32(m_nodes.size()); index++)
   {
-    return;
+    if (m_nodes[index].slot != TW_NIL)
+    {
+      this->unlink(index);
+      this->release(index);
+    }
   }
+}
+
+size_t TimerWheel::poll()
+{
+  std::vector<FnCallback> fns;
 
-  if (ptr_timer->m_handle != 0)
   {
-    ::KillTimer(0, ptr_timer->m_handle);
+    std::lock_guard<std::mutex> lg(m_mutex);
+    this->expire(fns);
   }
 
-  ptr_timer->m_function = fn;
-  ptr_timer->m_handle = ::SetTimer(0, m_using_timer_id, elapse, fn_timer_proc);
+  const size_t result = fns.size();
+
+  this->dispatch(fns);
+
+  return result;
 }
 
-VOID CALLBACK Debouncer::fn_timer_proc(HWND hWnd, UINT message, UINT_PTR idTimer, DWORD dwTime)
+ulong TimerWheel::next_timeout()
 {
-  auto it = m_timers.find(m_using_timer_id);
-  if (it == m_timers.cend())
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  const uint64 tick = this->next_tick();
+  if (tick == TW_NEVER)
   {
-    return;
+    return INFINITE;
   }
 
-  if (it->second == nullptr)
+  const uint64 now = StopWatch::now_ns() - m_origin;
+  const uint64 due = tick * m_tick_ns;
+
+  return due > now ? ulong((due - now + 999999ULL) / 1000000ULL) : 0;
+}
+
+/**
+ * Debouncer
+ */
+
+Debouncer::Debouncer() : m_sequence(0), m_wheel(1)
+{
+}
+
+Debouncer::~Debouncer()
+{
+  this->cleanup();
+}
+
+bool Debouncer::exists(ulongptr id)
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+  return m_entries.find(id) != m_entries.cend();
+}
+
+void Debouncer::remove(ulongptr id)
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  auto it = m_entries.find(id);
+  if (it == m_entries.cend())
   {
     return;
   }
 
-  if (it->second->m_function != nullptr)
+  m_wheel.cancel(it->second.timer);
+  m_entries.erase(it);
+}
+
+void Debouncer::cleanup()
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  for (auto& e : m_entries)
+  {
+    m_wheel.cancel(e.second.timer);
+  }
+
+  m_entries.clear();
+}
+
+void Debouncer::debounce(ulongptr id, ulong elapse, std::function<void()> fn)
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  auto it = m_entries.find(id);
+  if (it != m_entries.end())
+  {
+    if (!it->second.throttling)
+    {
+      it->second.fn = fn;
+      if (m_wheel.reschedule(it->second.timer, elapse))
+      {
+        return;
+      }
+    }
+    else
+    {
+      m_wheel.cancel(it->second.timer);
+    }
+  }
+
+  auto& entry = m_entries[id];
+  entry.sequence = ++m_sequence;
+  entry.throttling = false;
+  entry.pending = false;
+  entry.fn = fn;
+
+  const auto sequence = entry.sequence;
+  entry.timer = m_wheel.schedule(elapse, [this, id, sequence, elapse]() -> void
   {
-    it->second->m_function();
+    this->fire(id, sequence, elapse);
+  });
+}
+
+void Debouncer::throttle(ulongptr id, ulong elapse, std::function<void()> fn)
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  auto it = m_entries.find(id);
+  if (it != m_entries.end())
+  {
+    if (it->second.throttling)
+    {
+      it->second.fn = fn;
+      it->second.pending = true;
+      return;
+    }
+
+    m_wheel.cancel(it->second.timer);
   }
 
-  ::KillTimer(0, it->second->m_handle);
+  auto& entry = m_entries[id];
+  entry.sequence = ++m_sequence;
+  entry.throttling = true;
+  entry.pending = false;
+  entry.fn = nullptr;
+
+  const auto sequence = entry.sequence;
+  entry.timer = m_wheel.schedule(elapse, [this, id, sequence, elapse]() -> void
+  {
+    this->fire(id, sequence, elapse);
+  });
+
+  m_wheel.schedule(0, fn); // the leading call
+}
+
+void Debouncer::fire(const ulongptr id, const uint64 sequence, const ulong elapse)
+{
+  std::function<void()> fn;
+
+  {
+    std::lock_guard<std::mutex> lg(m_mutex);
+
+    auto it = m_entries.find(id);
+    if (it == m_entries.end() || it->second.sequence != sequence)
+    {
+      return;
+    }
+
+    auto& entry = it->second;
+
+    if (entry.throttling && entry.pending)
+    {
+      // the trailing call then a new throttling window
+
+      fn = std::move(entry.fn);
+      entry.fn = nullptr;
+      entry.pending = false;
+      entry.timer = m_wheel.schedule(elapse, [this, id, sequence, elapse]() -> void
+      {
+        this->fire(id, sequence, elapse);
+      });
+    }
+    else
+    {
+      fn = std::move(entry.fn);
+      m_entries.erase(it);
+    }
+  }
+
+  if (fn != nullptr)
+  {
+    fn();
+  }
 }
 
-} // namespace vu
\ No newline at end of file
+} // namespace vu
@@ -116,29 +116,17 @@ bool vuapi read_file_binary_W(const std::wstring& file_path, std::vector<byte>&
 {
   data.clear();
 
-  FILE* file = nullptr;
-  _wfopen_s(&file, file_path.c_str(), L"rb");
-  if (file == nullptr)
+  FileViewW file_view(file_path);
+  if (!file_view.ready())
   {
     return false;
   }
 
-  fseek(file, 0, SEEK_END);
-  size_t file_size = ftell(file);
-  fseek(file, 0, SEEK_SET);
-
-  if (data.empty() || data.size() > file_size)
-  {
-    data.resize(file_size);
-  }
-
-  std::fill(data.begin(), data.end(), 0);
+  // copy once from the view, no zero-filling before reading
 
-  size_t read_bytes = fread(&data[0], 1, data.size(), file);
+  data.assign(file_view.data(), file_view.data() + file_view.size());
 
-  fclose(file);
-
-  return read_bytes == data.size();
+  return true;
 }
 
 std::unique_ptr<std::vector<vu::byte>> vuapi read_file_binary_A(const std::string& file_path)
@@ -930,6 +918,453 @@ std::wostream& operator<<(std::wostream& os, PathW& Path)
   return os;
 }
 
+/**
+ * PathPoolT
+ */
+
+template <typename CharT>
+static inline bool path_pool_is_separator(const CharT c)
+{
+  return c == CharT('\\') || c == CharT('/');
+}
+
+template <typename CharT>
+static inline CharT path_pool_fold(const CharT c)
+{
+  return c >= CharT('A') && c <= CharT('Z') ? CharT(c + ('a' - 'A')) : c;
+}
+
+static inline uint32 path_pool_node_hash(const uint32 parent, const uint32 component)
+{
+  uint32 result = parent * 0x9E3779B1U ^ component * 0x85EBCA77U;
+  result ^= result >> 15;
+  return result;
+}
+
+template <class StringT>
+const typename PathPoolT<StringT>::id_t PathPoolT<StringT>::root;
+
+template <class StringT>
+PathPoolT<StringT>::PathPoolT(const path_separator separator) : m_separator(separator)
+{
+  this->clear();
+}
+
+template <class StringT>
+PathPoolT<StringT>::~PathPoolT()
+{
+}
+
+template <class StringT>
+void PathPoolT<StringT>::clear()
+{
+  m_chars.clear();
+
+  m_components.clear();
+  Component component = { 0, 0, 0, CK_NAME };
+  m_components.push_back(component);
+  m_component_table.assign(64, 0);
+
+  m_nodes.clear();
+  Node node = { root, 0, 0 };
+  m_nodes.push_back(node);
+  m_node_table.assign(64, 0);
+}
+
+template <class StringT>
+path_separator PathPoolT<StringT>::separator() const
+{
+  return m_separator;
+}
+
+template <class StringT>
+size_t PathPoolT<StringT>::size() const
+{
+  return m_nodes.size() - 1;
+}
+
+template <class StringT>
+uint32 PathPoolT<StringT>::hash(const char_type* ptr, const size_t length) const // FNV-1a
+{
+  uint32 result = 2166136261U;
+
+  for (size_t i = 0; i < length; i++)
+  {
+    const auto c = m_separator == path_separator::WIN ? path_pool_fold(ptr[i]) : ptr[i];
+    result ^= uint32(c);
+    result *= 16777619U;
+  }
+
+  return result;
+}
+
+template <class StringT>
+bool PathPoolT<StringT>::equal(const Component& component, const char_type* ptr, const size_t length) const
+{
+  if (component.length != length)
+  {
+    return false;
+  }
+
+  const char_type* ptr_component = m_chars.data() + component.offset;
+
+  for (size_t i = 0; i < length; i++)
+  {
+    if (m_separator == path_separator::WIN ?
+      path_pool_fold(ptr_component[i]) != path_pool_fold(ptr[i]) : ptr_component[i] != ptr[i])
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <class StringT>
+void PathPoolT<StringT>::rehash_components()
+{
+  m_component_table.assign(m_component_table.size() * 2, 0);
+
+  const size_t mask = m_component_table.size() - 1;
+
+  for (id_t id = 1; id < id_t(m_components.size()); id++)
+  {
+    size_t i = m_components[id].hash & mask;
+    while (m_component_table[i] != 0)
+    {
+      i = (i + 1) & mask;
+    }
+
+    m_component_table[i] = id;
+  }
+}
+
+template <class StringT>
+void PathPoolT<StringT>::rehash_nodes()
+{
+  m_node_table.assign(m_node_table.size() * 2, 0);
+
+  const size_t mask = m_node_table.size() - 1;
+
+  for (id_t id = 1; id < id_t(m_nodes.size()); id++)
+  {
+    size_t i = path_pool_node_hash(m_nodes[id].parent, m_nodes[id].component) & mask;
+    while (m_node_table[i] != 0)
+    {
+      i = (i + 1) & mask;
+    }
+
+    m_node_table[i] = id;
+  }
+}
+
+template <class StringT>
+typename PathPoolT<StringT>::id_t PathPoolT<StringT>::intern_component(
+  const char_type* ptr, const size_t length, const component_kind kind)
+{
+  const uint32 h = this->hash(ptr, length);
+
+  size_t mask = m_component_table.size() - 1;
+  size_t i = h & mask;
+
+  for (; m_component_table[i] != 0; i = (i + 1) & mask)
+  {
+    const id_t id = m_component_table[i];
+    const auto& component = m_components[id];
+    if (component.hash == h && this->equal(component, ptr, length))
+    {
+      return id;
+    }
+  }
+
+  // keep the load factor under a half
+
+  if ((m_components.size() + 1) * 2 > m_component_table.size())
+  {
+    this->rehash_components();
+
+    mask = m_component_table.size() - 1;
+    for (i = h & mask; m_component_table[i] != 0; i = (i + 1) & mask);
+  }
+
+  const id_t id = id_t(m_components.size());
+
+  Component component = { m_chars.size(), uint32(length), h, kind };
+  m_chars.append(ptr, length);
+  m_components.push_back(component);
+  m_component_table[i] = id;
+
+  return id;
+}
+
+template <class StringT>
+typename PathPoolT<StringT>::id_t PathPoolT<StringT>::child(const id_t id, const id_t component_id)
+{
+  const uint32 h = path_pool_node_hash(id, component_id);
+
+  size_t mask = m_node_table.size() - 1;
+  size_t i = h & mask;
+
+  for (; m_node_table[i] != 0; i = (i + 1) & mask)
+  {
+    const auto& node = m_nodes[m_node_table[i]];
+    if (node.parent == id && node.component == component_id)
+    {
+      return m_node_table[i];
+    }
+  }
+
+  if ((m_nodes.size() + 1) * 2 > m_node_table.size())
+  {
+    this->rehash_nodes();
+
+    mask = m_node_table.size() - 1;
+    for (i = h & mask; m_node_table[i] != 0; i = (i + 1) & mask);
+  }
+
+  const id_t result = id_t(m_nodes.size());
+
+  Node node = { id, component_id, m_nodes[id].depth + 1 };
+  m_nodes.push_back(node);
+  m_node_table[i] = result;
+
+  return result;
+}
+
+template <class StringT>
+typename PathPoolT<StringT>::id_t PathPoolT<StringT>::child(
+  const id_t id, const char_type* ptr, const size_t length)
+{
+  if (length == 1 && ptr[0] == char_type('.'))
+  {
+    return id;
+  }
+
+  auto kind = CK_NAME;
+
+  if (length == 2 && ptr[0] == char_type('.') && ptr[1] == char_type('.'))
+  {
+    if (id != root)
+    {
+      switch (m_components[m_nodes[id].component].kind)
+      {
+      case CK_NAME:
+        return m_nodes[id].parent;
+      case CK_ROOT:
+        return id; // could not go above the root
+      default:
+        break;
+      }
+    }
+
+    kind = CK_PARENT;
+  }
+
+  return this->child(id, this->intern_component(ptr, length, kind));
+}
+
+template <class StringT>
+typename PathPoolT<StringT>::id_t PathPoolT<StringT>::intern(const StringT& path)
+{
+  return this->join(root, path.data(), path.length());
+}
+
+template <class StringT>
+typename PathPoolT<StringT>::id_t PathPoolT<StringT>::join(const id_t id, const StringT& path)
+{
+  return this->join(id, path.data(), path.length());
+}
+
+template <class StringT>
+typename PathPoolT<StringT>::id_t PathPoolT<StringT>::join(
+  const id_t id, const char_type* ptr, const size_t length)
+{
+  id_t result = id;
+  size_t i = 0;
+
+  const auto sep = m_separator == path_separator::WIN ? char_type('\\') : char_type('/');
+
+  // an absolute path replaces the current one from its root (`\`, `\\` (UNC), `/` or `X:\`)
+
+  if (length != 0 && path_pool_is_separator(ptr[0]))
+  {
+    for (i = 1; i < length && path_pool_is_separator(ptr[i]); i++);
+
+    const char_type prefix[] = { sep, sep };
+    const bool unc = m_separator == path_separator::WIN && i > 1;
+    result = this->child(root, this->intern_component(prefix, unc ? 2 : 1, CK_ROOT));
+  }
+  else if (m_separator == path_separator::WIN && length >= 2 && ptr[1] == char_type(':') &&
+    path_pool_fold(ptr[0]) >= char_type('a') && path_pool_fold(ptr[0]) <= char_type('z') &&
+    (length == 2 || path_pool_is_separator(ptr[2])))
+  {
+    const char_type prefix[] = { ptr[0], char_type(':'), sep };
+    result = this->child(root, this->intern_component(prefix, 3, CK_ROOT));
+    i = 2;
+  }
+
+  while (i < length)
+  {
+    for (; i < length && path_pool_is_separator(ptr[i]); i++);
+
+    size_t j = i;
+    for (; j < length && !path_pool_is_separator(ptr[j]); j++);
+
+    if (j > i)
+    {
+      result = this->child(result, ptr + i, j - i);
+    }
+
+    i = j;
+  }
+
+  return result;
+}
+
+template <class StringT>
+typename PathPoolT<StringT>::id_t PathPoolT<StringT>::join(const id_t id, const id_t relative_id)
+{
+  if (relative_id == root)
+  {
+    return id;
+  }
+
+  if (this->is_absolute(relative_id))
+  {
+    return relative_id;
+  }
+
+  // replay the components from the top, the ancestors are found by walking up to stay allocation-free
+
+  id_t result = id;
+
+  const size_t n = this->depth(relative_id);
+  for (size_t level = 1; level <= n; level++)
+  {
+    id_t component_id = relative_id;
+    for (size_t k = n; k > level; k--)
+    {
+      component_id = m_nodes[component_id].parent;
+    }
+
+    size_t length = 0;
+    auto ptr = this->name(component_id, length);
+    result = this->child(result, ptr, length);
+  }
+
+  return result;
+}
+
+template <class StringT>
+typename PathPoolT<StringT>::id_t PathPoolT<StringT>::parent(const id_t id) const
+{
+  return m_nodes[id].parent;
+}
+
+template <class StringT>
+size_t PathPoolT<StringT>::depth(const id_t id) const
+{
+  return m_nodes[id].depth;
+}
+
+template <class StringT>
+const typename PathPoolT<StringT>::char_type* PathPoolT<StringT>::name(const id_t id, size_t& length) const
+{
+  const auto& component = m_components[m_nodes[id].component];
+  length = component.length;
+  return m_chars.data() + component.offset;
+}
+
+template <class StringT>
+StringT PathPoolT<StringT>::name(const id_t id) const
+{
+  size_t length = 0;
+  auto ptr = this->name(id, length);
+  return StringT(ptr, length);
+}
+
+template <class StringT>
+bool PathPoolT<StringT>::is_absolute(const id_t id) const
+{
+  id_t top = id;
+  while (top != root && m_nodes[top].parent != root)
+  {
+    top = m_nodes[top].parent;
+  }
+
+  return top != root && m_components[m_nodes[top].component].kind == CK_ROOT;
+}
+
+template <class StringT>
+bool PathPoolT<StringT>::is_ancestor(const id_t ancestor_id, const id_t id) const
+{
+  id_t result = id;
+  while (m_nodes[result].depth > m_nodes[ancestor_id].depth)
+  {
+    result = m_nodes[result].parent;
+  }
+
+  return result == ancestor_id;
+}
+
+template <class StringT>
+void PathPoolT<StringT>::components(const id_t id, std::vector<id_t>& ids) const
+{
+  ids.resize(m_nodes[id].depth);
+
+  id_t node_id = id;
+  for (size_t i = ids.size(); i != 0; i--)
+  {
+    ids[i - 1] = node_id;
+    node_id = m_nodes[node_id].parent;
+  }
+}
+
+template <class StringT>
+StringT PathPoolT<StringT>::as_string(const id_t id) const
+{
+  StringT result;
+  this->as_string(id, result);
+  return result;
+}
+
+template <class StringT>
+void PathPoolT<StringT>::as_string(const id_t id, StringT& result) const
+{
+  const auto sep = m_separator == path_separator::WIN ? char_type('\\') : char_type('/');
+
+  // a separator follows every component except the roots (that already end with it)
+
+  auto fn_has_separator = [&](const id_t node_id) -> bool
+  {
+    const id_t parent_id = m_nodes[node_id].parent;
+    return parent_id != root && m_components[m_nodes[parent_id].component].kind != CK_ROOT;
+  };
+
+  size_t length = 0;
+  for (id_t node_id = id; node_id != root; node_id = m_nodes[node_id].parent)
+  {
+    length += m_components[m_nodes[node_id].component].length + (fn_has_separator(node_id) ? 1 : 0);
+  }
+
+  result.resize(length);
+
+  for (id_t node_id = id; node_id != root; node_id = m_nodes[node_id].parent)
+  {
+    const auto& component = m_components[m_nodes[node_id].component];
+    length -= component.length;
+    std::copy_n(m_chars.data() + component.offset, component.length, &result[length]);
+
+    if (fn_has_separator(node_id))
+    {
+      result[--length] = sep;
+    }
+  }
+}
+
+template class PathPoolT<std::string>;
+template class PathPoolT<std::wstring>;
+
 // @refer to https://blog.aaronballman.com/2011/08/how-to-check-access-rights/
 
 bool check_path_permissions_W(const std::wstring& path, ulong generic_access_rights)
@@ -55,6 +55,23 @@ void* vuapi FileMappingX::view(
   return m_ptr_data;
 }
 
+uint64 vuapi FileMappingX::get_file_size_64()
+{
+  if (!this->valid(m_file_handle))
+  {
+    return 0;
+  }
+
+  LARGE_INTEGER size = { 0 };
+  if (GetFileSizeEx(m_file_handle, &size) == FALSE)
+  {
+    m_last_error_code = GetLastError();
+    return 0;
+  }
+
+  return uint64(size.QuadPart);
+}
+
 void vuapi FileMappingX::close()
 {
   if (m_ptr_data != nullptr)
@@ -290,4 +307,533 @@ VUResult vuapi FileMappingW::open(
   return VU_OK;
 }
 
+/**
+ * FileViewX
+ */
+
+static const size_t FILE_VIEW_CHUNK_SIZE = 64 * KiB;    // the chunk size to read the non-mappable files
+static const size_t FILE_VIEW_PREFETCH_SIZE = 32 * MiB; // the max size to prefetch the mapped view
+
+/**
+ * Prefetch the mapped range (like MADV_WILLNEED) by PrefetchVirtualMemory (Windows 8+).
+ */
+
+static void file_view_prefetch(const void* ptr, const size_t size)
+{
+  struct MemoryRangeEntry
+  {
+    PVOID  VirtualAddress;
+    SIZE_T NumberOfBytes;
+  };
+
+  typedef BOOL (WINAPI *PfnPrefetchVirtualMemory)(HANDLE, ULONG_PTR, MemoryRangeEntry*, ULONG);
+
+  static auto pfn = PfnPrefetchVirtualMemory(
+    GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "PrefetchVirtualMemory"));
+  if (pfn == nullptr)
+  {
+    return;
+  }
+
+  MemoryRangeEntry range = { PVOID(ptr), size };
+  pfn(GetCurrentProcess(), 1, &range, 0);
+}
+
+FileViewX::FileViewX() : LastError()
+{
+  m_file_handle = INVALID_HANDLE_VALUE;
+  m_map_handle = nullptr;
+  m_ptr_data = nullptr;
+  m_size = 0;
+}
+
+FileViewX::~FileViewX()
+{
+  this->close();
+}
+
+bool vuapi FileViewX::ready() const
+{
+  return m_file_handle != INVALID_HANDLE_VALUE;
+}
+
+bool vuapi FileViewX::mapped() const
+{
+  return m_map_handle != nullptr;
+}
+
+const byte* vuapi FileViewX::data() const
+{
+  return m_ptr_data;
+}
+
+size_t vuapi FileViewX::size() const
+{
+  return m_size;
+}
+
+void vuapi FileViewX::close()
+{
+  if (m_map_handle != nullptr)
+  {
+    UnmapViewOfFile(m_ptr_data);
+    CloseHandle(m_map_handle);
+    m_map_handle = nullptr;
+  }
+
+  if (m_file_handle != INVALID_HANDLE_VALUE)
+  {
+    CloseHandle(m_file_handle);
+    m_file_handle = INVALID_HANDLE_VALUE;
+  }
+
+  std::vector<byte>().swap(m_data);
+
+  m_ptr_data = nullptr;
+  m_size = 0;
+}
+
+bool vuapi FileViewX::attach(HANDLE file_handle)
+{
+  this->close();
+
+  if (file_handle == INVALID_HANDLE_VALUE)
+  {
+    m_last_error_code = GetLastError();
+    return false;
+  }
+
+  m_file_handle = file_handle;
+
+  // the regular files are mapped as a whole (an empty file could not be mapped)
+
+  LARGE_INTEGER file_size = { 0 };
+
+  if (GetFileType(m_file_handle) == FILE_TYPE_DISK && GetFileSizeEx(m_file_handle, &file_size) != FALSE)
+  {
+    if (file_size.QuadPart == 0)
+    {
+      return true;
+    }
+
+    if (uint64(file_size.QuadPart) <= uint64(SIZE_MAX))
+    {
+      m_map_handle = CreateFileMappingW(m_file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (m_map_handle != nullptr)
+      {
+        m_ptr_data = static_cast<const byte*>(MapViewOfFile(m_map_handle, FILE_MAP_READ, 0, 0, 0));
+        if (m_ptr_data != nullptr)
+        {
+          m_size = size_t(file_size.QuadPart);
+          file_view_prefetch(m_ptr_data, std::min(m_size, FILE_VIEW_PREFETCH_SIZE));
+          return true;
+        }
+
+        CloseHandle(m_map_handle);
+        m_map_handle = nullptr;
+      }
+    }
+  }
+
+  // the others are read in chunks until the end of file (or the write end of the pipe is closed)
+
+  for (;;)
+  {
+    const size_t size = m_data.size();
+    m_data.resize(size + FILE_VIEW_CHUNK_SIZE);
+
+    DWORD read_size = 0;
+    BOOL result = ReadFile(m_file_handle, &m_data[size], DWORD(FILE_VIEW_CHUNK_SIZE), &read_size, nullptr);
+
+    m_data.resize(size + read_size);
+
+    if (result == FALSE)
+    {
+      const ulong error = GetLastError();
+      if (error == ERROR_BROKEN_PIPE || error == ERROR_HANDLE_EOF)
+      {
+        break;
+      }
+
+      m_last_error_code = error;
+      this->close();
+      return false;
+    }
+
+    if (read_size == 0)
+    {
+      break;
+    }
+  }
+
+  m_ptr_data = m_data.data();
+  m_size = m_data.size();
+
+  return true;
+}
+
+/**
+ * FileViewA
+ */
+
+FileViewA::FileViewA() : FileViewX()
+{
+}
+
+FileViewA::FileViewA(const std::string& file_path) : FileViewX()
+{
+  this->open(file_path);
+}
+
+FileViewA::~FileViewA()
+{
+}
+
+bool vuapi FileViewA::open(const std::string& file_path)
+{
+  HANDLE file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  return this->attach(file_handle);
+}
+
+/**
+ * FileViewW
+ */
+
+FileViewW::FileViewW() : FileViewX()
+{
+}
+
+FileViewW::FileViewW(const std::wstring& file_path) : FileViewX()
+{
+  this->open(file_path);
+}
+
+FileViewW::~FileViewW()
+{
+}
+
+bool vuapi FileViewW::open(const std::wstring& file_path)
+{
+  HANDLE file_handle = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  return this->attach(file_handle);
+}
+
+/**
+ * FileCursorX
+ */
+
+static const size_t FILE_CURSOR_NONE = size_t(-1);
+
+FileCursorX::FileCursorX(const size_t window_size, const size_t max_windows) : LastError()
+{
+  SYSTEM_INFO si = { 0 };
+  GetSystemInfo(&si);
+
+  // the window offsets must be aligned to the allocation granularity
+
+  const size_t granularity = si.dwAllocationGranularity != 0 ? si.dwAllocationGranularity : 64 * KiB;
+
+  m_file_handle = INVALID_HANDLE_VALUE;
+  m_map_handle = nullptr;
+  m_size = 0;
+  m_window_size = std::max(granularity, (window_size + granularity - 1) / granularity * granularity);
+  m_max_windows = std::max(max_windows, size_t(1));
+  m_last_window = FILE_CURSOR_NONE;
+  m_tick = 0;
+
+  m_windows.reserve(m_max_windows);
+}
+
+FileCursorX::~FileCursorX()
+{
+  this->close();
+}
+
+bool vuapi FileCursorX::ready() const
+{
+  return m_file_handle != INVALID_HANDLE_VALUE;
+}
+
+uint64 vuapi FileCursorX::size() const
+{
+  return m_size;
+}
+
+size_t vuapi FileCursorX::window_size() const
+{
+  return m_window_size;
+}
+
+void vuapi FileCursorX::close()
+{
+  for (const auto& window : m_windows)
+  {
+    UnmapViewOfFile(window.ptr);
+  }
+
+  m_windows.clear();
+  m_last_window = FILE_CURSOR_NONE;
+
+  if (m_map_handle != nullptr)
+  {
+    CloseHandle(m_map_handle);
+    m_map_handle = nullptr;
+  }
+
+  if (m_file_handle != INVALID_HANDLE_VALUE)
+  {
+    CloseHandle(m_file_handle);
+    m_file_handle = INVALID_HANDLE_VALUE;
+  }
+
+  m_size = 0;
+}
+
+bool vuapi FileCursorX::attach(HANDLE file_handle)
+{
+  this->close();
+
+  if (file_handle == INVALID_HANDLE_VALUE)
+  {
+    m_last_error_code = GetLastError();
+    return false;
+  }
+
+  m_file_handle = file_handle;
+
+  LARGE_INTEGER file_size = { 0 };
+  if (GetFileSizeEx(m_file_handle, &file_size) == FALSE)
+  {
+    m_last_error_code = GetLastError();
+    this->close();
+    return false;
+  }
+
+  m_size = uint64(file_size.QuadPart);
+
+  if (m_size == 0) // an empty file could not be mapped
+  {
+    return true;
+  }
+
+  m_map_handle = CreateFileMappingW(m_file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (m_map_handle == nullptr)
+  {
+    m_last_error_code = GetLastError();
+    this->close();
+    return false;
+  }
+
+  return true;
+}
+
+size_t FileCursorX::map_window(const uint64 offset)
+{
+  // unmap the least recently used window to keep under the budget
+
+  if (m_windows.size() >= m_max_windows)
+  {
+    auto it = std::min_element(m_windows.begin(), m_windows.end(),
+      [](const Window& a, const Window& b) { return a.tick < b.tick; });
+    UnmapViewOfFile(it->ptr);
+    m_windows.erase(it);
+    m_last_window = FILE_CURSOR_NONE;
+  }
+
+  const size_t size = size_t(std::min(uint64(m_window_size), m_size - offset));
+
+  auto ptr = MapViewOfFile(m_map_handle, FILE_MAP_READ, DWORD(offset >> 32), DWORD(offset), size);
+  if (ptr == nullptr)
+  {
+    m_last_error_code = GetLastError();
+    return FILE_CURSOR_NONE;
+  }
+
+  Window window = { offset, static_cast<const byte*>(ptr), size, ++m_tick };
+  m_windows.push_back(window);
+
+  return m_windows.size() - 1;
+}
+
+size_t FileCursorX::find_window(const uint64 offset)
+{
+  if (m_map_handle == nullptr || offset >= m_size)
+  {
+    return FILE_CURSOR_NONE;
+  }
+
+  const uint64 window_offset = offset - offset % m_window_size;
+
+  if (m_last_window != FILE_CURSOR_NONE && m_windows[m_last_window].offset == window_offset)
+  {
+    return m_last_window;
+  }
+
+  const uint64 previous_offset = m_last_window != FILE_CURSOR_NONE ? m_windows[m_last_window].offset : 0;
+  const bool sequential = m_last_window != FILE_CURSOR_NONE && previous_offset + m_window_size == window_offset;
+
+  size_t index = FILE_CURSOR_NONE;
+
+  for (size_t i = 0; i < m_windows.size(); i++)
+  {
+    if (m_windows[i].offset == window_offset)
+    {
+      m_windows[i].tick = ++m_tick;
+      index = i;
+      break;
+    }
+  }
+
+  if (index == FILE_CURSOR_NONE)
+  {
+    index = this->map_window(window_offset);
+    if (index == FILE_CURSOR_NONE)
+    {
+      return FILE_CURSOR_NONE;
+    }
+  }
+
+  // map and prefetch the next window ahead of the sequential access
+
+  const uint64 next_offset = window_offset + m_window_size;
+
+  if (sequential && m_max_windows > 1 && next_offset < m_size)
+  {
+    const bool mapped = std::any_of(m_windows.cbegin(), m_windows.cend(),
+      [&](const Window& window) { return window.offset == next_offset; });
+    if (!mapped)
+    {
+      const size_t next = this->map_window(next_offset);
+      if (next != FILE_CURSOR_NONE)
+      {
+        file_view_prefetch(m_windows[next].ptr, m_windows[next].size);
+      }
+
+      // the current window is the most recent but one, so it is kept, but its index may be changed
+
+      for (size_t i = 0; i < m_windows.size(); i++)
+      {
+        if (m_windows[i].offset == window_offset)
+        {
+          index = i;
+          break;
+        }
+      }
+    }
+  }
+
+  m_last_window = index;
+
+  return index;
+}
+
+const byte* vuapi FileCursorX::view(const uint64 offset, size_t& available_size)
+{
+  available_size = 0;
+
+  const size_t index = this->find_window(offset);
+  if (index == FILE_CURSOR_NONE)
+  {
+    return nullptr;
+  }
+
+  const auto& window = m_windows[index];
+  const size_t delta = size_t(offset - window.offset);
+
+  available_size = window.size - delta;
+
+  return window.ptr + delta;
+}
+
+size_t vuapi FileCursorX::read(const uint64 offset, void* ptr_buffer, const size_t size)
+{
+  auto ptr = static_cast<byte*>(ptr_buffer);
+
+  size_t read_size = 0;
+
+  while (read_size < size)
+  {
+    size_t available_size = 0;
+    auto ptr_view = this->view(offset + read_size, available_size);
+    if (ptr_view == nullptr)
+    {
+      break;
+    }
+
+    const size_t n = std::min(available_size, size - read_size);
+    memcpy(ptr + read_size, ptr_view, n);
+    read_size += n;
+  }
+
+  return read_size;
+}
+
+bool vuapi FileCursorX::at(const uint64 offset, byte& value)
+{
+  size_t available_size = 0;
+  auto ptr = this->view(offset, available_size);
+  if (ptr == nullptr)
+  {
+    return false;
+  }
+
+  value = *ptr;
+
+  return true;
+}
+
+/**
+ * FileCursorA
+ */
+
+FileCursorA::FileCursorA(const size_t window_size, const size_t max_windows)
+  : FileCursorX(window_size, max_windows)
+{
+}
+
+FileCursorA::FileCursorA(const std::string& file_path, const size_t window_size, const size_t max_windows)
+  : FileCursorX(window_size, max_windows)
+{
+  this->open(file_path);
+}
+
+FileCursorA::~FileCursorA()
+{
+}
+
+bool vuapi FileCursorA::open(const std::string& file_path)
+{
+  HANDLE file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  return this->attach(file_handle);
+}
+
+/**
+ * FileCursorW
+ */
+
+FileCursorW::FileCursorW(const size_t window_size, const size_t max_windows)
+  : FileCursorX(window_size, max_windows)
+{
+}
+
+FileCursorW::FileCursorW(const std::wstring& file_path, const size_t window_size, const size_t max_windows)
+  : FileCursorX(window_size, max_windows)
+{
+  this->open(file_path);
+}
+
+FileCursorW::~FileCursorW()
+{
+}
+
+bool vuapi FileCursorW::open(const std::wstring& file_path)
+{
+  HANDLE file_handle = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  return this->attach(file_handle);
+}
+
 } // namespace vu
\ No newline at end of file
@@ -5,19 +5,173 @@
  */
 
 #include "Vutils.h"
+#include "crisec.h"
 
 #include <cassert>
+#include <deque>
 
 namespace vu
 {
 
 static const size_t WIDE_CHAR_SIZE = sizeof(wchar);
 
-FileSystemX::FileSystemX() : LastError()
+static const size_t FS_MAX_CHUNK_SIZE = 1 << 30; // the max size per ReadFile/WriteFile call
+
+static_assert(alignof(FileSystemA) >= 4 && alignof(FileSystemW) >= 4,
+  "the pending count of the asynchronous I/O must be naturally aligned");
+
+/**
+ * The per-thread event for the positional transfers. Its low-order bit is set in the OVERLAPPED,
+ * so the completions of these transfers are not queued to the completion port of the handle.
+ */
+
+struct FSEvent
+{
+  FSEvent() : handle(CreateEventW(nullptr, TRUE, FALSE, nullptr)) {}
+  ~FSEvent() { if (handle != nullptr) CloseHandle(handle); }
+  HANDLE handle;
+};
+
+static ulong fs_transfer_at(
+  HANDLE handle, const bool writing, const uint64 offset, void* ptr_buffer, const size_t size, size_t& transferred)
+{
+  static thread_local FSEvent event;
+
+  transferred = 0;
+
+  if (event.handle == nullptr)
+  {
+    return ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  auto ptr = static_cast<byte*>(ptr_buffer);
+
+  while (transferred < size)
+  {
+    const DWORD chunk_size = DWORD(std::min(size - transferred, FS_MAX_CHUNK_SIZE));
+    const uint64 position = offset + transferred;
+
+    OVERLAPPED overlapped = { 0 };
+    overlapped.Offset = DWORD(position);
+    overlapped.OffsetHigh = DWORD(position >> 32);
+    overlapped.hEvent = HANDLE(ULONG_PTR(event.handle) | 1);
+
+    DWORD n = 0;
+
+    BOOL result = writing
+      ? WriteFile(handle, ptr + transferred, chunk_size, &n, &overlapped)
+      : ReadFile(handle, ptr + transferred, chunk_size, &n, &overlapped);
+    if (!result && GetLastError() == ERROR_IO_PENDING)
+    {
+      result = GetOverlappedResult(handle, &overlapped, &n, TRUE);
+    }
+
+    if (!result)
+    {
+      const ulong error = GetLastError();
+      return error == ERROR_HANDLE_EOF ? ERROR_SUCCESS : error;
+    }
+
+    transferred += n;
+
+    if (n == 0) // the end of file
+    {
+      break;
+    }
+  }
+
+  return ERROR_SUCCESS;
+}
+
+static ulong fs_transfer_at(HANDLE handle, const bool writing, const uint64 offset,
+  const std::vector<FileSystemX::IOVector>& buffers, size_t& transferred)
+{
+  transferred = 0;
+
+  for (const auto& buffer : buffers)
+  {
+    size_t n = 0;
+
+    const auto error = fs_transfer_at(handle, writing, offset + transferred, buffer.ptr, buffer.size, n);
+
+    transferred += n;
+
+    if (error != ERROR_SUCCESS)
+    {
+      return error;
+    }
+
+    if (n != buffer.size) // the end of file
+    {
+      break;
+    }
+  }
+
+  return ERROR_SUCCESS;
+}
+
+/**
+ * The asynchronous transfer, it is owned by the system thread pool until it is completed.
+ */
+
+struct FSAsync : public OVERLAPPED
+{
+  HANDLE handle;
+  bool writing;
+  uint64 offset;
+  void* ptr_buffer;
+  size_t size;
+  FileSystemX::fn_io_completion_t fn;
+  std::atomic<uint32>* ptr_pending;
+};
+
+static void fs_async_release(std::atomic<uint32>& pending)
+{
+  if (--pending == 0)
+  {
+    futex_wake(pending, true); // the waiter in wait_async
+  }
+}
+
+static void fs_async_complete(FSAsync* ptr_async, const ulong error, const size_t transferred)
+{
+  if (ptr_async->fn != nullptr)
+  {
+    ptr_async->fn(error, transferred);
+  }
+
+  auto ptr_pending = ptr_async->ptr_pending;
+
+  delete ptr_async;
+
+  fs_async_release(*ptr_pending);
+}
+
+static VOID CALLBACK fs_async_io_callback(
+  PTP_CALLBACK_INSTANCE, PVOID, PVOID ptr_overlapped, ULONG io_result, ULONG_PTR transferred, PTP_IO)
+{
+  auto ptr_async = static_cast<FSAsync*>(static_cast<OVERLAPPED*>(ptr_overlapped));
+  fs_async_complete(ptr_async, io_result == ERROR_HANDLE_EOF ? ERROR_SUCCESS : io_result, size_t(transferred));
+}
+
+static VOID CALLBACK fs_async_work_callback(PTP_CALLBACK_INSTANCE, PVOID context)
+{
+  auto ptr_async = static_cast<FSAsync*>(context);
+
+  size_t transferred = 0;
+  const auto error = fs_transfer_at(
+    ptr_async->handle, ptr_async->writing, ptr_async->offset, ptr_async->ptr_buffer, ptr_async->size, transferred);
+
+  fs_async_complete(ptr_async, error, transferred);
+}
+
+FileSystemX::FileSystemX() : LastError(), m_pending_async(0)
 {
   m_read_size  = 0;
   m_wrote_size = 0;
   m_handle = nullptr;
+  m_overlapped = false;
+  m_ptr_io = nullptr;
 }
 
 FileSystemX::~FileSystemX()
@@ -40,6 +194,17 @@ bool vuapi FileSystemX::ready()
   return this->valid(m_handle);
 }
 
+bool FileSystemX::streamable()
+{
+  if (m_overlapped) // the overlapped handles have no file pointer, only the positional I/O is valid
+  {
+    m_last_error_code = ERROR_INVALID_FUNCTION;
+    return false;
+  }
+
+  return true;
+}
+
 bool vuapi FileSystemX::read(ulong offset, void* ptr_buffer, ulong size, fs_position_at flags)
 {
   if (!this->seek(offset, flags))
@@ -59,6 +224,11 @@ bool vuapi FileSystemX::read(ulong offset, void* ptr_buffer, ulong size, fs_posi
 
 bool vuapi FileSystemX::read(void* ptr_buffer, ulong size)
 {
+  if (!this->streamable())
+  {
+    return false;
+  }
+
   BOOL result = ReadFile(m_handle, ptr_buffer, size, (LPDWORD)&m_read_size, NULL);
   if (!result && size != m_read_size)
   {
@@ -85,6 +255,11 @@ bool vuapi FileSystemX::write(ulong offset, const void* ptr_buffer, ulong size,
 
 bool vuapi FileSystemX::write(const void* ptr_buffer, ulong size)
 {
+  if (!this->streamable())
+  {
+    return false;
+  }
+
   BOOL result = WriteFile(m_handle, ptr_buffer, size, (LPDWORD)&m_wrote_size, NULL);
   if (!result && size != m_wrote_size)
   {
@@ -97,7 +272,7 @@ bool vuapi FileSystemX::write(const void* ptr_buffer, ulong size)
 
 bool vuapi FileSystemX::seek(ulong offset, fs_position_at flags)
 {
-  if (!this->valid(m_handle))
+  if (!this->valid(m_handle) || !this->streamable())
   {
     return false;
   }
@@ -109,6 +284,23 @@ bool vuapi FileSystemX::seek(ulong offset, fs_position_at flags)
   return (result != INVALID_SET_FILE_POINTER);
 }
 
+bool vuapi FileSystemX::seek_64(int64 offset, fs_position_at flags)
+{
+  if (!this->valid(m_handle) || !this->streamable())
+  {
+    return false;
+  }
+
+  LARGE_INTEGER distance = { 0 };
+  distance.QuadPart = offset;
+
+  bool result = SetFilePointerEx(m_handle, distance, nullptr, flags) != FALSE;
+
+  m_last_error_code = GetLastError();
+
+  return result;
+}
+
 ulong vuapi FileSystemX::get_file_size()
 {
   if (!this->valid(m_handle))
@@ -123,6 +315,202 @@ ulong vuapi FileSystemX::get_file_size()
   return result;
 }
 
+uint64 vuapi FileSystemX::get_file_size_64()
+{
+  if (!this->valid(m_handle))
+  {
+    return 0;
+  }
+
+  LARGE_INTEGER size = { 0 };
+  if (GetFileSizeEx(m_handle, &size) == FALSE)
+  {
+    m_last_error_code = GetLastError();
+    return 0;
+  }
+
+  return uint64(size.QuadPart);
+}
+
+bool vuapi FileSystemX::read_at(uint64 offset, void* ptr_buffer, size_t size, size_t* ptr_read_size)
+{
+  size_t read_size = 0;
+
+  const auto error = this->valid(m_handle) ?
+    fs_transfer_at(m_handle, false, offset, ptr_buffer, size, read_size) : ERROR_INVALID_HANDLE;
+
+  if (ptr_read_size != nullptr)
+  {
+    *ptr_read_size = read_size;
+  }
+
+  if (error != ERROR_SUCCESS)
+  {
+    m_last_error_code = error;
+    return false;
+  }
+
+  return true;
+}
+
+bool vuapi FileSystemX::write_at(uint64 offset, const void* ptr_buffer, size_t size, size_t* ptr_wrote_size)
+{
+  size_t wrote_size = 0;
+
+  const auto error = this->valid(m_handle) ?
+    fs_transfer_at(m_handle, true, offset, const_cast<void*>(ptr_buffer), size, wrote_size) : ERROR_INVALID_HANDLE;
+
+  if (ptr_wrote_size != nullptr)
+  {
+    *ptr_wrote_size = wrote_size;
+  }
+
+  if (error != ERROR_SUCCESS)
+  {
+    m_last_error_code = error;
+    return false;
+  }
+
+  return true;
+}
+
+bool vuapi FileSystemX::read_at(uint64 offset, const std::vector<IOVector>& buffers, size_t* ptr_read_size)
+{
+  size_t read_size = 0;
+
+  const auto error = this->valid(m_handle) ?
+    fs_transfer_at(m_handle, false, offset, buffers, read_size) : ERROR_INVALID_HANDLE;
+
+  if (ptr_read_size != nullptr)
+  {
+    *ptr_read_size = read_size;
+  }
+
+  if (error != ERROR_SUCCESS)
+  {
+    m_last_error_code = error;
+    return false;
+  }
+
+  return true;
+}
+
+bool vuapi FileSystemX::write_at(uint64 offset, const std::vector<IOVector>& buffers, size_t* ptr_wrote_size)
+{
+  size_t wrote_size = 0;
+
+  const auto error = this->valid(m_handle) ?
+    fs_transfer_at(m_handle, true, offset, buffers, wrote_size) : ERROR_INVALID_HANDLE;
+
+  if (ptr_wrote_size != nullptr)
+  {
+    *ptr_wrote_size = wrote_size;
+  }
+
+  if (error != ERROR_SUCCESS)
+  {
+    m_last_error_code = error;
+    return false;
+  }
+
+  return true;
+}
+
+bool vuapi FileSystemX::read_async(uint64 offset, void* ptr_buffer, size_t size, fn_io_completion_t fn)
+{
+  return this->submit_async(false, offset, ptr_buffer, size, fn);
+}
+
+bool vuapi FileSystemX::write_async(uint64 offset, const void* ptr_buffer, size_t size, fn_io_completion_t fn)
+{
+  return this->submit_async(true, offset, const_cast<void*>(ptr_buffer), size, fn);
+}
+
+bool FileSystemX::submit_async(
+  bool writing, uint64 offset, void* ptr_buffer, size_t size, fn_io_completion_t& fn)
+{
+  if (!this->valid(m_handle))
+  {
+    m_last_error_code = ERROR_INVALID_HANDLE;
+    return false;
+  }
+
+  std::unique_ptr<FSAsync> ptr_async(new FSAsync);
+  ZeroMemory(static_cast<OVERLAPPED*>(ptr_async.get()), sizeof(OVERLAPPED));
+  ptr_async->Offset = DWORD(offset);
+  ptr_async->OffsetHigh = DWORD(offset >> 32);
+  ptr_async->handle = m_handle;
+  ptr_async->writing = writing;
+  ptr_async->offset = offset;
+  ptr_async->ptr_buffer = ptr_buffer;
+  ptr_async->size = size;
+  ptr_async->fn = std::move(fn);
+  ptr_async->ptr_pending = &m_pending_async;
+
+  m_pending_async++;
+
+  // the overlapped handle is bound to the completion port of the system thread pool
+
+  if (m_ptr_io != nullptr && size <= MAXDWORD)
+  {
+    auto ptr_io = PTP_IO(m_ptr_io);
+
+    StartThreadpoolIo(ptr_io);
+
+    BOOL result = writing
+      ? WriteFile(m_handle, ptr_buffer, DWORD(size), nullptr, ptr_async.get())
+      : ReadFile(m_handle, ptr_buffer, DWORD(size), nullptr, ptr_async.get());
+    if (!result && GetLastError() != ERROR_IO_PENDING)
+    {
+      const ulong error = GetLastError();
+
+      CancelThreadpoolIo(ptr_io);
+
+      if (error == ERROR_HANDLE_EOF)
+      {
+        fs_async_complete(ptr_async.release(), ERROR_SUCCESS, 0);
+        return true;
+      }
+
+      fs_async_release(m_pending_async);
+      m_last_error_code = error;
+      return false;
+    }
+
+    ptr_async.release(); // it is released by the completion callback
+
+    return true;
+  }
+
+  // otherwise the positional transfer is queued to the system thread pool
+
+  if (TrySubmitThreadpoolCallback(fs_async_work_callback, ptr_async.get(), nullptr) == FALSE)
+  {
+    const ulong error = GetLastError();
+    fs_async_release(m_pending_async);
+    m_last_error_code = error;
+    return false;
+  }
+
+  ptr_async.release(); // it is released by the work callback
+
+  return true;
+}
+
+void vuapi FileSystemX::wait_async()
+{
+  for (;;)
+  {
+    const auto pending = m_pending_async.load();
+    if (pending == 0)
+    {
+      break;
+    }
+
+    futex_wait(m_pending_async, pending, INFINITE);
+  }
+}
+
 bool vuapi FileSystemX::io_control(
   ulong code, void* ptr_send_buffer, ulong send_size, void* ptr_recv_buffer, ulong recv_size)
 {
@@ -146,6 +534,15 @@ bool vuapi FileSystemX::io_control(
 
 bool vuapi FileSystemX::close()
 {
+  this->wait_async();
+
+  if (m_ptr_io != nullptr)
+  {
+    WaitForThreadpoolIoCallbacks(PTP_IO(m_ptr_io), FALSE);
+    CloseThreadpoolIo(PTP_IO(m_ptr_io));
+    m_ptr_io = nullptr;
+  }
+
   if (!this->valid(m_handle))
   {
     return false;
@@ -163,19 +560,442 @@ bool vuapi FileSystemX::close()
 
 std::unique_ptr<Buffer> vuapi FileSystemX::read_as_buffer()
 {
-  auto size = this->get_file_size();
-  if (size == 0)
+  auto size = this->get_file_size_64();
+  if (size == 0 || size > uint64(SIZE_MAX))
   {
     return nullptr;
   }
 
-  std::unique_ptr<Buffer> buffer(new Buffer(size));
+  std::unique_ptr<Buffer> buffer(new Buffer(size_t(size)));
 
-  this->read(0, buffer->pointer(), size, fs_position_at::PA_BEGIN);
+  this->read_at(0, buffer->pointer(), size_t(size));
 
   return buffer;
 }
 
+/**
+ * The recursive walker
+ */
+
+#ifndef FIND_FIRST_EX_LARGE_FETCH
+#define FIND_FIRST_EX_LARGE_FETCH 0x00000002
+#endif // FIND_FIRST_EX_LARGE_FETCH
+
+static inline HANDLE fs_find_first(const std::string& pattern, WIN32_FIND_DATAA& wfd)
+{
+  return FindFirstFileExA(
+    pattern.c_str(), FindExInfoBasic, &wfd, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+}
+
+static inline HANDLE fs_find_first(const std::wstring& pattern, WIN32_FIND_DATAW& wfd)
+{
+  return FindFirstFileExW(
+    pattern.c_str(), FindExInfoBasic, &wfd, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+}
+
+static inline BOOL fs_find_next(HANDLE hfind, WIN32_FIND_DATAA& wfd)
+{
+  return FindNextFileA(hfind, &wfd);
+}
+
+static inline BOOL fs_find_next(HANDLE hfind, WIN32_FIND_DATAW& wfd)
+{
+  return FindNextFileW(hfind, &wfd);
+}
+
+static inline std::wstring fs_wide_path(const std::string& path)
+{
+  return to_string_W(path);
+}
+
+static inline const std::wstring& fs_wide_path(const std::wstring& path)
+{
+  return path;
+}
+
+template <typename CharT>
+static inline CharT fs_fold(const CharT c)
+{
+  return c >= CharT('A') && c <= CharT('Z') ? CharT(c + ('a' - 'A')) : c;
+}
+
+/**
+ * Match a name with a wildcard pattern (`*` and `?`), case-insensitive as the file system.
+ */
+
+template <typename CharT>
+static bool fs_wildcard_match(const CharT* pattern, const CharT* name)
+{
+  const CharT* ptr_star_pattern = nullptr;
+  const CharT* ptr_star_name = nullptr;
+
+  while (*name != CharT(0))
+  {
+    if (*pattern == CharT('*'))
+    {
+      ptr_star_pattern = ++pattern;
+      ptr_star_name = name;
+    }
+    else if (*pattern == CharT('?') || (*pattern != CharT(0) && fs_fold(*pattern) == fs_fold(*name)))
+    {
+      pattern++;
+      name++;
+    }
+    else if (ptr_star_pattern != nullptr)
+    {
+      pattern = ptr_star_pattern;
+      name = ++ptr_star_name;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  while (*pattern == CharT('*'))
+  {
+    pattern++;
+  }
+
+  return *pattern == CharT(0);
+}
+
+/**
+ * The identity (the volume serial number and the file index) of a directory to visit it once.
+ */
+
+static bool fs_directory_identity(const std::wstring& path, std::pair<uint64, uint64>& identity)
+{
+  HANDLE hfile = CreateFileW(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+    nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+  if (hfile == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  BY_HANDLE_FILE_INFORMATION info = { 0 };
+  bool result = GetFileInformationByHandle(hfile, &info) != FALSE;
+
+  CloseHandle(hfile);
+
+  identity.first  = info.dwVolumeSerialNumber;
+  identity.second = (uint64(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+
+  return result;
+}
+
+template <class StringT, class FSObjectT, class FSWalkOptionsT, class FindDataT>
+class FSWalker
+{
+public:
+  typedef typename StringT::value_type CharT;
+  typedef std::function<bool(const std::vector<FSObjectT>& batch)> fn_callback_t;
+
+  FSWalker(const FSWalkOptionsT& options, const fn_callback_t& fn_callback)
+    : m_options(options), m_fn_callback(fn_callback), m_n_queues(0)
+    , m_pending(0), m_queued(0), m_stop(false), m_root_failed(false)
+  {
+    if (m_options.batch_size == 0)
+    {
+      m_options.batch_size = 1;
+    }
+  }
+
+  bool run(const StringT& path)
+  {
+    auto directory = path;
+    if (directory.empty())
+    {
+      return false;
+    }
+
+    if (directory.back() != CharT('\\') && directory.back() != CharT('/'))
+    {
+      directory += CharT('\\');
+    }
+
+    m_n_queues = m_options.n_threads;
+    if (m_n_queues == 0)
+    {
+      m_n_queues = std::max(size_t(std::thread::hardware_concurrency()), size_t(1));
+    }
+
+    m_queues.reset(new Queue[m_n_queues]);
+
+    if (m_options.link_policy == fs_link_policy::LP_FOLLOW)
+    {
+      this->first_visit(directory, true);
+    }
+
+    Task task = { std::move(directory), 0 };
+    this->push(0, std::move(task));
+
+    ThreadPool pool(m_n_queues);
+
+    for (size_t i = 0; i < m_n_queues; i++)
+    {
+      pool.add_task([this, i]() { this->worker(i); });
+    }
+
+    pool.launch();
+
+    return !m_root_failed;
+  }
+
+private:
+  struct Task
+  {
+    StringT directory;
+    size_t depth;
+  };
+
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void push(const size_t index, Task&& task)
+  {
+    m_pending++;
+
+    {
+      std::lock_guard<std::mutex> lg(m_queues[index].mutex);
+      m_queues[index].tasks.push_back(std::move(task));
+      m_queued++;
+    }
+
+    this->wake(false);
+  }
+
+  void wake(const bool all)
+  {
+    // taken to not lose the wake-up between the check and the wait of an idle worker
+
+    std::lock_guard<std::mutex> lg(m_idle_mutex);
+
+    if (all)
+    {
+      m_idle_cv.notify_all();
+    }
+    else
+    {
+      m_idle_cv.notify_one();
+    }
+  }
+
+  bool pop(const size_t index, Task& task)
+  {
+    // the own queue is processed as a stack (depth-first), the others are stolen from the oldest tasks
+
+    {
+      auto& queue = m_queues[index];
+      std::lock_guard<std::mutex> lg(queue.mutex);
+      if (!queue.tasks.empty())
+      {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        m_queued--;
+        return true;
+      }
+    }
+
+    for (size_t i = 1; i < m_n_queues; i++)
+    {
+      auto& queue = m_queues[(index + i) % m_n_queues];
+      std::lock_guard<std::mutex> lg(queue.mutex);
+      if (!queue.tasks.empty())
+      {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        m_queued--;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void worker(const size_t index)
+  {
+    std::vector<FSObjectT> batch;
+    batch.reserve(m_options.batch_size);
+
+    Task task;
+
+    while (!m_stop)
+    {
+      if (this->pop(index, task))
+      {
+        this->list(index, task, batch);
+
+        if (--m_pending == 0) // after its subdirectories were pushed, so nothing is left to walk
+        {
+          this->wake(true);
+        }
+
+        continue;
+      }
+
+      // park until a directory is pushed, the walk is done or stopped
+
+      std::unique_lock<std::mutex> lock(m_idle_mutex);
+      m_idle_cv.wait(lock, [this]() { return m_queued != 0 || m_pending == 0 || m_stop; });
+
+      if (m_pending == 0)
+      {
+        break;
+      }
+    }
+
+    this->flush(batch);
+  }
+
+  bool accept(const CharT* name) const
+  {
+    if (m_options.patterns.empty())
+    {
+      return true;
+    }
+
+    for (const auto& pattern : m_options.patterns)
+    {
+      if (fs_wildcard_match(pattern.c_str(), name))
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool first_visit(const StringT& directory, const bool unidentified)
+  {
+    std::pair<uint64, uint64> identity;
+    if (!fs_directory_identity(fs_wide_path(directory), identity))
+    {
+      return unidentified;
+    }
+
+    std::lock_guard<std::mutex> lg(m_visited_mutex);
+    return m_visited.insert(identity).second;
+  }
+
+  void list(const size_t index, const Task& task, std::vector<FSObjectT>& batch)
+  {
+    StringT pattern = task.directory;
+    pattern += CharT('*');
+
+    FindDataT wfd;
+
+    HANDLE hfind = fs_find_first(pattern, wfd);
+    if (hfind == INVALID_HANDLE_VALUE)
+    {
+      if (task.depth == 0)
+      {
+        m_root_failed = true;
+      }
+
+      return;
+    }
+
+    do
+    {
+      const CharT* name = wfd.cFileName;
+      if (name[0] == CharT('.') && (name[1] == CharT(0) || (name[1] == CharT('.') && name[2] == CharT(0))))
+      {
+        continue;
+      }
+
+      const bool is_directory = (wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+      const bool is_link = (wfd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+
+      if (is_link && m_options.link_policy == fs_link_policy::LP_SKIP)
+      {
+        continue;
+      }
+
+      if (is_directory)
+      {
+        if (task.depth < m_options.max_depth)
+        {
+          StringT directory = task.directory;
+          directory += name;
+          directory += CharT('\\');
+
+          // when following the links, every directory is recorded, so a directory that is reachable
+          // both directly and through a link (or a link to an ancestor) is walked once
+
+          const bool follow = m_options.link_policy == fs_link_policy::LP_FOLLOW;
+          if (follow ? this->first_visit(directory, !is_link) : !is_link)
+          {
+            Task sub_task = { std::move(directory), task.depth + 1 };
+            this->push(index, std::move(sub_task));
+          }
+        }
+
+        if (!m_options.include_directories)
+        {
+          continue;
+        }
+      }
+
+      if (!this->accept(name))
+      {
+        continue;
+      }
+
+      FSObjectT object;
+      object.directory = task.directory;
+      object.name = name;
+      object.size = is_directory ? 0 : int64((uint64(wfd.nFileSizeHigh) << 32) | wfd.nFileSizeLow);
+      object.attributes = wfd.dwFileAttributes;
+
+      batch.push_back(std::move(object));
+      if (batch.size() >= m_options.batch_size)
+      {
+        this->flush(batch);
+      }
+    } while (!m_stop && fs_find_next(hfind, wfd) != FALSE);
+
+    FindClose(hfind);
+  }
+
+  void flush(std::vector<FSObjectT>& batch)
+  {
+    if (batch.empty())
+    {
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lg(m_callback_mutex);
+      if (!m_stop && !m_fn_callback(batch))
+      {
+        m_stop = true;
+        this->wake(true);
+      }
+    }
+
+    batch.clear();
+  }
+
+private:
+  FSWalkOptionsT m_options;
+  const fn_callback_t& m_fn_callback;
+  std::unique_ptr<Queue[]> m_queues;
+  size_t m_n_queues;
+  std::atomic<size_t> m_pending; // the directories that are queued or being listed
+  std::atomic<size_t> m_queued;  // the directories that are queued
+  std::atomic<bool> m_stop;
+  std::atomic<bool> m_root_failed;
+  std::mutex m_callback_mutex;
+  std::mutex m_visited_mutex;
+  std::set<std::pair<uint64, uint64>> m_visited;
+  std::mutex m_idle_mutex;
+  std::condition_variable m_idle_cv;
+};
+
 // A
 
 FileSystemA::FileSystemA() : FileSystemX()
@@ -211,6 +1031,12 @@ bool vuapi FileSystemA::initialize(
     return false;
   }
 
+  m_overlapped = (fa_flags & FILE_FLAG_OVERLAPPED) != 0;
+  if (m_overlapped)
+  {
+    m_ptr_io = CreateThreadpoolIo(m_handle, fs_async_io_callback, nullptr, nullptr);
+  }
+
   return true;
 }
 
@@ -283,8 +1109,13 @@ std::unique_ptr<Buffer> FileSystemA::quick_read_as_buffer(const std::string& fil
     return nullptr;
   }
 
-  FileSystemA fs(file_path, fs_mode::FM_OPENEXISTING, fs_generic::FG_READ, fs_share::FS_READ);
-  return fs.read_as_buffer();
+  FileViewA file_view(file_path);
+  if (!file_view.ready() || file_view.size() == 0)
+  {
+    return nullptr;
+  }
+
+  return std::unique_ptr<Buffer>(new Buffer(file_view.data(), file_view.size()));
 }
 
 bool FileSystemA::iterate(
@@ -346,6 +1177,15 @@ bool FileSystemA::iterate(
   return true;
 }
 
+bool FileSystemA::walk(
+  const std::string& path,
+  const FSWalkOptionsA& options,
+  const std::function<bool(const std::vector<FSObjectA>& batch)> fn_callback)
+{
+  FSWalker<std::string, FSObjectA, FSWalkOptionsA, WIN32_FIND_DATAA> walker(options, fn_callback);
+  return walker.run(trim_string_A(path));
+}
+
 // W
 
 FileSystemW::FileSystemW() : FileSystemX()
@@ -381,6 +1221,12 @@ bool vuapi FileSystemW::initialize(
     return false;
   }
 
+  m_overlapped = (fa_flags & FILE_FLAG_OVERLAPPED) != 0;
+  if (m_overlapped)
+  {
+    m_ptr_io = CreateThreadpoolIo(m_handle, fs_async_io_callback, nullptr, nullptr);
+  }
+
   return true;
 }
 
@@ -453,8 +1299,13 @@ std::unique_ptr<Buffer> FileSystemW::quick_read_as_buffer(const std::wstring& fi
     return nullptr;
   }
 
-  FileSystemW fs(file_path, fs_mode::FM_OPENEXISTING, fs_generic::FG_READ, fs_share::FS_READ);
-  return fs.read_as_buffer();
+  FileViewW file_view(file_path);
+  if (!file_view.ready() || file_view.size() == 0)
+  {
+    return nullptr;
+  }
+
+  return std::unique_ptr<Buffer>(new Buffer(file_view.data(), file_view.size()));
 }
 
 bool FileSystemW::iterate(
@@ -513,4 +1364,13 @@ bool FileSystemW::iterate(
   return true;
 }
 
+bool FileSystemW::walk(
+  const std::wstring& path,
+  const FSWalkOptionsW& options,
+  const std::function<bool(const std::vector<FSObjectW>& batch)> fn_callback)
+{
+  FSWalker<std::wstring, FSObjectW, FSWalkOptionsW, WIN32_FIND_DATAW> walker(options, fn_callback);
+  return walker.run(trim_string_W(path));
+}
+
 } // namespace vu
\ No newline at end of file
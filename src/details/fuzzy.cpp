@@ -0,0 +1,374 @@
+/**
+ * @file   fuzzy.cpp
+ * @author Vic P.
+ * @brief  Implementation for Fuzzy Index
+ */
+
+#include "Vutils.h"
+
+#include <queue>
+#include <algorithm>
+#include <type_traits>
+
+namespace vu
+{
+
+static const size_t FUZZY_NONE = size_t(-1);
+
+/**
+ * FuzzyScorer - The edit distance from a fixed pattern to any text.
+ * Patterns up to 64 characters use Myers' bit-parallel algorithm (in Hyyrö's formulation for the
+ * global distance), that is O(text) per text. Longer patterns fall back to the two-row DP.
+ */
+
+template <typename CharT>
+class FuzzyScorer
+{
+public:
+  FuzzyScorer(const CharT* ptr, const size_t length) : m_ptr(ptr), m_length(length)
+  {
+    memset(m_peq_small, 0, sizeof(m_peq_small));
+
+    if (m_length == 0 || m_length > 64)
+    {
+      return;
+    }
+
+    for (size_t i = 0; i < m_length; i++)
+    {
+      const uint64 bit = 1ULL << i;
+      const auto c = ptr[i];
+
+      if (is_small(c))
+      {
+        m_peq_small[small(c)] |= bit;
+        continue;
+      }
+
+      auto it = std::find_if(m_peq_large.begin(), m_peq_large.end(),
+        [&](const std::pair<CharT, uint64>& e) { return e.first == c; });
+      if (it != m_peq_large.end())
+      {
+        it->second |= bit;
+      }
+      else
+      {
+        m_peq_large.push_back(std::make_pair(c, bit));
+      }
+    }
+  }
+
+  size_t distance(const CharT* ptr, const size_t length)
+  {
+    if (m_length == 0)
+    {
+      return length;
+    }
+
+    if (length == 0)
+    {
+      return m_length;
+    }
+
+    return m_length <= 64 ? this->myers(ptr, length) : this->two_row(ptr, length);
+  }
+
+private:
+  typedef typename std::make_unsigned<CharT>::type UCharT;
+
+  static bool is_small(const CharT c)
+  {
+    return UCharT(c) < 256;
+  }
+
+  static byte small(const CharT c)
+  {
+    return byte(UCharT(c));
+  }
+
+  uint64 peq(const CharT c) const
+  {
+    if (is_small(c))
+    {
+      return m_peq_small[small(c)];
+    }
+
+    for (const auto& e : m_peq_large)
+    {
+      if (e.first == c)
+      {
+        return e.second;
+      }
+    }
+
+    return 0;
+  }
+
+  size_t myers(const CharT* ptr, const size_t length) const
+  {
+    const uint64 last = 1ULL << (m_length - 1);
+
+    uint64 pv = m_length == 64 ? ~0ULL : (1ULL << m_length) - 1;
+    uint64 mv = 0;
+    size_t score = m_length;
+
+    for (size_t j = 0; j < length; j++)
+    {
+      const uint64 eq = this->peq(ptr[j]);
+      const uint64 xv = eq | mv;
+      const uint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+
+      uint64 ph = mv | ~(xh | pv);
+      uint64 mh = pv & xh;
+
+      if (ph & last)
+      {
+        score++;
+      }
+      else if (mh & last)
+      {
+        score--;
+      }
+
+      ph = (ph << 1) | 1;
+      mh = (mh << 1);
+
+      pv = mh | ~(xv | ph);
+      mv = ph & xv;
+    }
+
+    return score;
+  }
+
+  size_t two_row(const CharT* ptr, const size_t length)
+  {
+    m_row.resize(m_length + 1);
+    for (size_t i = 0; i <= m_length; i++)
+    {
+      m_row[i] = i;
+    }
+
+    for (size_t j = 1; j <= length; j++)
+    {
+      size_t diagonal = m_row[0];
+      m_row[0] = j;
+
+      for (size_t i = 1; i <= m_length; i++)
+      {
+        const size_t above = m_row[i];
+        const size_t cost = m_ptr[i - 1] == ptr[j - 1] ? 0 : 1;
+        m_row[i] = std::min(std::min(m_row[i - 1], above) + 1, diagonal + cost);
+        diagonal = above;
+      }
+    }
+
+    return m_row[m_length];
+  }
+
+private:
+  const CharT* m_ptr;
+  size_t m_length;
+  uint64 m_peq_small[256];
+  std::vector<std::pair<CharT, uint64>> m_peq_large;
+  std::vector<size_t> m_row;
+};
+
+/**
+ * FuzzyIndexT
+ */
+
+template <class StringT>
+FuzzyIndexT<StringT>::FuzzyIndexT()
+{
+}
+
+template <class StringT>
+FuzzyIndexT<StringT>::FuzzyIndexT(const std::vector<StringT>& string_list)
+{
+  this->build(string_list);
+}
+
+template <class StringT>
+FuzzyIndexT<StringT>::~FuzzyIndexT()
+{
+}
+
+template <class StringT>
+void FuzzyIndexT<StringT>::build(const std::vector<StringT>& string_list)
+{
+  this->clear();
+
+  m_strings.reserve(string_list.size());
+  m_nodes.reserve(string_list.size());
+
+  for (const auto& string : string_list)
+  {
+    this->add(string);
+  }
+}
+
+template <class StringT>
+void FuzzyIndexT<StringT>::add(const StringT& string)
+{
+  const size_t index = m_strings.size();
+
+  m_strings.push_back(string);
+
+  Node node = { 0, FUZZY_NONE, FUZZY_NONE };
+  m_nodes.push_back(node);
+
+  if (index == 0)
+  {
+    return;
+  }
+
+  const auto& s = m_strings[index];
+  FuzzyScorer<typename StringT::value_type> scorer(s.data(), s.length());
+
+  size_t parent = 0;
+
+  for (;;)
+  {
+    const auto& t = m_strings[parent];
+    const size_t d = scorer.distance(t.data(), t.length());
+
+    size_t child = m_nodes[parent].first_child;
+    while (child != FUZZY_NONE && m_nodes[child].distance != d)
+    {
+      child = m_nodes[child].next_sibling;
+    }
+
+    if (child == FUZZY_NONE)
+    {
+      m_nodes[index].distance = d;
+      m_nodes[index].next_sibling = m_nodes[parent].first_child;
+      m_nodes[parent].first_child = index;
+      break;
+    }
+
+    parent = child;
+  }
+}
+
+template <class StringT>
+void FuzzyIndexT<StringT>::clear()
+{
+  m_strings.clear();
+  m_nodes.clear();
+}
+
+template <class StringT>
+bool FuzzyIndexT<StringT>::empty() const
+{
+  return m_strings.empty();
+}
+
+template <class StringT>
+size_t FuzzyIndexT<StringT>::size() const
+{
+  return m_strings.size();
+}
+
+template <class StringT>
+const StringT& FuzzyIndexT<StringT>::at(const size_t index) const
+{
+  return m_strings.at(index);
+}
+
+template <class StringT>
+std::vector<typename FuzzyIndexT<StringT>::Match> FuzzyIndexT<StringT>::find(
+  const StringT& string, const size_t k, const size_t max_distance) const
+{
+  std::vector<Match> result;
+
+  if (k == 0 || m_strings.empty())
+  {
+    return result;
+  }
+
+  auto fn_less = [](const Match& a, const Match& b) -> bool
+  {
+    return a.second < b.second || (a.second == b.second && a.first < b.first);
+  };
+
+  // the max-heap of the best matches so far, its top is the worst of them
+
+  std::priority_queue<Match, std::vector<Match>, decltype(fn_less)> best(fn_less);
+
+  FuzzyScorer<typename StringT::value_type> scorer(string.data(), string.length());
+
+  size_t radius = max_distance;
+
+  // the pending nodes with the lower bound of their distances (by the triangle inequality)
+
+  std::vector<std::pair<size_t, size_t>> pending;
+  pending.push_back(std::make_pair(size_t(0), size_t(0)));
+
+  while (!pending.empty())
+  {
+    const auto e = pending.back();
+    pending.pop_back();
+
+    if (e.second > radius)
+    {
+      continue;
+    }
+
+    const auto& t = m_strings[e.first];
+    const size_t d = scorer.distance(t.data(), t.length());
+
+    if (d <= radius)
+    {
+      best.push(Match(e.first, d));
+      if (best.size() > k)
+      {
+        best.pop();
+      }
+
+      if (best.size() == k)
+      {
+        radius = std::min(radius, best.top().second);
+      }
+    }
+
+    for (size_t child = m_nodes[e.first].first_child; child != FUZZY_NONE; child = m_nodes[child].next_sibling)
+    {
+      const size_t edge = m_nodes[child].distance;
+      const size_t lower_bound = edge > d ? edge - d : d - edge;
+      if (lower_bound <= radius)
+      {
+        pending.push_back(std::make_pair(child, lower_bound));
+      }
+    }
+  }
+
+  result.reserve(best.size());
+
+  for (; !best.empty(); best.pop())
+  {
+    result.push_back(best.top());
+  }
+
+  std::reverse(result.begin(), result.end());
+
+  return result;
+}
+
+template <class StringT>
+StringT FuzzyIndexT<StringT>::closest(const StringT& string) const
+{
+  const auto matches = this->find(string, 1);
+  return matches.empty() ? StringT() : m_strings[matches.front().first];
+}
+
+template <class StringT>
+size_t FuzzyIndexT<StringT>::distance(const StringT& a, const StringT& b)
+{
+  FuzzyScorer<typename StringT::value_type> scorer(a.data(), a.length());
+  return scorer.distance(b.data(), b.length());
+}
+
+template class FuzzyIndexT<std::string>;
+template class FuzzyIndexT<std::wstring>;
+
+} // namespace vu
@@ -7,9 +7,10 @@
 #include "Vutils.h"
 
 #ifdef VU_GUID_ENABLED
-#include <rpc.h>
+#include <ntsecapi.h> // RtlGenRandom
+#include <random>
 #if defined(_MSC_VER) || defined(__BCPLUSPLUS__)
-#pragma comment(lib, "rpcrt4.lib")
+#pragma comment(lib, "advapi32.lib")
 #endif
 #endif // VU_GUID_ENABLED
 
@@ -18,18 +19,368 @@ namespace vu
 
 #ifdef VU_GUID_ENABLED
 
-#define NONE
+/**
+ * Per-thread CSPRNG
+ * ChaCha20 keystream (RFC 8439), keyed by the system CSPRNG and re-keyed every MiB of output.
+ */
 
-#ifdef __MINGW32__
-typedef unsigned char __RPC_FAR * RPC_CSTR;
-#if defined(RPC_USE_NATIVE_WCHAR) && defined(_NATIVE_WCHAR_T_DEFINED)
-typedef wchar_t __RPC_FAR * RPC_WSTR;
-typedef const wchar_t * RPC_CWSTR;
-#else
-typedef unsigned short __RPC_FAR * RPC_WSTR;
-typedef const unsigned short * RPC_CWSTR;
-#endif
-#endif
+class GuidRandom
+{
+public:
+  GuidRandom() : m_used(sizeof(m_block)), m_remaining(0), m_secure(false)
+  {
+    memset(m_state, 0, sizeof(m_state));
+    memset(m_block, 0, sizeof(m_block));
+  }
+
+  ~GuidRandom()
+  {
+    SecureZeroMemory(m_state, sizeof(m_state));
+    SecureZeroMemory(m_block, sizeof(m_block));
+  }
+
+  bool fill(void* ptr, size_t size)
+  {
+    auto p = static_cast<byte*>(ptr);
+
+    while (size > 0)
+    {
+      if (m_used == sizeof(m_block))
+      {
+        this->refill();
+      }
+
+      auto block = reinterpret_cast<byte*>(m_block) + m_used;
+      const auto n = std::min(size, sizeof(m_block) - m_used);
+      memcpy(p, block, n);
+      memset(block, 0, n); // the consumed keystream must not stay in memory
+
+      m_used += n;
+      p += n;
+      size -= n;
+    }
+
+    return m_secure;
+  }
+
+private:
+  static uint32 rotl(const uint32 v, const int n)
+  {
+    return (v << n) | (v >> (32 - n));
+  }
+
+  static void quarter_round(uint32* x, const int a, const int b, const int c, const int d)
+  {
+    x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 16);
+    x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 12);
+    x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 8);
+    x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 7);
+  }
+
+  void reseed()
+  {
+    uint32 seed[10] = { 0 }; // 256-bit key and 64-bit nonce
+
+    m_secure = RtlGenRandom(seed, sizeof(seed)) != FALSE;
+    if (!m_secure) // should never happen, but never hand out a fixed sequence
+    {
+      std::random_device device;
+      for (auto& e : seed)
+      {
+        e ^= device();
+      }
+
+      const auto ticks = uint64(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+      seed[0] ^= uint32(ticks);
+      seed[1] ^= uint32(ticks >> 32);
+      seed[2] ^= uint32(GetCurrentThreadId());
+      seed[3] ^= uint32(ulongptr(this));
+    }
+
+    m_state[0] = 0x61707865; // "expand 32-byte k"
+    m_state[1] = 0x3320646E;
+    m_state[2] = 0x79622D32;
+    m_state[3] = 0x6B206574;
+    memcpy(&m_state[4], &seed[0], 8 * sizeof(uint32));
+    m_state[12] = 0;
+    m_state[13] = 0;
+    m_state[14] = seed[8];
+    m_state[15] = seed[9];
+
+    SecureZeroMemory(seed, sizeof(seed));
+
+    m_remaining = (1 << 20) / sizeof(m_block);
+  }
+
+  void refill()
+  {
+    if (m_remaining == 0)
+    {
+      this->reseed();
+    }
+
+    memcpy(m_block, m_state, sizeof(m_block));
+
+    for (int i = 0; i < 10; i++)
+    {
+      quarter_round(m_block, 0, 4,  8, 12);
+      quarter_round(m_block, 1, 5,  9, 13);
+      quarter_round(m_block, 2, 6, 10, 14);
+      quarter_round(m_block, 3, 7, 11, 15);
+      quarter_round(m_block, 0, 5, 10, 15);
+      quarter_round(m_block, 1, 6, 11, 12);
+      quarter_round(m_block, 2, 7,  8, 13);
+      quarter_round(m_block, 3, 4,  9, 14);
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+      m_block[i] += m_state[i];
+    }
+
+    if (++m_state[12] == 0)
+    {
+      m_state[13]++;
+    }
+
+    m_remaining--;
+    m_used = 0;
+  }
+
+private:
+  uint32 m_state[16];
+  uint32 m_block[16];
+  size_t m_used;
+  size_t m_remaining;
+  bool m_secure;
+};
+
+static thread_local GuidRandom g_guid_random;
+
+/**
+ * Canonical (big-endian) byte order
+ */
+
+static void guid_to_bytes(const Guid& guid, byte bytes[16])
+{
+  bytes[0] = byte(guid.data1 >> 24);
+  bytes[1] = byte(guid.data1 >> 16);
+  bytes[2] = byte(guid.data1 >> 8);
+  bytes[3] = byte(guid.data1);
+  bytes[4] = byte(guid.data2 >> 8);
+  bytes[5] = byte(guid.data2);
+  bytes[6] = byte(guid.data3 >> 8);
+  bytes[7] = byte(guid.data3);
+  memcpy(&bytes[8], guid.data4, sizeof(guid.data4));
+}
+
+static void guid_from_bytes(const byte bytes[16], Guid& guid)
+{
+  guid.data1 = (ulong(bytes[0]) << 24) | (ulong(bytes[1]) << 16) | (ulong(bytes[2]) << 8) | ulong(bytes[3]);
+  guid.data2 = ushort((bytes[4] << 8) | bytes[5]);
+  guid.data3 = ushort((bytes[6] << 8) | bytes[7]);
+  memcpy(guid.data4, &bytes[8], sizeof(guid.data4));
+}
+
+static int guid_compare(const Guid& left, const Guid& right)
+{
+  if (left.data1 != right.data1)
+  {
+    return left.data1 < right.data1 ? -1 : 1;
+  }
+
+  if (left.data2 != right.data2)
+  {
+    return left.data2 < right.data2 ? -1 : 1;
+  }
+
+  if (left.data3 != right.data3)
+  {
+    return left.data3 < right.data3 ? -1 : 1;
+  }
+
+  return memcmp(left.data4, right.data4, sizeof(left.data4));
+}
+
+/**
+ * Generation (RFC 9562)
+ */
+
+static bool guid_generate(const int version, Guid& guid)
+{
+  byte bytes[16] = { 0 };
+  bool secure = false;
+
+  if (version == 4)
+  {
+    secure = g_guid_random.fill(bytes, sizeof(bytes));
+    bytes[6] = 0x40 | (bytes[6] & 0x0F);
+    bytes[8] = 0x80 | (bytes[8] & 0x3F);
+  }
+  else if (version == 7)
+  {
+    // unix_ts_ms (48 bits) | ver (4 bits) | counter (12 bits) | var (2 bits) | rand (62 bits)
+    // The counter starts at a random value under 2048 on each new millisecond and is incremented
+    // within the same millisecond. On overflow, or if the clock goes backwards, the timestamp of
+    // the thread is advanced instead, so the identifiers of a thread are strictly increasing.
+
+    static thread_local uint64 last_ms = 0;
+    static thread_local uint32 counter = 0;
+
+    byte random[10] = { 0 };
+    secure = g_guid_random.fill(random, sizeof(random));
+
+    const auto now_ms = uint64(std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count());
+
+    if (now_ms > last_ms)
+    {
+      last_ms = now_ms;
+      counter = ((uint32(random[0]) << 8) | random[1]) & 0x7FF;
+    }
+    else if (++counter > 0xFFF)
+    {
+      last_ms++;
+      counter = ((uint32(random[0]) << 8) | random[1]) & 0x7FF;
+    }
+
+    bytes[0] = byte(last_ms >> 40);
+    bytes[1] = byte(last_ms >> 32);
+    bytes[2] = byte(last_ms >> 24);
+    bytes[3] = byte(last_ms >> 16);
+    bytes[4] = byte(last_ms >> 8);
+    bytes[5] = byte(last_ms);
+    bytes[6] = byte(0x70 | (counter >> 8));
+    bytes[7] = byte(counter);
+    bytes[8] = 0x80 | (random[2] & 0x3F);
+    memcpy(&bytes[9], &random[3], 7);
+  }
+  else
+  {
+    return false;
+  }
+
+  guid_from_bytes(bytes, guid);
+
+  return secure;
+}
+
+/**
+ * Formatting & Parsing
+ */
+
+static inline int hex_digit(uint32 c)
+{
+  if (c - '0' < 10)
+  {
+    return int(c - '0');
+  }
+
+  c |= 0x20; // to lower-case
+
+  if (c - 'a' < 6)
+  {
+    return int(c - 'a' + 10);
+  }
+
+  return -1;
+}
+
+template <typename Char>
+static size_t guid_to_chars(const Guid& guid, Char* buffer, const bool upper)
+{
+  if (buffer == nullptr)
+  {
+    return 0;
+  }
+
+  const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+
+  byte bytes[16];
+  guid_to_bytes(guid, bytes);
+
+  auto p = buffer;
+
+  for (int i = 0; i < 16; i++)
+  {
+    if (i == 4 || i == 6 || i == 8 || i == 10)
+    {
+      *p++ = Char('-');
+    }
+
+    *p++ = Char(digits[bytes[i] >> 4]);
+    *p++ = Char(digits[bytes[i] & 0xF]);
+  }
+
+  return GUIDX::GUID_LENGTH;
+}
+
+template <typename Char>
+static bool guid_from_chars(const Char* text, size_t length, Guid& guid)
+{
+  if (text == nullptr)
+  {
+    return false;
+  }
+
+  if (length == GUIDX::GUID_LENGTH + 2)
+  {
+    if (text[0] != Char('{') || text[length - 1] != Char('}'))
+    {
+      return false;
+    }
+
+    text++;
+    length -= 2;
+  }
+
+  static const byte offsets_dashed[16] = { 0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34 };
+  static const byte offsets_plain[16]  = { 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30 };
+
+  const byte* offsets = nullptr;
+
+  if (length == GUIDX::GUID_LENGTH)
+  {
+    if (text[8] != Char('-') || text[13] != Char('-') || text[18] != Char('-') || text[23] != Char('-'))
+    {
+      return false;
+    }
+
+    offsets = offsets_dashed;
+  }
+  else if (length == 32)
+  {
+    offsets = offsets_plain;
+  }
+  else
+  {
+    return false;
+  }
+
+  byte bytes[16];
+  int invalid = 0;
+
+  for (int i = 0; i < 16; i++)
+  {
+    const auto hi = hex_digit(uint32(text[offsets[i]]));
+    const auto lo = hex_digit(uint32(text[offsets[i] + 1]));
+    invalid |= hi | lo;
+    bytes[i] = byte((uint32(hi) << 4) | uint32(lo));
+  }
+
+  if (invalid < 0)
+  {
+    return false;
+  }
+
+  guid_from_bytes(bytes, guid);
+
+  return true;
+}
+
+/**
+ * Guid
+ */
 
 const Guid& Guid::operator=(const Guid &right) const
 {
@@ -47,22 +398,70 @@ bool Guid::operator != (const Guid &right) const
   return !(*this == right);
 }
 
-#define CAST_GUID(_object, _const) reinterpret_cast<_const ::UUID *> ( _object )
+bool Guid::operator < (const Guid &right) const
+{
+  return guid_compare(*this, right) < 0;
+}
 
-GUIDX::GUIDX(bool create)
+bool Guid::operator > (const Guid &right) const
+{
+  return guid_compare(*this, right) > 0;
+}
+
+bool Guid::operator <= (const Guid &right) const
+{
+  return guid_compare(*this, right) <= 0;
+}
+
+bool Guid::operator >= (const Guid &right) const
+{
+  return guid_compare(*this, right) >= 0;
+}
+
+int Guid::version() const
+{
+  return data3 >> 12;
+}
+
+bool Guid::empty() const
+{
+  static const Guid zero = { 0 };
+  return *this == zero;
+}
+
+size_t GuidHash::operator()(const Guid& guid) const
+{
+  return GUIDX::hash(guid);
+}
+
+/**
+ * GUIDX
+ */
+
+GUIDX::GUIDX(bool create, int version)
 {
   ZeroMemory(&m_guid, sizeof(m_guid));
+  m_status = VU_OK;
   if (create)
   {
-    this->create();
+    this->create(version);
   }
 }
 
 GUIDX::~GUIDX() {}
 
-bool GUIDX::create()
+bool GUIDX::create(int version)
 {
-  return ((m_status = UuidCreate(CAST_GUID(&m_guid, NONE))) == RPC_S_OK);
+  if (version != 4 && version != 7)
+  {
+    m_status = ERROR_INVALID_PARAMETER;
+    return false;
+  }
+
+  const auto secure = guid_generate(version, m_guid);
+  m_status = secure ? VU_OK : ERROR_GEN_FAILURE;
+
+  return secure;
 }
 
 const Guid& GUIDX::GUID() const
@@ -91,48 +490,85 @@ bool GUIDX::operator != (const GUIDX &right) const
   return m_guid != right.m_guid;
 }
 
-void GUIDA::parse(const std::string& guid)
+Guid GUIDX::generate(int version)
 {
-  m_guid = GUIDA::to_guid(guid);
+  Guid result = { 0 };
+  guid_generate(version, result);
+  return result;
 }
 
-std::string GUIDA::as_string() const
+size_t GUIDX::to_chars(const Guid& guid, char* buffer, bool upper)
 {
-  return GUIDA::to_string(m_guid);
+  return guid_to_chars(guid, buffer, upper);
 }
 
-const std::string GUIDA::to_string(const Guid& guid)
+size_t GUIDX::to_chars(const Guid& guid, wchar_t* buffer, bool upper)
 {
-  std::string result("");
+  return guid_to_chars(guid, buffer, upper);
+}
 
-  RPC_CSTR rpcUUID;
-  #if defined(__MINGW32__)
-  auto pUUID = (::UUID*)(&guid);
-  if (UuidToStringA(pUUID, &rpcUUID) != RPC_S_OK)
-  #else
-  if (UuidToStringA(CAST_GUID(&guid, const), &rpcUUID) != RPC_S_OK)
-  #endif
-  {
-    return result;
-  }
+bool GUIDX::from_chars(const char* text, size_t length, Guid& guid)
+{
+  return guid_from_chars(text, length, guid);
+}
 
-  result = LPCSTR(rpcUUID);
+bool GUIDX::from_chars(const wchar_t* text, size_t length, Guid& guid)
+{
+  return guid_from_chars(text, length, guid);
+}
+
+size_t GUIDX::hash(const Guid& guid)
+{
+  byte bytes[16];
+  guid_to_bytes(guid, bytes);
 
-  RpcStringFreeA(&rpcUUID);
+  uint64 hi = 0, lo = 0;
+  memcpy(&hi, &bytes[0], sizeof(hi));
+  memcpy(&lo, &bytes[8], sizeof(lo));
 
-  return result;
+  // splitmix64 finalizer over both halves, so structured (eg. v1, v7) identifiers spread as well
+
+  uint64 x = (hi * 0x9E3779B97F4A7C15ULL) ^ lo;
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+
+  return size_t(x);
 }
 
-const Guid GUIDA::to_guid(const std::string& guid)
+/**
+ * GUIDA
+ */
+
+void GUIDA::parse(const std::string& guid)
 {
-  Guid result = {0};
+  m_guid = GUIDA::to_guid(guid);
+}
+
+std::string GUIDA::as_string() const
+{
+  return GUIDA::to_string(m_guid);
+}
 
-  auto rpcUUID = RPC_CSTR(guid.c_str());
-  UuidFromStringA(rpcUUID, CAST_GUID(&result, NONE));
+const std::string GUIDA::to_string(const Guid& guid)
+{
+  char buffer[GUID_LENGTH];
+  return std::string(buffer, GUIDX::to_chars(guid, buffer));
+}
 
+const Guid GUIDA::to_guid(const std::string& guid)
+{
+  Guid result = { 0 };
+  GUIDX::from_chars(guid.c_str(), guid.length(), result);
   return result;
 }
 
+/**
+ * GUIDW
+ */
+
 void GUIDW::parse(const std::wstring& guid)
 {
   m_guid = GUIDW::to_guid(guid);
@@ -145,33 +581,14 @@ std::wstring GUIDW::as_string() const
 
 const std::wstring GUIDW::to_string(const Guid& guid)
 {
-  std::wstring result(L"");
-
-  RPC_WSTR rpcUUID;
-  #if defined(__MINGW32__)
-  auto pUUID = (::UUID*)(&guid);
-  if (UuidToStringW(pUUID, &rpcUUID) != RPC_S_OK)
-  #else
-  if (UuidToStringW(CAST_GUID(&guid, const), &rpcUUID) != RPC_S_OK)
-  #endif
-  {
-    return result;
-  }
-
-  result = LPCWSTR(rpcUUID);
-
-  RpcStringFreeW(&rpcUUID);
-
-  return result;
+  wchar_t buffer[GUID_LENGTH];
+  return std::wstring(buffer, GUIDX::to_chars(guid, buffer));
 }
 
 const Guid GUIDW::to_guid(const std::wstring& guid)
 {
-  Guid result = {0};
-
-  auto rpcUUID = RPC_WSTR(guid.c_str());
-  UuidFromStringW(rpcUUID, CAST_GUID(&result, NONE));
-
+  Guid result = { 0 };
+  GUIDX::from_chars(guid.c_str(), guid.length(), result);
   return result;
 }
 
@@ -0,0 +1,812 @@
+/**
+ * @file   hashcache.cpp
+ * @author Vic P.
+ * @brief  Implementation for Hash Cache
+ */
+
+#include "Vutils.h"
+
+namespace vu
+{
+
+/**
+ * The cache file layout (little-endian)
+ *  Header  : magic (4) | version (4)
+ *  Record  : magic (4) | payload size (4) | payload checksum (4) | payload
+ *  Payload : size (8) | time (8) | index (8) | volume (4) | key length (2) | digest length (2) | key | digest
+ */
+
+static const ulong HASH_CACHE_MAGIC = 0x43485556;   // VUHC
+static const ulong HASH_CACHE_VERSION = 1;
+static const ulong HASH_CACHE_RECORD_MAGIC = 0x52485556; // VUHR
+
+static const size_t HASH_CACHE_HEADER_SIZE = 8;
+static const size_t HASH_CACHE_RECORD_HEADER_SIZE = 12;
+static const size_t HASH_CACHE_PAYLOAD_FIXED_SIZE = 32;
+
+static ulong hash_cache_checksum(const byte* ptr, const size_t size) // FNV-1a
+{
+  ulong result = 2166136261UL;
+
+  for (size_t i = 0; i < size; i++)
+  {
+    result ^= ptr[i];
+    result *= 16777619UL;
+  }
+
+  return result;
+}
+
+template <typename T>
+static inline void hash_cache_put(std::vector<byte>& data, const T value)
+{
+  const auto ptr = reinterpret_cast<const byte*>(&value);
+  data.insert(data.end(), ptr, ptr + sizeof(T));
+}
+
+template <typename T>
+static inline T hash_cache_get(const byte* ptr)
+{
+  T value;
+  memcpy(&value, ptr, sizeof(T));
+  return value;
+}
+
+static bool hash_cache_write(HANDLE file_handle, const std::vector<byte>& data)
+{
+  DWORD written = 0;
+  return WriteFile(file_handle, data.data(), DWORD(data.size()), &written, nullptr) != FALSE &&
+    written == data.size();
+}
+
+static std::vector<byte> hash_cache_header()
+{
+  std::vector<byte> data;
+  hash_cache_put(data, uint32_t(HASH_CACHE_MAGIC));
+  hash_cache_put(data, uint32_t(HASH_CACHE_VERSION));
+  return data;
+}
+
+/**
+ * The digest function never throws into the caller (or a worker), and an empty digest means failure
+ */
+
+static std::string hash_cache_compute(const HashCacheX::fn_digest_t& fn, const std::wstring& file_path)
+{
+  try
+  {
+    return fn(file_path);
+  }
+  catch (...)
+  {
+    return "";
+  }
+}
+
+/**
+ * HashCacheX
+ */
+
+HashCacheX::HashCacheX() : LastError(), m_file_handle(INVALID_HANDLE_VALUE)
+{
+}
+
+HashCacheX::~HashCacheX()
+{
+  this->close();
+}
+
+bool vuapi HashCacheX::ready() const
+{
+  return m_file_handle != INVALID_HANDLE_VALUE;
+}
+
+size_t vuapi HashCacheX::size() const
+{
+  return m_entries.size();
+}
+
+void vuapi HashCacheX::close()
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  if (m_file_handle != INVALID_HANDLE_VALUE)
+  {
+    CloseHandle(m_file_handle);
+    m_file_handle = INVALID_HANDLE_VALUE;
+  }
+
+  m_entries.clear();
+}
+
+bool vuapi HashCacheX::open_cache(const std::wstring& file_path)
+{
+  this->close();
+
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  m_file_path = file_path;
+
+  // the write sharing is denied, the records are appended at the own file pointer so the cache file
+  // that is opened by another cache object (or process) is failed with ERROR_SHARING_VIOLATION
+
+  m_file_handle = CreateFileW(m_file_path.c_str(), GENERIC_READ | GENERIC_WRITE,
+    FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_file_handle == INVALID_HANDLE_VALUE)
+  {
+    m_last_error_code = GetLastError();
+    return false;
+  }
+
+  // index the valid records, the log is cut at the first torn or corrupted record
+
+  size_t valid_size = 0;
+
+  {
+    FileViewW file_view(m_file_path);
+
+    const byte* ptr = file_view.data();
+    const size_t size = file_view.size();
+
+    if (size >= HASH_CACHE_HEADER_SIZE &&
+        hash_cache_get<uint32_t>(ptr) == HASH_CACHE_MAGIC &&
+        hash_cache_get<uint32_t>(ptr + 4) == HASH_CACHE_VERSION)
+    {
+      valid_size = HASH_CACHE_HEADER_SIZE;
+    }
+
+    while (valid_size != 0 && size - valid_size >= HASH_CACHE_RECORD_HEADER_SIZE)
+    {
+      const byte* ptr_record = ptr + valid_size;
+
+      const size_t payload_size = hash_cache_get<uint32_t>(ptr_record + 4);
+      if (hash_cache_get<uint32_t>(ptr_record) != HASH_CACHE_RECORD_MAGIC ||
+          payload_size < HASH_CACHE_PAYLOAD_FIXED_SIZE ||
+          payload_size > size - valid_size - HASH_CACHE_RECORD_HEADER_SIZE)
+      {
+        break;
+      }
+
+      const byte* ptr_payload = ptr_record + HASH_CACHE_RECORD_HEADER_SIZE;
+      if (hash_cache_get<uint32_t>(ptr_record + 8) != hash_cache_checksum(ptr_payload, payload_size))
+      {
+        break;
+      }
+
+      const size_t key_length = hash_cache_get<uint16_t>(ptr_payload + 28);
+      const size_t digest_length = hash_cache_get<uint16_t>(ptr_payload + 30);
+      if (HASH_CACHE_PAYLOAD_FIXED_SIZE + key_length * sizeof(wchar) + digest_length != payload_size)
+      {
+        break;
+      }
+
+      Entry entry;
+      entry.stamp.size   = hash_cache_get<uint64>(ptr_payload);
+      entry.stamp.time   = hash_cache_get<uint64>(ptr_payload + 8);
+      entry.stamp.index  = hash_cache_get<uint64>(ptr_payload + 16);
+      entry.stamp.volume = hash_cache_get<uint32_t>(ptr_payload + 24);
+
+      std::wstring key(key_length, L'\0');
+      memcpy(&key[0], ptr_payload + HASH_CACHE_PAYLOAD_FIXED_SIZE, key_length * sizeof(wchar));
+
+      auto ptr_digest = ptr_payload + HASH_CACHE_PAYLOAD_FIXED_SIZE + key_length * sizeof(wchar);
+      entry.digest.assign(reinterpret_cast<const char*>(ptr_digest), digest_length);
+
+      m_entries[std::move(key)] = std::move(entry);
+
+      valid_size += HASH_CACHE_RECORD_HEADER_SIZE + payload_size;
+    }
+  }
+
+  // drop the invalid tail (or the whole invalid file), then the records are appended from there
+
+  LARGE_INTEGER position = { 0 };
+  position.QuadPart = LONGLONG(valid_size);
+
+  if (SetFilePointerEx(m_file_handle, position, nullptr, FILE_BEGIN) == FALSE ||
+      SetEndOfFile(m_file_handle) == FALSE ||
+     (valid_size == 0 && !hash_cache_write(m_file_handle, hash_cache_header())))
+  {
+    m_last_error_code = GetLastError();
+    CloseHandle(m_file_handle);
+    m_file_handle = INVALID_HANDLE_VALUE;
+    m_entries.clear();
+    return false;
+  }
+
+  return true;
+}
+
+std::wstring HashCacheX::key(const std::wstring& file_path, const std::string& algorithm)
+{
+  std::wstring result;
+
+  const DWORD length = GetFullPathNameW(file_path.c_str(), 0, nullptr, nullptr);
+  if (length != 0)
+  {
+    result.resize(length);
+    result.resize(GetFullPathNameW(file_path.c_str(), length, &result[0], nullptr));
+  }
+  else
+  {
+    result = file_path;
+  }
+
+  lower_string_in_place_W(result);
+
+  result += L'|';
+  result.append(algorithm.cbegin(), algorithm.cend());
+
+  return result;
+}
+
+bool HashCacheX::stamp(const std::wstring& file_path, Stamp& stamp)
+{
+  HANDLE file_handle = CreateFileW(file_path.c_str(), FILE_READ_ATTRIBUTES,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+  if (file_handle == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  BY_HANDLE_FILE_INFORMATION info = { 0 };
+  bool result = GetFileInformationByHandle(file_handle, &info) != FALSE;
+
+  CloseHandle(file_handle);
+
+  stamp.size   = (uint64(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+  stamp.time   = (uint64(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+  stamp.index  = (uint64(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+  stamp.volume = info.dwVolumeSerialNumber;
+
+  return result;
+}
+
+bool HashCacheX::lookup(const std::wstring& key, const Stamp& stamp, std::string& digest)
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  auto it = m_entries.find(key);
+  if (it == m_entries.cend())
+  {
+    return false;
+  }
+
+  const auto& e = it->second.stamp;
+  if (e.size != stamp.size || e.time != stamp.time || e.index != stamp.index || e.volume != stamp.volume)
+  {
+    return false;
+  }
+
+  digest = it->second.digest;
+
+  return true;
+}
+
+void HashCacheX::store(const std::wstring& key, const Stamp& stamp, const std::string& digest)
+{
+  if (digest.empty())
+  {
+    return;
+  }
+
+  Entry entry;
+  entry.stamp = stamp;
+  entry.digest = digest;
+
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  this->append(key, entry);
+
+  m_entries[key] = std::move(entry);
+}
+
+bool HashCacheX::append(const std::wstring& key, const Entry& entry)
+{
+  if (m_file_handle == INVALID_HANDLE_VALUE || key.length() > 0xFFFF || entry.digest.length() > 0xFFFF)
+  {
+    return false;
+  }
+
+  std::vector<byte> payload;
+  payload.reserve(HASH_CACHE_PAYLOAD_FIXED_SIZE + key.length() * sizeof(wchar) + entry.digest.length());
+  hash_cache_put(payload, uint64(entry.stamp.size));
+  hash_cache_put(payload, uint64(entry.stamp.time));
+  hash_cache_put(payload, uint64(entry.stamp.index));
+  hash_cache_put(payload, uint32_t(entry.stamp.volume));
+  hash_cache_put(payload, uint16_t(key.length()));
+  hash_cache_put(payload, uint16_t(entry.digest.length()));
+  auto ptr_key = reinterpret_cast<const byte*>(key.data());
+  payload.insert(payload.end(), ptr_key, ptr_key + key.length() * sizeof(wchar));
+  payload.insert(payload.end(), entry.digest.cbegin(), entry.digest.cend());
+
+  // the record is written by a single call, a torn one is discarded when the cache is opened again
+
+  std::vector<byte> record;
+  record.reserve(HASH_CACHE_RECORD_HEADER_SIZE + payload.size());
+  hash_cache_put(record, uint32_t(HASH_CACHE_RECORD_MAGIC));
+  hash_cache_put(record, uint32_t(payload.size()));
+  hash_cache_put(record, uint32_t(hash_cache_checksum(payload.data(), payload.size())));
+  record.insert(record.end(), payload.cbegin(), payload.cend());
+
+  if (!hash_cache_write(m_file_handle, record))
+  {
+    m_last_error_code = GetLastError();
+    return false;
+  }
+
+  return true;
+}
+
+bool vuapi HashCacheX::compact()
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  if (m_file_handle == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  // keep the latest records of the files that are unchanged
+
+  for (auto it = m_entries.begin(); it != m_entries.end();)
+  {
+    const auto file_path = it->first.substr(0, it->first.rfind(L'|'));
+
+    Stamp stamp = { 0 };
+    const auto& e = it->second.stamp;
+    if (!HashCacheX::stamp(file_path, stamp) ||
+        e.size != stamp.size || e.time != stamp.time || e.index != stamp.index || e.volume != stamp.volume)
+    {
+      it = m_entries.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  // rewrite into a temporary file then replace the cache file by it
+
+  const auto temp_file_path = m_file_path + L".tmp";
+
+  HANDLE temp_file_handle = m_file_handle;
+
+  m_file_handle = CreateFileW(temp_file_path.c_str(), GENERIC_WRITE, 0,
+    nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_file_handle == INVALID_HANDLE_VALUE)
+  {
+    m_last_error_code = GetLastError();
+    m_file_handle = temp_file_handle;
+    return false;
+  }
+
+  bool result = hash_cache_write(m_file_handle, hash_cache_header());
+
+  for (auto it = m_entries.cbegin(); result && it != m_entries.cend(); ++it)
+  {
+    result = this->append(it->first, it->second);
+  }
+
+  result = result && FlushFileBuffers(m_file_handle) != FALSE;
+
+  CloseHandle(m_file_handle);
+  CloseHandle(temp_file_handle);
+
+  if (result)
+  {
+    result = MoveFileExW(temp_file_path.c_str(), m_file_path.c_str(),
+      MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+  }
+
+  if (!result)
+  {
+    m_last_error_code = GetLastError();
+    DeleteFileW(temp_file_path.c_str());
+  }
+
+  // reopen the cache file to continue appending
+
+  m_file_handle = CreateFileW(m_file_path.c_str(), GENERIC_READ | GENERIC_WRITE,
+    FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_file_handle == INVALID_HANDLE_VALUE)
+  {
+    m_last_error_code = GetLastError();
+    return false;
+  }
+
+  LARGE_INTEGER position = { 0 };
+  SetFilePointerEx(m_file_handle, position, nullptr, FILE_END);
+
+  return result;
+}
+
+std::string vuapi HashCacheX::digest(
+  const std::wstring& file_path, const std::string& algorithm, const fn_digest_t& fn)
+{
+  Stamp stamp = { 0 };
+  if (!HashCacheX::stamp(file_path, stamp))
+  {
+    m_last_error_code = GetLastError();
+    return "";
+  }
+
+  const auto key = HashCacheX::key(file_path, algorithm);
+
+  std::string result;
+  if (this->lookup(key, stamp, result))
+  {
+    return result;
+  }
+
+  // the stamp is taken before hashing, so a file that is modified meanwhile is recomputed next time
+
+  result = hash_cache_compute(fn, file_path);
+
+  this->store(key, stamp, result);
+
+  return result;
+}
+
+std::vector<std::string> vuapi HashCacheX::digest(
+  const std::vector<std::wstring>& file_paths,
+  const std::string& algorithm,
+  const fn_digest_t& fn,
+  const size_t n_threads)
+{
+  std::vector<std::string> result(file_paths.size());
+
+  struct Stale
+  {
+    size_t index;
+    std::wstring key;
+    Stamp stamp;
+  };
+
+  std::vector<Stale> stale_list;
+
+  for (size_t i = 0; i < file_paths.size(); i++)
+  {
+    Stale stale = { i, std::wstring(), { 0 } };
+    if (!HashCacheX::stamp(file_paths[i], stale.stamp))
+    {
+      continue;
+    }
+
+    stale.key = HashCacheX::key(file_paths[i], algorithm);
+
+    if (!this->lookup(stale.key, stale.stamp, result[i]))
+    {
+      stale_list.push_back(std::move(stale));
+    }
+  }
+
+  if (stale_list.empty())
+  {
+    return result;
+  }
+
+  // recompute the stale ones in parallel (the files are pulled one by one, so the sizes could be uneven)
+
+  size_t n = n_threads != 0 ? n_threads : size_t(std::thread::hardware_concurrency());
+  n = std::max(size_t(1), std::min(n, stale_list.size()));
+
+  std::atomic<size_t> next(0);
+
+  auto fn_worker = [&]() -> void
+  {
+    for (size_t i = next++; i < stale_list.size(); i = next++)
+    {
+      const auto& stale = stale_list[i];
+      auto& digest = result[stale.index];
+      digest = hash_cache_compute(fn, file_paths[stale.index]);
+      this->store(stale.key, stale.stamp, digest);
+    }
+  };
+
+  ThreadPool pool(n);
+
+  for (size_t i = 0; i < n; i++)
+  {
+    pool.add_task(fn_worker);
+  }
+
+  pool.launch();
+
+  return result;
+}
+
+/**
+ * The digest functions of the algorithms
+ */
+
+static std::string hash_cache_md5(const std::wstring& file_path)
+{
+  std::vector<byte> data;
+  if (!read_file_binary_W(file_path, data))
+  {
+    return "";
+  }
+
+  return crypt_md5_buffer_A(data);
+}
+
+static std::string hash_cache_sha(const std::wstring& file_path, const sha_version version, const crypt_bits bits)
+{
+  std::vector<byte> data;
+  if (!read_file_binary_W(file_path, data))
+  {
+    return "";
+  }
+
+  std::vector<byte> hash;
+  crypt_sha_buffer(data, version, bits, hash);
+
+  return to_hex_string_A(hash.data(), hash.size());
+}
+
+static std::string hash_cache_crc(const std::wstring& file_path, const crypt_bits bits)
+{
+  std::vector<byte> data;
+  if (!read_file_binary_W(file_path, data))
+  {
+    return "";
+  }
+
+  return format_A("%016llX", crypt_crc_buffer(data, bits));
+}
+
+static bool hash_cache_sha_valid(const sha_version version, const crypt_bits bits)
+{
+  if (version == sha_version::_1)
+  {
+    return bits == crypt_bits::_160;
+  }
+
+  if (version == sha_version::_2 || version == sha_version::_3)
+  {
+    return bits == crypt_bits::_224 || bits == crypt_bits::_256 ||
+      bits == crypt_bits::_384 || bits == crypt_bits::_512;
+  }
+
+  return false;
+}
+
+static bool hash_cache_crc_valid(const crypt_bits bits)
+{
+  return bits == crypt_bits::_8 || bits == crypt_bits::_16 || bits == crypt_bits::_32 || bits == crypt_bits::_64;
+}
+
+static std::string hash_cache_sha_algorithm(const sha_version version, const crypt_bits bits)
+{
+  return format_A("sha%d-%d", int(version), int(bits));
+}
+
+static std::string hash_cache_crc_algorithm(const crypt_bits bits)
+{
+  return format_A("crc-%d", int(bits));
+}
+
+static uint64 hash_cache_crc_value(const std::string& digest)
+{
+  return digest.empty() ? 0 : strtoull(digest.c_str(), nullptr, 16);
+}
+
+static std::vector<std::wstring> hash_cache_paths(const std::vector<std::string>& file_paths)
+{
+  std::vector<std::wstring> result;
+  result.reserve(file_paths.size());
+
+  for (const auto& file_path : file_paths)
+  {
+    result.push_back(to_string_W(file_path));
+  }
+
+  return result;
+}
+
+/**
+ * HashCacheA
+ */
+
+HashCacheA::HashCacheA() : HashCacheX()
+{
+}
+
+HashCacheA::HashCacheA(const std::string& file_path) : HashCacheX()
+{
+  this->open(file_path);
+}
+
+HashCacheA::~HashCacheA()
+{
+}
+
+bool vuapi HashCacheA::open(const std::string& file_path)
+{
+  return this->open_cache(to_string_W(file_path));
+}
+
+std::string vuapi HashCacheA::md5(const std::string& file_path)
+{
+  return this->digest(to_string_W(file_path), "md5", hash_cache_md5);
+}
+
+std::string vuapi HashCacheA::sha(const std::string& file_path, const sha_version version, const crypt_bits bits)
+{
+  if (!hash_cache_sha_valid(version, bits))
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return "";
+  }
+
+  return this->digest(to_string_W(file_path), hash_cache_sha_algorithm(version, bits),
+    [&](const std::wstring& path) { return hash_cache_sha(path, version, bits); });
+}
+
+uint64 vuapi HashCacheA::crc(const std::string& file_path, const crypt_bits bits)
+{
+  if (!hash_cache_crc_valid(bits))
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return 0;
+  }
+
+  return hash_cache_crc_value(this->digest(to_string_W(file_path), hash_cache_crc_algorithm(bits),
+    [&](const std::wstring& path) { return hash_cache_crc(path, bits); }));
+}
+
+std::vector<std::string> vuapi HashCacheA::md5(const std::vector<std::string>& file_paths, const size_t n_threads)
+{
+  return this->digest(hash_cache_paths(file_paths), "md5", hash_cache_md5, n_threads);
+}
+
+std::vector<std::string> vuapi HashCacheA::sha(const std::vector<std::string>& file_paths,
+  const sha_version version, const crypt_bits bits, const size_t n_threads)
+{
+  if (!hash_cache_sha_valid(version, bits))
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return std::vector<std::string>(file_paths.size());
+  }
+
+  return this->digest(hash_cache_paths(file_paths), hash_cache_sha_algorithm(version, bits),
+    [&](const std::wstring& path) { return hash_cache_sha(path, version, bits); }, n_threads);
+}
+
+std::vector<uint64> vuapi HashCacheA::crc(const std::vector<std::string>& file_paths,
+  const crypt_bits bits, const size_t n_threads)
+{
+  if (!hash_cache_crc_valid(bits))
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return std::vector<uint64>(file_paths.size());
+  }
+
+  const auto digests = this->digest(hash_cache_paths(file_paths), hash_cache_crc_algorithm(bits),
+    [&](const std::wstring& path) { return hash_cache_crc(path, bits); }, n_threads);
+
+  std::vector<uint64> result;
+  result.reserve(digests.size());
+
+  for (const auto& digest : digests)
+  {
+    result.push_back(hash_cache_crc_value(digest));
+  }
+
+  return result;
+}
+
+/**
+ * HashCacheW
+ */
+
+HashCacheW::HashCacheW() : HashCacheX()
+{
+}
+
+HashCacheW::HashCacheW(const std::wstring& file_path) : HashCacheX()
+{
+  this->open(file_path);
+}
+
+HashCacheW::~HashCacheW()
+{
+}
+
+bool vuapi HashCacheW::open(const std::wstring& file_path)
+{
+  return this->open_cache(file_path);
+}
+
+std::wstring vuapi HashCacheW::md5(const std::wstring& file_path)
+{
+  return to_string_W(this->digest(file_path, "md5", hash_cache_md5));
+}
+
+std::wstring vuapi HashCacheW::sha(const std::wstring& file_path, const sha_version version, const crypt_bits bits)
+{
+  if (!hash_cache_sha_valid(version, bits))
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return L"";
+  }
+
+  return to_string_W(this->digest(file_path, hash_cache_sha_algorithm(version, bits),
+    [&](const std::wstring& path) { return hash_cache_sha(path, version, bits); }));
+}
+
+uint64 vuapi HashCacheW::crc(const std::wstring& file_path, const crypt_bits bits)
+{
+  if (!hash_cache_crc_valid(bits))
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return 0;
+  }
+
+  return hash_cache_crc_value(this->digest(file_path, hash_cache_crc_algorithm(bits),
+    [&](const std::wstring& path) { return hash_cache_crc(path, bits); }));
+}
+
+std::vector<std::wstring> vuapi HashCacheW::md5(const std::vector<std::wstring>& file_paths, const size_t n_threads)
+{
+  const auto digests = this->digest(file_paths, "md5", hash_cache_md5, n_threads);
+
+  std::vector<std::wstring> result;
+  result.reserve(digests.size());
+
+  for (const auto& digest : digests)
+  {
+    result.push_back(to_string_W(digest));
+  }
+
+  return result;
+}
+
+std::vector<std::wstring> vuapi HashCacheW::sha(const std::vector<std::wstring>& file_paths,
+  const sha_version version, const crypt_bits bits, const size_t n_threads)
+{
+  if (!hash_cache_sha_valid(version, bits))
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return std::vector<std::wstring>(file_paths.size());
+  }
+
+  const auto digests = this->digest(file_paths, hash_cache_sha_algorithm(version, bits),
+    [&](const std::wstring& path) { return hash_cache_sha(path, version, bits); }, n_threads);
+
+  std::vector<std::wstring> result;
+  result.reserve(digests.size());
+
+  for (const auto& digest : digests)
+  {
+    result.push_back(to_string_W(digest));
+  }
+
+  return result;
+}
+
+std::vector<uint64> vuapi HashCacheW::crc(const std::vector<std::wstring>& file_paths,
+  const crypt_bits bits, const size_t n_threads)
+{
+  if (!hash_cache_crc_valid(bits))
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return std::vector<uint64>(file_paths.size());
+  }
+
+  const auto digests = this->digest(file_paths, hash_cache_crc_algorithm(bits),
+    [&](const std::wstring& path) { return hash_cache_crc(path, bits); }, n_threads);
+
+  std::vector<uint64> result;
+  result.reserve(digests.size());
+
+  for (const auto& digest : digests)
+  {
+    result.push_back(hash_cache_crc_value(digest));
+  }
+
+  return result;
+}
+
+} // namespace vu
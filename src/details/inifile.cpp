@@ -10,18 +10,681 @@
 namespace vu
 {
 
+/**
+ * INIDocumentT
+ */
+
+template <typename CharT>
+static inline CharT ini_fold(const CharT c)
+{
+  return c >= CharT('A') && c <= CharT('Z') ? CharT(c + ('a' - 'A')) : c;
+}
+
+template <class StringT>
+static StringT ini_lower(const StringT& string)
+{
+  StringT result(string);
+  for (auto& c : result)
+  {
+    c = ini_fold(c);
+  }
+  return result;
+}
+
+template <typename CharT>
+static inline bool ini_is_space(const CharT c)
+{
+  return c == CharT(' ') || c == CharT('\t');
+}
+
+template <typename CharT>
+static void ini_trim(const CharT*& ptr, size_t& length)
+{
+  while (length != 0 && ini_is_space(*ptr))
+  {
+    ptr++;
+    length--;
+  }
+
+  while (length != 0 && ini_is_space(ptr[length - 1]))
+  {
+    length--;
+  }
+}
+
+template <class StringT>
+static bool ini_is_blank(const StringT& text)
+{
+  auto ptr = text.data();
+  auto length = text.length();
+  ini_trim(ptr, length);
+  return length == 0;
+}
+
+template <class StringT>
+INIDocumentT<StringT>::INIDocumentT() : m_modified(false)
+{
+  this->clear();
+}
+
+template <class StringT>
+INIDocumentT<StringT>::~INIDocumentT()
+{
+}
+
+template <class StringT>
+void INIDocumentT<StringT>::clear()
+{
+  m_sections.clear();
+  m_sections.push_back(Section());
+  m_section_index.clear();
+
+  m_new_line.clear();
+  m_new_line.push_back(char_type('\r'));
+  m_new_line.push_back(char_type('\n'));
+
+  m_modified = false;
+}
+
+template <class StringT>
+void INIDocumentT<StringT>::parse(const StringT& text)
+{
+  this->parse(text.data(), text.length());
+}
+
+template <class StringT>
+void INIDocumentT<StringT>::parse(const char_type* ptr, const size_t length)
+{
+  typedef std::char_traits<char_type> traits;
+
+  this->clear();
+
+  if (ptr == nullptr || length == 0)
+  {
+    return;
+  }
+
+  // keep the new-line style of the document, CR LF is for the document without any line break
+
+  auto ptr_lf = traits::find(ptr, length, char_type('\n'));
+  if (ptr_lf != nullptr && (ptr_lf == ptr || ptr_lf[-1] != char_type('\r')))
+  {
+    m_new_line.assign(1, char_type('\n'));
+  }
+
+  for (size_t i = 0; i < length;)
+  {
+    ptr_lf = traits::find(ptr + i, length - i, char_type('\n'));
+
+    size_t n = ptr_lf != nullptr ? size_t(ptr_lf - ptr) - i : length - i;
+    const size_t next = i + n + 1;
+
+    if (n != 0 && ptr[i + n - 1] == char_type('\r'))
+    {
+      n--;
+    }
+
+    this->parse_line(ptr + i, n);
+
+    i = next;
+  }
+
+  m_modified = false;
+}
+
+template <class StringT>
+void INIDocumentT<StringT>::parse_line(const char_type* ptr, size_t length)
+{
+  Line line;
+  line.text.assign(ptr, length);
+  line.is_key = false;
+
+  ini_trim(ptr, length);
+
+  // the blank lines and the comments
+
+  if (length == 0 || *ptr == char_type(';'))
+  {
+    m_sections.back().lines.push_back(std::move(line));
+    return;
+  }
+
+  // the section header
+
+  if (*ptr == char_type('['))
+  {
+    ptr++;
+    length--;
+
+    for (size_t i = 0; i < length; i++)
+    {
+      if (ptr[i] == char_type(']'))
+      {
+        length = i;
+        break;
+      }
+    }
+
+    ini_trim(ptr, length);
+
+    Section section;
+    section.name.assign(ptr, length);
+    section.header = std::move(line.text);
+
+    m_section_index.insert(std::make_pair(ini_lower(section.name), m_sections.size()));
+    m_sections.push_back(std::move(section));
+
+    return;
+  }
+
+  // the key-value pair
+
+  size_t eq = 0;
+  while (eq < length && ptr[eq] != char_type('='))
+  {
+    eq++;
+  }
+
+  if (eq == length)
+  {
+    m_sections.back().lines.push_back(std::move(line));
+    return;
+  }
+
+  auto ptr_key = ptr;
+  size_t key_length = eq;
+  ini_trim(ptr_key, key_length);
+
+  auto ptr_value = ptr + eq + 1;
+  size_t value_length = length - eq - 1;
+  ini_trim(ptr_value, value_length);
+
+  if (value_length >= 2 && ptr_value[0] == ptr_value[value_length - 1] &&
+     (ptr_value[0] == char_type('"') || ptr_value[0] == char_type('\'')))
+  {
+    ptr_value++;
+    value_length -= 2;
+  }
+
+  line.key.assign(ptr_key, key_length);
+  line.value.assign(ptr_value, value_length);
+  line.is_key = true;
+
+  auto& section = m_sections.back();
+  section.keys.insert(std::make_pair(ini_lower(line.key), section.lines.size()));
+  section.lines.push_back(std::move(line));
+}
+
+template <class StringT>
+StringT INIDocumentT<StringT>::serialize() const
+{
+  size_t length = 0;
+
+  for (const auto& section : m_sections)
+  {
+    length += section.header.length() + m_new_line.length();
+    for (const auto& line : section.lines)
+    {
+      length += line.text.length() + m_new_line.length();
+    }
+  }
+
+  StringT result;
+  result.reserve(length);
+
+  for (size_t i = 0; i < m_sections.size(); i++)
+  {
+    const auto& section = m_sections[i];
+
+    if (i != 0) // the area before any section header has no header
+    {
+      result.append(section.header);
+      result.append(m_new_line);
+    }
+
+    for (const auto& line : section.lines)
+    {
+      result.append(line.text);
+      result.append(m_new_line);
+    }
+  }
+
+  return result;
+}
+
+template <class StringT>
+bool INIDocumentT<StringT>::modified() const
+{
+  return m_modified;
+}
+
+template <class StringT>
+void INIDocumentT<StringT>::modified(const bool state)
+{
+  m_modified = state;
+}
+
+template <class StringT>
+const typename INIDocumentT<StringT>::Section* INIDocumentT<StringT>::find_section(
+  const StringT& section) const
+{
+  auto it = m_section_index.find(ini_lower(section));
+  return it != m_section_index.cend() ? &m_sections[it->second] : nullptr;
+}
+
+template <class StringT>
+bool INIDocumentT<StringT>::has_section(const StringT& section) const
+{
+  return this->find_section(section) != nullptr;
+}
+
+template <class StringT>
+std::vector<StringT> INIDocumentT<StringT>::section_names() const
+{
+  std::vector<StringT> result;
+  result.reserve(m_section_index.size());
+
+  for (size_t i = 1; i < m_sections.size(); i++)
+  {
+    const auto& name = m_sections[i].name;
+    auto it = m_section_index.find(ini_lower(name));
+    if (it != m_section_index.cend() && it->second == i)
+    {
+      result.push_back(name);
+    }
+  }
+
+  return result;
+}
+
+template <class StringT>
+std::vector<StringT> INIDocumentT<StringT>::key_names(const StringT& section) const
+{
+  std::vector<StringT> result;
+
+  auto ptr_section = this->find_section(section);
+  if (ptr_section == nullptr)
+  {
+    return result;
+  }
+
+  result.reserve(ptr_section->keys.size());
+
+  for (size_t i = 0; i < ptr_section->lines.size(); i++)
+  {
+    const auto& line = ptr_section->lines[i];
+    if (line.is_key && ptr_section->keys.find(ini_lower(line.key))->second == i)
+    {
+      result.push_back(line.key);
+    }
+  }
+
+  return result;
+}
+
+template <class StringT>
+const StringT* INIDocumentT<StringT>::find(const StringT& section, const StringT& key) const
+{
+  auto ptr_section = this->find_section(section);
+  if (ptr_section == nullptr)
+  {
+    return nullptr;
+  }
+
+  auto it = ptr_section->keys.find(ini_lower(key));
+  return it != ptr_section->keys.cend() ? &ptr_section->lines[it->second].value : nullptr;
+}
+
+template <class StringT>
+void INIDocumentT<StringT>::set(const StringT& section, const StringT& key, const StringT& value)
+{
+  StringT text(key);
+  text.push_back(char_type('='));
+  text.append(value);
+
+  auto it_section = m_section_index.find(ini_lower(section));
+  if (it_section == m_section_index.end())
+  {
+    Section new_section;
+    new_section.name = section;
+    new_section.header.push_back(char_type('['));
+    new_section.header.append(section);
+    new_section.header.push_back(char_type(']'));
+
+    it_section = m_section_index.insert(std::make_pair(ini_lower(section), m_sections.size())).first;
+    m_sections.push_back(std::move(new_section));
+  }
+
+  auto& the_section = m_sections[it_section->second];
+
+  auto lower_key = ini_lower(key);
+
+  auto it_key = the_section.keys.find(lower_key);
+  if (it_key != the_section.keys.end())
+  {
+    auto& line = the_section.lines[it_key->second];
+    if (line.value == value)
+    {
+      return;
+    }
+
+    line.text  = std::move(text);
+    line.value = value;
+    m_modified = true;
+    return;
+  }
+
+  Line line;
+  line.text  = std::move(text);
+  line.key   = key;
+  line.value = value;
+  line.is_key = true;
+
+  // the new key is appended after the last non-blank line to keep the blank lines between sections
+
+  auto& lines = the_section.lines;
+
+  size_t position = lines.size();
+  while (position != 0 && !lines[position - 1].is_key && ini_is_blank(lines[position - 1].text))
+  {
+    position--;
+  }
+
+  lines.insert(lines.begin() + position, std::move(line));
+
+  m_modified = true;
+
+  if (position + 1 == lines.size())
+  {
+    the_section.keys.insert(std::make_pair(std::move(lower_key), position));
+  }
+  else
+  {
+    this->reindex(the_section);
+  }
+}
+
+template <class StringT>
+bool INIDocumentT<StringT>::remove(const StringT& section, const StringT& key)
+{
+  auto it_section = m_section_index.find(ini_lower(section));
+  if (it_section == m_section_index.end())
+  {
+    return false;
+  }
+
+  auto& the_section = m_sections[it_section->second];
+
+  auto it_key = the_section.keys.find(ini_lower(key));
+  if (it_key == the_section.keys.end())
+  {
+    return false;
+  }
+
+  the_section.lines.erase(the_section.lines.begin() + it_key->second);
+  this->reindex(the_section);
+
+  m_modified = true;
+
+  return true;
+}
+
+template <class StringT>
+bool INIDocumentT<StringT>::remove(const StringT& section)
+{
+  auto it_section = m_section_index.find(ini_lower(section));
+  if (it_section == m_section_index.end())
+  {
+    return false;
+  }
+
+  m_sections.erase(m_sections.begin() + it_section->second);
+
+  m_section_index.clear();
+  for (size_t i = 1; i < m_sections.size(); i++)
+  {
+    m_section_index.insert(std::make_pair(ini_lower(m_sections[i].name), i));
+  }
+
+  m_modified = true;
+
+  return true;
+}
+
+template <class StringT>
+void INIDocumentT<StringT>::reindex(Section& section)
+{
+  section.keys.clear();
+
+  for (size_t i = 0; i < section.lines.size(); i++)
+  {
+    const auto& line = section.lines[i];
+    if (line.is_key)
+    {
+      section.keys.insert(std::make_pair(ini_lower(line.key), i));
+    }
+  }
+}
+
+template class INIDocumentT<std::string>;
+template class INIDocumentT<std::wstring>;
+
+/**
+ * The file stamp (the last write time and the size) for the change detection.
+ */
+
+static bool ini_file_stamp(const std::wstring& file_path, uint64& time, uint64& size)
+{
+  WIN32_FILE_ATTRIBUTE_DATA data = { 0 };
+  if (GetFileAttributesExW(file_path.c_str(), GetFileExInfoStandard, &data) == FALSE)
+  {
+    time = 0;
+    size = 0;
+    return false;
+  }
+
+  time = (uint64(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+  size = (uint64(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+
+  return true;
+}
+
+static bool ini_file_not_found(const ulong error)
+{
+  return error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND;
+}
+
+/**
+ * Write the whole file atomically. The data is written into a temporary file next to the target,
+ * flushed to the disk, then the temporary file replaces the target in a single rename.
+ */
+
+static bool ini_write_atomic(const std::wstring& file_path, const std::string& data, ulong& error)
+{
+  const auto temp_file_path = file_path + L".tmp";
+
+  HANDLE hfile = CreateFileW(
+    temp_file_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (hfile == INVALID_HANDLE_VALUE)
+  {
+    error = GetLastError();
+    return false;
+  }
+
+  DWORD written = 0;
+  bool result = data.empty() ||
+    (WriteFile(hfile, data.data(), DWORD(data.size()), &written, nullptr) != FALSE && written == data.size());
+  result = result && FlushFileBuffers(hfile) != FALSE;
+
+  error = GetLastError();
+
+  CloseHandle(hfile);
+
+  if (result)
+  {
+    result = MoveFileExW(temp_file_path.c_str(), file_path.c_str(),
+      MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+    error = GetLastError();
+  }
+
+  if (!result)
+  {
+    DeleteFileW(temp_file_path.c_str());
+  }
+  else
+  {
+    error = ERROR_SUCCESS;
+  }
+
+  return result;
+}
+
+static const byte INI_BOM_UTF8[]  = { 0xEF, 0xBB, 0xBF };
+static const byte INI_BOM_UTF16[] = { 0xFF, 0xFE };
+
+// the files without BOM (and the new files) are in the ANSI code page as the profile functions
+
+static const text_encoding INI_ANSI = text_encoding::TE_UNKNOWN;
+
+static text_encoding ini_detect_encoding(const byte* ptr, const size_t size)
+{
+  if (size >= sizeof(INI_BOM_UTF16) && memcmp(ptr, INI_BOM_UTF16, sizeof(INI_BOM_UTF16)) == 0)
+  {
+    return text_encoding::TE_UTF16_LE_BOM;
+  }
+
+  if (size >= sizeof(INI_BOM_UTF8) && memcmp(ptr, INI_BOM_UTF8, sizeof(INI_BOM_UTF8)) == 0)
+  {
+    return text_encoding::TE_UTF8_BOM;
+  }
+
+  return INI_ANSI;
+}
+
+/**
+ * The document of the UTF-8 BOM and UTF-16 LE BOM files is kept as UTF-8 so that they are rewritten
+ * lossless, while the strings of INIFileA are in the ANSI code page as GetPrivateProfileStringA.
+ */
+
+static bool ini_is_ascii(const std::string& text)
+{
+  for (const auto c : text)
+  {
+    if (byte(c) >= 0x80)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static std::string ini_to_document(const text_encoding encoding, const std::string& text)
+{
+  if (encoding == INI_ANSI || ini_is_ascii(text))
+  {
+    return text;
+  }
+
+  return to_string_A(to_string_W(text), true);
+}
+
+static std::string ini_from_document(const text_encoding encoding, const std::string& text)
+{
+  if (encoding == INI_ANSI || ini_is_ascii(text))
+  {
+    return text;
+  }
+
+  return to_string_A(to_string_W(text, true));
+}
+
+/**
+ * The pending writes are kept (one per key, in the order of the first write) until they are flushed,
+ * so that they could be re-applied on top of the file if it was changed meanwhile by another writer.
+ */
+
+template <class PendingT, class StringT>
+static void ini_pending_add(
+  std::vector<PendingT>& pending,
+  std::unordered_map<StringT, size_t>& pending_index,
+  const StringT& section, const StringT& key, const StringT& value)
+{
+  auto id = ini_lower(section);
+  id.push_back(typename StringT::value_type(0));
+  id.append(ini_lower(key));
+
+  auto it = pending_index.find(id);
+  if (it != pending_index.end())
+  {
+    pending[it->second].value = value;
+    return;
+  }
+
+  pending_index.insert(std::make_pair(std::move(id), pending.size()));
+
+  PendingT entry = { section, key, value };
+  pending.push_back(std::move(entry));
+}
+
+/**
+ * Map the whole file read-only and let the decoder parse the document straight from the view.
+ */
+
+template <class FileMappingT, class StringT, typename Fn>
+static bool ini_map_file(const StringT& file_path, const uint64 size, ulong& error, Fn fn)
+{
+  if (size == 0) // an empty file could not be mapped
+  {
+    fn(nullptr, 0);
+    return true;
+  }
+
+  FileMappingT file_mapping;
+
+  if (file_mapping.create_within_file(
+    file_path, 0, 0,
+    fs_generic::FG_READ,
+    fs_share::FS_ALLACCESS,
+    fs_mode::FM_OPENEXISTING,
+    fs_attribute::FA_NORMAL,
+    page_protection::PP_READ_ONLY) != VU_OK)
+  {
+    error = file_mapping.get_last_error_code();
+    return false;
+  }
+
+  auto ptr = static_cast<const byte*>(file_mapping.view(FileMappingX::desired_access::DA_READ));
+  if (ptr == nullptr)
+  {
+    error = file_mapping.get_last_error_code();
+    return false;
+  }
+
+  fn(ptr, size_t(size));
+
+  return true;
+}
+
+/**
+ * INIFileA
+ */
+
 INIFileA::INIFileA() : LastError()
+  , m_encoding(text_encoding::TE_UNKNOWN), m_loaded(false), m_time(0), m_size(0)
 {
   m_file_path = "";
 }
 
 INIFileA::INIFileA(const std::string& file_path) : LastError()
+  , m_encoding(text_encoding::TE_UNKNOWN), m_loaded(false), m_time(0), m_size(0)
 {
   m_file_path = file_path;
 }
 
 INIFileA::~INIFileA()
 {
+  this->flush();
 }
 
 std::unique_ptr<INIFileA::Section> INIFileA::section(const std::string& name)
@@ -31,29 +694,20 @@ std::unique_ptr<INIFileA::Section> INIFileA::section(const std::string& name)
 
 bool INIFileA::read_section_names(std::vector<std::string>& section_names, const ulong max_chars)
 {
-  section_names.clear();
+  UNREFERENCED_PARAMETER(max_chars);
 
-  Buffer p(max_chars);
-
-  DWORD actual_chars = GetPrivateProfileSectionNamesA(
-    LPSTR(p.pointer()), max_chars, m_file_path.c_str());
+  section_names.clear();
 
-  // MSDN said:
-  // If the buffer is not large enough to contain all the section names associated with the
-  // specified initialization file, the return value is equal to the size specified by nSize minus two.
-  if (actual_chars == max_chars - 2)
+  if (!this->load())
   {
-    SetLastError(ERROR_NOT_ENOUGH_MEMORY);
     return false;
   }
 
-  m_last_error_code = GetLastError();
+  section_names = m_document.section_names();
 
-  for (char* s = LPSTR(p.pointer()); *s; s++)
+  for (auto& section_name : section_names)
   {
-    std::string section_name = s;
-    section_names.push_back(std::move(section_name));
-    s += lstrlenA(s);
+    section_name = ini_from_document(m_encoding, section_name);
   }
 
   return true;
@@ -62,44 +716,29 @@ bool INIFileA::read_section_names(std::vector<std::string>& section_names, const
 std::string vuapi INIFileA::read_string(
   const std::string& section, const std::string& key, const std::string& def)
 {
-  std::string s;
-  s.clear();
-
-  std::unique_ptr<char[]> p(new char[MAX_SIZE]);
-  if (p == nullptr)
+  if (!this->load())
   {
-    return s;
+    return def;
   }
 
-  ZeroMemory(p.get(), MAX_SIZE);
-
-  ulong result = GetPrivateProfileStringA(
-    section.c_str(),
-    key.c_str(),
-    def.c_str(),
-    p.get(),
-    MAX_SIZE,
-    m_file_path.c_str()
-  );
+  auto ptr_value = m_document.find(ini_to_document(m_encoding, section), ini_to_document(m_encoding, key));
+  return ptr_value != nullptr ? ini_from_document(m_encoding, *ptr_value) : def;
+}
 
-  if (result == 0)
+bool vuapi INIFileA::write_string(
+  const std::string& section, const std::string& key, const std::string& val)
+{
+  if (!this->load())
   {
-    m_last_error_code = GetLastError();
-    return s;
+    return false;
   }
 
-  s.assign(p.get());
+  m_document.set(
+    ini_to_document(m_encoding, section), ini_to_document(m_encoding, key), ini_to_document(m_encoding, val));
 
-  return s;
-}
+  ini_pending_add(m_pending, m_pending_index, section, key, val);
 
-bool vuapi INIFileA::write_string(
-  const std::string& section, const std::string& key, const std::string& val)
-{
-  bool result = WritePrivateProfileStringA(
-    section.c_str(), key.c_str(), val.c_str(), m_file_path.c_str()) != 0;
-  m_last_error_code = GetLastError();
-  return result;
+  return true;
 }
 
 vu::VariantA INIFileA::read(const std::string& section, const std::string& key)
@@ -114,22 +753,179 @@ bool INIFileA::write(const std::string& section, const std::string& key, const V
   return this->write_string(section, key, var.to_string());
 }
 
+bool INIFileA::changed(uint64& time, uint64& size)
+{
+  ini_file_stamp(to_string_W(m_file_path), time, size);
+  return time != m_time || size != m_size;
+}
+
+bool INIFileA::load()
+{
+  uint64 time = 0, size = 0;
+
+  if (m_loaded && !this->changed(time, size))
+  {
+    return true;
+  }
+
+  // the first load, or the file was changed by another writer meanwhile, so (re)load it then
+  // re-apply the pending writes on top
+
+  if (!this->load_file())
+  {
+    return false;
+  }
+
+  for (const auto& pending : m_pending)
+  {
+    m_document.set(
+      ini_to_document(m_encoding, pending.section),
+      ini_to_document(m_encoding, pending.key),
+      ini_to_document(m_encoding, pending.value));
+  }
+
+  return true;
+}
+
+bool INIFileA::reload()
+{
+  m_pending.clear();
+  m_pending_index.clear();
+
+  return this->load_file();
+}
+
+bool INIFileA::load_file()
+{
+  m_document.clear();
+  m_encoding = text_encoding::TE_UNKNOWN;
+  m_loaded = false;
+
+  if (m_file_path.empty())
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return false;
+  }
+
+  if (!ini_file_stamp(to_string_W(m_file_path), m_time, m_size))
+  {
+    m_last_error_code = GetLastError();
+    m_loaded = ini_file_not_found(m_last_error_code); // a new file
+    return m_loaded;
+  }
+
+  auto& document = m_document;
+  auto& encoding = m_encoding;
+
+  m_loaded = ini_map_file<FileMappingA>(m_file_path, m_size, m_last_error_code,
+    [&](const byte* ptr, const size_t size) -> void
+  {
+    encoding = ini_detect_encoding(ptr, size);
+
+    switch (encoding)
+    {
+    case text_encoding::TE_UTF16_LE_BOM:
+      {
+        std::string text;
+        const size_t length = (size - sizeof(INI_BOM_UTF16)) / sizeof(wchar);
+        utf16_to_utf8(reinterpret_cast<const wchar*>(ptr + sizeof(INI_BOM_UTF16)), length, text);
+        document.parse(text);
+      }
+      break;
+
+    case text_encoding::TE_UTF8_BOM:
+      document.parse(reinterpret_cast<const char*>(ptr + sizeof(INI_BOM_UTF8)), size - sizeof(INI_BOM_UTF8));
+      break;
+
+    default:
+      document.parse(reinterpret_cast<const char*>(ptr), size);
+      break;
+    }
+  });
+
+  return m_loaded;
+}
+
+bool INIFileA::flush()
+{
+  if (m_pending.empty())
+  {
+    return true;
+  }
+
+  if (m_file_path.empty())
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return false;
+  }
+
+  if (!this->load()) // merge with the changes of the other writers since the last load
+  {
+    return false;
+  }
+
+  const auto text = m_document.serialize();
+
+  std::string data;
+
+  switch (m_encoding)
+  {
+  case text_encoding::TE_UTF16_LE_BOM:
+    {
+      std::wstring temp;
+      utf8_to_utf16(text.data(), text.length(), temp);
+      data.assign(reinterpret_cast<const char*>(INI_BOM_UTF16), sizeof(INI_BOM_UTF16));
+      data.append(reinterpret_cast<const char*>(temp.data()), temp.length() * sizeof(wchar));
+    }
+    break;
+
+  case text_encoding::TE_UTF8_BOM:
+    data.assign(reinterpret_cast<const char*>(INI_BOM_UTF8), sizeof(INI_BOM_UTF8));
+    data.append(text);
+    break;
+
+  default:
+    data = text;
+    break;
+  }
+
+  const auto file_path = to_string_W(m_file_path);
+
+  if (!ini_write_atomic(file_path, data, m_last_error_code))
+  {
+    return false;
+  }
+
+  ini_file_stamp(file_path, m_time, m_size);
+
+  m_document.modified(false);
+
+  m_pending.clear();
+  m_pending_index.clear();
+
+  return true;
+}
+
 /**
  * INIFileW
+ * Note: The new files are created in the ANSI code page as WritePrivateProfileStringW.
  */
 
 INIFileW::INIFileW() : LastError()
+  , m_encoding(text_encoding::TE_UNKNOWN), m_loaded(false), m_time(0), m_size(0)
 {
   m_file_path = L"";
 }
 
 INIFileW::INIFileW(const std::wstring& file_path) : LastError()
+  , m_encoding(text_encoding::TE_UNKNOWN), m_loaded(false), m_time(0), m_size(0)
 {
   m_file_path = file_path;
 }
 
 INIFileW::~INIFileW()
 {
+  this->flush();
 }
 
 std::unique_ptr<INIFileW::Section> INIFileW::section(const std::wstring& name)
@@ -139,30 +935,16 @@ std::unique_ptr<INIFileW::Section> INIFileW::section(const std::wstring& name)
 
 bool INIFileW::read_section_names(std::vector<std::wstring>& section_names, const ulong max_chars)
 {
-  section_names.clear();
+  UNREFERENCED_PARAMETER(max_chars);
 
-  Buffer p(max_chars * 2);
-
-  DWORD actual_chars = GetPrivateProfileSectionNamesW(
-    LPWSTR(p.pointer()), max_chars, m_file_path.c_str());
+  section_names.clear();
 
-  // MSDN said:
-  // If the buffer is not large enough to contain all the section names associated with the
-  // specified initialization file, the return value is equal to the size specified by nSize minus two.
-  if (actual_chars == max_chars - 2)
+  if (!this->load())
   {
-    SetLastError(ERROR_NOT_ENOUGH_MEMORY);
     return false;
   }
 
-  m_last_error_code = GetLastError();
-
-  for (wchar* s = LPWSTR(p.pointer()); *s; s++)
-  {
-    std::wstring section_name = s;
-    section_names.push_back(std::move(section_name));
-    s += lstrlenW(s);
-  }
+  section_names = m_document.section_names();
 
   return true;
 }
@@ -170,43 +952,28 @@ bool INIFileW::read_section_names(std::vector<std::wstring>& section_names, cons
 std::wstring INIFileW::read_string(
   const std::wstring& section, const std::wstring& key, const std::wstring& def)
 {
-  std::wstring s;
-  s.clear();
-
-  std::unique_ptr<wchar[]> p(new wchar[MAX_SIZE]);
-  if (p == nullptr)
+  if (!this->load())
   {
-    return s;
+    return def;
   }
 
-  ZeroMemory(p.get(), 2 * MAX_SIZE);
+  auto ptr_value = m_document.find(section, key);
+  return ptr_value != nullptr ? *ptr_value : def;
+}
 
-  ulong result = GetPrivateProfileStringW(
-    section.c_str(),
-    key.c_str(),
-    def.c_str(),
-    p.get(),
-    2 * MAX_SIZE,
-    m_file_path.c_str()
-  );
-  if (result == 0)
+bool INIFileW::write_string(
+  const std::wstring& section, const std::wstring& key, const std::wstring& val)
+{
+  if (!this->load())
   {
-    m_last_error_code = GetLastError();
-    return s;
+    return false;
   }
 
-  s.assign(p.get());
+  m_document.set(section, key, val);
 
-  return s;
-}
+  ini_pending_add(m_pending, m_pending_index, section, key, val);
 
-bool INIFileW::write_string(
-  const std::wstring& section, const std::wstring& key, const std::wstring& val)
-{
-  bool result = WritePrivateProfileStringW(
-    section.c_str(), key.c_str(), val.c_str(), m_file_path.c_str()) != 0;
-  m_last_error_code = GetLastError();
-  return result;
+  return true;
 }
 
 vu::VariantW INIFileW::read(const std::wstring& section, const std::wstring& key)
@@ -221,4 +988,149 @@ bool INIFileW::write(const std::wstring& section, const std::wstring& key, const
   return this->write_string(section, key, var.to_string());
 }
 
-} // namespace vu
\ No newline at end of file
+bool INIFileW::changed(uint64& time, uint64& size)
+{
+  ini_file_stamp(m_file_path, time, size);
+  return time != m_time || size != m_size;
+}
+
+bool INIFileW::load()
+{
+  uint64 time = 0, size = 0;
+
+  if (m_loaded && !this->changed(time, size))
+  {
+    return true;
+  }
+
+  // the first load, or the file was changed by another writer meanwhile, so (re)load it then
+  // re-apply the pending writes on top
+
+  if (!this->load_file())
+  {
+    return false;
+  }
+
+  for (const auto& pending : m_pending)
+  {
+    m_document.set(pending.section, pending.key, pending.value);
+  }
+
+  return true;
+}
+
+bool INIFileW::reload()
+{
+  m_pending.clear();
+  m_pending_index.clear();
+
+  return this->load_file();
+}
+
+bool INIFileW::load_file()
+{
+  m_document.clear();
+  m_encoding = text_encoding::TE_UNKNOWN;
+  m_loaded = false;
+
+  if (m_file_path.empty())
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return false;
+  }
+
+  if (!ini_file_stamp(m_file_path, m_time, m_size))
+  {
+    m_last_error_code = GetLastError();
+    m_loaded = ini_file_not_found(m_last_error_code); // a new file
+    return m_loaded;
+  }
+
+  auto& document = m_document;
+  auto& encoding = m_encoding;
+
+  m_loaded = ini_map_file<FileMappingW>(m_file_path, m_size, m_last_error_code,
+    [&](const byte* ptr, const size_t size) -> void
+  {
+    encoding = ini_detect_encoding(ptr, size);
+
+    switch (encoding)
+    {
+    case text_encoding::TE_UTF16_LE_BOM: // the view is page-aligned so it is parsed in place
+      document.parse(
+        reinterpret_cast<const wchar*>(ptr + sizeof(INI_BOM_UTF16)),
+        (size - sizeof(INI_BOM_UTF16)) / sizeof(wchar));
+      break;
+
+    case text_encoding::TE_UTF8_BOM:
+      {
+        std::wstring text;
+        utf8_to_utf16(reinterpret_cast<const char*>(ptr + sizeof(INI_BOM_UTF8)), size - sizeof(INI_BOM_UTF8), text);
+        document.parse(text);
+      }
+      break;
+
+    default:
+      document.parse(to_string_W(std::string(reinterpret_cast<const char*>(ptr), size)));
+      break;
+    }
+  });
+
+  return m_loaded;
+}
+
+bool INIFileW::flush()
+{
+  if (m_pending.empty())
+  {
+    return true;
+  }
+
+  if (m_file_path.empty())
+  {
+    m_last_error_code = ERROR_INVALID_PARAMETER;
+    return false;
+  }
+
+  if (!this->load()) // merge with the changes of the other writers since the last load
+  {
+    return false;
+  }
+
+  const auto text = m_document.serialize();
+
+  std::string data;
+
+  switch (m_encoding)
+  {
+  case text_encoding::TE_UTF8_BOM:
+    data.assign(reinterpret_cast<const char*>(INI_BOM_UTF8), sizeof(INI_BOM_UTF8));
+    data.append(to_string_A(text, true));
+    break;
+
+  case text_encoding::TE_UTF16_LE_BOM:
+    data.assign(reinterpret_cast<const char*>(INI_BOM_UTF16), sizeof(INI_BOM_UTF16));
+    data.append(reinterpret_cast<const char*>(text.data()), text.length() * sizeof(wchar));
+    break;
+
+  default:
+    data = to_string_A(text);
+    break;
+  }
+
+  if (!ini_write_atomic(m_file_path, data, m_last_error_code))
+  {
+    return false;
+  }
+
+  ini_file_stamp(m_file_path, m_time, m_size);
+
+  m_document.modified(false);
+
+  m_pending.clear();
+  m_pending_index.clear();
+
+  return true;
+}
+
+} // namespace vu
@@ -105,6 +105,102 @@ intptr vuapi lcm(ulongptr count, ...) // Least Common Multiples -> UCLN = | a1 *
   return result;
 }
 
+static inline ulong count_trailing_zeros_64(const uint64 v)
+{
+  #if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index = 0;
+  _BitScanForward64(&index, v);
+  return index;
+  #elif defined(_MSC_VER)
+  unsigned long index = 0;
+  if (_BitScanForward(&index, ulong(v)) == 0)
+  {
+    _BitScanForward(&index, ulong(v >> 32));
+    index += 32;
+  }
+  return index;
+  #else // _MSC_VER
+  return __builtin_ctzll(v);
+  #endif // _MSC_VER
+}
+
+static uint64 binary_gcd(uint64 a, uint64 b) // Stein's algorithm
+{
+  if (a == 0 || b == 0)
+  {
+    return a | b;
+  }
+
+  const auto shift = count_trailing_zeros_64(a | b);
+  a >>= count_trailing_zeros_64(a);
+
+  do
+  {
+    b >>= count_trailing_zeros_64(b);
+    if (a > b)
+    {
+      std::swap(a, b);
+    }
+    b -= a;
+  } while (b != 0);
+
+  return a << shift;
+}
+
+/**
+ * The Greatest Common Divisor of the values (the zeros are skipped).
+ * It stops early once the result is 1.
+ */
+uint64 vuapi gcd(const uint64* values, const size_t count)
+{
+  uint64 result = 0;
+
+  if (values == nullptr)
+  {
+    return result;
+  }
+
+  for (size_t i = 0; i < count && result != 1; i++)
+  {
+    result = binary_gcd(result, values[i]);
+  }
+
+  return result;
+}
+
+/**
+ * The Least Common Multiple of the values.
+ * It is 0 if any value is 0 or the result does not fit in 64 bits.
+ */
+uint64 vuapi lcm(const uint64* values, const size_t count)
+{
+  uint64 result = 1;
+
+  if (values == nullptr)
+  {
+    return result;
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    const auto v = values[i];
+    if (v == 0)
+    {
+      return 0;
+    }
+
+    const auto m = v / binary_gcd(result, v);
+    if (result > uint64(-1) / m)
+    {
+      return 0;
+    }
+
+    result *= m;
+  }
+
+  return result;
+}
+
 // https://en.wikipedia.org/wiki/Fast_inverse_square_root#Overview_of_the_code
 float q_rsqrt(float number)
 {
@@ -128,8 +224,44 @@ float vuapi fast_sqrtf(const float number)
   return 1.F / q_rsqrt(number);
 }
 
+/**
+ * The piece idx of the blocks [0, num_blocks) that are divided into num_pieces balanced pieces,
+ * the first (num_blocks % num_pieces) pieces have one block more than the others.
+ * A block is `alignment` items, the last one is clipped by num_items.
+ */
+static piece_t piece_of_blocks(const size_t num_items, const size_t alignment,
+  const size_t num_blocks, const size_t num_pieces, const size_t idx)
+{
+  const size_t base = num_blocks / num_pieces;
+  const size_t remainder = num_blocks % num_pieces;
+
+  const size_t beg_block = idx * base + (idx < remainder ? idx : remainder);
+  const size_t end_block = beg_block + base + (idx < remainder ? 1 : 0);
+
+  piece_t piece;
+  piece.idx = idx;
+
+  if (beg_block == end_block)
+  {
+    piece.beg = size_t(-1);
+    piece.end = size_t(-1);
+    piece.num = 0;
+    return piece;
+  }
+
+  const size_t beg = beg_block * alignment;
+  const size_t end = end_block == num_blocks ? num_items : end_block * alignment;
+
+  piece.beg = beg;
+  piece.end = end - 1;
+  piece.num = end - beg;
+
+  return piece;
+}
+
 /**
  * Divides a set of items into a specified number of pieces.
+ * The pieces are balanced, their numbers of items are different by one at most.
  * @param[in] num_items  The number of items.
  * @param[in] num_pieces The number of pieces.
  * @param[in] fn The function that apply to each piece.
@@ -140,34 +272,22 @@ float vuapi fast_sqrtf(const float number)
  * Eg. In these cases, the number of items of each piece as the following:
  *  (4, 1) => (4)
  *  (4, 2) => (2, 2)
- *  (4, 3) => (1, 1, 2)
+ *  (4, 3) => (2, 1, 1)
  *  (4, 4) => (1, 1, 1, 1)
  *  (4, 5) => (1, 1, 1, 1, 0)
+ *  (10, 4) => (3, 3, 2, 2)
  */
 void divide_items_into_pieces(const size_t num_items, const size_t num_pieces,
   std::function<void(const piece_t& piece)> fn)
 {
-  if (fn == nullptr)
+  if (fn == nullptr || num_pieces == 0)
   {
     return;
   }
 
-  size_t num_items_per_piece = std::max(1, int(num_items / float(num_pieces) + 0.5F));
-
-  piece_t piece;
-
   for (size_t idx = 0; idx < num_pieces; ++idx)
   {
-    size_t beg = idx * num_items_per_piece;
-    size_t end = idx == num_pieces - 1 ? num_items : (idx + 1) * num_items_per_piece;
-    size_t num = end - beg;
-
-    piece.idx = idx;
-    piece.beg = idx < num_items ? beg : -1;
-    piece.end = idx < num_items ? end - 1 : -1;
-    piece.num = idx < num_items ? num : 0;
-
-    fn(piece);
+    fn(piece_of_blocks(num_items, 1, num_items, num_pieces, idx));
   }
 }
 
@@ -191,38 +311,125 @@ void divide_items_into_pieces(const size_t num_items, const size_t num_pieces,
 size_t divide_items_into_num_items_per_piece(const size_t num_items, const size_t num_items_per_piece,
   std::function<void(const piece_t& piece)> fn)
 {
-  if (fn == nullptr)
+  if (fn == nullptr || num_items_per_piece == 0)
   {
     return 0;
   }
 
+  const size_t num_pieces = num_items / num_items_per_piece + (num_items % num_items_per_piece != 0 ? 1 : 0);
+
   piece_t piece;
 
-  size_t result = 0;
+  for (size_t idx = 0; idx < num_pieces; ++idx)
+  {
+    const size_t beg = idx * num_items_per_piece;
+    const size_t num = idx == num_pieces - 1 ? num_items - beg : num_items_per_piece;
+
+    piece.idx = idx;
+    piece.beg = beg;
+    piece.end = beg + num - 1;
+    piece.num = num;
 
-  std::vector<size_t> temp;
+    fn(piece);
+  }
 
-  for (size_t j = 1; j <= num_items; j++)
+  return num_pieces;
+}
+
+/**
+ * The number of blocks and pieces of the items for divide_items(...).
+ */
+static size_t divide_items_blocks(const size_t num_items, size_t num_pieces,
+  const size_t grain_size, const size_t alignment, size_t& num_blocks)
+{
+  num_blocks = num_items / alignment + (num_items % alignment != 0 ? 1 : 0);
+
+  if (num_blocks == 0)
   {
-    size_t i = j - 1;
+    return 0;
+  }
 
-    temp.push_back(i);
+  if (num_pieces == size_t(MAX_NTHREADS))
+  {
+    num_pieces = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  else if (num_pieces == 0)
+  {
+    num_pieces = 1;
+  }
 
-    if (j % num_items_per_piece == 0 || i == num_items - 1)
-    {
-      piece.idx = result;
-      piece.beg = temp.front();
-      piece.end = temp.back();
-      piece.num = temp.size();
+  const size_t grain_blocks = grain_size / alignment + (grain_size % alignment != 0 ? 1 : 0);
+  const size_t limit = std::max<size_t>(1, num_blocks / std::max<size_t>(1, grain_blocks));
 
-      fn(piece);
+  return std::min(num_pieces, limit);
+}
 
-      temp.clear();
-      result += 1;
-    }
+/**
+ * The number of (non-empty) pieces that divide_items(...) produces.
+ */
+size_t divide_items_count(const size_t num_items, const size_t num_pieces,
+  const size_t grain_size, const size_t alignment)
+{
+  size_t num_blocks = 0;
+  return divide_items_blocks(num_items, num_pieces, grain_size, std::max<size_t>(1, alignment), num_blocks);
+}
+
+/**
+ * The piece idx that divide_items(...) produces, in O(1) (eg. for a worker that computes its own range).
+ * It is an empty piece (beg = end = -1, num = 0) if idx is out of range.
+ */
+piece_t divide_items_at(const size_t num_items, const size_t num_pieces, const size_t idx,
+  const size_t grain_size, const size_t alignment)
+{
+  const size_t align = std::max<size_t>(1, alignment);
+
+  size_t num_blocks = 0;
+  const size_t count = divide_items_blocks(num_items, num_pieces, grain_size, align, num_blocks);
+  if (idx >= count)
+  {
+    piece_t piece;
+    piece.idx = idx;
+    piece.beg = size_t(-1);
+    piece.end = size_t(-1);
+    return piece;
   }
 
-  return result;
+  return piece_of_blocks(num_items, align, num_blocks, count, idx);
+}
+
+/**
+ * Divides a set of items into the balanced pieces in O(pieces).
+ * @param[in] num_items  The number of items.
+ * @param[in] num_pieces The maximum number of pieces (MAX_NTHREADS for the number of hardware threads).
+ * @param[in] fn The function that apply to each (non-empty) piece.
+ * @param[in] grain_size The minimum number of items per piece, so there are fewer pieces for the few items.
+ * @param[in] alignment The piece boundaries are the multiples of it (in items),
+ *    eg. 64 / sizeof(T) to avoid the false sharing of the cache lines, 4096 / sizeof(T) for the pages.
+ * @return The number of pieces.
+ * Eg. The number of items of each piece as the following.
+ *  (10, 4)         => (3, 3, 2, 2)
+ *  (10, 4, 4)      => (5, 5)
+ *  (100, 4, 1, 16) => (32, 32, 32, 4)
+ */
+size_t divide_items(const size_t num_items, const size_t num_pieces,
+  std::function<void(const piece_t& piece)> fn, const size_t grain_size, const size_t alignment)
+{
+  if (fn == nullptr)
+  {
+    return 0;
+  }
+
+  const size_t align = std::max<size_t>(1, alignment);
+
+  size_t num_blocks = 0;
+  const size_t count = divide_items_blocks(num_items, num_pieces, grain_size, align, num_blocks);
+
+  for (size_t idx = 0; idx < count; ++idx)
+  {
+    fn(piece_of_blocks(num_items, align, num_blocks, count, idx));
+  }
+
+  return count;
 }
 
 } // namespace vu
\ No newline at end of file
@@ -23,6 +23,426 @@ typedef struct _IMAGE_BASE_RELOCATION_ENTRY
 #define COUNT_RELOCATION_ENTRY(ptr)\
   (ptr == nullptr ? 0 : (PIMAGE_BASE_RELOCATION(ptr)->SizeOfBlock - sizeof(IMAGE_BASE_RELOCATION)) / sizeof(IMAGE_BASE_RELOCATION_ENTRY))
 
+/**
+ * PE Resource
+ */
+
+bool PEResourceText::empty() const
+{
+  return ptr == nullptr || length == 0;
+}
+
+bool PEResourceText::equals(const std::wstring& text, bool ignore_case) const
+{
+  if (text.length() != length)
+  {
+    return false;
+  }
+
+  if (length == 0)
+  {
+    return true;
+  }
+
+  if (ignore_case)
+  {
+    return _wcsnicmp(ptr, text.c_str(), length) == 0;
+  }
+
+  return wmemcmp(ptr, text.c_str(), length) == 0;
+}
+
+std::wstring PEResourceText::as_string() const
+{
+  return this->empty() ? std::wstring() : std::wstring(ptr, length);
+}
+
+bool PEResourceId::named() const
+{
+  return name.ptr != nullptr;
+}
+
+PEResourceNode::PEResourceNode()
+  : m_ptr_root(nullptr), m_root_rva(0), m_root_size(0), m_offset(0), m_directory(false)
+{
+}
+
+PEResourceNode::PEResourceNode(const byte* ptr_root, const ulong root_rva, const ulong root_size)
+  : m_ptr_root(ptr_root), m_root_rva(root_rva), m_root_size(root_size), m_offset(0), m_directory(true)
+{
+  if (this->at(0, sizeof(IMAGE_RESOURCE_DIRECTORY)) == nullptr)
+  {
+    m_ptr_root = nullptr;
+  }
+}
+
+PEResourceNode::PEResourceNode(const PEResourceNode& parent, const ulong entry_offset)
+  : m_ptr_root(parent.m_ptr_root)
+  , m_root_rva(parent.m_root_rva)
+  , m_root_size(parent.m_root_size)
+  , m_offset(0)
+  , m_directory(false)
+{
+  auto ptr_entry = static_cast<const IMAGE_RESOURCE_DIRECTORY_ENTRY*>(
+    parent.at(entry_offset, sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY)));
+  if (ptr_entry == nullptr)
+  {
+    m_ptr_root = nullptr;
+    return;
+  }
+
+  if (ptr_entry->Name & IMAGE_RESOURCE_NAME_IS_STRING)
+  {
+    // IMAGE_RESOURCE_DIR_STRING_U - The length-prefixed (not null-terminated) unicode string
+
+    const ulong name_offset = ptr_entry->Name & ~IMAGE_RESOURCE_NAME_IS_STRING;
+    auto ptr_length = static_cast<const ushort*>(this->at(name_offset, sizeof(ushort)));
+    if (ptr_length == nullptr ||
+      this->at(name_offset, sizeof(ushort) + *ptr_length * sizeof(wchar)) == nullptr)
+    {
+      m_ptr_root = nullptr;
+      return;
+    }
+
+    m_id.name = PEResourceText(reinterpret_cast<const wchar*>(ptr_length + 1), *ptr_length);
+  }
+  else
+  {
+    m_id.id = LOWORD(ptr_entry->Name);
+  }
+
+  m_directory = (ptr_entry->OffsetToData & IMAGE_RESOURCE_DATA_IS_DIRECTORY) != 0;
+  m_offset = ptr_entry->OffsetToData & ~IMAGE_RESOURCE_DATA_IS_DIRECTORY;
+
+  const ulong size = m_directory ? sizeof(IMAGE_RESOURCE_DIRECTORY) : sizeof(IMAGE_RESOURCE_DATA_ENTRY);
+  if (this->at(m_offset, size) == nullptr)
+  {
+    m_ptr_root = nullptr;
+  }
+}
+
+PEResourceNode::~PEResourceNode()
+{
+}
+
+const void* PEResourceNode::at(const ulong offset, const ulong size) const
+{
+  if (m_ptr_root == nullptr || offset > m_root_size || size > m_root_size - offset)
+  {
+    return nullptr;
+  }
+
+  return m_ptr_root + offset;
+}
+
+bool PEResourceNode::valid() const
+{
+  return m_ptr_root != nullptr;
+}
+
+bool PEResourceNode::is_directory() const
+{
+  return this->valid() && m_directory;
+}
+
+const PEResourceId& PEResourceNode::id() const
+{
+  return m_id;
+}
+
+ulong PEResourceNode::count() const
+{
+  if (!this->is_directory())
+  {
+    return 0;
+  }
+
+  auto ptr_directory = static_cast<const IMAGE_RESOURCE_DIRECTORY*>(
+    this->at(m_offset, sizeof(IMAGE_RESOURCE_DIRECTORY)));
+  assert(ptr_directory != nullptr);
+
+  return ulong(ptr_directory->NumberOfNamedEntries) + ulong(ptr_directory->NumberOfIdEntries);
+}
+
+PEResourceNode PEResourceNode::child(const ulong index) const
+{
+  if (index >= this->count())
+  {
+    return PEResourceNode();
+  }
+
+  const ulong entry_offset = m_offset + sizeof(IMAGE_RESOURCE_DIRECTORY) +\
+    index * sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY);
+
+  return PEResourceNode(*this, entry_offset);
+}
+
+PEResourceNode PEResourceNode::find(const ushort id) const
+{
+  if (!this->is_directory())
+  {
+    return PEResourceNode();
+  }
+
+  auto ptr_directory = static_cast<const IMAGE_RESOURCE_DIRECTORY*>(
+    this->at(m_offset, sizeof(IMAGE_RESOURCE_DIRECTORY)));
+  assert(ptr_directory != nullptr);
+
+  // The named entries come first then the id entries which are sorted in ascending order,
+  // so perform a binary search on the raw entries without materializing the nodes.
+
+  const ulong entries_offset = m_offset + sizeof(IMAGE_RESOURCE_DIRECTORY);
+
+  ulong lo = ptr_directory->NumberOfNamedEntries;
+  ulong hi = lo + ptr_directory->NumberOfIdEntries;
+
+  while (lo < hi)
+  {
+    const ulong mid = lo + (hi - lo) / 2;
+    const ulong entry_offset = entries_offset + mid * sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY);
+
+    auto ptr_entry = static_cast<const IMAGE_RESOURCE_DIRECTORY_ENTRY*>(
+      this->at(entry_offset, sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY)));
+    if (ptr_entry == nullptr)
+    {
+      break;
+    }
+
+    const ushort v = LOWORD(ptr_entry->Name);
+    if (v == id)
+    {
+      return PEResourceNode(*this, entry_offset);
+    }
+
+    if (v < id)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return PEResourceNode();
+}
+
+PEResourceNode PEResourceNode::find(const std::wstring& name, bool ignore_case) const
+{
+  if (!this->is_directory())
+  {
+    return PEResourceNode();
+  }
+
+  auto ptr_directory = static_cast<const IMAGE_RESOURCE_DIRECTORY*>(
+    this->at(m_offset, sizeof(IMAGE_RESOURCE_DIRECTORY)));
+  assert(ptr_directory != nullptr);
+
+  for (ulong i = 0; i < ptr_directory->NumberOfNamedEntries; i++)
+  {
+    auto node = this->child(i);
+    if (node.valid() && node.id().name.equals(name, ignore_case))
+    {
+      return node;
+    }
+  }
+
+  return PEResourceNode();
+}
+
+PEResourceNode PEResourceNode::first() const
+{
+  return this->child(0);
+}
+
+bool PEResourceNode::data(PEResourceData& data) const
+{
+  if (!this->valid() || m_directory)
+  {
+    return false;
+  }
+
+  auto ptr_data_entry = static_cast<const IMAGE_RESOURCE_DATA_ENTRY*>(
+    this->at(m_offset, sizeof(IMAGE_RESOURCE_DATA_ENTRY)));
+  assert(ptr_data_entry != nullptr);
+
+  data.rva  = ptr_data_entry->OffsetToData;
+  data.size = ptr_data_entry->Size;
+  data.code_page = ptr_data_entry->CodePage;
+  data.ptr  = nullptr;
+
+  if (data.rva >= m_root_rva)
+  {
+    data.ptr = static_cast<const byte*>(this->at(data.rva - m_root_rva, data.size));
+  }
+
+  return data.ptr != nullptr;
+}
+
+bool PEResourceNode::iterate(const std::function<bool(const PEResourceNode& node)> fn) const
+{
+  if (!this->is_directory())
+  {
+    return false;
+  }
+
+  const auto n = this->count();
+  for (ulong i = 0; i < n; i++)
+  {
+    if (!fn(this->child(i)))
+    {
+      break;
+    }
+  }
+
+  return true;
+}
+
+const PEVersionString* PEVersionInfo::find(const std::wstring& key, bool ignore_case) const
+{
+  for (const auto& e : strings)
+  {
+    if (e.key.equals(key, ignore_case))
+    {
+      return &e;
+    }
+  }
+
+  return nullptr;
+}
+
+/**
+ * VS_VERSIONINFO / StringFileInfo / StringTable / String / VarFileInfo / Var
+ * https://docs.microsoft.com/en-us/windows/win32/menurc/vs-versioninfo
+ */
+
+struct VersionBlock
+{
+  ushort length;
+  ushort value_length;
+  ushort type;
+  PEResourceText key;
+  const byte* ptr_value;
+  ulong value_size;
+  const byte* ptr_children;
+  const byte* ptr_end;
+};
+
+static const byte* align_version_block(const byte* ptr_base, const byte* ptr)
+{
+  return ptr_base + VU_ALIGN_UP(ulongptr(ptr - ptr_base), sizeof(DWORD));
+}
+
+static bool read_version_block(
+  const byte* ptr_base, const byte* ptr, const byte* ptr_limit, VersionBlock& block)
+{
+  const ulong header_size = 3 * sizeof(ushort);
+
+  if (ptr >= ptr_limit || ulong(ptr_limit - ptr) < header_size)
+  {
+    return false;
+  }
+
+  auto ptr_words = reinterpret_cast<const ushort*>(ptr);
+  block.length = ptr_words[0];
+  block.value_length = ptr_words[1];
+  block.type = ptr_words[2];
+
+  if (block.length < header_size || ulong(ptr_limit - ptr) < block.length)
+  {
+    return false;
+  }
+
+  block.ptr_end = ptr + block.length;
+
+  auto ptr_key = reinterpret_cast<const wchar*>(ptr + header_size);
+  auto ptr_key_end = ptr_key;
+  while (reinterpret_cast<const byte*>(ptr_key_end + 1) <= block.ptr_end && *ptr_key_end != L'\0')
+  {
+    ptr_key_end++;
+  }
+
+  if (reinterpret_cast<const byte*>(ptr_key_end + 1) > block.ptr_end)
+  {
+    return false;
+  }
+
+  block.key = PEResourceText(ptr_key, ptr_key_end - ptr_key);
+
+  block.ptr_value = align_version_block(ptr_base, reinterpret_cast<const byte*>(ptr_key_end + 1));
+  if (block.ptr_value > block.ptr_end)
+  {
+    block.ptr_value = block.ptr_end;
+  }
+
+  // The value length is in words for the text value and in bytes for the binary value
+
+  block.value_size = block.type == 1 ? block.value_length * sizeof(wchar) : block.value_length;
+  if (block.value_size > ulong(block.ptr_end - block.ptr_value))
+  {
+    block.value_size = ulong(block.ptr_end - block.ptr_value);
+  }
+
+  block.ptr_children = align_version_block(ptr_base, block.ptr_value + block.value_size);
+  if (block.ptr_children > block.ptr_end)
+  {
+    block.ptr_children = block.ptr_end;
+  }
+
+  return true;
+}
+
+static void iterate_version_blocks(
+  const byte* ptr_base, const VersionBlock& parent, const std::function<void(const VersionBlock& block)> fn)
+{
+  for (auto ptr = parent.ptr_children; ptr < parent.ptr_end;)
+  {
+    VersionBlock block;
+    if (!read_version_block(ptr_base, ptr, parent.ptr_end, block))
+    {
+      break;
+    }
+
+    fn(block);
+
+    ptr = align_version_block(ptr_base, block.ptr_end);
+  }
+}
+
+static PEResourceNode find_resource_leaf(PEResourceNode node, const ushort lang)
+{
+  return lang == 0 ? node.first() : node.find(lang);
+}
+
+static bool parse_string_block(
+  const PEResourceData& data,
+  const uint block_id,
+  const std::function<bool(const uint id, const PEResourceText& text)> fn)
+{
+  // RT_STRING - The block of 16 length-prefixed unicode strings (the id of the block is `id / 16 + 1`)
+
+  auto ptr = reinterpret_cast<const wchar*>(data.ptr);
+  auto ptr_end = ptr + data.size / sizeof(wchar);
+
+  for (uint i = 0; i < 16 && ptr < ptr_end; i++)
+  {
+    const ushort length = *ptr++;
+    if (length > ulongptr(ptr_end - ptr))
+    {
+      return false;
+    }
+
+    if (length != 0 && !fn(((block_id - 1) << 4) | i, PEResourceText(ptr, length)))
+    {
+      return false;
+    }
+
+    ptr += length;
+  }
+
+  return true;
+}
+
 /**
  * PE Classes
  */
@@ -33,6 +453,7 @@ PEFileTX<T>::PEFileTX()
   m_initialized = false;
 
   m_ptr_base = nullptr;
+  m_file_size = 0;
   m_ptr_dos_header = nullptr;
   m_ptr_pe_header  = nullptr;
   m_section_headers.clear();
@@ -502,6 +923,207 @@ T vuapi PEFileTX<T>::offset_to_rva(T offset, bool in_cache)
   return result;
 }
 
+template<typename T>
+PEResourceNode vuapi PEFileTX<T>::get_resource_root()
+{
+  if (!m_initialized)
+  {
+    assert(0);
+  }
+
+  const auto& idd = m_ptr_pe_header->OptHeader.Resource;
+  if (idd.VirtualAddress == 0 || idd.Size == 0)
+  {
+    return PEResourceNode();
+  }
+
+  this->get_setion_headers();
+
+  for (const auto& e : m_section_headers)
+  {
+    const ulong virtual_size = e->Misc.VirtualSize != 0 ? e->Misc.VirtualSize : e->SizeOfRawData;
+    if (idd.VirtualAddress < e->VirtualAddress || idd.VirtualAddress >= e->VirtualAddress + virtual_size)
+    {
+      continue;
+    }
+
+    const ulong delta = idd.VirtualAddress - e->VirtualAddress;
+    if (delta >= e->SizeOfRawData)
+    {
+      break;
+    }
+
+    // The resource tree is bounded by the raw data of its section and by the mapped file
+
+    size_t root_offset = size_t(e->PointerToRawData) + delta;
+    size_t root_size = size_t(e->SizeOfRawData - delta);
+
+    if (m_file_size != 0)
+    {
+      if (root_offset >= m_file_size)
+      {
+        break;
+      }
+
+      if (root_size > m_file_size - root_offset)
+      {
+        root_size = m_file_size - root_offset;
+      }
+    }
+
+    auto ptr_root = static_cast<const byte*>(m_ptr_base) + root_offset;
+    return PEResourceNode(ptr_root, idd.VirtualAddress, ulong(root_size));
+  }
+
+  return PEResourceNode();
+}
+
+template<typename T>
+bool vuapi PEFileTX<T>::find_resource(
+  PEResourceData& data, const ushort type, const ushort name, const ushort lang)
+{
+  auto node = this->get_resource_root().find(type).find(name);
+  return find_resource_leaf(node, lang).data(data);
+}
+
+template<typename T>
+bool vuapi PEFileTX<T>::find_resource(
+  PEResourceData& data, const ushort type, const std::wstring& name, const ushort lang)
+{
+  auto node = this->get_resource_root().find(type).find(name);
+  return find_resource_leaf(node, lang).data(data);
+}
+
+template<typename T>
+bool vuapi PEFileTX<T>::get_manifest(PEResourceData& data, const ushort lang)
+{
+  // The manifest id is CREATEPROCESS_MANIFEST_RESOURCE_ID (1) for EXE and ISOLATIONAWARE_MANIFEST_RESOURCE_ID (2) for DLL
+  auto node = this->get_resource_root().find(LOWORD(RT_MANIFEST)).first();
+  return find_resource_leaf(node, lang).data(data);
+}
+
+template<typename T>
+bool vuapi PEFileTX<T>::get_version_info(PEVersionInfo& version_info, const ushort lang)
+{
+  version_info.ptr_fixed_file_info = nullptr;
+  version_info.strings.clear();
+  version_info.translations.clear();
+
+  PEResourceData data;
+  auto node = this->get_resource_root().find(LOWORD(RT_VERSION)).first();
+  if (!find_resource_leaf(node, lang).data(data))
+  {
+    return false;
+  }
+
+  const auto ptr_base = data.ptr;
+
+  VersionBlock root;
+  if (!read_version_block(ptr_base, ptr_base, ptr_base + data.size, root) ||
+    !root.key.equals(L"VS_VERSION_INFO"))
+  {
+    return false;
+  }
+
+  if (root.value_size >= sizeof(VS_FIXEDFILEINFO))
+  {
+    auto ptr_fixed_file_info = reinterpret_cast<const VS_FIXEDFILEINFO*>(root.ptr_value);
+    if (ptr_fixed_file_info->dwSignature == 0xFEEF04BD) // VS_FFI_SIGNATURE
+    {
+      version_info.ptr_fixed_file_info = ptr_fixed_file_info;
+    }
+  }
+
+  iterate_version_blocks(ptr_base, root, [&](const VersionBlock& file_info) -> void
+  {
+    if (file_info.key.equals(L"StringFileInfo"))
+    {
+      iterate_version_blocks(ptr_base, file_info, [&](const VersionBlock& table) -> void
+      {
+        iterate_version_blocks(ptr_base, table, [&](const VersionBlock& string) -> void
+        {
+          auto ptr_value = reinterpret_cast<const wchar*>(string.ptr_value);
+
+          size_t length = 0;
+          const size_t max_length = string.value_size / sizeof(wchar);
+          while (length < max_length && ptr_value[length] != L'\0')
+          {
+            length++;
+          }
+
+          PEVersionString e;
+          e.table = table.key;
+          e.key = string.key;
+          e.value = PEResourceText(ptr_value, length);
+          version_info.strings.push_back(e);
+        });
+      });
+    }
+    else if (file_info.key.equals(L"VarFileInfo"))
+    {
+      iterate_version_blocks(ptr_base, file_info, [&](const VersionBlock& var) -> void
+      {
+        if (!var.key.equals(L"Translation"))
+        {
+          return;
+        }
+
+        auto ptr_translations = reinterpret_cast<const ulong*>(var.ptr_value);
+        for (ulong i = 0; i < var.value_size / sizeof(ulong); i++)
+        {
+          version_info.translations.push_back(ptr_translations[i]);
+        }
+      });
+    }
+  });
+
+  return true;
+}
+
+template<typename T>
+bool vuapi PEFileTX<T>::get_resource_string(PEResourceText& text, const uint id, const ushort lang)
+{
+  text = PEResourceText();
+
+  PEResourceData data;
+  const uint block_id = (id >> 4) + 1;
+  if (block_id > 0xFFFF || !this->find_resource(data, LOWORD(RT_STRING), ushort(block_id), lang))
+  {
+    return false;
+  }
+
+  parse_string_block(data, block_id, [&](const uint string_id, const PEResourceText& string) -> bool
+  {
+    if (string_id != id)
+    {
+      return true;
+    }
+
+    text = string;
+    return false;
+  });
+
+  return !text.empty();
+}
+
+template<typename T>
+bool vuapi PEFileTX<T>::iterate_resource_strings(
+  const std::function<bool(const uint id, const PEResourceText& text)> fn, const ushort lang)
+{
+  auto type = this->get_resource_root().find(LOWORD(RT_STRING));
+
+  return type.iterate([&](const PEResourceNode& block) -> bool
+  {
+    PEResourceData data;
+    if (block.id().named() || block.id().id == 0 || !find_resource_leaf(block, lang).data(data))
+    {
+      return true;
+    }
+
+    return parse_string_block(data, block.id().id, fn);
+  });
+}
+
 template class PEFileTA<ulong32>;
 template class PEFileTA<ulong64>;
 
@@ -556,6 +1178,8 @@ VUResult vuapi PEFileTA<T>::parse()
     return 4;
   }
 
+  PEFileTX<T>::m_file_size = m_file_map.get_file_size();
+
   PEFileTX<T>::m_ptr_dos_header = (PDOSHeader)PEFileTX<T>::m_ptr_base;
   if (PEFileTX<T>::m_ptr_dos_header == nullptr)
   {
@@ -646,6 +1270,8 @@ VUResult vuapi PEFileTW<T>::parse()
     return 4;
   }
 
+  PEFileTX<T>::m_file_size = m_file_map.get_file_size();
+
   PEFileTX<T>::m_ptr_dos_header = (PDOSHeader)PEFileTX<T>::m_ptr_base;
   if (PEFileTX<T>::m_ptr_dos_header == nullptr)
   {
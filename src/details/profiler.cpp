@@ -0,0 +1,531 @@
+/**
+ * @file   profiler.cpp
+ * @author Vic P.
+ * @brief  Implementation for Profiler
+ */
+
+#include "Vutils.h"
+
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+
+namespace vu
+{
+
+static const size_t PROFILE_RING_CAPACITY = 1 << 13; // must be a power of two
+static const ulong  PROFILE_MAX_DEPTH = 64;
+
+static std::atomic<bool> g_profiler_enabled(false);
+
+static_assert(alignof(Profiler) >= alignof(void*), "the atomic flag and the mutexes must be naturally aligned");
+
+/**
+ * ProfileRing - The single-producer (the owner thread) single-consumer (the collector) ring buffer
+ */
+
+struct ProfileRing
+{
+  std::atomic<uint64> head;    // written by the owner thread
+  byte padding_head[64 - sizeof(std::atomic<uint64>)];
+  std::atomic<uint64> tail;    // written by the collector
+  byte padding_tail[64 - sizeof(std::atomic<uint64>)];
+  std::atomic<uint64> dropped; // written by the owner thread, exchanged by the collector
+  std::atomic<bool> retired;   // the owner thread has exited
+  ulong thread_id;
+  ProfileRecord records[PROFILE_RING_CAPACITY];
+
+  ProfileRing() : head(0), tail(0), dropped(0), retired(false), thread_id(GetCurrentThreadId()) {}
+};
+
+/**
+ * ProfileThread - The per-thread state (the ring buffer and the call-stack of the opened zones)
+ */
+
+struct ProfileThread
+{
+  std::shared_ptr<ProfileRing> ring;
+  uint64 paths[PROFILE_MAX_DEPTH + 1]; // paths[0] is the root, paths[d + 1] is the zone at depth d
+  ulong depth;
+
+  ProfileThread() : depth(0)
+  {
+    paths[0] = 0;
+  }
+
+  ~ProfileThread()
+  {
+    if (ring != nullptr)
+    {
+      ring->retired.store(true, std::memory_order_release);
+    }
+  }
+};
+
+static thread_local ProfileThread g_profile_thread;
+
+static inline uint64 profile_path_hash(const uint64 parent, const ProfileSite* site)
+{
+  // splitmix64 finalizer over the parent path and the call-site
+
+  uint64 v = parent * 0x9E3779B97F4A7C15ULL + uint64(ulongptr(site));
+  v = (v ^ (v >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  v = (v ^ (v >> 27)) * 0x94D049BB133111EBULL;
+  return v ^ (v >> 31);
+}
+
+/**
+ * ProfileZone
+ */
+
+ProfileZone::ProfileZone(const ProfileSite* site) : m_ptr_site(nullptr), m_begin(0)
+{
+  if (!g_profiler_enabled.load(std::memory_order_relaxed) || site == nullptr)
+  {
+    return;
+  }
+
+  auto& thread = g_profile_thread;
+  if (thread.depth >= PROFILE_MAX_DEPTH)
+  {
+    return;
+  }
+
+  if (thread.ring == nullptr && Profiler::instance().attach() == nullptr)
+  {
+    return;
+  }
+
+  thread.paths[thread.depth + 1] = profile_path_hash(thread.paths[thread.depth], site);
+  thread.depth++;
+
+  m_ptr_site = site;
+  m_begin = StopWatch::now_ns();
+}
+
+ProfileZone::~ProfileZone()
+{
+  if (m_ptr_site == nullptr)
+  {
+    return;
+  }
+
+  const uint64 end = StopWatch::now_ns();
+
+  auto& thread = g_profile_thread;
+  thread.depth--;
+
+  auto& ring = *thread.ring;
+
+  const uint64 head = ring.head.load(std::memory_order_relaxed);
+  if (head - ring.tail.load(std::memory_order_acquire) >= PROFILE_RING_CAPACITY)
+  {
+    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  auto& record = ring.records[head & (PROFILE_RING_CAPACITY - 1)];
+  record.site = m_ptr_site;
+  record.path = thread.paths[thread.depth + 1];
+  record.parent = thread.paths[thread.depth];
+  record.begin = m_begin;
+  record.end = end;
+  record.thread_id = ring.thread_id;
+  record.depth = thread.depth;
+
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * Profiler
+ */
+
+Profiler::Profiler()
+  : m_started(false), m_interval(10)
+  , m_origin(StopWatch::now_ns()), m_dropped(0), m_trace_capacity(0), m_trace_next(0)
+{
+}
+
+Profiler::~Profiler()
+{
+  this->stop();
+}
+
+bool Profiler::enabled()
+{
+  return g_profiler_enabled.load(std::memory_order_relaxed);
+}
+
+bool Profiler::started() const
+{
+  return m_started;
+}
+
+void Profiler::start(const ulong interval_ms, const size_t trace_capacity)
+{
+  if (m_started)
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lg(m_mutex_data);
+    m_interval = std::max(interval_ms, ulong(1));
+    m_trace_capacity = trace_capacity;
+    m_trace.clear();
+    m_trace_next = 0;
+    m_origin = StopWatch::now_ns();
+  }
+
+  m_started = true;
+  g_profiler_enabled = true;
+
+  m_thread = std::thread(&Profiler::collector, this);
+}
+
+void Profiler::stop()
+{
+  if (!m_started)
+  {
+    return;
+  }
+
+  g_profiler_enabled = false;
+
+  {
+    std::lock_guard<std::mutex> lg(m_mutex_signal);
+    m_started = false;
+  }
+
+  m_signal.notify_all();
+
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+
+  this->collect();
+}
+
+void Profiler::collector()
+{
+  std::unique_lock<std::mutex> lock(m_mutex_signal);
+
+  while (m_started)
+  {
+    m_signal.wait_for(lock, std::chrono::milliseconds(m_interval), [this]() { return !m_started; });
+
+    lock.unlock();
+    this->collect();
+    lock.lock();
+  }
+}
+
+ProfileRing* Profiler::attach()
+{
+  auto& thread = g_profile_thread;
+
+  try
+  {
+    thread.ring = std::make_shared<ProfileRing>();
+  }
+  catch (const std::bad_alloc&)
+  {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lg(m_mutex_rings);
+  m_rings.push_back(thread.ring);
+
+  return thread.ring.get();
+}
+
+void Profiler::drain(ProfileRing& ring)
+{
+  uint64 tail = ring.tail.load(std::memory_order_relaxed);
+  const uint64 head = ring.head.load(std::memory_order_acquire);
+
+  for (; tail != head; tail++)
+  {
+    const auto& record = ring.records[tail & (PROFILE_RING_CAPACITY - 1)];
+    const uint64 duration = record.end - record.begin;
+
+    auto& node = m_nodes[record.path];
+    node.site = record.site;
+    node.parent = record.parent;
+    node.total_ns += duration;
+
+    if (record.depth != 0)
+    {
+      m_nodes[record.parent].child_ns += duration;
+    }
+
+    auto& summary = m_sites[record.site];
+    summary.site = record.site;
+    summary.stats.record(duration);
+
+    if (m_trace_capacity != 0)
+    {
+      if (m_trace.size() < m_trace_capacity)
+      {
+        m_trace.push_back(record);
+      }
+      else
+      {
+        m_trace[m_trace_next] = record;
+        m_trace_next = (m_trace_next + 1) % m_trace_capacity;
+      }
+    }
+  }
+
+  ring.tail.store(tail, std::memory_order_release);
+
+  m_dropped += ring.dropped.exchange(0, std::memory_order_relaxed);
+}
+
+void Profiler::collect()
+{
+  std::vector<std::shared_ptr<ProfileRing>> rings;
+  {
+    std::lock_guard<std::mutex> lg(m_mutex_rings);
+    rings = m_rings;
+  }
+
+  std::vector<ProfileRing*> retired_rings;
+
+  {
+    std::lock_guard<std::mutex> lg(m_mutex_data);
+
+    for (auto& ring : rings)
+    {
+      // the retired flag must be read before draining, so no record is left behind
+
+      const bool retired = ring->retired.load(std::memory_order_acquire);
+      this->drain(*ring);
+      if (retired)
+      {
+        retired_rings.push_back(ring.get());
+      }
+    }
+  }
+
+  if (!retired_rings.empty())
+  {
+    std::lock_guard<std::mutex> lg(m_mutex_rings);
+    m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(),
+      [&](const std::shared_ptr<ProfileRing>& ring) -> bool
+    {
+      return std::find(retired_rings.cbegin(), retired_rings.cend(), ring.get()) != retired_rings.cend();
+    }), m_rings.end());
+  }
+}
+
+void Profiler::reset()
+{
+  this->collect();
+
+  std::lock_guard<std::mutex> lg(m_mutex_data);
+  m_nodes.clear();
+  m_sites.clear();
+  m_trace.clear();
+  m_trace_next = 0;
+  m_dropped = 0;
+  m_origin = StopWatch::now_ns();
+}
+
+uint64 Profiler::dropped()
+{
+  this->collect();
+
+  std::lock_guard<std::mutex> lg(m_mutex_data);
+  return m_dropped;
+}
+
+std::vector<Profiler::Summary> Profiler::summaries()
+{
+  this->collect();
+
+  std::vector<Summary> result;
+
+  std::lock_guard<std::mutex> lg(m_mutex_data);
+
+  std::unordered_map<const ProfileSite*, uint64> selves;
+  for (const auto& e : m_nodes)
+  {
+    if (e.second.site != nullptr)
+    {
+      selves[e.second.site] += e.second.total_ns - std::min(e.second.child_ns, e.second.total_ns);
+    }
+  }
+
+  for (const auto& e : m_sites)
+  {
+    Summary summary = e.second;
+    summary.self_ns = selves[e.first];
+    result.push_back(summary);
+  }
+
+  std::sort(result.begin(), result.end(), [](const Summary& left, const Summary& right) -> bool
+  {
+    return left.stats.total() > right.stats.total();
+  });
+
+  return result;
+}
+
+std::vector<ProfileRecord> Profiler::records()
+{
+  this->collect();
+
+  std::vector<ProfileRecord> result;
+
+  {
+    std::lock_guard<std::mutex> lg(m_mutex_data);
+    result = m_trace;
+  }
+
+  std::sort(result.begin(), result.end(), [](const ProfileRecord& left, const ProfileRecord& right) -> bool
+  {
+    return left.begin < right.begin || (left.begin == right.begin && left.depth < right.depth);
+  });
+
+  return result;
+}
+
+static void profile_json_escape(std::string& out, const char* text)
+{
+  for (auto p = text != nullptr ? text : ""; *p != '\0'; p++)
+  {
+    const auto c = static_cast<unsigned char>(*p);
+    switch (c)
+    {
+    case '\"': out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\n': out += "\\n";  break;
+    case '\r': out += "\\r";  break;
+    case '\t': out += "\\t";  break;
+    default:
+      if (c < 0x20)
+      {
+        char hex[8] = { 0 };
+        sprintf_s(hex, lengthof(hex), "\\u%04X", c);
+        out += hex;
+      }
+      else
+      {
+        out += char(c);
+      }
+      break;
+    }
+  }
+}
+
+std::string Profiler::to_chrome_trace()
+{
+  const auto records = this->records();
+
+  uint64 origin = 0;
+  {
+    std::lock_guard<std::mutex> lg(m_mutex_data);
+    origin = m_origin;
+  }
+
+  const auto pid = GetCurrentProcessId();
+
+  std::string result;
+  result.reserve(records.size() * 160 + 64);
+  result += "{\"traceEvents\":[";
+
+  char buffer[KB] = { 0 };
+
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    const auto& record = records[i];
+
+    result += i == 0 ? "\n" : ",\n";
+    result += "{\"name\":\"";
+    profile_json_escape(result, record.site->name);
+    result += "\",\"cat\":\"vu\",\"ph\":\"X\"";
+
+    sprintf_s(buffer, lengthof(buffer), ",\"pid\":%lu,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f",
+      pid, record.thread_id,
+      (double(record.begin) - double(origin)) / 1000., double(record.end - record.begin) / 1000.);
+    result += buffer;
+
+    result += ",\"args\":{\"file\":\"";
+    profile_json_escape(result, record.site->file);
+    sprintf_s(buffer, lengthof(buffer), "\",\"line\":%d}}", record.site->line);
+    result += buffer;
+  }
+
+  result += "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+  return result;
+}
+
+std::string Profiler::to_folded_stacks()
+{
+  this->collect();
+
+  std::map<std::string, uint64> stacks;
+
+  {
+    std::lock_guard<std::mutex> lg(m_mutex_data);
+
+    std::vector<const char*> names;
+
+    for (const auto& e : m_nodes)
+    {
+      const auto& node = e.second;
+      if (node.site == nullptr || node.child_ns >= node.total_ns)
+      {
+        continue;
+      }
+
+      names.clear();
+
+      // walk up to the root, a missing ancestor (eg. a zone still opened) ends the stack there
+
+      for (auto it = m_nodes.find(e.first);
+        it != m_nodes.cend() && it->second.site != nullptr && names.size() <= PROFILE_MAX_DEPTH;
+        it = m_nodes.find(it->second.parent))
+      {
+        names.push_back(it->second.site->name);
+        if (it->second.parent == 0)
+        {
+          break;
+        }
+      }
+
+      std::string stack;
+      for (auto it = names.crbegin(); it != names.crend(); it++)
+      {
+        if (!stack.empty())
+        {
+          stack += ';';
+        }
+
+        for (auto p = *it; p != nullptr && *p != '\0'; p++)
+        {
+          stack += (*p == ';' || *p == '\r' || *p == '\n') ? '_' : *p;
+        }
+      }
+
+      stacks[stack] += node.total_ns - node.child_ns;
+    }
+  }
+
+  std::string result;
+
+  for (const auto& e : stacks)
+  {
+    result += e.first;
+    result += ' ';
+    result += std::to_string(e.second);
+    result += '\n';
+  }
+
+  return result;
+}
+
+} // namespace vu
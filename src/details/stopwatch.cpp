@@ -8,41 +8,338 @@
 
 #include <cstdio>
 #include <cwchar>
-#include <numeric>
+#include <cmath>
+#include <limits>
 #include <iostream>
 
 namespace vu
 {
 
-StopWatch::StopWatch()
+/**
+ * LatencyStats
+ */
+
+LatencyStats::LatencyStats()
+{
+  this->reset();
+}
+
+LatencyStats::~LatencyStats()
+{
+}
+
+void LatencyStats::record(const uint64 value)
+{
+  m_count += 1;
+  m_total += value;
+  m_minimum = std::min(m_minimum, value);
+  m_maximum = std::max(m_maximum, value);
+
+  const double delta = double(value) - m_mean;
+  m_mean += delta / double(m_count);
+  m_m2 += delta * (double(value) - m_mean);
+}
+
+void LatencyStats::merge(const LatencyStats& right)
+{
+  if (right.m_count == 0)
+  {
+    return;
+  }
+
+  if (m_count == 0)
+  {
+    *this = right;
+    return;
+  }
+
+  // Chan et al. parallel variant of Welford's algorithm
+
+  const double n1 = double(m_count);
+  const double n2 = double(right.m_count);
+  const double delta = right.m_mean - m_mean;
+
+  m_mean += delta * n2 / (n1 + n2);
+  m_m2 += right.m_m2 + delta * delta * n1 * n2 / (n1 + n2);
+
+  m_count += right.m_count;
+  m_total += right.m_total;
+  m_minimum = std::min(m_minimum, right.m_minimum);
+  m_maximum = std::max(m_maximum, right.m_maximum);
+}
+
+void LatencyStats::reset()
+{
+  m_count = 0;
+  m_total = 0;
+  m_minimum = std::numeric_limits<uint64>::max();
+  m_maximum = 0;
+  m_mean = 0.;
+  m_m2 = 0.;
+}
+
+uint64 LatencyStats::count() const
+{
+  return m_count;
+}
+
+uint64 LatencyStats::total() const
+{
+  return m_total;
+}
+
+uint64 LatencyStats::minimum() const
+{
+  return m_count == 0 ? 0 : m_minimum;
+}
+
+uint64 LatencyStats::maximum() const
+{
+  return m_maximum;
+}
+
+double LatencyStats::mean() const
+{
+  return m_mean;
+}
+
+double LatencyStats::variance() const
+{
+  return m_count < 2 ? 0. : m_m2 / double(m_count - 1);
+}
+
+double LatencyStats::stddev() const
+{
+  return std::sqrt(this->variance());
+}
+
+/**
+ * LatencyHistogram
+ */
+
+static const uint64 LH_SUB_BUCKETS = 1ULL << LatencyHistogram::PRECISION;
+static const size_t LH_NUM_BUCKETS = size_t((65 - LatencyHistogram::PRECISION) * LH_SUB_BUCKETS);
+
+static inline int lh_most_significant_bit(uint64 value)
+{
+  int result = 0;
+
+  for (int shift = 32; shift != 0; shift >>= 1)
+  {
+    if (value >> shift)
+    {
+      value >>= shift;
+      result += shift;
+    }
+  }
+
+  return result;
+}
+
+LatencyHistogram::LatencyHistogram() : m_buckets(LH_NUM_BUCKETS, 0)
+{
+  this->reset();
+}
+
+LatencyHistogram::~LatencyHistogram()
+{
+}
+
+size_t LatencyHistogram::index_of(const uint64 value)
+{
+  if (value < 2 * LH_SUB_BUCKETS)
+  {
+    return size_t(value);
+  }
+
+  const int shift = lh_most_significant_bit(value) - PRECISION;
+  return size_t(shift * LH_SUB_BUCKETS + (value >> shift));
+}
+
+uint64 LatencyHistogram::lowest_of(const size_t index)
+{
+  if (index < 2 * LH_SUB_BUCKETS)
+  {
+    return uint64(index);
+  }
+
+  const uint64 shift = index / LH_SUB_BUCKETS - 1;
+  return (index - shift * LH_SUB_BUCKETS) << shift;
+}
+
+uint64 LatencyHistogram::highest_of(const size_t index)
+{
+  if (index < 2 * LH_SUB_BUCKETS)
+  {
+    return uint64(index);
+  }
+
+  const uint64 shift = index / LH_SUB_BUCKETS - 1;
+  return lowest_of(index) + ((1ULL << shift) - 1);
+}
+
+void LatencyHistogram::record(const uint64 value, const uint64 count)
 {
-  m_reset = true;
+  if (count == 0)
+  {
+    return;
+  }
+
+  m_buckets[index_of(value)] += count;
+  m_count += count;
+  m_total += double(value) * double(count);
+  m_minimum = std::min(m_minimum, value);
+  m_maximum = std::max(m_maximum, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& right)
+{
+  if (right.m_count == 0)
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < LH_NUM_BUCKETS; i++)
+  {
+    m_buckets[i] += right.m_buckets[i];
+  }
+
+  m_count += right.m_count;
+  m_total += right.m_total;
+  m_minimum = std::min(m_minimum, right.m_minimum);
+  m_maximum = std::max(m_maximum, right.m_maximum);
+}
+
+void LatencyHistogram::reset()
+{
+  std::fill(m_buckets.begin(), m_buckets.end(), 0);
   m_count = 0;
-  m_delta = 0;
-  m_delta_history.clear();
+  m_minimum = std::numeric_limits<uint64>::max();
+  m_maximum = 0;
+  m_total = 0.;
+}
+
+uint64 LatencyHistogram::count() const
+{
+  return m_count;
+}
+
+uint64 LatencyHistogram::minimum() const
+{
+  return m_count == 0 ? 0 : m_minimum;
+}
+
+uint64 LatencyHistogram::maximum() const
+{
+  return m_maximum;
+}
+
+double LatencyHistogram::mean() const
+{
+  return m_count == 0 ? 0. : m_total / double(m_count);
+}
+
+uint64 LatencyHistogram::percentile(const double percentage) const
+{
+  if (m_count == 0)
+  {
+    return 0;
+  }
+
+  if (percentage <= 0.)
+  {
+    return m_minimum;
+  }
+
+  if (percentage >= 100.)
+  {
+    return m_maximum;
+  }
+
+  // the nearest-rank method, the result is the highest value equivalent to the ranked sample
+
+  auto rank = uint64(std::ceil(percentage / 100. * double(m_count)));
+  rank = std::max(rank, uint64(1));
+
+  uint64 cumulative = 0;
+
+  for (size_t i = index_of(m_minimum); i < LH_NUM_BUCKETS; i++)
+  {
+    cumulative += m_buckets[i];
+    if (cumulative >= rank)
+    {
+      return std::max(m_minimum, std::min(m_maximum, highest_of(i)));
+    }
+  }
+
+  return m_maximum;
+}
+
+/**
+ * StopWatch
+ */
+
+StopWatch::StopWatch(const bool histogram) : m_start(0), m_delta(0)
+{
+  if (histogram)
+  {
+    m_ptr_histogram.reset(new LatencyHistogram);
+  }
 }
 
 StopWatch::~StopWatch()
 {
-  m_delta_history.clear();
 }
 
-void StopWatch::start(bool reset)
+uint64 StopWatch::now_ns()
+{
+  static const uint64 frequency = []() -> uint64
+  {
+    LARGE_INTEGER v = { 0 };
+    QueryPerformanceFrequency(&v);
+    return uint64(v.QuadPart);
+  }();
+
+  LARGE_INTEGER counter = { 0 };
+  QueryPerformanceCounter(&counter);
+
+  // split the conversion to avoid overflowing 64-bit (ticks * 10^9)
+
+  const uint64 ticks = uint64(counter.QuadPart);
+  return (ticks / frequency) * 1000000000ULL + (ticks % frequency) * 1000000000ULL / frequency;
+}
+
+StopWatch::TDuration StopWatch::to_duration(const uint64 ns)
 {
-  m_count = std::clock();
+  return TDuration((unsigned long)(ns / 1000000ULL), float(double(ns) / 1e9));
+}
 
-  if (m_reset = reset)
+void StopWatch::start(bool reset)
+{
+  if (reset)
   {
-    m_delta_history.clear();
+    m_stats.reset();
+
+    if (m_ptr_histogram != nullptr)
+    {
+      m_ptr_histogram->reset();
+    }
   }
+
+  m_start = now_ns();
 }
 
 const StopWatch::TDuration StopWatch::stop()
 {
-  if (m_count != 0)
+  if (m_start != 0)
   {
-    m_delta = std::clock() - m_count;
-    m_delta_history.push_back(m_delta);
+    m_delta = now_ns() - m_start;
+    m_stats.record(m_delta);
+
+    if (m_ptr_histogram != nullptr)
+    {
+      m_ptr_histogram->record(m_delta);
+    }
   }
 
   return this->duration();
@@ -50,19 +347,37 @@ const StopWatch::TDuration StopWatch::stop()
 
 const StopWatch::TDuration StopWatch::duration()
 {
-  return TDuration(m_delta, m_delta / float(CLOCKS_PER_SEC));
+  return to_duration(m_delta);
+}
+
+const StopWatch::TDuration StopWatch::total()
+{
+  return to_duration(m_stats.total());
+}
+
+uint64 StopWatch::elapsed_ns() const
+{
+  return m_start != 0 ? now_ns() - m_start : 0;
 }
 
-const vu::StopWatch::TDuration StopWatch::total()
+uint64 StopWatch::duration_ns() const
 {
-  const auto PrevDelta = m_delta;
+  return m_delta;
+}
 
-  m_delta = std::accumulate(m_delta_history.cbegin(), m_delta_history.cend(), 0);
-  const auto duration = this->duration();
+uint64 StopWatch::total_ns() const
+{
+  return m_stats.total();
+}
 
-  m_delta = PrevDelta;
+const LatencyStats& StopWatch::stats() const
+{
+  return m_stats;
+}
 
-  return duration;
+const LatencyHistogram* StopWatch::histogram() const
+{
+  return m_ptr_histogram.get();
 }
 
 /**
@@ -93,6 +408,11 @@ void ScopeStopWatchX::active(bool state)
   m_activated = state;
 }
 
+const StopWatch& ScopeStopWatchX::watcher() const
+{
+  return m_watcher;
+}
+
 void ScopeStopWatchX::reset()
 {
   this->stop();
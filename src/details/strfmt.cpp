@@ -81,32 +81,52 @@ int vuapi get_format_length_W(const std::wstring format, ...)
   return N;
 }
 
+/**
+ * The format functions try a single pass into a stack buffer first, then fall back to the length
+ * query and format straight into the result (vsnprintf of msvcrt returns -1 when it does not fit).
+ */
+
 std::string vuapi format_vl_A(const std::string format, va_list args)
 {
   std::string s;
-  s.clear();
 
-  auto N = get_format_length_vl_A(format, args);
-  if (N <= 0)
+  char buffer[KiB];
+
+  va_list args_copy;
+  va_copy(args_copy, args);
+
+  #ifdef _MSC_VER
+  int n = vsnprintf(buffer, lengthof(buffer), format.c_str(), args_copy);
+  #else
+  int n = Initialize_DLL_MISC() == VU_OK ? pfn_vsnprintf(buffer, lengthof(buffer), format.c_str(), args_copy) : -1;
+  #endif
+
+  va_end(args_copy);
+
+  if (n >= 0 && n < int(lengthof(buffer)))
   {
+    s.assign(buffer, n);
     return s;
   }
 
-  std::unique_ptr<char[]> p(new char [N]);
-  if (p == nullptr)
+  va_copy(args_copy, args);
+  auto N = get_format_length_vl_A(format, args_copy);
+  va_end(args_copy);
+
+  if (N <= 0)
   {
     return s;
   }
 
-  ZeroMemory(p.get(), N);
+  s.resize(N); // including the terminating null character
 
   #ifdef _MSC_VER
-  vsnprintf(p.get(), N, format.c_str(), args);
+  n = vsnprintf(&s[0], N, format.c_str(), args);
   #else
-  pfn_vsnprintf(p.get(), N, format.c_str(), args);
+  n = pfn_vsnprintf(&s[0], N, format.c_str(), args);
   #endif
 
-  s.assign(p.get());
+  s.resize(n >= 0 && n < N ? n : N - 1);
 
   return s;
 }
@@ -114,29 +134,36 @@ std::string vuapi format_vl_A(const std::string format, va_list args)
 std::wstring vuapi format_vl_W(const std::wstring format, va_list args)
 {
   std::wstring s;
-  s.clear();
 
-  auto N = get_format_length_vl_W(format, args);
-  if (N <= 0)
+  wchar buffer[KiB];
+
+  va_list args_copy;
+  va_copy(args_copy, args);
+
+  int n = _vsnwprintf(buffer, lengthof(buffer), format.c_str(), args_copy);
+
+  va_end(args_copy);
+
+  if (n >= 0 && n < int(lengthof(buffer)))
   {
+    s.assign(buffer, n);
     return s;
   }
 
-  std::unique_ptr<wchar[]> p(new wchar [N]);
-  if (p == nullptr)
+  va_copy(args_copy, args);
+  auto N = get_format_length_vl_W(format, args_copy);
+  va_end(args_copy);
+
+  if (N <= 0)
   {
     return s;
   }
 
-  ZeroMemory(p.get(), 2*N);
+  s.resize(N); // including the terminating null character
 
-  #ifdef _MSC_VER
-  vswprintf(p.get(), format.c_str(), args);
-  #else
-  pfn_vswprintf(p.get(), N, format.c_str(), args);
-  #endif
+  n = _vsnwprintf(&s[0], N, format.c_str(), args);
 
-  s.assign(p.get());
+  s.resize(n >= 0 && n < N ? n : N - 1);
 
   return s;
 }
@@ -657,124 +684,489 @@ void vuapi url_decode_W(const std::wstring& text, std::wstring& result)
  * VariantX
  */
 
-template <class T>
-VariantT<T>::VariantT()
+// the number text is narrowed into a stack buffer, then parsed/formatted by from_chars/to_chars
+// (C++17 with the floating point support) or by the C runtime
+
+static const size_t VARIANT_TEXT_SIZE = 64;
+
+template <typename CharT>
+static size_t variant_narrow_number(const CharT* ptr, const size_t length, char (&text)[VARIANT_TEXT_SIZE])
+{
+  size_t i = 0;
+  while (i < length && (ptr[i] == ' ' || (ptr[i] >= '\t' && ptr[i] <= '\r')))
+  {
+    i++;
+  }
+
+  if (i < length && ptr[i] == '+')
+  {
+    i++;
+  }
+
+  size_t n = 0;
+  for (; i < length && n < VARIANT_TEXT_SIZE - 1 && ptr[i] > 0 && ptr[i] < 0x80; i++)
+  {
+    text[n++] = char(ptr[i]);
+  }
+
+  text[n] = '\0';
+
+  return n;
+}
+
+static int64 variant_parse_int64(const char* text, const size_t length)
+{
+  int64 result = 0;
+  #if defined(__cpp_lib_to_chars)
+  std::from_chars(text, text + length, result);
+  #else  // __cpp_lib_to_chars
+  result = strtoll(text, nullptr, 10);
+  #endif // __cpp_lib_to_chars
+  return result;
+}
+
+static uint64 variant_parse_uint64(const char* text, const size_t length)
+{
+  if (length != 0 && text[0] == '-')
+  {
+    return uint64(variant_parse_int64(text, length)); // wrapped around as a stream does
+  }
+
+  uint64 result = 0;
+  #if defined(__cpp_lib_to_chars)
+  std::from_chars(text, text + length, result);
+  #else  // __cpp_lib_to_chars
+  result = strtoull(text, nullptr, 10);
+  #endif // __cpp_lib_to_chars
+  return result;
+}
+
+static double variant_parse_double(const char* text, const size_t length)
+{
+  double result = 0.;
+  #if defined(__cpp_lib_to_chars)
+  std::from_chars(text, text + length, result);
+  #else  // __cpp_lib_to_chars
+  result = strtod(text, nullptr);
+  #endif // __cpp_lib_to_chars
+  return result;
+}
+
+template <typename T>
+static size_t variant_format_integer(const T v, char (&text)[VARIANT_TEXT_SIZE])
+{
+  #if defined(__cpp_lib_to_chars)
+  return size_t(std::to_chars(text, text + VARIANT_TEXT_SIZE, v).ptr - text);
+  #else  // __cpp_lib_to_chars
+  const int n = std::is_signed<T>::value ?
+    snprintf(text, VARIANT_TEXT_SIZE, "%lld", (long long)v) :
+    snprintf(text, VARIANT_TEXT_SIZE, "%llu", (unsigned long long)v);
+  return n > 0 ? size_t(n) : 0;
+  #endif // __cpp_lib_to_chars
+}
+
+// the shortest text that round-trips to the same float/double
+
+static size_t variant_format_floating(const double v, const bool single, char (&text)[VARIANT_TEXT_SIZE])
+{
+  #if defined(__cpp_lib_to_chars)
+  const auto r = single ?
+    std::to_chars(text, text + VARIANT_TEXT_SIZE, float(v)) :
+    std::to_chars(text, text + VARIANT_TEXT_SIZE, v);
+  return size_t(r.ptr - text);
+  #else  // __cpp_lib_to_chars
+  int n = 0;
+
+  for (int precision = single ? 6 : 15; precision <= (single ? 9 : 17); precision++)
+  {
+    n = snprintf(text, VARIANT_TEXT_SIZE, "%.*g", precision, v);
+
+    const double parsed = strtod(text, nullptr);
+    if (single ? float(parsed) == float(v) : parsed == v)
+    {
+      break;
+    }
+  }
+
+  return n > 0 ? size_t(n) : 0;
+  #endif // __cpp_lib_to_chars
+}
+
+static void variant_to_hex(const std::vector<byte>& bytes, std::string& text)
+{
+  text = to_hex_string_A(bytes.data(), bytes.size());
+}
+
+static void variant_to_hex(const std::vector<byte>& bytes, std::wstring& text)
+{
+  text = to_hex_string_W(bytes.data(), bytes.size());
+}
+
+static void variant_from_hex(const std::string& text, std::vector<byte>& bytes)
+{
+  to_hex_bytes_A(text, bytes);
+}
+
+static void variant_from_hex(const std::wstring& text, std::vector<byte>& bytes)
 {
-  m_data.reset(new T);
+  to_hex_bytes_W(text, bytes);
 }
 
-template <class T>
-VariantT<T>::VariantT(const VariantT& right)
+template <class StringT>
+VariantT<StringT>::VariantT() : m_type(variant_type::VAR_EMPTY)
 {
+  m_value.u = 0;
+}
+
+template <class StringT>
+VariantT<StringT>::VariantT(const VariantT& right) : m_type(variant_type::VAR_EMPTY)
+{
+  m_value.u = 0;
   *this = right;
 }
 
-template <class T>
-VariantT<T>::~VariantT()
+template <class StringT>
+VariantT<StringT>::VariantT(VariantT&& right) : m_type(variant_type::VAR_EMPTY)
 {
+  m_value.u = 0;
+  *this = std::move(right);
 }
 
-template <class T>
-bool vu::VariantT<T>::empty() const
+template <class StringT>
+VariantT<StringT>::~VariantT()
 {
-  return m_data->str().empty();
 }
 
-template <class T>
-VariantT<T>& VariantT<T>::operator=(const VariantT<T>& right)
+template <class StringT>
+VariantT<StringT>& VariantT<StringT>::operator=(const VariantT<StringT>& right)
 {
   if (this != &right)
   {
-    auto ptr = new T();
-    *ptr << right.m_data->str();
-    this->m_data.reset(ptr);
+    m_type  = right.m_type;
+    m_value = right.m_value;
+    m_string = right.m_string;
+    m_bytes  = right.m_bytes;
   }
 
   return *this;
 }
 
-template <class T>
-int VariantT<T>::to_int() const
+template <class StringT>
+VariantT<StringT>& VariantT<StringT>::operator=(VariantT<StringT>&& right)
 {
-  int result = 0;
-  *m_data >> result;
-  return result;
+  if (this != &right)
+  {
+    m_type  = right.m_type;
+    m_value = right.m_value;
+    m_string = std::move(right.m_string);
+    m_bytes  = std::move(right.m_bytes);
+    right.clear();
+  }
+
+  return *this;
 }
 
-template <class T>
-unsigned int VariantT<T>::to_uint() const
+template <class StringT>
+variant_type VariantT<StringT>::type() const
 {
-  unsigned int result = 0;
-  *m_data >> result;
-  return result;
+  return m_type;
 }
 
-template <class T>
-__int64 VariantT<T>::to_int64() const
+template <class StringT>
+bool VariantT<StringT>::empty() const
 {
-  __int64 result = 0;
-  *m_data >> result;
-  return result;
+  switch (m_type)
+  {
+  case variant_type::VAR_EMPTY:
+    return true;
+  case variant_type::VAR_STRING:
+    return m_string.empty();
+  case variant_type::VAR_BYTES:
+    return m_bytes.empty();
+  default:
+    return false;
+  }
 }
 
-template <class T>
-unsigned __int64 VariantT<T>::to_uint64() const
+template <class StringT>
+void VariantT<StringT>::clear()
 {
-  unsigned __int64 result = 0;
-  *m_data >> result;
-  return result;
+  m_type = variant_type::VAR_EMPTY;
+  m_value.u = 0;
+  m_string.clear();
+  m_bytes.clear();
 }
 
-template <class T>
-bool VariantT<T>::to_bool() const
+template <class StringT>
+void VariantT<StringT>::put_bool(const bool v)
 {
-  return to_int() != 0;
+  VariantT<StringT> value;
+  value.m_type = variant_type::VAR_BOOL;
+  value.m_value.b = v;
+  this->put_variant(std::move(value));
 }
 
-template <class T>
-float VariantT<T>::to_float() const
+template <class StringT>
+void VariantT<StringT>::put_int(const int64 v)
 {
-  float result = 0.F;
-  *m_data >> result;
-  return result;
+  VariantT<StringT> value;
+  value.m_type = variant_type::VAR_INT;
+  value.m_value.i = v;
+  this->put_variant(std::move(value));
 }
 
-template <class T>
-double VariantT<T>::to_double() const
+template <class StringT>
+void VariantT<StringT>::put_uint(const uint64 v)
 {
-  double result = 0.;
-  *m_data >> result;
-  return result;
+  VariantT<StringT> value;
+  value.m_type = variant_type::VAR_UINT;
+  value.m_value.u = v;
+  this->put_variant(std::move(value));
 }
 
-template <class T>
-std::unique_ptr<byte[]> VariantT<T>::to_bytes() const
+template <class StringT>
+void VariantT<StringT>::put_float(const float v)
 {
-  std::vector<byte> bytes;
+  VariantT<StringT> value;
+  value.m_type = variant_type::VAR_FLOAT;
+  value.m_value.f = v;
+  this->put_variant(std::move(value));
+}
 
-  if (typeid(T) == typeid(std::stringstream))
+template <class StringT>
+void VariantT<StringT>::put_double(const double v)
+{
+  VariantT<StringT> value;
+  value.m_type = variant_type::VAR_DOUBLE;
+  value.m_value.d = v;
+  this->put_variant(std::move(value));
+}
+
+template <class StringT>
+void VariantT<StringT>::put_text(const char_type* ptr, const size_t length)
+{
+  if (m_type != variant_type::VAR_EMPTY && m_type != variant_type::VAR_STRING)
   {
-    to_hex_bytes_A((const char*)m_data->str().c_str(), bytes);
+    this->to_text(m_string);
+    m_bytes.clear();
   }
-  else if (typeid(T) == typeid(std::wstringstream))
+
+  m_type = variant_type::VAR_STRING;
+  m_string.append(ptr, length);
+}
+
+template <class StringT>
+void VariantT<StringT>::put_bytes(const std::vector<byte>& bytes)
+{
+  VariantT<StringT> value;
+  value.m_type = variant_type::VAR_BYTES;
+  value.m_bytes = bytes;
+  this->put_variant(std::move(value));
+}
+
+template <class StringT>
+void VariantT<StringT>::put_variant(VariantT<StringT>&& value)
+{
+  if (m_type == variant_type::VAR_EMPTY)
   {
-    to_hex_bytes_W((const wchar_t*)m_data->str().c_str(), bytes);
+    *this = std::move(value);
+    return;
   }
-  else
+
+  StringT text;
+  value.to_text(text);
+  this->put_text(text.data(), text.size());
+}
+
+template <class StringT>
+void VariantT<StringT>::to_text(StringT& text) const
+{
+  char number[VARIANT_TEXT_SIZE] = { 0 };
+  size_t n = 0;
+
+  switch (m_type)
+  {
+  case variant_type::VAR_BOOL:
+    number[0] = m_value.b ? '1' : '0';
+    n = 1;
+    break;
+
+  case variant_type::VAR_INT:
+    n = variant_format_integer(m_value.i, number);
+    break;
+
+  case variant_type::VAR_UINT:
+    n = variant_format_integer(m_value.u, number);
+    break;
+
+  case variant_type::VAR_FLOAT:
+    n = variant_format_floating(m_value.f, true, number);
+    break;
+
+  case variant_type::VAR_DOUBLE:
+    n = variant_format_floating(m_value.d, false, number);
+    break;
+
+  case variant_type::VAR_STRING:
+    text = m_string;
+    return;
+
+  case variant_type::VAR_BYTES:
+    variant_to_hex(m_bytes, text);
+    return;
+
+  default:
+    break;
+  }
+
+  text.assign(number, number + n);
+}
+
+template <class StringT>
+int VariantT<StringT>::to_int() const
+{
+  return int(this->to_int64());
+}
+
+template <class StringT>
+unsigned int VariantT<StringT>::to_uint() const
+{
+  return (unsigned int)(this->to_uint64());
+}
+
+template <class StringT>
+__int64 VariantT<StringT>::to_int64() const
+{
+  switch (m_type)
+  {
+  case variant_type::VAR_BOOL:
+    return m_value.b ? 1 : 0;
+  case variant_type::VAR_INT:
+    return m_value.i;
+  case variant_type::VAR_UINT:
+    return int64(m_value.u);
+  case variant_type::VAR_FLOAT:
+    return int64(m_value.f);
+  case variant_type::VAR_DOUBLE:
+    return int64(m_value.d);
+  case variant_type::VAR_STRING:
+    {
+      char text[VARIANT_TEXT_SIZE];
+      const auto n = variant_narrow_number(m_string.data(), m_string.size(), text);
+      return variant_parse_int64(text, n);
+    }
+  default:
+    return 0;
+  }
+}
+
+template <class StringT>
+unsigned __int64 VariantT<StringT>::to_uint64() const
+{
+  switch (m_type)
+  {
+  case variant_type::VAR_UINT:
+    return m_value.u;
+  case variant_type::VAR_STRING:
+    {
+      char text[VARIANT_TEXT_SIZE];
+      const auto n = variant_narrow_number(m_string.data(), m_string.size(), text);
+      return variant_parse_uint64(text, n);
+    }
+  default:
+    return uint64(this->to_int64());
+  }
+}
+
+template <class StringT>
+bool VariantT<StringT>::to_bool() const
+{
+  switch (m_type)
+  {
+  case variant_type::VAR_BOOL:
+    return m_value.b;
+  case variant_type::VAR_FLOAT:
+  case variant_type::VAR_DOUBLE:
+    return this->to_double() != 0.;
+  case variant_type::VAR_STRING:
+    {
+      char text[VARIANT_TEXT_SIZE];
+      const auto n = variant_narrow_number(m_string.data(), m_string.size(), text);
+      const std::string s(text, n);
+
+      if (compare_string_A(s, "true", true) || compare_string_A(s, "yes", true) || compare_string_A(s, "on", true))
+      {
+        return true;
+      }
+
+      return variant_parse_int64(text, n) != 0;
+    }
+  case variant_type::VAR_BYTES:
+    return !m_bytes.empty();
+  default:
+    return this->to_uint64() != 0;
+  }
+}
+
+template <class StringT>
+float VariantT<StringT>::to_float() const
+{
+  return m_type == variant_type::VAR_FLOAT ? m_value.f : float(this->to_double());
+}
+
+template <class StringT>
+double VariantT<StringT>::to_double() const
+{
+  switch (m_type)
+  {
+  case variant_type::VAR_FLOAT:
+    return double(m_value.f);
+  case variant_type::VAR_DOUBLE:
+    return m_value.d;
+  case variant_type::VAR_UINT:
+    return double(m_value.u);
+  case variant_type::VAR_STRING:
+    {
+      char text[VARIANT_TEXT_SIZE];
+      const auto n = variant_narrow_number(m_string.data(), m_string.size(), text);
+      return variant_parse_double(text, n);
+    }
+  default:
+    return double(this->to_int64());
+  }
+}
+
+template <class StringT>
+std::unique_ptr<byte[]> VariantT<StringT>::to_bytes() const
+{
+  std::vector<byte> temp;
+
+  if (m_type != variant_type::VAR_BYTES)
   {
-    assert(0 && "invalid template class");
+    StringT text;
+    this->to_text(text);
+    variant_from_hex(text, temp);
   }
 
+  const auto& bytes = m_type == variant_type::VAR_BYTES ? m_bytes : temp;
   if (bytes.empty())
   {
     return nullptr;
   }
 
   std::unique_ptr<byte[]> result(new byte[bytes.size()]);
-  for (size_t i = 0; i < bytes.size(); i++) result.get()[i] = bytes[i]; // std::move(bytes.cbegin(), bytes.cend(), result.get());
+  memcpy(result.get(), bytes.data(), bytes.size());
   return result;
 }
 
+template <class StringT>
+StringT VariantT<StringT>::to_string() const
+{
+  StringT text;
+  this->to_text(text);
+  return text;
+}
+
 /**
  * VariantA
  */
@@ -791,11 +1183,6 @@ VariantA::~VariantA()
 {
 }
 
-std::string VariantA::to_string() const
-{
-  return m_data->str();
-}
-
 template class VariantTA;
 
 /**
@@ -814,12 +1201,402 @@ VariantW::~VariantW()
 {
 }
 
-std::wstring VariantW::to_string() const
+template class VariantTW;
+
+/**
+ * TimestampFormatterT
+ */
+
+static const int64 TS_TICKS_PER_SECOND = 10000000; // the 100-nanosecond intervals
+static const int64 TS_UNIX_EPOCH_TICKS = 116444736000000000LL; // 1601-01-01 to 1970-01-01
+
+static const char* TS_MONTH_NAMES[] =
 {
-  return m_data->str();
+  "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec",
+};
+
+static const char* TS_WEEKDAY_NAMES[] =
+{
+  "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat",
+};
+
+static uint64 timestamp_formatter_next_id()
+{
+  static std::atomic<uint64> id(0);
+  return ++id;
 }
 
-template class VariantTW;
+static int64 timestamp_formatter_now()
+{
+  typedef VOID (WINAPI *PfnGetSystemTimePreciseAsFileTime)(LPFILETIME);
+
+  static auto pfn = PfnGetSystemTimePreciseAsFileTime(
+    GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "GetSystemTimePreciseAsFileTime"));
+
+  FILETIME ft = { 0 };
+  pfn != nullptr ? pfn(&ft) : GetSystemTimeAsFileTime(&ft);
+
+  return int64((uint64(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) - TS_UNIX_EPOCH_TICKS;
+}
+
+template <typename CharT>
+static inline void timestamp_formatter_put_digits(CharT* ptr, uint64 value, const size_t width)
+{
+  for (size_t i = width; i != 0; i--)
+  {
+    ptr[i - 1] = CharT('0' + value % 10);
+    value /= 10;
+  }
+}
+
+template <typename CharT>
+struct TimestampFormatterT<CharT>::Cache
+{
+  static const size_t max_fractions = 8;
+
+  uint64 id;
+  int64 second;
+  size_t length;
+  size_t n_fractions;
+  ushort fraction_offsets[max_fractions];
+  byte fraction_widths[max_fractions];
+  CharT text[128];
+};
+
+template <typename CharT>
+TimestampFormatterT<CharT>::TimestampFormatterT(const bool utc)
+  : m_id(timestamp_formatter_next_id()), m_utc(utc)
+{
+  const CharT iso_8601[] =
+  {
+    '%', 'Y', '-', '%', 'm', '-', '%', 'd', 'T', '%', 'H', ':', '%', 'M', ':', '%', 'S', '.', '%', '3', 'f', '%', 'z', 0
+  };
+
+  this->compile(iso_8601);
+}
+
+template <typename CharT>
+TimestampFormatterT<CharT>::TimestampFormatterT(const String& pattern, const bool utc)
+  : m_id(timestamp_formatter_next_id()), m_utc(utc)
+{
+  this->compile(pattern);
+}
+
+template <typename CharT>
+TimestampFormatterT<CharT>::~TimestampFormatterT()
+{
+}
+
+template <typename CharT>
+const typename TimestampFormatterT<CharT>::String& TimestampFormatterT<CharT>::pattern() const
+{
+  return m_pattern;
+}
+
+template <typename CharT>
+bool TimestampFormatterT<CharT>::utc() const
+{
+  return m_utc;
+}
+
+template <typename CharT>
+void TimestampFormatterT<CharT>::compile(const String& pattern)
+{
+  m_pattern = pattern;
+  m_literals.clear();
+  m_tokens.clear();
+
+  auto fn_add_literal = [&](const CharT* ptr, const size_t length) -> void
+  {
+    if (m_tokens.empty() || m_tokens.back().type != TT_LITERAL)
+    {
+      Token token = { TT_LITERAL, 0, ushort(m_literals.length()), 0 };
+      m_tokens.push_back(token);
+    }
+
+    m_literals.append(ptr, length);
+    m_tokens.back().length += ushort(length);
+  };
+
+  auto fn_add_field = [&](const token_type type, const byte width) -> void
+  {
+    Token token = { type, width, 0, 0 };
+    m_tokens.push_back(token);
+  };
+
+  for (size_t i = 0; i < pattern.length(); i++)
+  {
+    if (pattern[i] != CharT('%') || i + 1 == pattern.length())
+    {
+      fn_add_literal(&pattern[i], 1);
+      continue;
+    }
+
+    const CharT c = pattern[++i];
+    switch (c)
+    {
+    case 'Y': fn_add_field(TT_YEAR, 4); break;
+    case 'y': fn_add_field(TT_YEAR_2, 2); break;
+    case 'm': fn_add_field(TT_MONTH, 2); break;
+    case 'd': fn_add_field(TT_DAY, 2); break;
+    case 'H': fn_add_field(TT_HOUR, 2); break;
+    case 'M': fn_add_field(TT_MINUTE, 2); break;
+    case 'S': fn_add_field(TT_SECOND, 2); break;
+    case 'b': fn_add_field(TT_MONTH_NAME, 3); break;
+    case 'a': fn_add_field(TT_WEEKDAY_NAME, 3); break;
+    case 'f': fn_add_field(TT_FRACTION, 3); break;
+    case 'z': fn_add_field(TT_ZONE, 0); break;
+    case '%': fn_add_literal(&pattern[i], 1); break;
+    default:
+      if (c >= CharT('1') && c <= CharT('9') && i + 1 < pattern.length() && pattern[i + 1] == CharT('f'))
+      {
+        fn_add_field(TT_FRACTION, byte(c - CharT('0')));
+        i++;
+      }
+      else // unknown, kept as is
+      {
+        fn_add_literal(&pattern[i - 1], 2);
+      }
+      break;
+    }
+  }
+}
+
+template <typename CharT>
+size_t TimestampFormatterT<CharT>::render_seconds(
+  const int64 seconds, CharT* buffer, const size_t size, Cache& cache) const
+{
+  // the only calendar conversion, it is done once per second per thread
+
+  const time_t t = time_t(seconds);
+
+  tm lt = { 0 };
+  int64 zone = 0; // the offset from UTC in seconds
+
+  #if defined(_MSC_VER) && (_MSC_VER > 1200) // Above VC++ 6.0
+  m_utc ? gmtime_s(&lt, &t) : localtime_s(&lt, &t);
+  #else
+  auto ptr_tm = m_utc ? gmtime(&t) : localtime(&t);
+  if (ptr_tm != nullptr) memcpy((void*)&lt, ptr_tm, sizeof(tm));
+  #endif
+
+  if (!m_utc)
+  {
+    tm temp = lt;
+    zone = int64(_mkgmtime(&temp)) - seconds;
+  }
+
+  cache.n_fractions = 0;
+
+  size_t length = 0;
+
+  for (const auto& token : m_tokens)
+  {
+    const size_t width = token.type == TT_LITERAL ? token.length : token.type == TT_ZONE ? (m_utc ? 1 : 6) : token.width;
+    if (length + width >= size)
+    {
+      return size_t(-1);
+    }
+
+    CharT* ptr = buffer + length;
+
+    switch (token.type)
+    {
+    case TT_LITERAL:
+      std::copy_n(m_literals.data() + token.offset, token.length, ptr);
+      break;
+    case TT_YEAR:
+      timestamp_formatter_put_digits(ptr, uint64(lt.tm_year + 1900), width);
+      break;
+    case TT_YEAR_2:
+      timestamp_formatter_put_digits(ptr, uint64(lt.tm_year + 1900) % 100, width);
+      break;
+    case TT_MONTH:
+      timestamp_formatter_put_digits(ptr, uint64(lt.tm_mon + 1), width);
+      break;
+    case TT_DAY:
+      timestamp_formatter_put_digits(ptr, uint64(lt.tm_mday), width);
+      break;
+    case TT_HOUR:
+      timestamp_formatter_put_digits(ptr, uint64(lt.tm_hour), width);
+      break;
+    case TT_MINUTE:
+      timestamp_formatter_put_digits(ptr, uint64(lt.tm_min), width);
+      break;
+    case TT_SECOND:
+      timestamp_formatter_put_digits(ptr, uint64(lt.tm_sec), width);
+      break;
+    case TT_MONTH_NAME:
+      std::copy_n(TS_MONTH_NAMES[lt.tm_mon % 12], width, ptr);
+      break;
+    case TT_WEEKDAY_NAME:
+      std::copy_n(TS_WEEKDAY_NAMES[lt.tm_wday % 7], width, ptr);
+      break;
+    case TT_FRACTION:
+      if (cache.n_fractions < Cache::max_fractions)
+      {
+        cache.fraction_offsets[cache.n_fractions] = ushort(length);
+        cache.fraction_widths[cache.n_fractions] = token.width;
+        cache.n_fractions++;
+      }
+      std::fill_n(ptr, width, CharT('0'));
+      break;
+    case TT_ZONE:
+      if (m_utc)
+      {
+        ptr[0] = CharT('Z');
+      }
+      else
+      {
+        const int64 minutes = (zone < 0 ? -zone : zone) / 60;
+        ptr[0] = CharT(zone < 0 ? '-' : '+');
+        timestamp_formatter_put_digits(ptr + 1, uint64(minutes / 60), 2);
+        ptr[3] = CharT(':');
+        timestamp_formatter_put_digits(ptr + 4, uint64(minutes % 60), 2);
+      }
+      break;
+    default:
+      break;
+    }
+
+    length += width;
+  }
+
+  buffer[length] = CharT(0);
+
+  return length;
+}
+
+template <typename CharT>
+size_t TimestampFormatterT<CharT>::render(const int64 ticks, CharT* buffer, const size_t size) const
+{
+  static thread_local Cache caches[4];
+
+  if (buffer == nullptr || size == 0)
+  {
+    return 0;
+  }
+
+  int64 seconds = ticks / TS_TICKS_PER_SECOND;
+  int64 sub_second = ticks % TS_TICKS_PER_SECOND;
+  if (sub_second < 0)
+  {
+    seconds -= 1;
+    sub_second += TS_TICKS_PER_SECOND;
+  }
+
+  // the date/time fields are copied from the cache of the current second, or rendered to it
+
+  Cache& cache = caches[m_id % 4];
+
+  if (cache.id != m_id || cache.second != seconds)
+  {
+    cache.id = 0;
+
+    cache.length = this->render_seconds(seconds, cache.text, _countof(cache.text), cache);
+    if (cache.length != size_t(-1))
+    {
+      cache.id = m_id;
+      cache.second = seconds;
+    }
+  }
+
+  size_t length = 0;
+
+  if (cache.id == m_id)
+  {
+    length = cache.length;
+    if (length >= size)
+    {
+      return 0;
+    }
+
+    std::copy_n(cache.text, length + 1, buffer);
+  }
+  else // too long to be cached
+  {
+    length = this->render_seconds(seconds, buffer, size, cache);
+    if (length == size_t(-1))
+    {
+      return 0;
+    }
+  }
+
+  // the sub-second fields (100-nanosecond resolution)
+
+  static const uint64 powers_of_10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+  for (size_t i = 0; i < cache.n_fractions; i++)
+  {
+    const size_t width = cache.fraction_widths[i];
+    const uint64 value = width <= 7 ?
+      uint64(sub_second) / powers_of_10[7 - width] : uint64(sub_second) * powers_of_10[width - 7];
+    timestamp_formatter_put_digits(buffer + cache.fraction_offsets[i], value, width);
+  }
+
+  return length;
+}
+
+template <typename CharT>
+size_t TimestampFormatterT<CharT>::write(CharT* buffer, const size_t size) const
+{
+  return this->render(timestamp_formatter_now(), buffer, size);
+}
+
+template <typename CharT>
+size_t TimestampFormatterT<CharT>::write(const FILETIME& time, CharT* buffer, const size_t size) const
+{
+  const int64 ticks = int64((uint64(time.dwHighDateTime) << 32) | time.dwLowDateTime) - TS_UNIX_EPOCH_TICKS;
+  return this->render(ticks, buffer, size);
+}
+
+template <typename CharT>
+size_t TimestampFormatterT<CharT>::write(const time_t time, CharT* buffer, const size_t size) const
+{
+  return this->render(int64(time) * TS_TICKS_PER_SECOND, buffer, size);
+}
+
+template <typename CharT>
+typename TimestampFormatterT<CharT>::String TimestampFormatterT<CharT>::to_string() const
+{
+  return this->format_string(timestamp_formatter_now());
+}
+
+template <typename CharT>
+typename TimestampFormatterT<CharT>::String TimestampFormatterT<CharT>::to_string(const FILETIME& time) const
+{
+  const int64 ticks = int64((uint64(time.dwHighDateTime) << 32) | time.dwLowDateTime) - TS_UNIX_EPOCH_TICKS;
+  return this->format_string(ticks);
+}
+
+template <typename CharT>
+typename TimestampFormatterT<CharT>::String TimestampFormatterT<CharT>::to_string(const time_t time) const
+{
+  return this->format_string(int64(time) * TS_TICKS_PER_SECOND);
+}
+
+template <typename CharT>
+typename TimestampFormatterT<CharT>::String TimestampFormatterT<CharT>::format_string(const int64 ticks) const
+{
+  String result(64, CharT(0));
+
+  for (;;)
+  {
+    const size_t length = this->render(ticks, &result[0], result.size());
+    if (length != 0 || m_tokens.empty())
+    {
+      result.resize(length);
+      break;
+    }
+
+    result.resize(result.size() * 2);
+  }
+
+  return result;
+}
+
+template class TimestampFormatterT<char>;
+template class TimestampFormatterT<wchar>;
 
 #ifdef _MSC_VER
 #pragma warning(pop)
@@ -10,6 +10,14 @@
 #include <csignal>
 #include <algorithm>
 
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VU_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+
 #include VU_3RD_INCL(TE/include/text_encoding_detect.h)
 
 namespace vu
@@ -135,64 +143,332 @@ text_encoding vuapi detect_text_encoding(const void* data, const size_t size)
 
 /* ------------------------------------------------ String Working ------------------------------------------------- */
 
-std::string vuapi lower_string_A(const std::string& string)
+/**
+ * UTF-8 <-> UTF-16 Transcoding
+ * The destination is sized to the worst case up-front then filled in a single pass and shrunk,
+ * runs of ASCII are widened/narrowed 16/8 units at a time (SSE2) or checked 8 bytes at a time (SWAR).
+ * Invalid sequences are replaced by U+FFFD per maximal subpart (the same as MultiByteToWideChar)
+ * or rejected when `strict` is set.
+ */
+
+static const wchar UTF_REPLACEMENT_CHARACTER = 0xFFFD;
+static const ulong UTF_INVALID = ulong(-1);
+
+static inline ulong count_trailing_zeros(ulong v)
 {
-  std::string s(string);
-  std::transform(s.begin(), s.end(), s.begin(), tolower);
-  return s;
+  #ifdef _MSC_VER
+  unsigned long index = 0;
+  _BitScanForward(&index, v);
+  return index;
+  #else // _MSC_VER
+  return __builtin_ctz(v);
+  #endif // _MSC_VER
 }
 
-std::wstring vuapi lower_string_W(const std::wstring& string)
+static inline bool utf16_is_ascii_8(const wchar* ptr)
 {
-  std::wstring s(string);
-  std::transform(s.begin(), s.end(), s.begin(), tolower);
-  return s;
+  uint64 v[2] = { 0 };
+  memcpy(v, ptr, sizeof(v));
+  return ((v[0] | v[1]) & 0xFF80FF80FF80FF80ULL) == 0;
 }
 
-std::string vuapi upper_string_A(const std::string& string)
+static size_t utf8_ascii_length(const char* ptr, const size_t length)
 {
-  std::string s(string);
-  std::transform(s.begin(), s.end(), s.begin(), toupper);
-  return s;
+  size_t i = 0;
+
+  for (uint64 v = 0; i + 8 <= length; i += 8)
+  {
+    memcpy(&v, ptr + i, sizeof(v));
+    if ((v & 0x8080808080808080ULL) != 0)
+    {
+      break;
+    }
+  }
+
+  for (; i < length && byte(ptr[i]) < 0x80; i++);
+
+  return i;
 }
 
-std::wstring vuapi upper_string_W(const std::wstring& string)
+static size_t utf16_ascii_length(const wchar* ptr, const size_t length)
 {
-  std::wstring s(string);
-  std::transform(s.begin(), s.end(), s.begin(), toupper);
-  return s;
+  size_t i = 0;
+
+  for (; i + 8 <= length && utf16_is_ascii_8(ptr + i); i += 8);
+  for (; i < length && ptr[i] < 0x80; i++);
+
+  return i;
+}
+
+/**
+ * Decode the non-ASCII sequence at `ptr[i]` and return the number of consumed bytes.
+ * When the sequence is ill-formed, `cp` is set to UTF_INVALID and the maximal subpart is consumed.
+ */
+static inline size_t utf8_decode_sequence(const byte* ptr, const size_t length, const size_t i, ulong& cp)
+{
+  const byte c = ptr[i];
+
+  size_t need = 0;
+  byte lo = 0x80, hi = 0xBF;
+
+  if (c >= 0xC2 && c <= 0xDF)
+  {
+    need = 1;
+    cp = c & 0x1F;
+  }
+  else if (c >= 0xE0 && c <= 0xEF)
+  {
+    need = 2;
+    cp = c & 0x0F;
+    if (c == 0xE0) lo = 0xA0; // overlong
+    if (c == 0xED) hi = 0x9F; // surrogates
+  }
+  else if (c >= 0xF0 && c <= 0xF4)
+  {
+    need = 3;
+    cp = c & 0x07;
+    if (c == 0xF0) lo = 0x90; // overlong
+    if (c == 0xF4) hi = 0x8F; // > U+10FFFF
+  }
+  else
+  {
+    cp = UTF_INVALID;
+    return 1;
+  }
+
+  for (size_t k = 1; k <= need; k++)
+  {
+    const size_t j = i + k;
+    if (j >= length || ptr[j] < lo || ptr[j] > hi)
+    {
+      cp = UTF_INVALID;
+      return k;
+    }
+
+    cp = (cp << 6) | (ptr[j] & 0x3F);
+    lo = 0x80, hi = 0xBF;
+  }
+
+  return need + 1;
+}
+
+bool vuapi utf8_to_utf16(const char* ptr, const size_t length, std::wstring& result, const bool strict)
+{
+  result.clear();
+
+  if (ptr == nullptr || length == 0)
+  {
+    return true;
+  }
+
+  result.resize(length); // each byte produces at most one code unit
+
+  const auto p = reinterpret_cast<const byte*>(ptr);
+  auto out = &result[0];
+
+  bool valid = true;
+  size_t i = 0;
+
+  while (i < length)
+  {
+    #ifdef VU_SSE2
+    while (i + 16 <= length) // out + 16 <= length as well since out is never ahead of i
+    {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      const __m128i zero = _mm_setzero_si128();
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 0), _mm_unpacklo_epi8(v, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(v, zero));
+
+      const ulong mask = ulong(_mm_movemask_epi8(v));
+      if (mask != 0)
+      {
+        const auto n = count_trailing_zeros(mask);
+        i += n, out += n;
+        break;
+      }
+
+      i += 16, out += 16;
+    }
+    #else  // VU_SSE2
+    for (uint64 v = 0; i + 8 <= length; i += 8, out += 8)
+    {
+      memcpy(&v, p + i, sizeof(v));
+      if ((v & 0x8080808080808080ULL) != 0)
+      {
+        break;
+      }
+
+      for (size_t k = 0; k < 8; k++) out[k] = wchar(p[i + k]);
+    }
+    #endif // VU_SSE2
+
+    if (i >= length)
+    {
+      break;
+    }
+
+    if (p[i] < 0x80)
+    {
+      *out++ = wchar(p[i++]);
+      continue;
+    }
+
+    ulong cp = 0;
+    i += utf8_decode_sequence(p, length, i, cp);
+
+    if (cp == UTF_INVALID)
+    {
+      valid = false;
+      if (strict)
+      {
+        result.clear();
+        return false;
+      }
+
+      cp = UTF_REPLACEMENT_CHARACTER;
+    }
+
+    if (cp >= 0x10000)
+    {
+      cp -= 0x10000;
+      *out++ = wchar(0xD800 + (cp >> 10));
+      *out++ = wchar(0xDC00 + (cp & 0x3FF));
+    }
+    else
+    {
+      *out++ = wchar(cp);
+    }
+  }
+
+  result.resize(size_t(out - &result[0]));
+
+  return valid;
+}
+
+bool vuapi utf16_to_utf8(const wchar* ptr, const size_t length, std::string& result, const bool strict)
+{
+  result.clear();
+
+  if (ptr == nullptr || length == 0)
+  {
+    return true;
+  }
+
+  result.resize(3 * length); // each code unit produces at most three bytes (a pair produces four)
+
+  auto out = reinterpret_cast<byte*>(&result[0]);
+  const auto out_first = out;
+
+  bool valid = true;
+  size_t i = 0;
+
+  while (i < length)
+  {
+    #ifdef VU_SSE2
+    while (i + 8 <= length)
+    {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+      const __m128i high = _mm_and_si128(v, _mm_set1_epi16(short(0xFF80)));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xFFFF)
+      {
+        break;
+      }
+
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(v, v));
+      i += 8, out += 8;
+    }
+    #else  // VU_SSE2
+    for (; i + 8 <= length && utf16_is_ascii_8(ptr + i); i += 8, out += 8)
+    {
+      for (size_t k = 0; k < 8; k++) out[k] = byte(ptr[i + k]);
+    }
+    #endif // VU_SSE2
+
+    if (i >= length)
+    {
+      break;
+    }
+
+    ulong cp = ptr[i++];
+
+    if (cp < 0x80)
+    {
+      *out++ = byte(cp);
+      continue;
+    }
+
+    if (cp >= 0xD800 && cp <= 0xDFFF)
+    {
+      if (cp <= 0xDBFF && i < length && ptr[i] >= 0xDC00 && ptr[i] <= 0xDFFF)
+      {
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (ulong(ptr[i++]) - 0xDC00);
+      }
+      else // lone surrogate
+      {
+        valid = false;
+        if (strict)
+        {
+          result.clear();
+          return false;
+        }
+
+        cp = UTF_REPLACEMENT_CHARACTER;
+      }
+    }
+
+    if (cp < 0x800)
+    {
+      *out++ = byte(0xC0 | (cp >> 6));
+      *out++ = byte(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+      *out++ = byte(0xE0 | (cp >> 12));
+      *out++ = byte(0x80 | ((cp >> 6) & 0x3F));
+      *out++ = byte(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+      *out++ = byte(0xF0 | (cp >> 18));
+      *out++ = byte(0x80 | ((cp >> 12) & 0x3F));
+      *out++ = byte(0x80 | ((cp >> 6) & 0x3F));
+      *out++ = byte(0x80 | (cp & 0x3F));
+    }
+  }
+
+  result.resize(size_t(out - out_first));
+
+  return valid;
 }
 
 std::string vuapi to_string_A(const std::wstring& string, const bool utf8)
 {
   std::string s;
-  s.clear();
 
   if (string.empty())
   {
     return s;
   }
 
-  int N = (int)string.length();
+  // The ASCII range maps to itself in UTF-8 and in every ANSI code page
 
-  if (utf8)
+  if (utf8 || utf16_ascii_length(string.data(), string.length()) == string.length())
   {
-    N = WideCharToMultiByte(CP_UTF8, 0, string.c_str(), int(string.length()), NULL, 0, NULL, NULL);
+    utf16_to_utf8(string.data(), string.length(), s);
+    return s;
   }
 
-  N += 1;
-
-  std::unique_ptr<char[]> p(new char [N]);
-  if (p == nullptr)
+  const int N = WideCharToMultiByte(
+    CP_ACP, WC_COMPOSITECHECK, string.data(), int(string.length()), NULL, 0, NULL, NULL);
+  if (N <= 0)
   {
     return s;
   }
 
-  ZeroMemory(p.get(), N);
-
-  WideCharToMultiByte(utf8 ? CP_UTF8 : CP_ACP, WC_COMPOSITECHECK, string.c_str(), -1, p.get(), N, NULL, NULL);
+  s.resize(N);
 
-  s.assign(p.get());
+  WideCharToMultiByte(
+    CP_ACP, WC_COMPOSITECHECK, string.data(), int(string.length()), &s[0], N, NULL, NULL);
 
   return s;
 }
@@ -200,34 +476,367 @@ std::string vuapi to_string_A(const std::wstring& string, const bool utf8)
 std::wstring vuapi to_string_W(const std::string& string, const bool utf8)
 {
   std::wstring s;
-  s.clear();
 
   if (string.empty())
   {
     return s;
   }
 
-  int N = (int)string.length();
+  if (utf8 || utf8_ascii_length(string.data(), string.length()) == string.length())
+  {
+    utf8_to_utf16(string.data(), string.length(), s);
+    return s;
+  }
 
-  if (utf8)
+  const int N = MultiByteToWideChar(CP_ACP, 0, string.data(), int(string.length()), NULL, 0);
+  if (N <= 0)
   {
-    N = MultiByteToWideChar(CP_UTF8, 0, string.c_str(), int(string.length()), NULL, 0);
+    return s;
   }
 
-  N += 1;
+  s.resize(N);
 
-  std::unique_ptr<wchar[]> p(new wchar [N]);
-  if (p == nullptr)
+  MultiByteToWideChar(CP_ACP, 0, string.data(), int(string.length()), &s[0], N);
+
+  return s;
+}
+
+/**
+ * Case Folding
+ * The ANSI strings are folded in the ASCII range only (locale-free), 16 characters at a time (SSE2).
+ * The wide strings are folded by the simple case mapping of the invariant locale, looked up from
+ * the tables that are built on the first non-ASCII character. The lengths never change.
+ */
+
+static inline char fold_lower_A(const char c)
+{
+  return byte(c - 'A') < 26 ? char(c | 0x20) : c;
+}
+
+static inline char fold_upper_A(const char c)
+{
+  return byte(c - 'a') < 26 ? char(c & ~0x20) : c;
+}
+
+#ifdef VU_SSE2
+static inline __m128i fold_range_16(const __m128i v, const char first, const char last)
+{
+  // the signed comparisons leave the non-ASCII bytes (negative) untouched
+  const __m128i ge = _mm_cmpgt_epi8(v, _mm_set1_epi8(char(first - 1)));
+  const __m128i le = _mm_cmplt_epi8(v, _mm_set1_epi8(char(last + 1)));
+  return _mm_xor_si128(v, _mm_and_si128(_mm_and_si128(ge, le), _mm_set1_epi8(0x20)));
+}
+#endif // VU_SSE2
+
+struct CaseTableW
+{
+  wchar lower[0x10000];
+  wchar upper[0x10000];
+};
+
+static int case_map_string_W(const DWORD flags, const wchar* ptr_source, const int source_length, wchar* ptr_dest)
+{
+  typedef int (WINAPI *PfnLCMapStringEx)(
+    LPCWSTR, DWORD, LPCWSTR, int, LPWSTR, int, LPNLSVERSIONINFO, LPVOID, LPARAM);
+
+  // the locale name version is resolved at run-time to keep the library loadable prior to Windows Vista
+
+  static auto pfn = PfnLCMapStringEx(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "LCMapStringEx"));
+
+  if (pfn != nullptr)
   {
-    s.clear();
+    const wchar* locale_name_invariant = L""; // LOCALE_NAME_INVARIANT
+    return pfn(locale_name_invariant, flags, ptr_source, source_length, ptr_dest, source_length, NULL, NULL, 0);
   }
 
-  ZeroMemory(p.get(), 2*N);
+  return LCMapStringW(LOCALE_INVARIANT, flags, ptr_source, source_length, ptr_dest, source_length);
+}
 
-  MultiByteToWideChar(utf8 ? CP_UTF8 : CP_ACP, 0, string.c_str(), -1, p.get(), 2*N);
+static CaseTableW* build_case_table_W()
+{
+  auto ptr_table = new CaseTableW;
 
-  s.assign(p.get());
+  std::vector<wchar> source(0x10000);
+  for (ulong c = 0; c < 0x10000; c++)
+  {
+    source[c] = c >= 0xD800 && c <= 0xDFFF ? 0 : wchar(c); // no lone surrogates for the mapping
+  }
 
+  const struct { wchar* ptr; DWORD flags; } maps[] =
+  {
+    { ptr_table->lower, LCMAP_LOWERCASE },
+    { ptr_table->upper, LCMAP_UPPERCASE },
+  };
+
+  for (const auto& map : maps)
+  {
+    const int n = case_map_string_W(map.flags, source.data(), int(source.size()), map.ptr);
+
+    for (ulong c = 0; c < 0x10000; c++)
+    {
+      if (n != int(source.size()) || c < 0x80 || (c >= 0xD800 && c <= 0xDFFF))
+      {
+        map.ptr[c] = wchar(c);
+      }
+    }
+  }
+
+  for (char c = 'A'; c <= 'Z'; c++)
+  {
+    ptr_table->lower[byte(c)] = wchar(c | 0x20);
+    ptr_table->upper[byte(c | 0x20)] = wchar(c);
+  }
+
+  return ptr_table;
+}
+
+static const CaseTableW& case_table_W()
+{
+  static const std::unique_ptr<CaseTableW> ptr_table(build_case_table_W());
+  return *ptr_table;
+}
+
+static inline wchar fold_lower_W(const wchar c, const CaseTableW*& ptr_table)
+{
+  if (c < 0x80)
+  {
+    return wchar(fold_lower_A(char(c)));
+  }
+
+  if (ptr_table == nullptr)
+  {
+    ptr_table = &case_table_W();
+  }
+
+  return ptr_table->lower[c];
+}
+
+static void fold_string_A(char* ptr, const size_t length, const bool upper)
+{
+  const char first = upper ? 'a' : 'A';
+  const char last  = upper ? 'z' : 'Z';
+
+  size_t i = 0;
+
+  #ifdef VU_SSE2
+  for (; i + 16 <= length; i += 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr + i), fold_range_16(v, first, last));
+  }
+  #endif // VU_SSE2
+
+  for (; i < length; i++)
+  {
+    if (byte(ptr[i] - first) < 26)
+    {
+      ptr[i] ^= 0x20;
+    }
+  }
+}
+
+static void fold_string_W(wchar* ptr, const size_t length, const bool upper)
+{
+  const wchar first = upper ? L'a' : L'A';
+  const CaseTableW* ptr_table = nullptr;
+
+  for (size_t i = 0; i < length; i++)
+  {
+    const wchar c = ptr[i];
+
+    if (c < 0x80)
+    {
+      if (ulong(c - first) < 26)
+      {
+        ptr[i] = wchar(c ^ 0x20);
+      }
+    }
+    else
+    {
+      if (ptr_table == nullptr)
+      {
+        ptr_table = &case_table_W();
+      }
+
+      ptr[i] = upper ? ptr_table->upper[c] : ptr_table->lower[c];
+    }
+  }
+}
+
+static bool equal_fold_A(const char* a, const char* b, const size_t length)
+{
+  size_t i = 0;
+
+  #ifdef VU_SSE2
+  for (; i + 16 <= length; i += 16)
+  {
+    const __m128i va = fold_range_16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), 'A', 'Z');
+    const __m128i vb = fold_range_16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)), 'A', 'Z');
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF)
+    {
+      return false;
+    }
+  }
+  #endif // VU_SSE2
+
+  for (; i < length; i++)
+  {
+    if (fold_lower_A(a[i]) != fold_lower_A(b[i]))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool equal_fold_W(const wchar* a, const wchar* b, const size_t length)
+{
+  const CaseTableW* ptr_table = nullptr;
+
+  for (size_t i = 0; i < length; i++)
+  {
+    if (a[i] != b[i] && fold_lower_W(a[i], ptr_table) != fold_lower_W(b[i], ptr_table))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static size_t find_fold_A(const std::string& text, const std::string& test)
+{
+  const size_t n = text.length();
+  const size_t m = test.length();
+
+  if (m == 0)
+  {
+    return 0;
+  }
+
+  if (m > n)
+  {
+    return std::string::npos;
+  }
+
+  const char* p = text.data();
+  const char* q = test.data();
+
+  const char lo = fold_lower_A(q[0]);
+  const char hi = fold_upper_A(q[0]);
+  const size_t count = n - m + 1; // the number of the start positions
+
+  size_t i = 0;
+
+  #ifdef VU_SSE2
+  const __m128i vlo = _mm_set1_epi8(lo);
+  const __m128i vhi = _mm_set1_epi8(hi);
+
+  for (; i + 16 <= count; i += 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    ulong mask = ulong(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, vlo), _mm_cmpeq_epi8(v, vhi))));
+
+    for (; mask != 0; mask &= mask - 1)
+    {
+      const size_t j = i + count_trailing_zeros(mask);
+      if (equal_fold_A(p + j + 1, q + 1, m - 1))
+      {
+        return j;
+      }
+    }
+  }
+  #endif // VU_SSE2
+
+  for (; i < count; i++)
+  {
+    if ((p[i] == lo || p[i] == hi) && equal_fold_A(p + i + 1, q + 1, m - 1))
+    {
+      return i;
+    }
+  }
+
+  return std::string::npos;
+}
+
+static size_t find_fold_W(const std::wstring& text, const std::wstring& test)
+{
+  const size_t n = text.length();
+  const size_t m = test.length();
+
+  if (m == 0)
+  {
+    return 0;
+  }
+
+  if (m > n)
+  {
+    return std::wstring::npos;
+  }
+
+  const wchar* p = text.data();
+  const wchar* q = test.data();
+
+  const CaseTableW* ptr_table = nullptr;
+  const wchar first = fold_lower_W(q[0], ptr_table);
+
+  for (size_t i = 0; i + m <= n; i++)
+  {
+    if (fold_lower_W(p[i], ptr_table) == first && equal_fold_W(p + i + 1, q + 1, m - 1))
+    {
+      return i;
+    }
+  }
+
+  return std::wstring::npos;
+}
+
+void vuapi lower_string_in_place_A(std::string& string)
+{
+  fold_string_A(&string[0], string.length(), false);
+}
+
+void vuapi lower_string_in_place_W(std::wstring& string)
+{
+  fold_string_W(&string[0], string.length(), false);
+}
+
+void vuapi upper_string_in_place_A(std::string& string)
+{
+  fold_string_A(&string[0], string.length(), true);
+}
+
+void vuapi upper_string_in_place_W(std::wstring& string)
+{
+  fold_string_W(&string[0], string.length(), true);
+}
+
+std::string vuapi lower_string_A(const std::string& string)
+{
+  std::string s(string);
+  lower_string_in_place_A(s);
+  return s;
+}
+
+std::wstring vuapi lower_string_W(const std::wstring& string)
+{
+  std::wstring s(string);
+  lower_string_in_place_W(s);
+  return s;
+}
+
+std::string vuapi upper_string_A(const std::string& string)
+{
+  std::string s(string);
+  upper_string_in_place_A(s);
+  return s;
+}
+
+std::wstring vuapi upper_string_W(const std::wstring& string)
+{
+  std::wstring s(string);
+  upper_string_in_place_W(s);
   return s;
 }
 
@@ -243,21 +852,27 @@ std::vector<std_string_t> split_string_T(
     return l;
   }
 
-  std_string_t s(string), sep(separator), sub;
-  ulongptr start, end;
+  // Walk the input in-place and construct each piece once (embedded NULs are kept)
+
+  auto ptr_first = string.data();
+  auto ptr_last  = ptr_first + string.length();
 
-  start = 0;
-  end = s.find(sep);
-  while (end != std_string_t::npos)
+  for (;;)
   {
-    sub = s.substr(start, end - start);
-    if (!sub.empty() || !remove_empty) l.push_back(std_string_t(sub.c_str()));
-    start = end + sep.length();
-    end = s.find(sep, start);
-  }
+    auto ptr = find_sequence_T(ptr_first, ptr_last, separator.data(), separator.length());
 
-  sub = s.substr(start, end);
-  if (!sub.empty() || !remove_empty) l.push_back(std_string_t(sub.c_str()));
+    if (ptr != ptr_first || !remove_empty)
+    {
+      l.emplace_back(ptr_first, ptr);
+    }
+
+    if (ptr == ptr_last)
+    {
+      break;
+    }
+
+    ptr_first = ptr + separator.length();
+  }
 
   return l;
 }
@@ -522,9 +1137,7 @@ bool vuapi starts_with_A(const std::string& text, const std::string& with, bool
 {
   if (ignore_case)
   {
-    const auto v1 = lower_string_A(text);
-    const auto v2 = lower_string_A(with);
-    return starts_with_T<std::string>(v1, v2);
+    return text.length() >= with.length() && equal_fold_A(text.data(), with.data(), with.length());
   }
 
   return starts_with_T<std::string>(text, with);
@@ -534,9 +1147,7 @@ bool vuapi starts_with_W(const std::wstring& text, const std::wstring& with, boo
 {
   if (ignore_case)
   {
-    const auto v1 = lower_string_W(text);
-    const auto v2 = lower_string_W(with);
-    return starts_with_T<std::wstring>(v1, v2);
+    return text.length() >= with.length() && equal_fold_W(text.data(), with.data(), with.length());
   }
 
   return starts_with_T<std::wstring>(text, with);
@@ -553,9 +1164,8 @@ bool vuapi ends_with_A(const std::string& text, const std::string& with, bool ig
 {
   if (ignore_case)
   {
-    const auto v1 = lower_string_A(text);
-    const auto v2 = lower_string_A(with);
-    return ends_with_T<std::string>(v1, v2);
+    return text.length() >= with.length() &&
+      equal_fold_A(text.data() + text.length() - with.length(), with.data(), with.length());
   }
 
   return ends_with_T<std::string>(text, with);
@@ -565,9 +1175,8 @@ bool vuapi ends_with_W(const std::wstring& text, const std::wstring& with, bool
 {
   if (ignore_case)
   {
-    const auto v1 = lower_string_W(text);
-    const auto v2 = lower_string_W(with);
-    return ends_with_T<std::wstring>(v1, v2);
+    return text.length() >= with.length() &&
+      equal_fold_W(text.data() + text.length() - with.length(), with.data(), with.length());
   }
 
   return ends_with_T<std::wstring>(text, with);
@@ -577,9 +1186,7 @@ bool vuapi contains_string_A(const std::string& text, const std::string& test, b
 {
   if (ignore_case)
   {
-    const auto v1 = lower_string_A(text);
-    const auto v2 = lower_string_A(test);
-    return v1.find(v2) != std::string::npos;
+    return find_fold_A(text, test) != std::string::npos;
   }
 
   return text.find(test) != std::string::npos;
@@ -589,21 +1196,27 @@ bool vuapi contains_string_W(const std::wstring& text, const std::wstring& test,
 {
   if (ignore_case)
   {
-    const auto v1 = lower_string_W(text);
-    const auto v2 = lower_string_W(test);
-    return v1.find(v2) != std::string::npos;
+    return find_fold_W(text, test) != std::wstring::npos;
   }
 
   return text.find(test) != std::wstring::npos;
 }
 
+size_t vuapi find_string_A(const std::string& text, const std::string& test, bool ignore_case)
+{
+  return ignore_case ? find_fold_A(text, test) : text.find(test);
+}
+
+size_t vuapi find_string_W(const std::wstring& text, const std::wstring& test, bool ignore_case)
+{
+  return ignore_case ? find_fold_W(text, test) : text.find(test);
+}
+
 bool vuapi compare_string_A(const std::string& vl, const std::string& vr, bool ignore_case)
 {
   if (ignore_case)
   {
-    const auto v1 = lower_string_A(vl);
-    const auto v2 = lower_string_A(vr);
-    return v1 == v2;
+    return vl.length() == vr.length() && equal_fold_A(vl.data(), vr.data(), vl.length());
   }
 
   return vl == vr;
@@ -613,9 +1226,7 @@ bool vuapi compare_string_W(const std::wstring& vl, const std::wstring& vr, bool
 {
   if (ignore_case)
   {
-    const auto v1 = lower_string_W(vl);
-    const auto v2 = lower_string_W(vr);
-    return v1 == v2;
+    return vl.length() == vr.length() && equal_fold_W(vl.data(), vr.data(), vl.length());
   }
 
   return vl == vr;
@@ -661,30 +1272,38 @@ StringT vuapi find_closest_string_T(const StringT& string, const std::vector<Str
     return StringT();
   }
 
+  std::vector<size_t> length_row; // the rolling row of the table, reused for all candidates
+
   auto fn_find_max_common_sub_string_length = [&](const StringT& a, const StringT& b) -> size_t
   {
     size_t result = 0;
 
     size_t n = a.length();
     size_t m = b.length();
-    std::vector<std::vector<size_t>> length_table(n + 1, std::vector<size_t>(m + 1, 0));
+    length_row.assign(m + 1, 0);
 
     for (size_t i = 1; i <= n; i++)
     {
+      size_t diagonal = 0; // the length_table[i - 1][j - 1]
+
       for (size_t j = 1; j <= m; j++)
       {
+        const size_t above = length_row[j];
+
         if (a[i - 1] == b[j - 1])
         {
-          length_table[i][j] = length_table[i - 1][j - 1] + 1;
-          if (length_table[i][j] > result)
+          length_row[j] = diagonal + 1;
+          if (length_row[j] > result)
           {
-            result = length_table[i][j];
+            result = length_row[j];
           }
         }
         else
         {
-          length_table[i][j] = 0;
+          length_row[j] = 0;
         }
+
+        diagonal = above;
       }
     }
 
@@ -703,7 +1322,7 @@ StringT vuapi find_closest_string_T(const StringT& string, const std::vector<Str
     }
   }
 
-  return max_idx >= 0 ? string_list[max_idx] : string_list[0];
+  return string_list[max_idx];
 }
 
 std::string vuapi find_closest_string_A(
@@ -39,6 +39,24 @@ void ThreadPool::launch()
   m_ptr_impl->waitAll();
 }
 
+size_t ThreadPool::parallel_for(const size_t num_items, std::function<void(const piece_t& piece)> fn,
+  const size_t grain_size, const size_t alignment)
+{
+  if (fn == nullptr)
+  {
+    return 0;
+  }
+
+  const auto num_pieces = divide_items(num_items, this->worker_count(), [&](const piece_t& piece)
+  {
+    this->add_task([fn, piece]() { fn(piece); });
+  }, grain_size, alignment);
+
+  this->launch();
+
+  return num_pieces;
+}
+
 size_t ThreadPool::worker_count() const
 {
   return m_ptr_impl->getWorkerCount();